@@ -1,3 +1,9 @@
 @echo off
 
-python build.py build.json
\ No newline at end of file
+python build.py build.json
+python build.py build_hlodbuilder.json
+python build.py build_obj2ucmesh.json
+python build.py build_png2uctex.json
+python build.py build_assetcooker.json
+python build.py build_ucpack.json
+python build.py build_pvsbuilder.json
\ No newline at end of file
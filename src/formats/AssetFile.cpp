@@ -0,0 +1,29 @@
+#include "AssetFile.hpp"
+
+#include "UCPACKFile.hpp"
+
+// === PUBLIC ===
+
+bool AssetFile::Open(std::string filename)
+{
+    Close();
+
+    if (!UCPACKFile::ReadMounted(filename, &data, &size, &buffer))
+    {
+        if (!file.Open(filename)) return false;
+        data = file.GetData();
+        size = file.GetSize();
+    }
+
+    opened = true;
+    return true;
+}
+
+void AssetFile::Close()
+{
+    file.Close();
+    buffer = std::vector<uint8_t>();
+    data = nullptr;
+    size = 0;
+    opened = false;
+}
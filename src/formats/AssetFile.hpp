@@ -0,0 +1,32 @@
+#ifndef ASSETFILE_HPP
+#define ASSETFILE_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "MappedFile.hpp"
+
+// contents of asset file: entry of mounted UCPACK archive if there is one (see UCPACKFile::Mount()), mapped file otherwise.
+class AssetFile
+{
+  private:
+    MappedFile file;
+    std::vector<uint8_t> buffer = std::vector<uint8_t>(); // decompressed archive entry.
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    bool opened = false;
+
+  public:
+    AssetFile() {}
+
+    bool Open(std::string filename);
+    void Close();
+
+    inline bool IsOpen() { return opened; }
+    inline const uint8_t *GetData() { return data; }
+    inline size_t GetSize() { return size; }
+};
+
+#endif
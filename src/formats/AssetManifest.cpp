@@ -0,0 +1,110 @@
+#include "AssetManifest.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <algorithm>
+
+#include "MappedFile.hpp"
+#include "AssetFile.hpp"
+#include "../utils.hpp"
+
+// === PUBLIC ===
+
+bool AssetManifest::Load(std::string filename)
+{
+    Clear();
+
+    MappedFile file = MappedFile();
+    if (!file.Open(filename)) return false;
+
+    const uint8_t *data = file.GetData();
+    size_t size = file.GetSize();
+    UCMANIFESTHeader header;
+    if (size < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+
+    size_t entriesSize = (size_t)header.entriesCount * sizeof(UCMANIFESTEntry);
+    if (memcmp(header.signature, "UCMANIF", 8) || header.version > UCMANIFEST_VERSION || header.stringsSize == 0 ||
+        sizeof(header) + entriesSize + header.stringsSize > size) return false;
+
+    entries.resize(header.entriesCount);
+    memcpy(entries.data(), data + sizeof(header), entriesSize);
+    strings.assign(data + sizeof(header) + entriesSize, data + sizeof(header) + entriesSize + header.stringsSize);
+
+    // strings must end with null, so GetString() never runs out of them.
+    if (strings.back() != '\0') { Clear(); return false; }
+    return true;
+}
+
+bool AssetManifest::Save(std::string filename)
+{
+    std::sort(entries.begin(), entries.end(), [](const UCMANIFESTEntry &a, const UCMANIFESTEntry &b) { return a.sourceId < b.sourceId; });
+
+    // written next to target and renamed, so readers never see half written manifest.
+    std::string temp = filename + ".tmp";
+    FILE *f = fopen(temp.c_str(), "wb");
+    if (!f) return false;
+
+    UCMANIFESTHeader header = UCMANIFESTHeader();
+    memcpy(header.signature, "UCMANIF", 8);
+    header.version = UCMANIFEST_VERSION;
+    header.entriesCount = entries.size();
+    header.stringsSize = strings.size();
+
+    fwrite(&header, sizeof(header), 1, f);
+    fwrite(entries.data(), sizeof(UCMANIFESTEntry), entries.size(), f);
+    fwrite(strings.data(), sizeof(char), strings.size(), f);
+
+    bool ok = !ferror(f);
+    if (fclose(f) != 0 || !ok) return false;
+
+    std::error_code ec;
+    std::filesystem::rename(temp, filename, ec);
+    return !ec;
+}
+
+void AssetManifest::Clear()
+{
+    entries.clear();
+    strings.assign(1, '\0');
+}
+
+void AssetManifest::AddEntry(UCMANIFESTEntry entry, std::string source_path, std::string cooked_path)
+{
+    entry.sourcePath = strings.size();
+    strings.insert(strings.end(), source_path.begin(), source_path.end());
+    strings.push_back('\0');
+
+    entry.cookedPath = strings.size();
+    strings.insert(strings.end(), cooked_path.begin(), cooked_path.end());
+    strings.push_back('\0');
+
+    entries.push_back(entry);
+}
+
+int64_t AssetManifest::Find(uint64_t source_id)
+{
+    std::vector<UCMANIFESTEntry>::iterator it = std::lower_bound(entries.begin(), entries.end(), source_id,
+        [](const UCMANIFESTEntry &e, uint64_t id) { return e.sourceId < id; });
+    return it != entries.end() && it->sourceId == source_id ? it - entries.begin() : -1;
+}
+
+int64_t AssetManifest::Find(std::string source_path) { return Find(Utils::hash64(source_path)); }
+
+std::string AssetManifest::Locate(std::string source_path)
+{
+    int64_t i = Find(source_path);
+    return i >= 0 ? GetString(entries[i].cookedPath) : "";
+}
+
+bool AssetManifest::Validate(size_t index, std::string root, bool full)
+{
+    if (index >= entries.size()) return false;
+    UCMANIFESTEntry *e = &entries[index];
+
+    AssetFile file = AssetFile();
+    if (!file.Open((std::filesystem::path(root) / GetString(e->cookedPath)).string()) || file.GetSize() != e->cookedSize) return false;
+
+    return !full || Utils::hash64(file.GetData(), file.GetSize()) == e->cookedHash;
+}
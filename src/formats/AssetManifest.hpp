@@ -0,0 +1,75 @@
+#ifndef ASSETMANIFEST_HPP
+#define ASSETMANIFEST_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+    UCMANIFEST - list of cooked assets written by assetcooker: header, entries (sorted by sourceId),
+    strings (null terminated, offset 0 is empty string).
+
+    Paths are generic (with '/'): source ones are relative to source directory, cooked ones to manifest's directory.
+*/
+
+#define UCMANIFEST_VERSION 0
+
+struct
+{
+    char signature[8]; // "UCMANIF\0".
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t entriesCount;
+    uint32_t stringsSize;
+    uint32_t reserved2; // entries are 8 byte aligned.
+} typedef UCMANIFESTHeader;
+
+struct
+{
+    uint64_t sourceId; // Utils::hash64 of source path.
+    uint64_t sourceHash; // Utils::hash64 of source content.
+    uint64_t settingsHash; // converter version and settings.
+    uint64_t sourceSize;
+    int64_t sourceTime; // modification time, lets cooker skip hashing of untouched sources.
+    uint64_t cookedHash; // Utils::hash64 of cooked file.
+    uint64_t cookedSize;
+    uint32_t sourcePath;
+    uint32_t cookedPath;
+    uint32_t type; // UCSCENEAssetType.
+    uint32_t reserved;
+} typedef UCMANIFESTEntry;
+
+class AssetManifest
+{
+  private:
+    std::vector<UCMANIFESTEntry> entries = std::vector<UCMANIFESTEntry>();
+    std::vector<char> strings = std::vector<char>(1, '\0');
+
+  public:
+    AssetManifest() {}
+
+    bool Load(std::string filename);
+    // entries are sorted on save.
+    bool Save(std::string filename);
+    void Clear();
+
+    // source_path and cooked_path are copied into strings, fields with their offsets are set.
+    void AddEntry(UCMANIFESTEntry entry, std::string source_path, std::string cooked_path);
+
+    inline size_t GetEntriesCount() { return entries.size(); }
+    inline const UCMANIFESTEntry *GetEntries() { return entries.data(); }
+    inline const char *GetString(uint32_t offset) { return offset < strings.size() ? strings.data() + offset : ""; }
+
+    // index of entry (binary search, manifest must be loaded or saved), -1 if there is none.
+    int64_t Find(uint64_t source_id);
+    int64_t Find(std::string source_path);
+
+    // cooked path (relative to manifest) of source, empty if source isn't cooked.
+    std::string Locate(std::string source_path);
+
+    // cooked file (cooked path is relative to root, can be in mounted UCPACK archive) exists and has recorded size,
+    // full also compares content hash.
+    bool Validate(size_t index, std::string root, bool full = false);
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include "LZ4.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+// === PRIVATE ===
+
+#define LZ4_HASH_BITS 14
+#define LZ4_MIN_MATCH 4
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_LAST_LITERALS 5 // end of block is never matched.
+#define LZ4_MF_LIMIT 12 // last match must start at least that far from end.
+
+static inline uint32_t read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t hash(uint32_t sequence) { return (sequence * 2654435761U) >> (32 - LZ4_HASH_BITS); }
+
+// 15 in token nibble is continued by bytes of 255 and the last one less than 255.
+static inline uint8_t *writelength(uint8_t *op, size_t length)
+{
+    for (length -= 15; length >= 255; length -= 255) *op++ = 255;
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+static inline bool readlength(const uint8_t **ip, const uint8_t *iend, size_t *length)
+{
+    uint8_t b;
+    do
+    {
+        if (*ip >= iend) return false;
+        b = *(*ip)++;
+        *length += b;
+    } while (b == 255);
+    return true;
+}
+
+static uint8_t *writesequence(uint8_t *op, const uint8_t *literals, size_t literals_count, size_t offset, size_t match_length)
+{
+    uint8_t *token = op++;
+    *token = (uint8_t)((literals_count >= 15 ? 15 : literals_count) << 4);
+    if (literals_count >= 15) op = writelength(op, literals_count);
+    if (literals_count > 0) memcpy(op, literals, literals_count);
+    op += literals_count;
+
+    if (offset == 0) return op; // last sequence has literals only.
+
+    *op++ = offset & 0xFF;
+    *op++ = offset >> 8;
+    match_length -= LZ4_MIN_MATCH;
+    *token |= match_length >= 15 ? 15 : match_length;
+    if (match_length >= 15) op = writelength(op, match_length);
+    return op;
+}
+
+// === PUBLIC ===
+
+size_t LZ4::Compress(const uint8_t *src, size_t size, uint8_t *dst, size_t dst_capacity)
+{
+    if (dst_capacity < GetMaxCompressedSize(size)) return 0;
+
+    const uint8_t *ip = src, *anchor = src, *end = src + size;
+    uint8_t *op = dst;
+
+    if (size > LZ4_MF_LIMIT)
+    {
+        // positions relative to src, initial 0 is just a candidate that fails comparison.
+        std::vector<uint32_t> table = std::vector<uint32_t>(1 << LZ4_HASH_BITS, 0);
+        const uint8_t *mflimit = end - LZ4_MF_LIMIT, *matchlimit = end - LZ4_LAST_LITERALS;
+
+        while (ip < mflimit)
+        {
+            uint32_t sequence = read32(ip);
+            uint32_t *slot = &table[hash(sequence)];
+            const uint8_t *ref = src + *slot;
+            *slot = (uint32_t)(ip - src);
+
+            if (ref >= ip || ip - ref > LZ4_MAX_OFFSET || read32(ref) != sequence)
+            {
+                // incompressible data is skipped faster the longer there is no match.
+                ip += std::min<size_t>(1 + ((ip - anchor) >> 6), mflimit - ip);
+                continue;
+            }
+
+            while (ip > anchor && ref > src && ip[-1] == ref[-1]) { ip--; ref--; }
+
+            const uint8_t *m = ip + LZ4_MIN_MATCH, *r = ref + LZ4_MIN_MATCH;
+            while (m < matchlimit && *m == *r) { m++; r++; }
+
+            op = writesequence(op, anchor, ip - anchor, ip - ref, m - ip);
+            ip = anchor = m;
+
+            if (ip - 2 >= src && ip < mflimit) table[hash(read32(ip - 2))] = (uint32_t)(ip - 2 - src);
+        }
+    }
+
+    op = writesequence(op, anchor, end - anchor, 0, 0);
+    return op - dst;
+}
+
+bool LZ4::Decompress(const uint8_t *src, size_t size, uint8_t *dst, size_t dst_size)
+{
+    const uint8_t *ip = src, *iend = src + size;
+    uint8_t *op = dst, *oend = dst + dst_size;
+
+    while (ip < iend)
+    {
+        uint8_t token = *ip++;
+
+        size_t literals_count = token >> 4;
+        if (literals_count == 15 && !readlength(&ip, iend, &literals_count)) return false;
+        if (literals_count > (size_t)(iend - ip) || literals_count > (size_t)(oend - op)) return false;
+        if (literals_count > 0) memcpy(op, ip, literals_count);
+        ip += literals_count;
+        op += literals_count;
+
+        if (ip == iend) break; // last sequence.
+
+        if (iend - ip < 2) return false;
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst)) return false;
+
+        size_t match_length = token & 15;
+        if (match_length == 15 && !readlength(&ip, iend, &match_length)) return false;
+        match_length += LZ4_MIN_MATCH;
+        if (match_length > (size_t)(oend - op)) return false;
+
+        // overlapping match repeats the last offset bytes, so it's copied byte by byte.
+        const uint8_t *match = op - offset;
+        if (offset >= match_length) memcpy(op, match, match_length);
+        else for (size_t i = 0; i < match_length; i++) op[i] = match[i];
+        op += match_length;
+    }
+
+    return op == oend;
+}
@@ -0,0 +1,23 @@
+#ifndef LZ4_HPP
+#define LZ4_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+/*
+    LZ4 block format (sequences of token, literals, 16 bit offset and match length, last 5 bytes are always literals),
+    so blocks can be checked by reference lz4 tools. Compressor is greedy single hash table one: fast, not the best ratio.
+*/
+class LZ4
+{
+  public:
+    // dst must have at least this size for Compress().
+    static inline size_t GetMaxCompressedSize(size_t size) { return size + size / 255 + 16; }
+
+    // returns compressed size, 0 if dst_capacity is less than GetMaxCompressedSize(size).
+    static size_t Compress(const uint8_t *src, size_t size, uint8_t *dst, size_t dst_capacity);
+    // false if src is malformed or doesn't decompress exactly into dst_size bytes, never reads or writes out of bounds.
+    static bool Decompress(const uint8_t *src, size_t size, uint8_t *dst, size_t dst_size);
+};
+
+#endif
@@ -0,0 +1,76 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+// === PUBLIC ===
+
+MappedFile::~MappedFile() { Close(); }
+
+bool MappedFile::Open(std::string filename)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE f = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fsize;
+    if (!GetFileSizeEx(f, &fsize)) { CloseHandle(f); return false; }
+
+    file = f;
+    size = (size_t)fsize.QuadPart;
+    opened = true;
+    if (size == 0) return true; // empty file can't be mapped.
+
+    HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m) { Close(); return false; }
+    mapping = m;
+
+    data = (const uint8_t *)MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+    if (!data) { Close(); return false; }
+#else
+    fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) { Close(); return false; }
+
+    size = (size_t)st.st_size;
+    opened = true;
+    if (size == 0) return true;
+
+    void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) { Close(); return false; }
+    data = (const uint8_t *)p;
+#endif
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (data) UnmapViewOfFile(data);
+    if (mapping) CloseHandle((HANDLE)mapping);
+    if (file) CloseHandle((HANDLE)file);
+    mapping = file = nullptr;
+#else
+    if (data) munmap((void *)data, size);
+    if (fd >= 0) close(fd);
+    fd = -1;
+#endif
+
+    data = nullptr;
+    size = 0;
+    opened = false;
+}
@@ -0,0 +1,39 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// read-only memory mapped file, data stay valid until Close() (or destruction).
+class MappedFile
+{
+  private:
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    bool opened = false;
+
+#ifdef _WIN32
+    void *file = nullptr;
+    void *mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+
+  public:
+    MappedFile() {}
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // empty file is opened successfully, but has no data.
+    bool Open(std::string filename);
+    void Close();
+
+    inline bool IsOpen() { return opened; }
+    inline const uint8_t *GetData() { return data; }
+    inline size_t GetSize() { return size; }
+};
+
+#endif
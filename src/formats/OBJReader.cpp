@@ -0,0 +1,256 @@
+#include "OBJReader.hpp"
+
+#include <unordered_map>
+#include <charconv>
+#include <cstring>
+#include <cmath>
+
+#include "MappedFile.hpp"
+#include "../utils.hpp"
+
+// === PRIVATE ===
+
+struct
+{
+    float x, y, z, u, v;
+} typedef OBJVertexKey;
+
+struct OBJVertexKeyHash
+{
+    size_t operator()(const OBJVertexKey &k) const { return Utils::hash64(&k, sizeof(k)); }
+};
+
+struct OBJVertexKeyEqual
+{
+    bool operator()(const OBJVertexKey &a, const OBJVertexKey &b) const { return !memcmp(&a, &b, sizeof(a)); }
+};
+
+static inline const char *skipspaces(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    return p;
+}
+
+static inline bool isseparator(const char *p, const char *end) { return p >= end || *p == ' ' || *p == '\t' || *p == '\r'; }
+
+static bool parsefloat(const char **p, const char *end, float *out)
+{
+    const char *s = skipspaces(*p, end);
+    if (s < end && *s == '+') s++;
+
+    std::from_chars_result r = std::from_chars(s, end, *out);
+    if (r.ec != std::errc() || !isseparator(r.ptr, end)) return false;
+
+    *p = r.ptr;
+    return true;
+}
+
+static bool parseindex(const char **p, const char *end, int64_t *out)
+{
+    std::from_chars_result r = std::from_chars(*p, end, *out);
+    if (r.ec != std::errc()) return false;
+
+    *p = r.ptr;
+    return true;
+}
+
+// 1-based or negative (relative to end) OBJ index -> 0-based, -1 if invalid.
+static inline int64_t resolveindex(int64_t index, size_t count)
+{
+    int64_t i = index > 0 ? index - 1 : (int64_t)count + index;
+    return index != 0 && i >= 0 && i < (int64_t)count ? i : -1;
+}
+
+// twice signed area, positive for counter-clockwise.
+static inline float area(glm::vec2 a, glm::vec2 b, glm::vec2 c) { return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x); }
+
+static inline bool iskeyword(const char *p, size_t length, const char *keyword) { return strlen(keyword) == length && !memcmp(p, keyword, length); }
+
+// === PUBLIC ===
+
+bool OBJReader::ReadOBJFile(std::string filename, UCMESHData *mesh)
+{
+    MappedFile file = MappedFile();
+    if (!file.Open(filename)) return false;
+
+    return ReadOBJ((const char *)file.GetData(), file.GetSize(), mesh);
+}
+
+bool OBJReader::ReadOBJ(const char *text, size_t size, UCMESHData *mesh)
+{
+    positions.clear();
+    uvs.clear();
+    stats = OBJReadStats();
+    mesh->Clear();
+
+    std::unordered_map<OBJVertexKey, uint32_t, OBJVertexKeyHash, OBJVertexKeyEqual> welded = std::unordered_map<OBJVertexKey, uint32_t, OBJVertexKeyHash, OBJVertexKeyEqual>();
+    std::vector<std::pair<int64_t, int64_t>> references = std::vector<std::pair<int64_t, int64_t>>(); // (position, UV or -1) of face corners.
+    std::vector<uint32_t> corners = std::vector<uint32_t>();
+    std::vector<uint32_t> triangles = std::vector<uint32_t>();
+
+    const char *p = text, *end = text + size;
+    while (p < end)
+    {
+        const char *eol = (const char *)memchr(p, '\n', end - p);
+        if (!eol) eol = end;
+        stats.linesCount++;
+
+        const char *s = skipspaces(p, eol);
+        const char *kw = s;
+        while (s < eol && !isseparator(s, eol)) s++;
+        size_t kwlength = s - kw;
+
+        bool ok = true;
+        if (kwlength == 0 || *kw == '#') {}
+        else if (iskeyword(kw, kwlength, "v"))
+        {
+            glm::vec3 v;
+            ok = parsefloat(&s, eol, &v.x) && parsefloat(&s, eol, &v.y) && parsefloat(&s, eol, &v.z);
+            if (ok) positions.push_back(v);
+        }
+        else if (iskeyword(kw, kwlength, "vt"))
+        {
+            glm::vec2 uv = glm::vec2(0.0f);
+            ok = parsefloat(&s, eol, &uv.x);
+            if (ok && skipspaces(s, eol) < eol) ok = parsefloat(&s, eol, &uv.y);
+            if (ok) uvs.push_back(uv);
+        }
+        else if (iskeyword(kw, kwlength, "f"))
+        {
+            references.clear();
+            corners.clear();
+            while (ok && (s = skipspaces(s, eol)) < eol)
+            {
+                int64_t vi, ti = 0, ni;
+                ok = parseindex(&s, eol, &vi) && (vi = resolveindex(vi, positions.size())) >= 0;
+                if (ok && s < eol && *s == '/')
+                {
+                    s++;
+                    if (s < eol && *s != '/') ok = parseindex(&s, eol, &ti) && (ti = resolveindex(ti, uvs.size())) >= 0;
+                    else ti = -1;
+                    if (ok && s < eol && *s == '/') { s++; ok = parseindex(&s, eol, &ni); } // normals are ignored.
+                }
+                else ti = -1;
+                ok = ok && isseparator(s, eol);
+                if (ok) references.push_back({ vi, ti });
+            }
+
+            // vertices are made only for valid faces, so skipped ones don't leave unused vertices.
+            ok = ok && references.size() >= 3;
+            for (size_t i = 0; ok && i < references.size(); i++)
+            {
+                glm::vec3 v = positions[references[i].first];
+                glm::vec2 uv = references[i].second >= 0 ? uvs[references[i].second] : glm::vec2(0.0f);
+                // +0.0f makes -0 and 0 the same key.
+                OBJVertexKey key = { v.x + 0.0f, v.y + 0.0f, v.z + 0.0f, uv.x + 0.0f, uv.y + 0.0f };
+
+                std::pair<decltype(welded)::iterator, bool> it = welded.emplace(key, (uint32_t)mesh->vertices.size());
+                if (it.second)
+                {
+                    mesh->vertices.push_back(v);
+                    mesh->uvs.push_back(uv);
+                }
+                corners.push_back(it.first->second);
+            }
+
+            if (ok)
+            {
+                stats.facesCount++;
+                if (corners.size() > 3) stats.polygonsCount++;
+
+                triangles.clear();
+                TriangulatePolygon(mesh->vertices.data(), corners.data(), corners.size(), &triangles);
+                for (size_t i = 0; i < triangles.size(); i += 3)
+                {
+                    uint32_t a = triangles[i], b = triangles[i + 1], c = triangles[i + 2];
+                    if (a == b || b == c || a == c) stats.degenerateTrianglesCount++;
+                    else mesh->indices.insert(mesh->indices.end(), { a, b, c });
+                }
+            }
+        }
+        else
+        {
+            ok = iskeyword(kw, kwlength, "vn") || iskeyword(kw, kwlength, "vp") || iskeyword(kw, kwlength, "g") || iskeyword(kw, kwlength, "o")
+                || iskeyword(kw, kwlength, "s") || iskeyword(kw, kwlength, "usemtl") || iskeyword(kw, kwlength, "mtllib")
+                || iskeyword(kw, kwlength, "l") || iskeyword(kw, kwlength, "p");
+        }
+
+        if (!ok)
+        {
+            stats.skippedLinesCount++;
+            if (!stats.firstSkippedLine) stats.firstSkippedLine = stats.linesCount;
+        }
+
+        p = eol < end ? eol + 1 : end;
+    }
+
+    return true;
+}
+
+void OBJReader::TriangulatePolygon(const glm::vec3 *positions, const uint32_t *corners, size_t corners_count, std::vector<uint32_t> *out)
+{
+    if (corners_count < 3) return;
+    if (corners_count == 3)
+    {
+        out->insert(out->end(), { corners[0], corners[1], corners[2] });
+        return;
+    }
+
+    // Newell normal, polygon is projected on plane of its dominant axis and made counter-clockwise.
+    glm::vec3 normal = glm::vec3(0.0f);
+    for (size_t i = 0; i < corners_count; i++)
+    {
+        glm::vec3 a = positions[corners[i]], b = positions[corners[(i + 1) % corners_count]];
+        normal += glm::vec3((a.y - b.y) * (a.z + b.z), (a.z - b.z) * (a.x + b.x), (a.x - b.x) * (a.y + b.y));
+    }
+
+    int axis = 0;
+    for (int i = 1; i < 3; i++) if (std::fabs(normal[i]) > std::fabs(normal[axis])) axis = i;
+
+    std::vector<uint32_t> remaining = std::vector<uint32_t>();
+    for (uint32_t i = 0; i < corners_count; i++) remaining.push_back(i);
+
+    if (normal[axis] != 0.0f)
+    {
+        std::vector<glm::vec2> points = std::vector<glm::vec2>(corners_count);
+        for (size_t i = 0; i < corners_count; i++)
+        {
+            glm::vec3 p = positions[corners[i]];
+            points[i] = glm::vec2(normal[axis] > 0.0f ? p[(axis + 1) % 3] : -p[(axis + 1) % 3], p[(axis + 2) % 3]);
+        }
+
+        while (remaining.size() > 3)
+        {
+            size_t m = remaining.size();
+            bool clipped = false;
+            for (size_t i = 0; i < m && !clipped; i++)
+            {
+                uint32_t a = remaining[(i + m - 1) % m], b = remaining[i], c = remaining[(i + 1) % m];
+                if (area(points[a], points[b], points[c]) <= 0.0f) continue; // reflex or flat corner.
+
+                bool ear = true;
+                for (uint32_t r : remaining)
+                {
+                    glm::vec2 q = points[r];
+                    if (r == a || r == b || r == c || q == points[a] || q == points[b] || q == points[c]) continue;
+                    if (area(points[a], points[b], q) >= 0.0f && area(points[b], points[c], q) >= 0.0f && area(points[c], points[a], q) >= 0.0f)
+                    {
+                        ear = false;
+                        break;
+                    }
+                }
+                if (!ear) continue;
+
+                out->insert(out->end(), { corners[a], corners[b], corners[c] });
+                remaining.erase(remaining.begin() + i);
+                clipped = true;
+            }
+
+            // self-intersecting or degenerate rest, fan is as good as anything.
+            if (!clipped) break;
+        }
+    }
+
+    for (size_t i = 1; i + 1 < remaining.size(); i++)
+        out->insert(out->end(), { corners[remaining[0]], corners[remaining[i]], corners[remaining[i + 1]] });
+}
@@ -0,0 +1,47 @@
+#ifndef OBJREADER_HPP
+#define OBJREADER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "../glm.hpp"
+#include "UCMESHData.hpp"
+
+struct
+{
+    size_t linesCount;
+    size_t facesCount;
+    size_t polygonsCount; // faces with more than 3 corners.
+    size_t skippedLinesCount; // invalid or unsupported statements.
+    size_t firstSkippedLine; // 0 - none.
+    size_t degenerateTrianglesCount; // dropped.
+} typedef OBJReadStats;
+
+/*
+    Wavefront OBJ reader: positions ("v"), UVs ("vt") and faces ("f", any number of corners, negative indices are
+    relative), everything else (normals, groups, materials) is ignored. Corners with equal position and UV become
+    one vertex (corners without UV get (0, 0)), polygons are ear clipped in their plane so concave ones are fine.
+*/
+class OBJReader
+{
+  private:
+    std::vector<glm::vec3> positions = std::vector<glm::vec3>();
+    std::vector<glm::vec2> uvs = std::vector<glm::vec2>();
+    OBJReadStats stats = OBJReadStats();
+
+  public:
+    OBJReader() {}
+
+    bool ReadOBJFile(std::string filename, UCMESHData *mesh);
+    // text doesn't have to be null terminated.
+    bool ReadOBJ(const char *text, size_t size, UCMESHData *mesh);
+
+    inline OBJReadStats GetStats() { return stats; }
+
+    // appends triangles of polygon (corners are indices into positions) to out.
+    static void TriangulatePolygon(const glm::vec3 *positions, const uint32_t *corners, size_t corners_count, std::vector<uint32_t> *out);
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "PNGReader.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#include <libpng16/png.h>
+
+// === PUBLIC ===
+
+bool PNGReader::ReadPNGFile(std::string filename, UCTEXImage *image, std::string *error)
+{
+    png_image png;
+    memset(&png, 0, sizeof(png));
+    png.version = PNG_IMAGE_VERSION;
+
+    if (png_image_begin_read_from_file(&png, filename.c_str()))
+    {
+        // 0xAABBGGRR in memory is R, G, B, A bytes.
+        png.format = PNG_FORMAT_RGBA;
+        if (png.width > 0 && png.height > 0 && png.width <= 65536 && png.height <= 65536)
+        {
+            UCTEXImage decoded = UCTEXImage(png.width, png.height);
+            if (png_image_finish_read(&png, nullptr, decoded.GetPixels(), 0, nullptr))
+            {
+                *image = std::move(decoded);
+                return true;
+            }
+        }
+        else snprintf(png.message, sizeof(png.message), "unsupported size %ux%u", png.width, png.height);
+    }
+
+    if (error) *error = png.message;
+    png_image_free(&png);
+    return false;
+}
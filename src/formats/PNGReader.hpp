@@ -0,0 +1,16 @@
+#ifndef PNGREADER_HPP
+#define PNGREADER_HPP
+
+#include <string>
+
+#include "UCTEXImage.hpp"
+
+// PNG decoding through libpng (any color type and bit depth is converted to RGBA8), used by tools only.
+class PNGReader
+{
+  public:
+    // error (optional) gets libpng message on failure.
+    static bool ReadPNGFile(std::string filename, UCTEXImage *image, std::string *error = nullptr);
+};
+
+#endif
@@ -0,0 +1,346 @@
+#include "UCMESHData.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+#include "AssetFile.hpp"
+#include "../utils.hpp"
+
+// === PRIVATE ===
+
+static inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+static void encodeindices(const uint32_t *indices, size_t count, std::vector<uint8_t> *out)
+{
+    out->clear();
+    uint32_t previous = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t v = zigzag((int32_t)(indices[i] - previous));
+        previous = indices[i];
+        while (v >= 0x80) { out->push_back((uint8_t)(v | 0x80)); v >>= 7; }
+        out->push_back((uint8_t)v);
+    }
+}
+
+// false if data end too early (or have bytes left) or index is out of range.
+static bool decodeindices(const uint8_t *data, size_t size, uint32_t *out, size_t count, uint32_t vertices_count)
+{
+    const uint8_t *p = data, *end = data + size;
+    uint32_t previous = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t v;
+        // deltas of cache optimized mesh mostly fit one byte.
+        if (p < end && *p < 0x80) v = *p++;
+        else
+        {
+            v = 0;
+            for (int shift = 0; ; shift += 7)
+            {
+                if (p >= end || shift > 28) return false;
+                uint8_t b = *p++;
+                v |= (uint32_t)(b & 0x7F) << shift;
+                if (!(b & 0x80)) break;
+            }
+        }
+
+        previous += (uint32_t)unzigzag(v);
+        if (previous >= vertices_count) return false;
+        out[i] = previous;
+    }
+    return p == end;
+}
+
+static inline uint16_t quantize(float v, float offset, float scale)
+{
+    if (scale <= 0.0f) return 0;
+    long q = lroundf((v - offset) / scale * 65535.0f);
+    return q < 0 ? 0 : q > 65535 ? 65535 : q;
+}
+
+static void writeencoded(FILE *f, const std::vector<uint32_t> &indices, std::vector<uint8_t> *buffer)
+{
+    encodeindices(indices.data(), indices.size(), buffer);
+    uint32_t size = buffer->size();
+    fwrite(&size, sizeof(size), 1, f);
+    fwrite(buffer->data(), 1, size, f);
+}
+
+static bool readencoded(const uint8_t **p, const uint8_t *end, size_t triangles_count, uint32_t vertices_count, std::vector<uint32_t> *indices)
+{
+    uint32_t size;
+    if (!Utils::readbytes(p, end, &size, sizeof(size)) || (size_t)(end - *p) < size) return false;
+    if (size / 3 < triangles_count) return false; // every index takes at least one byte.
+
+    indices->resize(triangles_count * 3);
+    if (!decodeindices(*p, size, indices->data(), indices->size(), vertices_count)) return false;
+    *p += size;
+    return true;
+}
+
+// === PUBLIC ===
+
+bool UCMESHData::LoadFromUCMESHFile(std::string filename)
+{
+    AssetFile file = AssetFile();
+    if (!file.Open(filename)) return false;
+
+    return LoadFromUCMESH(file.GetData(), file.GetSize());
+}
+
+bool UCMESHData::LoadFromUCMESH(const uint8_t *data, size_t size)
+{
+    const uint8_t *p = data, *end = data + size;
+
+    char sig[6];
+    if (!Utils::readbytes(&p, end, sig, 6) || strncmp(sig, "UCMESH", 6)) return false;
+
+    uint16_t version;
+    if (!Utils::readbytes(&p, end, &version, sizeof(version)) || version > UCMESH_VERSION) return false;
+
+    uint32_t vertices_count, primitives_count;
+    if (!Utils::readbytes(&p, end, &vertices_count, sizeof(vertices_count)) || !Utils::readbytes(&p, end, &primitives_count, sizeof(primitives_count))) return false;
+    if (version >= 2) return loadquantized(p, end, vertices_count, primitives_count);
+    if ((size_t)(end - p) / sizeof(UCMESHVertexInfo) < vertices_count) return false;
+
+    Clear();
+    vertices.reserve(vertices_count);
+    uvs.reserve(vertices_count);
+
+    UCMESHVertexInfo v;
+    for (uint32_t i = 0; i < vertices_count; i++)
+    {
+        Utils::readbytes(&p, end, &v, sizeof(v));
+        vertices.push_back(glm::vec3(v.x, v.y, v.z));
+        uvs.push_back(glm::vec2(v.u, v.v));
+    }
+
+    uint8_t prim_type;
+    for (uint32_t i = 0; i < primitives_count; i++)
+    {
+        if (!Utils::readbytes(&p, end, &prim_type, sizeof(prim_type))) goto readmesherrorquit;
+
+        switch (prim_type)
+        {
+            case UCMESH_PRIMITIVE_TRIANGLE:
+                UCMESHTriangleInfo tri;
+                if (!Utils::readbytes(&p, end, &tri, sizeof(tri))) goto readmesherrorquit;
+
+                if (tri.v0 >= vertices_count || tri.v1 >= vertices_count || tri.v2 >= vertices_count) continue;
+
+                indices.insert(indices.end(), { tri.v0, tri.v1, tri.v2 });
+                break;
+
+            case UCMESH_PRIMITIVE_QUAD:
+                UCMESHQuadInfo quad;
+                if (!Utils::readbytes(&p, end, &quad, sizeof(quad))) goto readmesherrorquit;
+
+                if (quad.v0 >= vertices_count || quad.v1 >= vertices_count || quad.v2 >= vertices_count || quad.v3 >= vertices_count) continue;
+
+                // same split as Mesh::AddQuad().
+                indices.insert(indices.end(), { quad.v3, quad.v0, quad.v1, quad.v1, quad.v2, quad.v3 });
+                break;
+
+            default:
+                goto readmesherrorquit;
+        }
+    }
+
+    if (version >= 1)
+    {
+        uint8_t lods_count;
+        if (!Utils::readbytes(&p, end, &lods_count, sizeof(lods_count))) goto readmesherrorquit;
+
+        lods.resize(lods_count);
+        for (UCMESHLOD &lod : lods)
+        {
+            uint32_t triangles_count;
+            if (!Utils::readbytes(&p, end, &lod.error, sizeof(lod.error)) || !Utils::readbytes(&p, end, &triangles_count, sizeof(triangles_count))) goto readmesherrorquit;
+            if ((size_t)(end - p) / sizeof(UCMESHTriangleInfo) < triangles_count) goto readmesherrorquit;
+
+            lod.indices.resize((size_t)triangles_count * 3);
+            Utils::readbytes(&p, end, lod.indices.data(), (size_t)triangles_count * sizeof(UCMESHTriangleInfo));
+
+            for (uint32_t i : lod.indices) if (i >= vertices_count) goto readmesherrorquit;
+        }
+    }
+
+    return true;
+
+    readmesherrorquit:
+        Clear();
+    return false;
+}
+
+bool UCMESHData::loadquantized(const uint8_t *p, const uint8_t *end, uint32_t vertices_count, uint32_t triangles_count)
+{
+    UCMESHQuantization q;
+    if (!Utils::readbytes(&p, end, &q, sizeof(q)) || (size_t)(end - p) / (sizeof(uint16_t) * 5) < vertices_count) return false;
+
+    Clear();
+    quantization = q;
+    quantizedPositions.resize((size_t)vertices_count * 4);
+    quantizedUVs.resize((size_t)vertices_count * 2);
+    for (uint32_t i = 0; i < vertices_count; i++)
+    {
+        Utils::readbytes(&p, end, &quantizedPositions[i * 4], sizeof(uint16_t) * 3);
+        quantizedPositions[i * 4 + 3] = 0;
+    }
+    Utils::readbytes(&p, end, quantizedUVs.data(), quantizedUVs.size() * sizeof(uint16_t));
+
+    vertices.resize(vertices_count);
+    uvs.resize(vertices_count);
+    for (uint32_t i = 0; i < vertices_count; i++)
+    {
+        vertices[i] = DequantizePosition(quantization, &quantizedPositions[i * 4]);
+        uvs[i] = DequantizeUV(quantization, &quantizedUVs[i * 2]);
+    }
+
+    if (!readencoded(&p, end, triangles_count, vertices_count, &indices)) goto readmesherrorquit;
+
+    uint8_t lods_count;
+    if (!Utils::readbytes(&p, end, &lods_count, sizeof(lods_count))) goto readmesherrorquit;
+
+    lods.resize(lods_count);
+    for (UCMESHLOD &lod : lods)
+    {
+        uint32_t lod_triangles_count;
+        if (!Utils::readbytes(&p, end, &lod.error, sizeof(lod.error)) || !Utils::readbytes(&p, end, &lod_triangles_count, sizeof(lod_triangles_count))) goto readmesherrorquit;
+        if (!readencoded(&p, end, lod_triangles_count, vertices_count, &lod.indices)) goto readmesherrorquit;
+    }
+
+    return true;
+
+    readmesherrorquit:
+        Clear();
+    return false;
+}
+
+bool UCMESHData::savequantized(FILE *f)
+{
+    uint16_t version = 2;
+    uint32_t vertices_count = vertices.size();
+    uint32_t triangles_count = indices.size() / 3;
+
+    fwrite("UCMESH", sizeof(char), 6, f);
+    fwrite(&version, sizeof(version), 1, f);
+    fwrite(&vertices_count, sizeof(vertices_count), 1, f);
+    fwrite(&triangles_count, sizeof(triangles_count), 1, f);
+    fwrite(&quantization, sizeof(quantization), 1, f);
+    for (uint32_t i = 0; i < vertices_count; i++) fwrite(&quantizedPositions[i * 4], sizeof(uint16_t), 3, f);
+    fwrite(quantizedUVs.data(), sizeof(uint16_t), quantizedUVs.size(), f);
+
+    std::vector<uint8_t> buffer = std::vector<uint8_t>();
+    writeencoded(f, indices, &buffer);
+
+    uint8_t lods_count = lods.size();
+    fwrite(&lods_count, sizeof(lods_count), 1, f);
+    for (UCMESHLOD &lod : lods)
+    {
+        uint32_t lod_triangles_count = lod.indices.size() / 3;
+        fwrite(&lod.error, sizeof(lod.error), 1, f);
+        fwrite(&lod_triangles_count, sizeof(lod_triangles_count), 1, f);
+        writeencoded(f, lod.indices, &buffer);
+    }
+
+    bool ok = !ferror(f);
+    return fclose(f) == 0 && ok;
+}
+
+bool UCMESHData::SaveToUCMESHFile(std::string filename)
+{
+    if (uvs.size() != vertices.size() || indices.size() % 3 != 0 || lods.size() > UINT8_MAX) return false;
+    for (UCMESHLOD &lod : lods) if (lod.indices.size() % 3 != 0) return false;
+    if (IsQuantized() && (quantizedPositions.size() != vertices.size() * 4 || quantizedUVs.size() != vertices.size() * 2)) return false;
+
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (!f) return false;
+    if (IsQuantized()) return savequantized(f);
+
+    uint16_t version = lods.empty() ? 0 : 1;
+    uint32_t vertices_count = vertices.size();
+    uint32_t primitives_count = indices.size() / 3;
+
+    fwrite("UCMESH", sizeof(char), 6, f);
+    fwrite(&version, sizeof(version), 1, f);
+    fwrite(&vertices_count, sizeof(vertices_count), 1, f);
+    fwrite(&primitives_count, sizeof(primitives_count), 1, f);
+
+    for (uint32_t i = 0; i < vertices_count; i++)
+    {
+        UCMESHVertexInfo v = { vertices[i].x, vertices[i].y, vertices[i].z, uvs[i].x, uvs[i].y };
+        fwrite(&v, sizeof(v), 1, f);
+    }
+
+    uint8_t prim_type = UCMESH_PRIMITIVE_TRIANGLE;
+    for (uint32_t i = 0; i < primitives_count; i++)
+    {
+        UCMESHTriangleInfo tri = { indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2] };
+        fwrite(&prim_type, sizeof(prim_type), 1, f);
+        fwrite(&tri, sizeof(tri), 1, f);
+    }
+
+    if (version >= 1)
+    {
+        uint8_t lods_count = lods.size();
+        fwrite(&lods_count, sizeof(lods_count), 1, f);
+        for (UCMESHLOD &lod : lods)
+        {
+            uint32_t triangles_count = lod.indices.size() / 3;
+            fwrite(&lod.error, sizeof(lod.error), 1, f);
+            fwrite(&triangles_count, sizeof(triangles_count), 1, f);
+            fwrite(lod.indices.data(), sizeof(UCMESHTriangleInfo), triangles_count, f);
+        }
+    }
+
+    bool ok = !ferror(f);
+    return fclose(f) == 0 && ok;
+}
+
+void UCMESHData::Clear()
+{
+    vertices.clear();
+    uvs.clear();
+    indices.clear();
+    lods.clear();
+    quantization = UCMESHQuantization();
+    quantizedPositions.clear();
+    quantizedUVs.clear();
+}
+
+void UCMESHData::Quantize()
+{
+    quantizedPositions.clear();
+    quantizedUVs.clear();
+    if (vertices.empty() || uvs.size() != vertices.size()) return;
+
+    glm::vec3 pmin = vertices[0], pmax = vertices[0];
+    glm::vec2 uvmin = uvs[0], uvmax = uvs[0];
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        pmin = glm::min(pmin, vertices[i]);
+        pmax = glm::max(pmax, vertices[i]);
+        uvmin = glm::min(uvmin, uvs[i]);
+        uvmax = glm::max(uvmax, uvs[i]);
+    }
+
+    for (int c = 0; c < 3; c++) { quantization.positionOffset[c] = pmin[c]; quantization.positionScale[c] = pmax[c] - pmin[c]; }
+    for (int c = 0; c < 2; c++) { quantization.uvOffset[c] = uvmin[c]; quantization.uvScale[c] = uvmax[c] - uvmin[c]; }
+
+    quantizedPositions.resize(vertices.size() * 4);
+    quantizedUVs.resize(vertices.size() * 2);
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        for (int c = 0; c < 3; c++) quantizedPositions[i * 4 + c] = quantize(vertices[i][c], quantization.positionOffset[c], quantization.positionScale[c]);
+        quantizedPositions[i * 4 + 3] = 0;
+        for (int c = 0; c < 2; c++) quantizedUVs[i * 2 + c] = quantize(uvs[i][c], quantization.uvOffset[c], quantization.uvScale[c]);
+
+        vertices[i] = DequantizePosition(quantization, &quantizedPositions[i * 4]);
+        uvs[i] = DequantizeUV(quantization, &quantizedUVs[i * 2]);
+    }
+}
+
+UCMESHQuantization UCMESHData::GetIdentityQuantization() { return { { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f }, { 1.0f, 1.0f } }; }
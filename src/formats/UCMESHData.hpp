@@ -0,0 +1,111 @@
+#ifndef UCMESHDATA_HPP
+#define UCMESHDATA_HPP
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+#include "../glm.hpp"
+
+/*
+    UCMESH: "UCMESH", uint16 version, uint32 vertices count, uint32 primitives count, vertices (UCMESHVertexInfo),
+    primitives (uint8 UCMESHPrimitiveType + UCMESHTriangleInfo/UCMESHQuadInfo).
+
+    Version 1 appends LOD chain: uint8 LODs count, then for every LOD float error (in mesh units),
+    uint32 triangles count and triangles (UCMESHTriangleInfo). LODs use the same vertices as full mesh.
+
+    Version 2 is quantized: "UCMESH", uint16 version, uint32 vertices count, uint32 triangles count, UCMESHQuantization,
+    positions (uint16 x, y, z per vertex), UVs (uint16 u, v per vertex), uint32 size of encoded indices and encoded
+    indices, then LOD chain as in version 1, but every LOD has uint32 size of encoded indices and encoded indices
+    instead of triangles. Indices are encoded as zigzag deltas from previous index in LEB128 (7 bits per byte).
+*/
+
+#define UCMESH_VERSION 2
+
+enum
+{
+    UCMESH_PRIMITIVE_TRIANGLE = 0,
+    UCMESH_PRIMITIVE_QUAD = 1
+} typedef UCMESHPrimitiveType;
+
+struct
+{
+    float x, y, z;
+    float u, v;
+} typedef UCMESHVertexInfo;
+
+struct
+{
+    unsigned int v0, v1, v2;
+} typedef UCMESHTriangleInfo;
+
+struct
+{
+    unsigned int v0, v1, v2, v3;
+} typedef UCMESHQuadInfo;
+
+// quantized value = offset + unorm16 / 65535 * scale, offset and scale are bounds of mesh positions or UVs.
+struct
+{
+    float positionOffset[3];
+    float positionScale[3];
+    float uvOffset[2];
+    float uvScale[2];
+} typedef UCMESHQuantization;
+
+// simplified version of mesh, indices refer to the same vertices.
+struct
+{
+    std::vector<uint32_t> indices; // triangle list.
+    float error; // max deviation from full mesh, in mesh units.
+} typedef UCMESHLOD;
+
+// CPU-side UCMESH geometry (quads are triangulated on load), doesn't touch OpenGL so can be used from any thread and by tools.
+class UCMESHData
+{
+  private:
+    bool loadquantized(const uint8_t *p, const uint8_t *end, uint32_t vertices_count, uint32_t triangles_count);
+    bool savequantized(FILE *f);
+
+  public:
+    std::vector<glm::vec3> vertices = std::vector<glm::vec3>();
+    std::vector<glm::vec2> uvs = std::vector<glm::vec2>(); // one per vertex.
+    std::vector<uint32_t> indices = std::vector<uint32_t>(); // triangle list.
+    std::vector<UCMESHLOD> lods = std::vector<UCMESHLOD>(); // from most to least detailed, without full mesh.
+
+    // quantized streams, filled by Quantize() or by loading version 2 file (vertices and uvs are decoded as well).
+    UCMESHQuantization quantization = UCMESHQuantization();
+    std::vector<uint16_t> quantizedPositions = std::vector<uint16_t>(); // x, y, z, 0 per vertex (8 bytes for GPU).
+    std::vector<uint16_t> quantizedUVs = std::vector<uint16_t>(); // u, v per vertex.
+
+    UCMESHData() {}
+
+    // file can be in mounted UCPACK archive (see AssetFile).
+    bool LoadFromUCMESHFile(std::string filename);
+    bool LoadFromUCMESH(const uint8_t *data, size_t size);
+    // writes triangles only, version 2 if mesh is quantized, otherwise version 0 if there are no LODs.
+    bool SaveToUCMESHFile(std::string filename);
+
+    void Clear();
+
+    // fills quantized streams and replaces vertices and uvs with their dequantized values, so CPU and GPU see the same
+    // geometry. Must be done after everything that changes vertices (see MeshOptimizer).
+    void Quantize();
+    inline bool IsQuantized() { return !quantizedPositions.empty(); }
+
+    static inline glm::vec3 DequantizePosition(const UCMESHQuantization &q, const uint16_t *p)
+    {
+        return glm::vec3(q.positionOffset[0] + p[0] / 65535.0f * q.positionScale[0], q.positionOffset[1] + p[1] / 65535.0f * q.positionScale[1],
+            q.positionOffset[2] + p[2] / 65535.0f * q.positionScale[2]);
+    }
+    static inline glm::vec2 DequantizeUV(const UCMESHQuantization &q, const uint16_t *uv)
+    { return glm::vec2(q.uvOffset[0] + uv[0] / 65535.0f * q.uvScale[0], q.uvOffset[1] + uv[1] / 65535.0f * q.uvScale[1]); }
+    // offsets 0 and scales 1, for meshes that aren't quantized.
+    static UCMESHQuantization GetIdentityQuantization();
+
+    inline size_t GetTrianglesCount() { return indices.size() / 3; }
+};
+
+#endif
@@ -0,0 +1,247 @@
+#include "UCPACKFile.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <algorithm>
+#include <shared_mutex>
+#include <mutex>
+
+#include "LZ4.hpp"
+#include "../utils.hpp"
+
+// === PRIVATE ===
+
+static std::vector<UCPACKFile *> mounted = std::vector<UCPACKFile *>();
+static std::shared_mutex mountedMutex;
+
+static inline bool isalignment(uint64_t a) { return a >= 8 && (a & (a - 1)) == 0; }
+
+bool UCPACKFile::validate()
+{
+    size_t size = file.GetSize();
+    if (!isalignment(header->alignment) || header->entriesOffset % 8 != 0 || header->entriesOffset < sizeof(UCPACKHeader) ||
+        header->entriesOffset > size || header->stringsSize == 0) return false;
+
+    uint64_t tablesize = (uint64_t)header->entriesCount * sizeof(UCPACKEntry) + header->stringsSize;
+    if (tablesize > size - header->entriesOffset) return false;
+
+    entries = reinterpret_cast<const UCPACKEntry *>(file.GetData() + header->entriesOffset);
+    strings = reinterpret_cast<const char *>(entries + header->entriesCount);
+    if (strings[header->stringsSize - 1] != '\0') return false;
+
+    for (uint32_t i = 0; i < header->entriesCount; i++)
+    {
+        const UCPACKEntry *e = &entries[i];
+        if (i > 0 && entries[i - 1].pathHash >= e->pathHash) return false; // also rejects duplicates.
+        if (e->path >= header->stringsSize || (e->flags & ~UCPACK_ENTRY_COMPRESSED)) return false;
+        if (e->offset < sizeof(UCPACKHeader) || e->offset % header->alignment != 0 || e->offset > header->entriesOffset ||
+            e->size > header->entriesOffset - e->offset) return false;
+        if (!(e->flags & UCPACK_ENTRY_COMPRESSED) && e->size != e->originalSize) return false;
+        // LZ4 can't expand data more than 255 times, so broken size isn't allocated on Read().
+        if ((e->flags & UCPACK_ENTRY_COMPRESSED) && e->originalSize > e->size * 255 + 16) return false;
+    }
+    return true;
+}
+
+bool UCPACKWriter::pad(uint32_t to)
+{
+    static const uint8_t zeros[256] = {};
+    uint64_t padding = (to - offset % to) % to;
+    for (uint64_t left = padding; left > 0; )
+    {
+        uint64_t n = std::min<uint64_t>(left, sizeof(zeros));
+        if (fwrite(zeros, 1, n, file) != n) return false;
+        left -= n;
+    }
+    offset += padding;
+    return true;
+}
+
+// === PUBLIC ===
+
+UCPACKFile::~UCPACKFile() { Close(); }
+
+bool UCPACKFile::Open(std::string filename)
+{
+    Close();
+    if (!file.Open(filename)) return false;
+    if (file.GetSize() < sizeof(UCPACKHeader)) { Close(); return false; }
+
+    header = reinterpret_cast<const UCPACKHeader *>(file.GetData());
+    if (memcmp(header->signature, "UCPACK\0", 8) || header->version != UCPACK_VERSION || !validate())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void UCPACKFile::Close()
+{
+    Unmount(this);
+    header = nullptr;
+    entries = nullptr;
+    strings = nullptr;
+    file.Close();
+}
+
+int64_t UCPACKFile::Find(std::string path)
+{
+    path = NormalizePath(path);
+    uint64_t hash = Utils::hash64(path);
+
+    const UCPACKEntry *end = entries + header->entriesCount;
+    const UCPACKEntry *e = std::lower_bound(entries, end, hash, [](const UCPACKEntry &e, uint64_t h) { return e.pathHash < h; });
+    return e != end && e->pathHash == hash && path == GetString(e->path) ? e - entries : -1;
+}
+
+bool UCPACKFile::Read(size_t index, const uint8_t **data, size_t *size, std::vector<uint8_t> *buffer)
+{
+    if (index >= header->entriesCount) return false;
+    const UCPACKEntry *e = &entries[index];
+
+    if (!(e->flags & UCPACK_ENTRY_COMPRESSED))
+    {
+        *data = file.GetData() + e->offset;
+        *size = e->size;
+        return true;
+    }
+
+    buffer->resize(e->originalSize);
+    if (!LZ4::Decompress(file.GetData() + e->offset, e->size, buffer->data(), buffer->size())) return false;
+    *data = buffer->data();
+    *size = buffer->size();
+    return true;
+}
+
+std::string UCPACKFile::NormalizePath(std::string path)
+{
+    std::string p = std::filesystem::path(path).lexically_normal().generic_string();
+    return p == "." ? "" : p;
+}
+
+void UCPACKFile::Mount(UCPACKFile *pack)
+{
+    std::unique_lock<std::shared_mutex> lock(mountedMutex);
+    if (std::find(mounted.begin(), mounted.end(), pack) == mounted.end()) mounted.push_back(pack);
+}
+
+void UCPACKFile::Unmount(UCPACKFile *pack)
+{
+    std::unique_lock<std::shared_mutex> lock(mountedMutex);
+    mounted.erase(std::remove(mounted.begin(), mounted.end(), pack), mounted.end());
+}
+
+bool UCPACKFile::ReadMounted(std::string path, const uint8_t **data, size_t *size, std::vector<uint8_t> *buffer)
+{
+    std::shared_lock<std::shared_mutex> lock(mountedMutex);
+    if (mounted.empty()) return false;
+
+    for (size_t i = mounted.size(); i-- > 0; )
+    {
+        int64_t index = mounted[i]->Find(path);
+        if (index >= 0) return mounted[i]->Read(index, data, size, buffer);
+    }
+    return false;
+}
+
+// ================================
+
+UCPACKWriter::~UCPACKWriter()
+{
+    if (!file) return;
+    fclose(file);
+    std::remove((filename + ".tmp").c_str());
+}
+
+bool UCPACKWriter::Create(std::string _filename, uint32_t _alignment)
+{
+    if (file || !isalignment(_alignment)) return false;
+
+    file = fopen((_filename + ".tmp").c_str(), "wb");
+    if (!file) return false;
+
+    filename = _filename;
+    alignment = _alignment;
+    entries.clear();
+    strings.assign(1, '\0');
+    hashes.clear();
+
+    // header is rewritten by Finish().
+    UCPACKHeader header = UCPACKHeader();
+    offset = sizeof(header);
+    return fwrite(&header, sizeof(header), 1, file) == 1;
+}
+
+bool UCPACKWriter::AddEntry(std::string path, const uint8_t *data, size_t size, bool compress)
+{
+    if (!file) return false;
+
+    path = UCPACKFile::NormalizePath(path);
+    uint64_t hash = Utils::hash64(path);
+    if (path.empty() || !hashes.insert(hash).second) return false;
+
+    const uint8_t *stored = data;
+    size_t stored_size = size;
+    uint32_t flags = 0;
+    if (compress && size > 0)
+    {
+        compressed.resize(LZ4::GetMaxCompressedSize(size));
+        size_t csize = LZ4::Compress(data, size, compressed.data(), compressed.size());
+        if (csize > 0 && csize <= size - size / 8)
+        {
+            stored = compressed.data();
+            stored_size = csize;
+            flags |= UCPACK_ENTRY_COMPRESSED;
+        }
+    }
+
+    if (!pad(alignment)) return false;
+
+    UCPACKEntry e = UCPACKEntry();
+    e.pathHash = hash;
+    e.offset = offset;
+    e.size = stored_size;
+    e.originalSize = size;
+    e.path = strings.size();
+    e.flags = flags;
+    strings.insert(strings.end(), path.begin(), path.end());
+    strings.push_back('\0');
+    entries.push_back(e);
+
+    if (stored_size > 0 && fwrite(stored, 1, stored_size, file) != stored_size) return false;
+    offset += stored_size;
+    return true;
+}
+
+bool UCPACKWriter::Finish()
+{
+    if (!file) return false;
+
+    std::sort(entries.begin(), entries.end(), [](const UCPACKEntry &a, const UCPACKEntry &b) { return a.pathHash < b.pathHash; });
+
+    bool ok = pad(8);
+
+    UCPACKHeader header = UCPACKHeader();
+    memcpy(header.signature, "UCPACK\0", 8);
+    header.version = UCPACK_VERSION;
+    header.alignment = alignment;
+    header.entriesOffset = offset;
+    header.entriesCount = entries.size();
+    header.stringsSize = strings.size();
+
+    ok = ok && fwrite(entries.data(), sizeof(UCPACKEntry), entries.size(), file) == entries.size();
+    ok = ok && fwrite(strings.data(), sizeof(char), strings.size(), file) == strings.size();
+    ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    offset += entries.size() * sizeof(UCPACKEntry) + strings.size();
+
+    ok = fclose(file) == 0 && ok;
+    file = nullptr;
+
+    std::string temp = filename + ".tmp";
+    if (!ok) { std::remove(temp.c_str()); return false; }
+
+    std::error_code ec;
+    std::filesystem::rename(temp, filename, ec);
+    return !ec;
+}
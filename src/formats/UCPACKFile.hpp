@@ -0,0 +1,128 @@
+#ifndef UCPACKFILE_HPP
+#define UCPACKFILE_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <cstdio>
+#include <cstdint>
+
+#include "MappedFile.hpp"
+
+/*
+    UCPACK - single file archive of cooked assets: header, entries data (each starts at multiple of header alignment,
+    in order they were added), then entries (sorted by pathHash) and strings (null terminated paths, offset 0 is
+    empty string) at the end, so archive is written in one pass.
+
+    Paths are generic (with '/') and relative to directory archive replaces. Stored entries are used right from mapped
+    archive, compressed ones are LZ4 blocks (see LZ4) of originalSize bytes.
+*/
+
+#define UCPACK_VERSION 0
+#define UCPACK_DEFAULT_ALIGNMENT 16 // enough for UCSCENE tables, which are read in place.
+
+enum
+{
+    UCPACK_ENTRY_COMPRESSED = 1
+} typedef UCPACKEntryFlags;
+
+struct
+{
+    char signature[8]; // "UCPACK\0\0".
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t alignment; // power of two, at least 8.
+    uint64_t entriesOffset; // strings follow entries.
+    uint32_t entriesCount;
+    uint32_t stringsSize;
+} typedef UCPACKHeader;
+
+struct
+{
+    uint64_t pathHash; // Utils::hash64 of path.
+    uint64_t offset; // from start of file.
+    uint64_t size; // stored.
+    uint64_t originalSize;
+    uint32_t path;
+    uint32_t flags; // UCPACKEntryFlags.
+} typedef UCPACKEntry;
+
+/*
+    Validated read-only view of mapped UCPACK file. Mounted archives are used by asset loaders instead of separate files
+    (see AssetFile), so whole level is read through one file mapping.
+*/
+class UCPACKFile
+{
+  private:
+    MappedFile file;
+    const UCPACKHeader *header = nullptr;
+    const UCPACKEntry *entries = nullptr;
+    const char *strings = nullptr;
+
+    bool validate();
+
+  public:
+    UCPACKFile() {}
+    ~UCPACKFile();
+
+    bool Open(std::string filename);
+    // unmounts archive too.
+    void Close();
+    inline bool IsOpen() { return header != nullptr; }
+
+    inline uint32_t GetEntriesCount() { return header->entriesCount; }
+    inline const UCPACKEntry *GetEntries() { return entries; }
+    inline const char *GetString(uint32_t offset) { return strings + offset; }
+
+    // path is normalized, -1 if not found.
+    int64_t Find(std::string path);
+    // stored entry points into mapped archive (valid until Close()), compressed one is decompressed into buffer.
+    bool Read(size_t index, const uint8_t **data, size_t *size, std::vector<uint8_t> *buffer);
+
+    // relative generic path without "." and ".." parts, the way paths are stored in archive.
+    static std::string NormalizePath(std::string path);
+
+    // archives mounted later are searched first. Mounting isn't meant to happen while assets are loading:
+    // data of stored entries given by ReadMounted() stay valid only while archive is mounted.
+    static void Mount(UCPACKFile *pack);
+    static void Unmount(UCPACKFile *pack);
+    // false if path isn't in mounted archives (or its entry can't be decompressed).
+    static bool ReadMounted(std::string path, const uint8_t **data, size_t *size, std::vector<uint8_t> *buffer);
+};
+
+// writes UCPACK file next to target and renames it on Finish(), archive that isn't finished is removed.
+class UCPACKWriter
+{
+  private:
+    FILE *file = nullptr;
+    std::string filename = std::string();
+    uint32_t alignment = UCPACK_DEFAULT_ALIGNMENT;
+    uint64_t offset = 0;
+
+    std::vector<UCPACKEntry> entries = std::vector<UCPACKEntry>();
+    std::vector<char> strings = std::vector<char>(1, '\0');
+    std::unordered_set<uint64_t> hashes = std::unordered_set<uint64_t>();
+    std::vector<uint8_t> compressed = std::vector<uint8_t>();
+
+    bool pad(uint32_t to);
+
+  public:
+    UCPACKWriter() {}
+    ~UCPACKWriter();
+
+    UCPACKWriter(const UCPACKWriter &) = delete;
+    UCPACKWriter &operator=(const UCPACKWriter &) = delete;
+
+    // alignment must be power of two, at least 8.
+    bool Create(std::string filename, uint32_t alignment = UCPACK_DEFAULT_ALIGNMENT);
+    // path is normalized, false if it's already added (or has the same hash as added one) or write failed.
+    // compressed data are kept only if they are at least 1/8 smaller.
+    bool AddEntry(std::string path, const uint8_t *data, size_t size, bool compress);
+    bool Finish();
+
+    inline size_t GetEntriesCount() { return entries.size(); }
+    inline const UCPACKEntry *GetEntries() { return entries.data(); }
+    inline uint64_t GetSize() { return offset; }
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "UCPVSFile.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+// header is used in place, layout must not depend on compiler.
+static_assert(sizeof(UCPVSHeader) == 56);
+
+// === PRIVATE ===
+
+bool UCPVSFile::validate()
+{
+    // every count is checked first, so product can't overflow.
+    for (int i = 0; i < 3; i++) if (header->cellsCount[i] == 0 || header->cellsCount[i] > UCPVS_MAX_CELLS) return false;
+    uint64_t cells = (uint64_t)header->cellsCount[0] * header->cellsCount[1] * header->cellsCount[2];
+    if (cells > UCPVS_MAX_CELLS) return false;
+
+    for (int i = 0; i < 3; i++)
+        if (!std::isfinite(header->boundsMin[i]) || !std::isfinite(header->cellSize[i]) || header->cellSize[i] <= 0.0f) return false;
+
+    size_t size = file.GetSize() - sizeof(UCPVSHeader);
+    if (size / sizeof(uint32_t) < cells + 1 || size - (cells + 1) * sizeof(uint32_t) < header->dataSize) return false;
+
+    offsets = reinterpret_cast<const uint32_t *>(file.GetData() + sizeof(UCPVSHeader));
+    data = reinterpret_cast<const uint8_t *>(offsets + cells + 1);
+
+    if (offsets[0] != 0 || offsets[cells] != header->dataSize) return false;
+    for (uint64_t i = 0; i < cells; i++) if (offsets[i] > offsets[i + 1]) return false;
+
+    return true;
+}
+
+// === PUBLIC ===
+
+bool UCPVSFile::Open(std::string filename)
+{
+    Close();
+    if (!file.Open(filename)) return false;
+    if (file.GetSize() < sizeof(UCPVSHeader)) { Close(); return false; }
+
+    header = reinterpret_cast<const UCPVSHeader *>(file.GetData());
+    if (memcmp(header->signature, "UCPVS\0\0", 8) || header->version != UCPVS_VERSION || !validate())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void UCPVSFile::Close()
+{
+    header = nullptr;
+    offsets = nullptr;
+    data = nullptr;
+    file.Close();
+}
+
+bool UCPVSFile::DecompressRow(uint32_t cell, uint8_t *row)
+{
+    size_t rowsize = GetRowSize();
+    if (cell >= GetCellsCount1D())
+    {
+        memset(row, 0xFF, rowsize);
+        return false;
+    }
+
+    const uint8_t *p = data + offsets[cell], *end = data + offsets[cell + 1];
+    size_t out = 0;
+    while (p < end && out < rowsize)
+    {
+        if (*p) { row[out++] = *p++; continue; }
+
+        if (end - p < 2 || p[1] == 0 || rowsize - out < p[1]) break;
+        memset(row + out, 0, p[1]);
+        out += p[1];
+        p += 2;
+    }
+
+    // broken row - everything is visible, culling too much is worse than culling nothing.
+    if (p != end || out != rowsize)
+    {
+        memset(row, 0xFF, rowsize);
+        return false;
+    }
+    return true;
+}
+
+// ================================
+
+bool UCPVSWriter::SetGrid(glm::vec3 bounds_min, glm::vec3 cell_size, glm::uvec3 cells_count)
+{
+    uint64_t cells = (uint64_t)cells_count.x * cells_count.y * cells_count.z;
+    if (cells == 0 || cells > UCPVS_MAX_CELLS || glm::any(glm::lessThanEqual(cell_size, glm::vec3(0.0f)))) return false;
+
+    boundsMin = bounds_min;
+    cellSize = cell_size;
+    cellsCount = cells_count;
+
+    offsets.assign(1, 0);
+    data.clear();
+    return true;
+}
+
+bool UCPVSWriter::AddRow(const uint8_t *row)
+{
+    uint32_t cells = cellsCount.x * cellsCount.y * cellsCount.z;
+    if (offsets.empty() || offsets.size() > cells) return false;
+
+    size_t rowsize = (cells + 7) / 8;
+    for (size_t i = 0; i < rowsize;)
+    {
+        if (row[i]) { data.push_back(row[i++]); continue; }
+
+        uint8_t run = 0;
+        while (i < rowsize && row[i] == 0 && run < 255) { run++; i++; }
+        data.push_back(0);
+        data.push_back(run);
+    }
+
+    if (data.size() > UINT32_MAX) return false;
+    offsets.push_back(data.size());
+    return true;
+}
+
+bool UCPVSWriter::Save(std::string filename)
+{
+    uint32_t cells = cellsCount.x * cellsCount.y * cellsCount.z;
+    if (offsets.size() != (size_t)cells + 1) return false;
+
+    UCPVSHeader header = UCPVSHeader();
+    memcpy(header.signature, "UCPVS\0\0", 8);
+    header.version = UCPVS_VERSION;
+    for (int i = 0; i < 3; i++)
+    {
+        header.cellsCount[i] = cellsCount[i];
+        header.boundsMin[i] = boundsMin[i];
+        header.cellSize[i] = cellSize[i];
+    }
+    header.dataSize = data.size();
+
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (!f) return false;
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    ok = ok && fwrite(offsets.data(), sizeof(uint32_t), offsets.size(), f) == offsets.size();
+    ok = ok && fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = fclose(f) == 0 && ok;
+    return ok;
+}
@@ -0,0 +1,92 @@
+#ifndef UCPVSFILE_HPP
+#define UCPVSFILE_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "../glm.hpp"
+#include "AssetFile.hpp"
+
+/*
+    UCPVS - precomputed potentially visible sets of static level, written by pvsbuilder next to its scene
+    ("level.ucscene" -> "level.ucpvs").
+
+    Level bounds are split into uniform grid of box cells, cell index is x + cellsCount[0] * (y + cellsCount[1] * z).
+    Every cell has row of visibility bits (bit j of byte j / 8 - cell j can be seen from this cell), rows are
+    compressed separately, so only row of camera's cell is unpacked at runtime.
+
+    Row compression: non-zero byte is stored as is, run of zero bytes as 0 and run length (1 - 255).
+
+    File: header, offsets of rows in data (cells count + 1, last one is data size), compressed rows.
+*/
+
+#define UCPVS_VERSION 0
+#define UCPVS_MAX_CELLS (1 << 20)
+
+struct
+{
+    char signature[8]; // "UCPVS\0\0\0".
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t cellsCount[3];
+    float boundsMin[3];
+    float cellSize[3];
+    uint32_t dataSize;
+    uint32_t reserved2; // offsets are 8 byte aligned.
+} typedef UCPVSHeader;
+
+// validated read-only view of mapped UCPVS file.
+class UCPVSFile
+{
+  private:
+    AssetFile file;
+    const UCPVSHeader *header = nullptr;
+    const uint32_t *offsets = nullptr;
+    const uint8_t *data = nullptr;
+
+    bool validate();
+
+  public:
+    UCPVSFile() {}
+
+    bool Open(std::string filename);
+    void Close();
+    inline bool IsOpen() { return header != nullptr; }
+
+    inline glm::uvec3 GetCellsCount() { return glm::uvec3(header->cellsCount[0], header->cellsCount[1], header->cellsCount[2]); }
+    inline uint32_t GetCellsCount1D() { return header->cellsCount[0] * header->cellsCount[1] * header->cellsCount[2]; }
+    inline glm::vec3 GetBoundsMin() { return glm::vec3(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]); }
+    inline glm::vec3 GetCellSize() { return glm::vec3(header->cellSize[0], header->cellSize[1], header->cellSize[2]); }
+    inline size_t GetRowSize() { return (GetCellsCount1D() + 7) / 8; }
+    inline size_t GetDataSize() { return header->dataSize; }
+
+    // row must have GetRowSize() bytes, false if compressed row is broken (row is filled with ones then).
+    bool DecompressRow(uint32_t cell, uint8_t *row);
+};
+
+// builds UCPVS file from uncompressed rows.
+class UCPVSWriter
+{
+  private:
+    glm::uvec3 cellsCount = glm::uvec3(0);
+    glm::vec3 boundsMin = glm::vec3(0.0f), cellSize = glm::vec3(1.0f);
+
+    std::vector<uint32_t> offsets = std::vector<uint32_t>();
+    std::vector<uint8_t> data = std::vector<uint8_t>();
+
+  public:
+    UCPVSWriter() {}
+
+    // starts new file, rows are added after it in cell order.
+    bool SetGrid(glm::vec3 bounds_min, glm::vec3 cell_size, glm::uvec3 cells_count);
+    // row has (cells count + 7) / 8 bytes.
+    bool AddRow(const uint8_t *row);
+
+    inline size_t GetDataSize() { return data.size(); }
+
+    bool Save(std::string filename);
+};
+
+#endif
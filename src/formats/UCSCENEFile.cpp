@@ -0,0 +1,335 @@
+#include "UCSCENEFile.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include "../utils.hpp"
+
+// records are used in place, layout must not depend on compiler.
+static_assert(sizeof(UCSCENEHeader) == 88);
+static_assert(sizeof(UCSCENEAsset) == 16);
+static_assert(sizeof(UCSCENENode) == 80);
+static_assert(sizeof(UCSCENESurface) == 80);
+static_assert(sizeof(UCSCENEAudioSource) == 32);
+static_assert(sizeof(UCSCENEEffectSlot) == 16);
+static_assert(sizeof(UCSCENEEffectParam) == 8);
+static_assert(sizeof(UCSCENEPrefab) == 16);
+static_assert(sizeof(UCSCENEInstance) == 56);
+
+static const size_t strides[UCSCENE_TABLES_COUNT] =
+{
+    sizeof(UCSCENEAsset), sizeof(UCSCENENode), sizeof(UCSCENESurface), sizeof(UCSCENEAudioSource), sizeof(UCSCENEEffectSlot),
+    sizeof(UCSCENEEffectParam), sizeof(UCSCENEPrefab), sizeof(UCSCENEInstance), 1
+};
+
+// === PRIVATE ===
+
+bool UCSCENEFile::validate()
+{
+    size_t size = file.GetSize();
+    for (unsigned int t = 0; t < UCSCENE_TABLES_COUNT; t++)
+    {
+        UCSCENETableInfo info = header->tables[t];
+        if (info.count == 0) continue;
+        if (info.offset % 8 || info.offset < sizeof(UCSCENEHeader) || info.offset > size) return false;
+        if ((size - info.offset) / strides[t] < info.count) return false;
+    }
+
+    // strings must be terminated, so any offset inside table gives valid C string.
+    uint32_t stringssize = GetCount(UCSCENE_TABLE_STRINGS);
+    if (stringssize == 0 || GetString(0)[stringssize - 1] != '\0') return false;
+
+    const UCSCENEAsset *assets = GetAssets();
+    for (uint32_t i = 0; i < GetCount(UCSCENE_TABLE_ASSETS); i++)
+    {
+        if (assets[i].path >= stringssize || assets[i].type > UCSCENE_ASSET_AUDIOCLIP) return false;
+        if (i > 0 && assets[i - 1].id >= assets[i].id) return false;
+    }
+
+    uint32_t nodescount = GetCount(UCSCENE_TABLE_NODES);
+    if (header->sceneNodesCount > nodescount) return false;
+
+    // prefab ranges must lie after scene nodes and not overlap, parents of their nodes - inside of the same range.
+    std::vector<uint32_t> rangebegin = std::vector<uint32_t>(nodescount, 0);
+    std::vector<bool> inprefab = std::vector<bool>(nodescount, false);
+    const UCSCENEPrefab *prefabs = GetPrefabs();
+    for (uint32_t i = 0; i < GetCount(UCSCENE_TABLE_PREFABS); i++)
+    {
+        const UCSCENEPrefab *p = &prefabs[i];
+        if (p->firstNode < header->sceneNodesCount || p->firstNode > nodescount || nodescount - p->firstNode < p->nodesCount) return false;
+        if (i > 0 && prefabs[i - 1].id >= p->id) return false;
+        for (uint32_t n = p->firstNode; n < p->firstNode + p->nodesCount; n++)
+        {
+            if (inprefab[n]) return false;
+            inprefab[n] = true;
+            rangebegin[n] = p->firstNode;
+        }
+    }
+
+    const UCSCENENode *nodes = GetNodes();
+    uint32_t surfacescount = GetCount(UCSCENE_TABLE_SURFACES);
+    uint32_t audiocount = GetCount(UCSCENE_TABLE_AUDIOSOURCES);
+    for (uint32_t i = 0; i < nodescount; i++)
+    {
+        const UCSCENENode *n = &nodes[i];
+        if (n->type > UCSCENE_NODE_AUDIOSOURCE) return false;
+        if (n->parent != -1 && (n->parent < (int32_t)rangebegin[i] || n->parent >= (int32_t)i)) return false;
+        if (n->firstSurface > surfacescount || surfacescount - n->firstSurface < n->surfacesCount) return false;
+        if ((n->type == UCSCENE_NODE_AUDIOSOURCE) != (n->audioSource != UCSCENE_NONE)) return false;
+        if (n->audioSource != UCSCENE_NONE && n->audioSource >= audiocount) return false;
+    }
+
+    // missing assets are allowed (they are left empty), assets of other type aren't.
+    auto isasset = [this, assets](uint64_t id, UCSCENEAssetType type) { int64_t a = FindAsset(id); return a < 0 || assets[a].type == type; };
+
+    const UCSCENESurface *surfaces = GetSurfaces();
+    for (uint32_t i = 0; i < surfacescount; i++)
+    {
+        const UCSCENESurface *s = &surfaces[i];
+        if (s->culling > UCSCENE_CULLING_BOTH || !isasset(s->mesh, UCSCENE_ASSET_MESH) || !isasset(s->texture, UCSCENE_ASSET_TEXTURE)) return false;
+    }
+
+    const UCSCENEAudioSource *sources = GetAudioSources();
+    uint32_t slotscount = GetCount(UCSCENE_TABLE_EFFECTSLOTS);
+    for (uint32_t i = 0; i < audiocount; i++)
+    {
+        if (sources[i].effectSlot != UCSCENE_NONE && sources[i].effectSlot >= slotscount) return false;
+        if (!isasset(sources[i].clip, UCSCENE_ASSET_AUDIOCLIP)) return false;
+    }
+
+    const UCSCENEEffectSlot *slots = GetEffectSlots();
+    uint32_t paramscount = GetCount(UCSCENE_TABLE_EFFECTPARAMS);
+    for (uint32_t i = 0; i < slotscount; i++)
+        if (slots[i].firstParam > paramscount || paramscount - slots[i].firstParam < slots[i].paramsCount) return false;
+
+    const UCSCENEInstance *instances = GetInstances();
+    for (uint32_t i = 0; i < GetCount(UCSCENE_TABLE_INSTANCES); i++)
+        if (instances[i].parent < -1 || instances[i].parent >= (int32_t)header->sceneNodesCount) return false;
+
+    return true;
+}
+
+template <typename T>
+static int64_t findbyid(const T *records, uint32_t count, uint64_t id)
+{
+    const T *end = records + count;
+    const T *it = std::lower_bound(records, end, id, [](const T &r, uint64_t v) { return r.id < v; });
+    return (it != end && it->id == id) ? it - records : -1;
+}
+
+std::vector<UCSCENEWriter::NodeEntry> *UCSCENEWriter::currentnodes() { return currentPrefab < 0 ? &nodes : &prefabs[currentPrefab].nodes; }
+
+// === PUBLIC ===
+
+bool UCSCENEFile::Open(std::string filename)
+{
+    Close();
+    if (!file.Open(filename)) return false;
+    if (file.GetSize() < sizeof(UCSCENEHeader)) { Close(); return false; }
+
+    header = reinterpret_cast<const UCSCENEHeader *>(file.GetData());
+    if (memcmp(header->signature, "UCSCENE", 8) || header->version != UCSCENE_VERSION || !validate())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void UCSCENEFile::Close()
+{
+    header = nullptr;
+    file.Close();
+}
+
+int64_t UCSCENEFile::FindAsset(uint64_t id) { return findbyid(GetAssets(), GetCount(UCSCENE_TABLE_ASSETS), id); }
+int64_t UCSCENEFile::FindPrefab(uint64_t id) { return findbyid(GetPrefabs(), GetCount(UCSCENE_TABLE_PREFABS), id); }
+
+// ================================
+
+UCSCENETransform UCSCENEWriter::MakeTransform(const float position[3], const float rotation[4], const float scale[3])
+{
+    UCSCENETransform t;
+    memcpy(t.position, position, sizeof(t.position));
+    memcpy(t.rotation, rotation, sizeof(t.rotation));
+    memcpy(t.scale, scale, sizeof(t.scale));
+    return t;
+}
+
+UCSCENETransform UCSCENEWriter::IdentityTransform()
+{
+    const float position[3] = { 0, 0, 0 }, rotation[4] = { 0, 0, 0, 1 }, scale[3] = { 1, 1, 1 };
+    return MakeTransform(position, rotation, scale);
+}
+
+UCSCENENode UCSCENEWriter::MakeNode(UCSCENENodeType type, UCSCENETransform transform, int32_t parent)
+{
+    UCSCENENode n = UCSCENENode();
+    n.transform = transform;
+    n.parent = parent;
+    n.type = type;
+    for (int i = 0; i < 4; i++) n.color[i] = 1.0f;
+    n.audioSource = UCSCENE_NONE;
+    return n;
+}
+
+UCSCENESurface UCSCENEWriter::MakeSurface(uint64_t mesh, uint64_t texture)
+{
+    UCSCENESurface s = UCSCENESurface();
+    s.transform = IdentityTransform();
+    for (int i = 0; i < 4; i++) s.color[i] = 1.0f;
+    s.mesh = mesh;
+    s.texture = texture;
+    s.culling = UCSCENE_CULLING_BACK;
+    return s;
+}
+
+uint64_t UCSCENEWriter::AddAsset(UCSCENEAssetType type, std::string path)
+{
+    uint64_t id = Utils::hash64(path);
+    for (UCSCENEAsset &a : assets) if (a.id == id) return id;
+
+    assets.push_back({ id, (uint32_t)type, (uint32_t)strings.size() });
+    strings += path;
+    strings += '\0';
+    return id;
+}
+
+uint64_t UCSCENEWriter::BeginPrefab(std::string name)
+{
+    uint64_t id = Utils::hash64(name);
+    prefabs.push_back({ id, std::vector<NodeEntry>() });
+    currentPrefab = prefabs.size() - 1;
+    return id;
+}
+
+void UCSCENEWriter::EndPrefab() { currentPrefab = -1; }
+
+int32_t UCSCENEWriter::AddNode(UCSCENENode node)
+{
+    std::vector<NodeEntry> *list = currentnodes();
+    if (node.parent < -1 || node.parent >= (int32_t)list->size()) return -1;
+
+    NodeEntry e = NodeEntry();
+    e.node = node;
+    e.node.audioSource = UCSCENE_NONE;
+    e.node.type = node.type == UCSCENE_NODE_AUDIOSOURCE ? (uint32_t)UCSCENE_NODE_EMPTY : node.type; // becomes source by SetAudioSource().
+    list->push_back(std::move(e));
+    return list->size() - 1;
+}
+
+bool UCSCENEWriter::AddSurface(int32_t node, UCSCENESurface surface)
+{
+    std::vector<NodeEntry> *list = currentnodes();
+    if (node < 0 || node >= (int32_t)list->size() || (*list)[node].node.type != UCSCENE_NODE_ENTITY) return false;
+
+    (*list)[node].surfaces.push_back(surface);
+    return true;
+}
+
+bool UCSCENEWriter::SetAudioSource(int32_t node, UCSCENEAudioSource source)
+{
+    std::vector<NodeEntry> *list = currentnodes();
+    if (node < 0 || node >= (int32_t)list->size() || (*list)[node].node.type == UCSCENE_NODE_ENTITY) return false;
+    if (source.effectSlot != UCSCENE_NONE && source.effectSlot >= effectSlots.size()) return false;
+
+    NodeEntry *e = &(*list)[node];
+    e->node.type = UCSCENE_NODE_AUDIOSOURCE;
+    e->hasAudioSource = true;
+    e->audioSource = source;
+    return true;
+}
+
+uint32_t UCSCENEWriter::AddEffectSlot(int32_t effect_type, std::vector<std::pair<int32_t, float>> params)
+{
+    EffectSlotEntry e = EffectSlotEntry();
+    e.effectType = effect_type;
+    for (std::pair<int32_t, float> p : params) e.params.push_back({ p.first, p.second });
+    effectSlots.push_back(std::move(e));
+    return effectSlots.size() - 1;
+}
+
+void UCSCENEWriter::AddInstance(uint64_t prefab, UCSCENETransform transform, int32_t parent)
+{ instances.push_back({ prefab, transform, parent, 0 }); }
+
+bool UCSCENEWriter::Save(std::string filename)
+{
+    for (UCSCENEInstance &i : instances) if (i.parent >= (int32_t)nodes.size()) return false;
+
+    std::vector<UCSCENENode> outnodes = std::vector<UCSCENENode>();
+    std::vector<UCSCENESurface> outsurfaces = std::vector<UCSCENESurface>();
+    std::vector<UCSCENEAudioSource> outsources = std::vector<UCSCENEAudioSource>();
+
+    auto flatten = [&](std::vector<NodeEntry> *list, uint32_t first)
+    {
+        for (NodeEntry &e : *list)
+        {
+            UCSCENENode n = e.node;
+            if (n.parent >= 0) n.parent += first;
+            n.firstSurface = outsurfaces.size();
+            n.surfacesCount = e.surfaces.size();
+            outsurfaces.insert(outsurfaces.end(), e.surfaces.begin(), e.surfaces.end());
+            if (e.hasAudioSource)
+            {
+                n.audioSource = outsources.size();
+                outsources.push_back(e.audioSource);
+            }
+            outnodes.push_back(n);
+        }
+    };
+
+    flatten(&nodes, 0);
+
+    std::vector<UCSCENEPrefab> outprefabs = std::vector<UCSCENEPrefab>();
+    for (PrefabEntry &p : prefabs)
+    {
+        outprefabs.push_back({ p.id, (uint32_t)outnodes.size(), (uint32_t)p.nodes.size() });
+        flatten(&p.nodes, outnodes.size());
+    }
+    std::sort(outprefabs.begin(), outprefabs.end(), [](const UCSCENEPrefab &a, const UCSCENEPrefab &b) { return a.id < b.id; });
+    for (size_t i = 1; i < outprefabs.size(); i++) if (outprefabs[i - 1].id == outprefabs[i].id) return false;
+
+    std::vector<UCSCENEEffectSlot> outslots = std::vector<UCSCENEEffectSlot>();
+    std::vector<UCSCENEEffectParam> outparams = std::vector<UCSCENEEffectParam>();
+    for (EffectSlotEntry &e : effectSlots)
+    {
+        outslots.push_back({ e.effectType, (uint32_t)outparams.size(), (uint32_t)e.params.size(), 0 });
+        outparams.insert(outparams.end(), e.params.begin(), e.params.end());
+    }
+
+    std::vector<UCSCENEAsset> outassets = assets;
+    std::sort(outassets.begin(), outassets.end(), [](const UCSCENEAsset &a, const UCSCENEAsset &b) { return a.id < b.id; });
+
+    UCSCENEHeader header = UCSCENEHeader();
+    memcpy(header.signature, "UCSCENE", 8);
+    header.version = UCSCENE_VERSION;
+    header.sceneNodesCount = nodes.size();
+
+    std::vector<uint8_t> out = std::vector<uint8_t>(sizeof(UCSCENEHeader));
+    auto put = [&out, &header](UCSCENETable t, const void *data, size_t count, size_t stride)
+    {
+        out.resize((out.size() + 7) / 8 * 8);
+        header.tables[t] = { (uint32_t)out.size(), (uint32_t)count };
+        const uint8_t *p = (const uint8_t *)data;
+        out.insert(out.end(), p, p + count * stride);
+    };
+
+    put(UCSCENE_TABLE_ASSETS, outassets.data(), outassets.size(), sizeof(UCSCENEAsset));
+    put(UCSCENE_TABLE_NODES, outnodes.data(), outnodes.size(), sizeof(UCSCENENode));
+    put(UCSCENE_TABLE_SURFACES, outsurfaces.data(), outsurfaces.size(), sizeof(UCSCENESurface));
+    put(UCSCENE_TABLE_AUDIOSOURCES, outsources.data(), outsources.size(), sizeof(UCSCENEAudioSource));
+    put(UCSCENE_TABLE_EFFECTSLOTS, outslots.data(), outslots.size(), sizeof(UCSCENEEffectSlot));
+    put(UCSCENE_TABLE_EFFECTPARAMS, outparams.data(), outparams.size(), sizeof(UCSCENEEffectParam));
+    put(UCSCENE_TABLE_PREFABS, outprefabs.data(), outprefabs.size(), sizeof(UCSCENEPrefab));
+    put(UCSCENE_TABLE_INSTANCES, instances.data(), instances.size(), sizeof(UCSCENEInstance));
+    put(UCSCENE_TABLE_STRINGS, strings.data(), strings.size(), 1);
+    memcpy(out.data(), &header, sizeof(header));
+
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (!f) return false;
+
+    bool ok = fwrite(out.data(), 1, out.size(), f) == out.size();
+    ok = fclose(f) == 0 && ok;
+    return ok;
+}
@@ -0,0 +1,266 @@
+#ifndef UCSCENEFILE_HPP
+#define UCSCENEFILE_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+#include "AssetFile.hpp"
+
+/*
+    UCSCENE - binary scene: GameObject hierarchy, surfaces, audio sources, effect slots and prefabs.
+
+    File is a header followed by tables of fixed size records (every table is 8 byte aligned), so loader
+    uses records right from mapped memory. Assets are referenced by 64-bit id (Utils::hash64 of path),
+    asset table (sorted by id) is the only place with paths. Prefabs are referenced by hash64 of name.
+
+    Nodes [0; sceneNodesCount) form the scene, rest of node table are prefab nodes. Parent of node always
+    has lower index (scene parents are absolute, -1 - root; prefab node parents are absolute too, -1 - prefab root),
+    so hierarchy is built in single pass.
+*/
+
+#define UCSCENE_VERSION 0
+#define UCSCENE_NONE UINT32_MAX
+
+enum
+{
+    UCSCENE_TABLE_ASSETS = 0,
+    UCSCENE_TABLE_NODES = 1,
+    UCSCENE_TABLE_SURFACES = 2,
+    UCSCENE_TABLE_AUDIOSOURCES = 3,
+    UCSCENE_TABLE_EFFECTSLOTS = 4,
+    UCSCENE_TABLE_EFFECTPARAMS = 5,
+    UCSCENE_TABLE_PREFABS = 6,
+    UCSCENE_TABLE_INSTANCES = 7,
+    UCSCENE_TABLE_STRINGS = 8, // count is size in bytes, offset 0 is always empty string.
+
+    UCSCENE_TABLES_COUNT = 9
+} typedef UCSCENETable;
+
+enum
+{
+    UCSCENE_ASSET_MESH = 0,
+    UCSCENE_ASSET_TEXTURE = 1,
+    UCSCENE_ASSET_AUDIOCLIP = 2
+} typedef UCSCENEAssetType;
+
+enum
+{
+    UCSCENE_NODE_EMPTY = 0,
+    UCSCENE_NODE_ENTITY = 1,
+    UCSCENE_NODE_AUDIOSOURCE = 2
+} typedef UCSCENENodeType;
+
+// same values as FaceCullingType.
+enum
+{
+    UCSCENE_CULLING_NONE = 0,
+    UCSCENE_CULLING_BACK = 1,
+    UCSCENE_CULLING_FRONT = 2,
+    UCSCENE_CULLING_BOTH = 3 // never rendered.
+} typedef UCSCENECulling;
+
+enum
+{
+    UCSCENE_NODE_HIDDEN = 1 << 0, // entity's enableRender = false.
+    UCSCENE_NODE_OCCLUDER = 1 << 1, // entity's surfaces are occluders (see OcclusionCuller).
+    UCSCENE_NODE_STATIC = 1 << 2 // entity never moves or changes, its surfaces are baked into PVS (see pvsbuilder).
+} typedef UCSCENENodeFlag;
+
+enum
+{
+    UCSCENE_AUDIO_LOOPING = 1 << 0,
+    UCSCENE_AUDIO_AUTOPLAY = 1 << 1
+} typedef UCSCENEAudioFlag;
+
+struct
+{
+    uint32_t offset;
+    uint32_t count;
+} typedef UCSCENETableInfo;
+
+struct
+{
+    char signature[8]; // "UCSCENE\0".
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t sceneNodesCount;
+    UCSCENETableInfo tables[UCSCENE_TABLES_COUNT];
+} typedef UCSCENEHeader;
+
+struct
+{
+    uint64_t id;
+    uint32_t type; // UCSCENEAssetType.
+    uint32_t path; // offset in strings table.
+} typedef UCSCENEAsset;
+
+struct
+{
+    float position[3];
+    float rotation[4]; // quaternion x, y, z, w.
+    float scale[3];
+} typedef UCSCENETransform;
+
+struct
+{
+    UCSCENETransform transform;
+    int32_t parent;
+    uint32_t type; // UCSCENENodeType.
+    float color[4];
+    uint32_t firstSurface;
+    uint32_t surfacesCount;
+    uint32_t audioSource; // UCSCENE_NONE if node isn't audio source.
+    uint32_t flags; // UCSCENENodeFlag.
+} typedef UCSCENENode;
+
+struct
+{
+    UCSCENETransform transform;
+    float color[4];
+    uint64_t mesh;
+    uint64_t texture; // 0 - untextured.
+    uint32_t culling; // UCSCENECulling.
+    float alphaCutoff;
+} typedef UCSCENESurface;
+
+struct
+{
+    uint64_t clip; // 0 - none.
+    float gain;
+    float pitch;
+    float referenceDistance;
+    float maxDistance;
+    uint32_t effectSlot; // UCSCENE_NONE - dry.
+    uint32_t flags; // UCSCENEAudioFlag.
+} typedef UCSCENEAudioSource;
+
+struct
+{
+    int32_t effectType; // AL_EFFECT_*.
+    uint32_t firstParam;
+    uint32_t paramsCount;
+    uint32_t reserved;
+} typedef UCSCENEEffectSlot;
+
+struct
+{
+    int32_t param; // AL_<EFFECT>_* float parameter.
+    float value;
+} typedef UCSCENEEffectParam;
+
+struct
+{
+    uint64_t id;
+    uint32_t firstNode;
+    uint32_t nodesCount;
+} typedef UCSCENEPrefab;
+
+struct
+{
+    uint64_t prefab;
+    UCSCENETransform transform;
+    int32_t parent; // scene node, -1 - root.
+    uint32_t reserved;
+} typedef UCSCENEInstance;
+
+// validated read-only view of mapped UCSCENE file, every index inside records is checked in Open().
+class UCSCENEFile
+{
+  private:
+    AssetFile file; // can be entry of mounted UCPACK archive, which keeps tables aligned.
+    const UCSCENEHeader *header = nullptr;
+
+    bool validate();
+
+    template <typename T>
+    inline const T *table(UCSCENETable t) { return reinterpret_cast<const T *>(file.GetData() + header->tables[t].offset); }
+
+  public:
+    UCSCENEFile() {}
+
+    bool Open(std::string filename);
+    void Close();
+    inline bool IsOpen() { return header != nullptr; }
+
+    inline uint32_t GetCount(UCSCENETable t) { return header->tables[t].count; }
+    inline uint32_t GetSceneNodesCount() { return header->sceneNodesCount; }
+
+    inline const UCSCENEAsset *GetAssets() { return table<UCSCENEAsset>(UCSCENE_TABLE_ASSETS); }
+    inline const UCSCENENode *GetNodes() { return table<UCSCENENode>(UCSCENE_TABLE_NODES); }
+    inline const UCSCENESurface *GetSurfaces() { return table<UCSCENESurface>(UCSCENE_TABLE_SURFACES); }
+    inline const UCSCENEAudioSource *GetAudioSources() { return table<UCSCENEAudioSource>(UCSCENE_TABLE_AUDIOSOURCES); }
+    inline const UCSCENEEffectSlot *GetEffectSlots() { return table<UCSCENEEffectSlot>(UCSCENE_TABLE_EFFECTSLOTS); }
+    inline const UCSCENEEffectParam *GetEffectParams() { return table<UCSCENEEffectParam>(UCSCENE_TABLE_EFFECTPARAMS); }
+    inline const UCSCENEPrefab *GetPrefabs() { return table<UCSCENEPrefab>(UCSCENE_TABLE_PREFABS); }
+    inline const UCSCENEInstance *GetInstances() { return table<UCSCENEInstance>(UCSCENE_TABLE_INSTANCES); }
+    inline const char *GetString(uint32_t offset) { return table<char>(UCSCENE_TABLE_STRINGS) + offset; }
+
+    // binary search, -1 if not found.
+    int64_t FindAsset(uint64_t id);
+    int64_t FindPrefab(uint64_t id);
+};
+
+// builds UCSCENE file in memory, node indices are local to scene or to prefab being built.
+class UCSCENEWriter
+{
+  private:
+    struct NodeEntry
+    {
+        UCSCENENode node;
+        std::vector<UCSCENESurface> surfaces;
+        bool hasAudioSource;
+        UCSCENEAudioSource audioSource;
+    };
+
+    struct PrefabEntry
+    {
+        uint64_t id;
+        std::vector<NodeEntry> nodes;
+    };
+
+    struct EffectSlotEntry
+    {
+        int32_t effectType;
+        std::vector<UCSCENEEffectParam> params;
+    };
+
+    std::vector<UCSCENEAsset> assets = std::vector<UCSCENEAsset>();
+    std::string strings = std::string(1, '\0');
+    std::vector<NodeEntry> nodes = std::vector<NodeEntry>();
+    std::vector<PrefabEntry> prefabs = std::vector<PrefabEntry>();
+    std::vector<EffectSlotEntry> effectSlots = std::vector<EffectSlotEntry>();
+    std::vector<UCSCENEInstance> instances = std::vector<UCSCENEInstance>();
+
+    int currentPrefab = -1;
+
+    std::vector<NodeEntry> *currentnodes();
+
+  public:
+    UCSCENEWriter() {}
+
+    static UCSCENETransform MakeTransform(const float position[3], const float rotation[4], const float scale[3]);
+    static UCSCENETransform IdentityTransform();
+    static UCSCENENode MakeNode(UCSCENENodeType type, UCSCENETransform transform, int32_t parent = -1);
+    static UCSCENESurface MakeSurface(uint64_t mesh, uint64_t texture = 0);
+
+    // returns id of asset (same path gives same id).
+    uint64_t AddAsset(UCSCENEAssetType type, std::string path);
+
+    // nodes added between BeginPrefab() and EndPrefab() belong to prefab, returns prefab id.
+    uint64_t BeginPrefab(std::string name);
+    void EndPrefab();
+
+    // returns node index, parent must be already added.
+    int32_t AddNode(UCSCENENode node);
+    bool AddSurface(int32_t node, UCSCENESurface surface);
+    bool SetAudioSource(int32_t node, UCSCENEAudioSource source);
+
+    uint32_t AddEffectSlot(int32_t effect_type, std::vector<std::pair<int32_t, float>> params);
+    void AddInstance(uint64_t prefab, UCSCENETransform transform, int32_t parent = -1);
+
+    bool Save(std::string filename);
+};
+
+#endif
@@ -0,0 +1,33 @@
+#include "UCSOUNDData.hpp"
+
+#include <cstdio>
+
+// === PUBLIC ===
+
+bool UCSOUNDData::SaveToUCSOUNDFile(std::string filename)
+{
+    if ((channels != 1 && channels != 2) || frequency == 0 || frequency > UINT16_MAX || samples.size() % channels != 0) return false;
+
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (!f) return false;
+
+    uint16_t version = UCSOUND_VERSION;
+    uint8_t type = channels == 1 ? UCSOUND_TYPE_MONO_S16 : UCSOUND_TYPE_STEREO_S16;
+    uint16_t frequency16 = frequency;
+
+    fwrite("UCSOUND", sizeof(char), 7, f);
+    fwrite(&version, sizeof(version), 1, f);
+    fwrite(&type, sizeof(type), 1, f);
+    fwrite(&frequency16, sizeof(frequency16), 1, f);
+    fwrite(samples.data(), sizeof(int16_t), samples.size(), f);
+
+    bool ok = !ferror(f);
+    return fclose(f) == 0 && ok;
+}
+
+void UCSOUNDData::Clear()
+{
+    channels = 1;
+    frequency = 0;
+    samples.clear();
+}
@@ -0,0 +1,38 @@
+#ifndef UCSOUNDDATA_HPP
+#define UCSOUNDDATA_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+    UCSOUND: "UCSOUND", uint16 version, uint8 UCSOUNDType, uint16 frequency, samples (interleaved) up to end of file.
+*/
+
+#define UCSOUND_VERSION 0
+
+enum
+{
+    UCSOUND_TYPE_MONO_U8 = 0,
+    UCSOUND_TYPE_MONO_S16 = 1,
+    UCSOUND_TYPE_STEREO_U8 = 2,
+    UCSOUND_TYPE_STEREO_S16 = 3
+} typedef UCSOUNDType;
+
+// CPU-side 16 bit sound for tools (game loads UCSOUND into AudioClip directly).
+class UCSOUNDData
+{
+  public:
+    unsigned int channels = 1; // 1 or 2.
+    uint32_t frequency = 0; // must fit in uint16 to be saved.
+    std::vector<int16_t> samples = std::vector<int16_t>(); // interleaved.
+
+    UCSOUNDData() {}
+
+    // writes MONO_S16 or STEREO_S16.
+    bool SaveToUCSOUNDFile(std::string filename);
+
+    void Clear();
+};
+
+#endif
@@ -0,0 +1,329 @@
+#include "UCTEXImage.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include "AssetFile.hpp"
+#include "../utils.hpp"
+
+// === PRIVATE ===
+
+static bool readheader(const uint8_t **p, const uint8_t *end, UCTEXHeader *header)
+{
+    char sig[5];
+    if (!Utils::readbytes(p, end, sig, 5) || strncmp(sig, "UCTEX", 5)) return false;
+
+    uint16_t version;
+    if (!Utils::readbytes(p, end, &version, sizeof(version)) || version > UCTEX_VERSION) return false;
+
+    uint8_t type;
+    if (!Utils::readbytes(p, end, &type, sizeof(type)) || (type > UCTEX_TYPE_RGB5)) return false;
+
+    uint16_t width16, height16;
+    if (!Utils::readbytes(p, end, &width16, sizeof(width16)) || !Utils::readbytes(p, end, &height16, sizeof(height16))) return false;
+
+    uint8_t levels = 1;
+    if (version >= 1 && (!Utils::readbytes(p, end, &levels, sizeof(levels)) || levels == 0)) return false;
+
+    header->type = type;
+    header->width = width16 + 1;
+    header->height = height16 + 1;
+    header->levels = levels;
+    return true;
+}
+
+static const char *typenames[] = { "rgba8", "rgb8", "rgb5a1", "rgb5" };
+
+static inline size_t pixelsize(uint8_t type) { return type == UCTEX_TYPE_RGBA8 ? 4 : type == UCTEX_TYPE_RGB8 ? 3 : 2; }
+
+// 4x4 Bayer matrix, thresholds in [0; 16).
+static const uint8_t bayer[4][4] = { { 0, 8, 2, 10 }, { 12, 4, 14, 6 }, { 3, 11, 1, 9 }, { 15, 7, 13, 5 } };
+
+// 8 bit channel -> 5 bit one (loader expands it back by << 3).
+static inline uint16_t tofivebits(uint32_t value, int offset)
+{
+    int v = ((int)value + offset + 4) >> 3;
+    return v < 0 ? 0 : v > 31 ? 31 : v;
+}
+
+static void writepixels(FILE *f, uint8_t type, bool dither, uint32_t width, uint32_t height, const uint32_t *pixels)
+{
+    std::vector<uint8_t> row = std::vector<uint8_t>(width * pixelsize(type));
+    for (uint32_t y = 0; y < height; y++)
+    {
+        const uint32_t *src = pixels + (size_t)y * width;
+        switch (type)
+        {
+            case UCTEX_TYPE_RGBA8:
+                memcpy(row.data(), src, width * 4);
+                break;
+
+            case UCTEX_TYPE_RGB8:
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    row[x * 3] = src[x] & 0xFF;
+                    row[x * 3 + 1] = (src[x] >> 8) & 0xFF;
+                    row[x * 3 + 2] = (src[x] >> 16) & 0xFF;
+                }
+                break;
+
+            case UCTEX_TYPE_RGB5_A1:
+            case UCTEX_TYPE_RGB5:
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    // threshold is spread over [-4; 4), one step of 5 bit channel.
+                    int offset = dither ? bayer[y & 3][x & 3] / 2 - 4 : 0;
+                    uint32_t p = src[x];
+                    uint16_t out = tofivebits(p & 0xFF, offset) | (tofivebits((p >> 8) & 0xFF, offset) << 5) | (tofivebits((p >> 16) & 0xFF, offset) << 10);
+                    if (type == UCTEX_TYPE_RGB5_A1 && (p >> 24) >= 128) out |= 1 << 15;
+                    memcpy(&row[x * 2], &out, sizeof(out));
+                }
+                break;
+        }
+        fwrite(row.data(), 1, row.size(), f);
+    }
+}
+
+static inline uint32_t decodepixel(uint8_t type, const uint8_t *src)
+{
+    uint16_t pixel;
+    switch (type)
+    {
+        case UCTEX_TYPE_RGB8:
+            return 0xFF000000 | (src[2] << 16) | (src[1] << 8) | src[0];
+
+        case UCTEX_TYPE_RGB5_A1:
+            memcpy(&pixel, src, sizeof(pixel));
+            return (((pixel >> 15) * 255) << 24) | ((pixel & 0b11111) << 3) | ((pixel & (0b11111 << 5)) << 6) | ((pixel & (0b11111 << 10)) << 9);
+
+        case UCTEX_TYPE_RGB5:
+            memcpy(&pixel, src, sizeof(pixel));
+            return 0xFF000000 | ((pixel & 0b11111) << 3) | ((pixel & (0b11111 << 5)) << 6) | ((pixel & (0b11111 << 10)) << 9);
+
+        default:
+            uint32_t rgba;
+            memcpy(&rgba, src, sizeof(rgba));
+            return rgba;
+    }
+}
+
+// checkerboard cells of missing pixels in every type, [type][odd cell].
+static const uint8_t missingpixels[4][2][4] =
+{
+    { { 0x00, 0x00, 0x00, 0xFF }, { 0xFF, 0x00, 0xFF, 0xFF } },
+    { { 0xFF, 0xFF, 0xFF }, { 0x00, 0xFF, 0x00 } },
+    { { 0x00, 0xFC }, { 0xFF, 0x83 } },
+    { { 0x1F, 0x00 }, { 0xE0, 0x7F } }
+};
+
+// missing pixels (truncated file) are filled with checkerboard pattern, *p is moved past read ones.
+static void readpixels(const uint8_t **p, const uint8_t *end, uint8_t type, uint32_t width, uint32_t height, std::vector<uint32_t> *pixels)
+{
+    size_t size = pixelsize(type);
+    size_t count = (size_t)width * height;
+    size_t available = std::min<size_t>((end - *p) / size, count);
+    pixels->resize(count);
+
+    const uint8_t *src = *p;
+    if (type == UCTEX_TYPE_RGBA8) memcpy(pixels->data(), src, available * size);
+    else for (size_t i = 0; i < available; i++) (*pixels)[i] = decodepixel(type, src + i * size);
+
+    for (size_t i = available; i < count; i++) (*pixels)[i] = decodepixel(type, missingpixels[type][(i % width + i / width) & 1]);
+    *p += available * size;
+}
+
+// === PUBLIC ===
+
+UCTEXImage::UCTEXImage(uint32_t _width, uint32_t _height) : width(_width), height(_height), pixels(_width * _height) {}
+UCTEXImage::UCTEXImage() {}
+
+bool UCTEXImage::ReadUCTEXHeader(std::string filename, UCTEXHeader *header)
+{
+    AssetFile file = AssetFile();
+    return file.Open(filename) && ReadUCTEXHeader(file.GetData(), file.GetSize(), header);
+}
+
+bool UCTEXImage::ReadUCTEXHeader(const uint8_t *data, size_t size, UCTEXHeader *header) { return readheader(&data, data + size, header); }
+
+bool UCTEXImage::LoadFromUCTEXFile(std::string filename)
+{
+    AssetFile file = AssetFile();
+    return file.Open(filename) && LoadFromUCTEX(file.GetData(), file.GetSize());
+}
+
+bool UCTEXImage::LoadFromUCTEX(const uint8_t *data, size_t size)
+{
+    const uint8_t *p = data, *end = data + size;
+
+    UCTEXHeader header;
+    if (!readheader(&p, end, &header)) return false;
+
+    width = header.width;
+    height = header.height;
+    type = header.type;
+    readpixels(&p, end, type, width, height, &pixels);
+    return true;
+}
+
+bool UCTEXImage::LoadMipsFromUCTEXFile(std::string filename, unsigned int first_mip, unsigned int end_mip, std::vector<UCTEXImage> *mips)
+{
+    mips->clear();
+
+    AssetFile file = AssetFile();
+    return file.Open(filename) && LoadMipsFromUCTEX(file.GetData(), file.GetSize(), first_mip, end_mip, mips);
+}
+
+bool UCTEXImage::LoadMipsFromUCTEX(const uint8_t *data, size_t size, unsigned int first_mip, unsigned int end_mip, std::vector<UCTEXImage> *mips)
+{
+    mips->clear();
+    const uint8_t *p = data, *end = data + size;
+
+    UCTEXHeader header;
+    if (!readheader(&p, end, &header)) return false;
+
+    end_mip = std::min(end_mip, GetMipLevelsCount(header.width, header.height));
+    unsigned int stored = std::min<unsigned int>(header.levels, end_mip);
+
+    UCTEXImage image = UCTEXImage();
+    for (unsigned int l = 0; l < end_mip; l++)
+    {
+        uint32_t w = GetMipDimension(header.width, l), h = GetMipDimension(header.height, l);
+        if (l < stored)
+        {
+            // skipped unless it's the last stored one and the rest is downsampled from it.
+            if (l < first_mip && l + 1 < stored)
+            {
+                p += std::min<size_t>((size_t)w * h * pixelsize(header.type), end - p);
+                continue;
+            }
+
+            image.width = w;
+            image.height = h;
+            image.type = header.type;
+            readpixels(&p, end, header.type, w, h, &image.pixels);
+        }
+        else image = image.GenerateNextMip();
+
+        if (l >= first_mip) mips->push_back(image);
+    }
+
+    return !mips->empty();
+}
+
+bool UCTEXImage::SaveToUCTEXFile(std::string filename, UCTEXType type, bool dither, UCTEXImage *mips, size_t mips_count)
+{
+    if (IsEmpty() || width > 65536 || height > 65536 || type > UCTEX_TYPE_RGB5 || mips_count + 1 > GetMipLevelsCount(width, height)) return false;
+    for (size_t i = 0; i < mips_count; i++)
+        if (mips[i].width != GetMipDimension(width, i + 1) || mips[i].height != GetMipDimension(height, i + 1) || mips[i].IsEmpty()) return false;
+
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (!f) return false;
+
+    uint16_t version = mips_count > 0 ? 1 : 0;
+    uint8_t type8 = type;
+    uint16_t width16 = width - 1, height16 = height - 1;
+
+    fwrite("UCTEX", sizeof(char), 5, f);
+    fwrite(&version, sizeof(version), 1, f);
+    fwrite(&type8, sizeof(type8), 1, f);
+    fwrite(&width16, sizeof(width16), 1, f);
+    fwrite(&height16, sizeof(height16), 1, f);
+    if (version >= 1)
+    {
+        uint8_t levels = mips_count + 1;
+        fwrite(&levels, sizeof(levels), 1, f);
+    }
+
+    writepixels(f, type, dither, width, height, pixels.data());
+    for (size_t i = 0; i < mips_count; i++) writepixels(f, type, dither, mips[i].width, mips[i].height, mips[i].pixels.data());
+
+    bool ok = !ferror(f);
+    return fclose(f) == 0 && ok;
+}
+
+bool UCTEXImage::SaveCookedUCTEXFile(std::string filename, int type, bool dither, bool mips, UCTEXType *saved_type, size_t *levels_count)
+{
+    UCTEXType t = type == UCTEX_TYPE_AUTO ? (HasTransparency() ? UCTEX_TYPE_RGBA8 : UCTEX_TYPE_RGB8) : (UCTEXType)type;
+
+    std::vector<UCTEXImage> chain = std::vector<UCTEXImage>();
+    if (mips)
+    {
+        unsigned int levels = GetMipLevelsCount(width, height);
+        for (unsigned int l = 1; l < levels; l++) chain.push_back((l == 1 ? *this : chain.back()).GenerateNextMip());
+    }
+
+    if (saved_type) *saved_type = t;
+    if (levels_count) *levels_count = chain.size() + 1;
+    return SaveToUCTEXFile(filename, t, dither, chain.data(), chain.size());
+}
+
+const char *UCTEXImage::GetTypeName(UCTEXType type) { return type <= UCTEX_TYPE_RGB5 ? typenames[type] : "unknown"; }
+
+bool UCTEXImage::ParseTypeName(const char *name, int *type)
+{
+    if (!strcmp(name, "auto"))
+    {
+        *type = UCTEX_TYPE_AUTO;
+        return true;
+    }
+
+    for (int t = 0; t <= UCTEX_TYPE_RGB5; t++)
+        if (!strcmp(name, typenames[t]))
+        {
+            *type = t;
+            return true;
+        }
+    return false;
+}
+
+bool UCTEXImage::HasTransparency()
+{
+    for (uint32_t p : pixels) if ((p >> 24) != 0xFF) return true;
+    return false;
+}
+
+UCTEXImage UCTEXImage::GenerateNextMip()
+{
+    uint32_t mw = GetMipDimension(width, 1);
+    uint32_t mh = GetMipDimension(height, 1);
+    UCTEXImage mip = UCTEXImage(mw, mh);
+    mip.type = type;
+
+    for (uint32_t y = 0; y < mh; y++)
+    {
+        uint32_t y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+        for (uint32_t x = 0; x < mw; x++)
+        {
+            uint32_t x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+            uint32_t p[4] = { GetPixel(x0, y0), GetPixel(x1, y0), GetPixel(x0, y1), GetPixel(x1, y1) };
+
+            uint32_t out = 0;
+            for (unsigned int ch = 0; ch < 4; ch++)
+            {
+                uint32_t sum = 0;
+                for (unsigned int i = 0; i < 4; i++) sum += (p[i] >> (ch * 8)) & 0xFF;
+                out |= ((sum + 2) / 4) << (ch * 8);
+            }
+            mip.SetPixel(x, y, out);
+        }
+    }
+
+    return mip;
+}
+
+unsigned int UCTEXImage::GetMipLevelsCount(uint32_t width, uint32_t height)
+{
+    unsigned int levels = 1;
+    uint32_t size = width > height ? width : height;
+    while (size > 1) { size >>= 1; levels++; }
+    return levels;
+}
+
+size_t UCTEXImage::GetMipChainSizeInBytes(uint32_t width, uint32_t height, unsigned int first_level)
+{
+    size_t size = 0;
+    unsigned int levels = GetMipLevelsCount(width, height);
+    for (unsigned int l = first_level; l < levels; l++) size += (size_t)GetMipDimension(width, l) * GetMipDimension(height, l) * sizeof(uint32_t);
+    return size;
+}
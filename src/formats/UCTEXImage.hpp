@@ -0,0 +1,94 @@
+#ifndef UCTEXIMAGE_HPP
+#define UCTEXIMAGE_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/*
+    UCTEX: "UCTEX", uint16 version, uint8 UCTEXType, uint16 width - 1, uint16 height - 1, pixels (rows from top).
+
+    Version 1 adds uint8 levels count after height and stores mip chain: levels [0; count) one after another,
+    all of the same type, sizes are UCTEXImage::GetMipDimension() of base ones.
+*/
+
+#define UCTEX_VERSION 1
+#define UCTEX_TYPE_AUTO -1 // for SaveCookedUCTEXFile(): RGBA8 for images with transparency, RGB8 for the rest.
+
+enum
+{
+    UCTEX_TYPE_RGBA8 = 0, // 0xAABBGGRR.
+    UCTEX_TYPE_RGB8 = 1, // 0xBBGGRR.
+    UCTEX_TYPE_RGB5_A1 = 2, // 0bABBBBBGGGGGRRRRR.
+    UCTEX_TYPE_RGB5 = 3 // 0b0BBBBBGGGGGRRRRR.
+} typedef UCTEXType;
+
+struct
+{
+    uint8_t type;
+    uint32_t width;
+    uint32_t height;
+    uint8_t levels; // stored mip levels, 1 for version 0.
+} typedef UCTEXHeader;
+
+// CPU-side decoded UCTEX image (always RGBA8, 0xAABBGGRR), doesn't touch OpenGL so can be used from any thread.
+class UCTEXImage
+{
+  private:
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint8_t type = UCTEX_TYPE_RGBA8;
+    std::vector<uint32_t> pixels = std::vector<uint32_t>();
+
+  public:
+    UCTEXImage(uint32_t _width, uint32_t _height);
+    UCTEXImage();
+
+    // files can be in mounted UCPACK archive (see AssetFile).
+    static bool ReadUCTEXHeader(std::string filename, UCTEXHeader *header);
+    static bool ReadUCTEXHeader(const uint8_t *data, size_t size, UCTEXHeader *header);
+
+    // loads level 0 only.
+    bool LoadFromUCTEXFile(std::string filename);
+    bool LoadFromUCTEX(const uint8_t *data, size_t size);
+    // mip levels [first_mip; end_mip) (clamped to full chain), levels that aren't stored in file are downsampled.
+    static bool LoadMipsFromUCTEXFile(std::string filename, unsigned int first_mip, unsigned int end_mip, std::vector<UCTEXImage> *mips);
+    static bool LoadMipsFromUCTEX(const uint8_t *data, size_t size, unsigned int first_mip, unsigned int end_mip, std::vector<UCTEXImage> *mips);
+
+    // dimensions must be in [1; 65536], mips are levels 1, 2, ... (file becomes version 1 if there are any).
+    // dither applies ordered dithering when type has less than 8 bits per channel.
+    bool SaveToUCTEXFile(std::string filename, UCTEXType type, bool dither, UCTEXImage *mips, size_t mips_count);
+    inline bool SaveToUCTEXFile(std::string filename) { return SaveToUCTEXFile(filename, UCTEX_TYPE_RGBA8, false, nullptr, 0); }
+    // as written by png2uctex and assetcooker: type is UCTEXType or UCTEX_TYPE_AUTO, mips - generate full chain.
+    // saved_type and levels_count (optional) get what was written.
+    bool SaveCookedUCTEXFile(std::string filename, int type, bool dither, bool mips, UCTEXType *saved_type = nullptr, size_t *levels_count = nullptr);
+
+    // "rgba8", "rgb8", "rgb5a1", "rgb5".
+    static const char *GetTypeName(UCTEXType type);
+    // type name or "auto" (UCTEX_TYPE_AUTO), false if unknown.
+    static bool ParseTypeName(const char *name, int *type);
+
+    // true if any pixel isn't fully opaque.
+    bool HasTransparency();
+
+    inline uint32_t GetWidth() { return width; }
+    inline uint32_t GetHeight() { return height; }
+    inline uint8_t GetSourceType() { return type; }
+    inline bool IsEmpty() { return pixels.empty(); }
+
+    inline uint32_t *GetPixels() { return pixels.data(); }
+    inline size_t GetSizeInBytes() { return pixels.size() * sizeof(uint32_t); }
+
+    inline uint32_t GetPixel(uint32_t x, uint32_t y) { return pixels[y * width + x]; }
+    inline void SetPixel(uint32_t x, uint32_t y, uint32_t pixel) { pixels[y * width + x] = pixel; }
+
+    // 2x2 box filter, every dimension is clamped to 1.
+    UCTEXImage GenerateNextMip();
+
+    static unsigned int GetMipLevelsCount(uint32_t width, uint32_t height);
+    static inline uint32_t GetMipDimension(uint32_t dimension, unsigned int level) { return (dimension >> level) > 0 ? (dimension >> level) : 1; }
+    static size_t GetMipChainSizeInBytes(uint32_t width, uint32_t height, unsigned int first_level);
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "WAVReader.hpp"
+
+#include <cstring>
+#include <cmath>
+
+#include "MappedFile.hpp"
+
+// === PRIVATE ===
+
+#define WAVE_FORMAT_PCM 1
+#define WAVE_FORMAT_IEEE_FLOAT 3
+#define WAVE_FORMAT_EXTENSIBLE 0xFFFE
+
+static inline uint16_t readu16(const uint8_t *p) { uint16_t v; memcpy(&v, p, sizeof(v)); return v; }
+static inline uint32_t readu32(const uint8_t *p) { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+
+static inline int16_t fromfloat(double v)
+{
+    v = std::round(v * 32767.0);
+    return v < -32768.0 ? -32768 : v > 32767.0 ? 32767 : (int16_t)v;
+}
+
+static inline bool fail(std::string *error, const char *reason)
+{
+    if (error) *error = reason;
+    return false;
+}
+
+// === PUBLIC ===
+
+bool WAVReader::ReadWAVFile(std::string filename, UCSOUNDData *sound, std::string *error)
+{
+    MappedFile file = MappedFile();
+    if (!file.Open(filename)) return fail(error, "can't open file");
+
+    const uint8_t *data = file.GetData();
+    size_t size = file.GetSize();
+    if (size < 12 || memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4)) return fail(error, "not a RIFF WAVE file");
+
+    uint16_t format = 0, channels = 0, bits = 0;
+    uint32_t frequency = 0;
+    const uint8_t *samples = nullptr;
+    size_t samplesSize = 0;
+
+    // chunks are word aligned.
+    for (size_t offset = 12; offset + 8 <= size;)
+    {
+        uint32_t chunkSize = readu32(data + offset + 4);
+        const uint8_t *chunk = data + offset + 8;
+        size_t available = size - offset - 8;
+
+        if (!memcmp(data + offset, "fmt ", 4))
+        {
+            if (chunkSize < 16 || available < 16) return fail(error, "broken fmt chunk");
+
+            format = readu16(chunk);
+            channels = readu16(chunk + 2);
+            frequency = readu32(chunk + 4);
+            bits = readu16(chunk + 14);
+
+            // subformat GUID starts with format tag.
+            if (format == WAVE_FORMAT_EXTENSIBLE)
+            {
+                if (chunkSize < 40 || available < 40) return fail(error, "broken fmt chunk");
+                format = readu16(chunk + 24);
+            }
+        }
+        else if (!memcmp(data + offset, "data", 4))
+        {
+            samples = chunk;
+            samplesSize = chunkSize < available ? chunkSize : available; // truncated file keeps what it has.
+        }
+
+        offset += 8 + (size_t)chunkSize + (chunkSize & 1);
+    }
+
+    if (!samples || format == 0) return fail(error, "no fmt or data chunk");
+    if (channels != 1 && channels != 2) return fail(error, "only mono and stereo are supported");
+    if (frequency == 0 || frequency > UINT16_MAX) return fail(error, "sample rate doesn't fit UCSOUND");
+
+    bool pcm = format == WAVE_FORMAT_PCM && (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+    bool flt = format == WAVE_FORMAT_IEEE_FLOAT && (bits == 32 || bits == 64);
+    if (!pcm && !flt) return fail(error, "unsupported sample format");
+
+    size_t bytes = bits / 8;
+    size_t count = samplesSize / bytes / channels * channels;
+
+    sound->Clear();
+    sound->channels = channels;
+    sound->frequency = frequency;
+    sound->samples.resize(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint8_t *s = samples + i * bytes;
+        int16_t v = 0;
+        if (flt && bits == 32) { float f; memcpy(&f, s, sizeof(f)); v = fromfloat(f); }
+        else if (flt) { double d; memcpy(&d, s, sizeof(d)); v = fromfloat(d); }
+        else if (bits == 8) v = (int16_t)(((int)s[0] - 128) << 8);
+        else v = (int16_t)readu16(s + bytes - 2); // most significant 16 bits of little endian sample.
+
+        sound->samples[i] = v;
+    }
+
+    return true;
+}
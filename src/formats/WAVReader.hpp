@@ -0,0 +1,16 @@
+#ifndef WAVREADER_HPP
+#define WAVREADER_HPP
+
+#include <string>
+
+#include "UCSOUNDData.hpp"
+
+// RIFF WAVE decoding: PCM 8/16/24/32 bit and 32/64 bit float (plain or WAVE_FORMAT_EXTENSIBLE), mono or stereo.
+class WAVReader
+{
+  public:
+    // error (optional) gets reason on failure.
+    static bool ReadWAVFile(std::string filename, UCSOUNDData *sound, std::string *error = nullptr);
+};
+
+#endif
@@ -0,0 +1,213 @@
+#include "HLODBuilder.hpp"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <cmath>
+
+#include "../utils.hpp"
+
+// === PRIVATE ===
+
+static uint32_t modulate(uint32_t pixel, glm::vec4 color)
+{
+    uint32_t out = 0;
+    for (unsigned int ch = 0; ch < 4; ch++)
+    {
+        float v = ((pixel >> (ch * 8)) & 0xFF) * glm::clamp(color[ch], 0.0f, 1.0f);
+        out |= (uint32_t)(v + 0.5f) << (ch * 8);
+    }
+    return out;
+}
+
+uint32_t HLODBuilder::gettile(UCTEXImage *texture, glm::vec4 color)
+{
+    for (uint32_t i = 0; i < tiles.size(); i++)
+        if (tiles[i].texture == texture && tiles[i].color == color) return i;
+
+    tiles.push_back({ texture, color });
+    return tiles.size() - 1;
+}
+
+void HLODBuilder::baketile(Tile *tile, UCTEXImage *atlas, uint32_t x, uint32_t y, uint32_t size, uint32_t padding)
+{
+    if (!tile->texture)
+    {
+        uint32_t pixel = modulate(0xFFFFFFFF, tile->color);
+        for (uint32_t ty = 0; ty < size + padding * 2; ty++)
+            for (uint32_t tx = 0; tx < size + padding * 2; tx++) atlas->SetPixel(x + tx, y + ty, pixel);
+        return;
+    }
+
+    // smallest mip that still has at least tile's resolution, then nearest sampling of it.
+    UCTEXImage mip = UCTEXImage();
+    UCTEXImage *src = tile->texture;
+    while (src->GetWidth() >= size * 2 && src->GetHeight() >= size * 2)
+    {
+        mip = src->GenerateNextMip();
+        src = &mip;
+    }
+
+    for (uint32_t ty = 0; ty < size + padding * 2; ty++)
+    {
+        // padding repeats tile's edge.
+        uint32_t cy = std::min(std::max(ty, padding), padding + size - 1) - padding;
+        uint32_t sy = std::min((uint32_t)(((uint64_t)cy * 2 + 1) * src->GetHeight() / (size * 2)), src->GetHeight() - 1);
+        for (uint32_t tx = 0; tx < size + padding * 2; tx++)
+        {
+            uint32_t cx = std::min(std::max(tx, padding), padding + size - 1) - padding;
+            uint32_t sx = std::min((uint32_t)(((uint64_t)cx * 2 + 1) * src->GetWidth() / (size * 2)), src->GetWidth() - 1);
+            atlas->SetPixel(x + tx, y + ty, modulate(src->GetPixel(sx, sy), tile->color));
+        }
+    }
+}
+
+// === PUBLIC ===
+
+HLODSettings HLODBuilder::GetDefaultSettings()
+{
+    HLODSettings s = HLODSettings();
+    s.clusterSize = 0.5f;
+    s.tileSize = 64;
+    s.maxAtlasSize = 2048;
+    s.padding = 2;
+    return s;
+}
+
+void HLODBuilder::AddSurface(UCMESHData *mesh, glm::mat4 transform, UCTEXImage *texture, glm::vec4 color)
+{
+    if (texture && texture->IsEmpty()) texture = nullptr;
+    sources.push_back({ mesh, transform, gettile(texture, color) });
+}
+
+bool HLODBuilder::Build(HLODSettings settings, UCMESHData *mesh, UCTEXImage *atlas)
+{
+    stats = HLODStats();
+    if (sources.empty() || tiles.size() > UINT16_MAX) return false;
+
+    // ===== ATLAS =====
+
+    uint32_t cols = (uint32_t)std::ceil(std::sqrt((double)tiles.size()));
+    uint32_t rows = (tiles.size() + cols - 1) / cols;
+    uint32_t tilesize = std::max(settings.tileSize, 1u);
+    while (tilesize > 1 && (tilesize + settings.padding * 2) * std::max(cols, rows) > settings.maxAtlasSize) tilesize /= 2;
+
+    uint32_t step = tilesize + settings.padding * 2;
+    *atlas = UCTEXImage(cols * step, rows * step);
+    for (uint32_t i = 0; i < tiles.size(); i++) baketile(&tiles[i], atlas, (i % cols) * step, (i / cols) * step, tilesize, settings.padding);
+
+    glm::vec2 atlassize = glm::vec2(atlas->GetWidth(), atlas->GetHeight());
+
+    // ===== CLUSTERING =====
+
+    glm::vec3 bmin = glm::vec3(INFINITY), bmax = glm::vec3(-INFINITY);
+    for (Source &s : sources)
+        for (glm::vec3 v : s.mesh->vertices)
+        {
+            glm::vec3 p = glm::vec3(s.transform * glm::vec4(v, 1.0f));
+            bmin = glm::min(bmin, p);
+            bmax = glm::max(bmax, p);
+        }
+
+    // grid is limited to 16 bits per axis, so key (with tile) fits 64 bits.
+    float cell = std::max(settings.clusterSize, glm::max(glm::max(bmax.x - bmin.x, bmax.y - bmin.y), bmax.z - bmin.z) / 65535.0f);
+    if (cell <= 0.0f) cell = 1.0f;
+
+    struct Cluster
+    {
+        glm::vec3 position;
+        glm::vec2 uv;
+        uint32_t count;
+        uint32_t index; // in output, UINT32_MAX - not used by any triangle.
+    };
+    std::vector<Cluster> clusters = std::vector<Cluster>();
+    std::unordered_map<uint64_t, uint32_t> clustersByKey = std::unordered_map<uint64_t, uint32_t>();
+
+    std::vector<uint32_t> triangles = std::vector<uint32_t>(); // cluster indices.
+    for (Source &s : sources)
+    {
+        UCMESHData *m = s.mesh;
+        if (m->uvs.size() != m->vertices.size()) continue;
+
+        // mirroring transform flips winding.
+        bool flip = glm::determinant(glm::mat3(s.transform)) < 0.0f;
+        glm::vec2 tileorigin = glm::vec2((s.tile % cols) * step + settings.padding, (s.tile / cols) * step + settings.padding);
+
+        for (size_t t = 0; t + 2 < m->indices.size(); t += 3)
+        {
+            stats.sourceTrianglesCount++;
+
+            uint32_t corners[3] = { m->indices[t], m->indices[t + 1], m->indices[t + 2] };
+            if (flip) std::swap(corners[1], corners[2]);
+
+            glm::vec2 shift = glm::floor(glm::min(glm::min(m->uvs[corners[0]], m->uvs[corners[1]]), m->uvs[corners[2]]));
+
+            uint32_t c[3];
+            for (int k = 0; k < 3; k++)
+            {
+                glm::vec3 p = glm::vec3(s.transform * glm::vec4(m->vertices[corners[k]], 1.0f));
+                glm::vec2 uv = tiles[s.tile].texture ? glm::clamp(m->uvs[corners[k]] - shift, 0.0f, 1.0f) : glm::vec2(0.5f);
+                uv = (tileorigin + uv * (float)tilesize) / atlassize;
+
+                glm::uvec3 g = glm::uvec3(glm::min((p - bmin) / cell, glm::vec3(65535.0f)));
+                uint64_t key = ((uint64_t)g.x << 48) | ((uint64_t)g.y << 32) | ((uint64_t)g.z << 16) | s.tile;
+
+                std::unordered_map<uint64_t, uint32_t>::iterator it = clustersByKey.find(key);
+                if (it == clustersByKey.end())
+                {
+                    it = clustersByKey.emplace(key, clusters.size()).first;
+                    clusters.push_back({ glm::vec3(0.0f), glm::vec2(0.0f), 0, UINT32_MAX });
+                }
+
+                Cluster *cl = &clusters[it->second];
+                cl->position += p;
+                cl->uv += uv;
+                cl->count++;
+                c[k] = it->second;
+            }
+
+            if (c[0] == c[1] || c[1] == c[2] || c[0] == c[2]) continue;
+            triangles.insert(triangles.end(), { c[0], c[1], c[2] });
+        }
+    }
+
+    // ===== OUTPUT =====
+
+    mesh->Clear();
+    std::unordered_set<uint64_t> seen = std::unordered_set<uint64_t>();
+    for (size_t t = 0; t < triangles.size(); t += 3)
+    {
+        // same triangle from overlapping sources is kept once, rotation keeps winding (two sided walls stay two sided).
+        uint32_t *tri = &triangles[t];
+        int first = tri[0] < tri[1] ? (tri[0] < tri[2] ? 0 : 2) : (tri[1] < tri[2] ? 1 : 2);
+        uint32_t ordered[3] = { tri[first], tri[(first + 1) % 3], tri[(first + 2) % 3] };
+        if (!seen.insert(Utils::hash64(ordered, sizeof(ordered))).second) continue;
+
+        for (int k = 0; k < 3; k++)
+        {
+            Cluster *cl = &clusters[tri[k]];
+            if (cl->index == UINT32_MAX)
+            {
+                cl->index = mesh->vertices.size();
+                mesh->vertices.push_back(cl->position / (float)cl->count);
+                mesh->uvs.push_back(cl->uv / (float)cl->count);
+            }
+            mesh->indices.push_back(cl->index);
+        }
+    }
+
+    stats.proxyTrianglesCount = mesh->GetTrianglesCount();
+    stats.proxyVerticesCount = mesh->vertices.size();
+    stats.tilesCount = tiles.size();
+    stats.tileSize = tilesize;
+    stats.atlasWidth = atlas->GetWidth();
+    stats.atlasHeight = atlas->GetHeight();
+    return true;
+}
+
+void HLODBuilder::Clear()
+{
+    tiles.clear();
+    sources.clear();
+    stats = HLODStats();
+}
@@ -0,0 +1,77 @@
+#ifndef HLODBUILDER_HPP
+#define HLODBUILDER_HPP
+
+#include <vector>
+#include <cstdint>
+
+#include "../glm.hpp"
+#include "../formats/UCMESHData.hpp"
+#include "../formats/UCTEXImage.hpp"
+
+struct
+{
+    float clusterSize; // vertices in the same grid cell of that size are merged into one.
+    uint32_t tileSize; // every (texture, color) pair is resampled into tileSize x tileSize tile of atlas.
+    uint32_t maxAtlasSize; // tiles are shrunk until atlas fits.
+    uint32_t padding; // edge pixels repeated around every tile, so filtering and mips don't bleed neighbours in.
+} typedef HLODSettings;
+
+struct
+{
+    size_t sourceTrianglesCount;
+    size_t proxyTrianglesCount;
+    size_t proxyVerticesCount;
+    unsigned int tilesCount;
+    uint32_t tileSize; // after shrinking.
+    uint32_t atlasWidth, atlasHeight;
+} typedef HLODStats;
+
+/*
+    Merges surfaces of a region into single proxy mesh with baked atlas texture, so far away region is one draw.
+
+    Geometry is simplified by vertex clustering (uniform grid, representative vertex is average of cluster),
+    triangles that collapse are dropped. It's crude, but proxies are only seen from far away and it's fast
+    and robust for any input (non-manifold, disjoint parts etc.).
+
+    Tiling UVs can't be kept in atlas, so UVs of every triangle are shifted into [0; 1] and clamped.
+*/
+class HLODBuilder
+{
+  private:
+    struct Tile
+    {
+        UCTEXImage *texture; // nullptr - solid color.
+        glm::vec4 color;
+    };
+
+    struct Source
+    {
+        UCMESHData *mesh;
+        glm::mat4 transform;
+        uint32_t tile;
+    };
+
+    std::vector<Tile> tiles = std::vector<Tile>();
+    std::vector<Source> sources = std::vector<Source>();
+    HLODStats stats = HLODStats();
+
+    uint32_t gettile(UCTEXImage *texture, glm::vec4 color);
+    void baketile(Tile *tile, UCTEXImage *atlas, uint32_t x, uint32_t y, uint32_t size, uint32_t padding);
+
+  public:
+    HLODBuilder() {}
+
+    static HLODSettings GetDefaultSettings();
+
+    // mesh and texture (nullptr - untextured) must stay alive until Build(). color is entity color * surface color.
+    void AddSurface(UCMESHData *mesh, glm::mat4 transform, UCTEXImage *texture, glm::vec4 color);
+    inline size_t GetSurfacesCount() { return sources.size(); }
+
+    // proxy mesh is in the space surfaces were transformed to.
+    bool Build(HLODSettings settings, UCMESHData *mesh, UCTEXImage *atlas);
+    void Clear();
+
+    inline HLODStats GetStats() { return stats; }
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include "MeshCooker.hpp"
+
+#include "MeshSimplifier.hpp"
+
+// === PUBLIC ===
+
+MeshCookSettings MeshCooker::GetDefaultSettings()
+{
+    MeshCookSettings s = MeshCookSettings();
+    s.lods = false;
+    s.optimize = true;
+    s.quantize = false;
+    return s;
+}
+
+bool MeshCooker::CookOBJFile(std::string input, std::string output, MeshCookSettings settings, MeshCookStats *stats, std::string *error)
+{
+    OBJReader reader = OBJReader();
+    UCMESHData mesh = UCMESHData();
+    if (!reader.ReadOBJFile(input, &mesh))
+    {
+        *error = "can't read file";
+        return false;
+    }
+
+    if (stats)
+    {
+        stats->obj = reader.GetStats();
+        stats->verticesCount = mesh.vertices.size();
+        stats->trianglesCount = mesh.GetTrianglesCount();
+    }
+
+    if (mesh.indices.empty())
+    {
+        *error = "no faces";
+        return false;
+    }
+
+    if (settings.lods)
+    {
+        MeshSimplifier::GenerateLODs(&mesh, MeshSimplifier::GetDefaultLODSettings());
+        if (stats) for (UCMESHLOD &lod : mesh.lods) stats->lodsTrianglesCount.push_back(lod.indices.size() / 3);
+    }
+
+    if (stats) stats->before = MeshOptimizer::AnalyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+    if (settings.optimize) MeshOptimizer::Optimize(&mesh);
+    if (stats) stats->after = MeshOptimizer::AnalyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+    if (settings.quantize) mesh.Quantize();
+
+    if (!mesh.SaveToUCMESHFile(output))
+    {
+        *error = "can't write \"" + output + "\"";
+        return false;
+    }
+    return true;
+}
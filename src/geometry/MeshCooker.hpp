@@ -0,0 +1,38 @@
+#ifndef MESHCOOKER_HPP
+#define MESHCOOKER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "../formats/OBJReader.hpp"
+#include "../formats/UCMESHData.hpp"
+#include "MeshOptimizer.hpp"
+
+struct
+{
+    bool lods; // LOD chain (see MeshSimplifier), file becomes UCMESH version 1.
+    bool optimize; // vertex cache, overdraw and vertex fetch order (see MeshOptimizer).
+    bool quantize; // 16-bit streams, file becomes UCMESH version 2.
+} typedef MeshCookSettings;
+
+struct
+{
+    OBJReadStats obj;
+    size_t verticesCount, trianglesCount; // as read.
+    std::vector<size_t> lodsTrianglesCount;
+    VertexCacheStats before, after; // of base level, before and after optimization.
+} typedef MeshCookStats;
+
+// OBJ -> UCMESH pipeline shared by obj2ucmesh and assetcooker, so both write the same file for the same settings.
+class MeshCooker
+{
+  public:
+    static MeshCookSettings GetDefaultSettings();
+
+    // stats is optional (vertex cache is analyzed only when it's given), error is set on failure.
+    static bool CookOBJFile(std::string input, std::string output, MeshCookSettings settings, MeshCookStats *stats, std::string *error);
+};
+
+#endif
@@ -0,0 +1,307 @@
+#include "MeshOptimizer.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+
+// === PRIVATE ===
+
+#define FORSYTH_CACHE_SIZE 32 // simulated LRU cache, bigger than real one is fine.
+#define FORSYTH_MAX_VALENCE 32 // valence scores above it are computed instead of looked up.
+
+struct
+{
+    float cache[FORSYTH_CACHE_SIZE];
+    float valence[FORSYTH_MAX_VALENCE + 1];
+} typedef ForsythScores;
+
+static ForsythScores forsythscores()
+{
+    ForsythScores s;
+    for (int i = 0; i < FORSYTH_CACHE_SIZE; i++)
+        s.cache[i] = i < 3 ? 0.75f : powf(1.0f - (i - 3) / (float)(FORSYTH_CACHE_SIZE - 3), 1.5f); // last triangle is scored lower to avoid strips.
+    s.valence[0] = 0.0f;
+    for (int i = 1; i <= FORSYTH_MAX_VALENCE; i++) s.valence[i] = 2.0f / sqrtf((float)i);
+    return s;
+}
+
+// vertex without remaining triangles doesn't matter.
+static inline float vertexscore(const ForsythScores &s, int cache_position, uint32_t valence)
+{
+    if (valence == 0) return -1.0f;
+    float score = valence <= FORSYTH_MAX_VALENCE ? s.valence[valence] : 2.0f / sqrtf((float)valence);
+    return cache_position >= 0 ? score + s.cache[cache_position] : score;
+}
+
+// FIFO cache, vertex is in it if it was loaded less than cache_size misses ago. Returns misses of triangle.
+static inline unsigned int simulatecache(const uint32_t *triangle, std::vector<uint32_t> *timestamps, uint32_t *time, unsigned int cache_size)
+{
+    unsigned int misses = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        uint32_t &stamp = (*timestamps)[triangle[i]];
+        if (*time - stamp > cache_size)
+        {
+            stamp = (*time)++;
+            misses++;
+        }
+    }
+    return misses;
+}
+
+static inline void flushcache(uint32_t *time, unsigned int cache_size) { *time += cache_size + 1; }
+
+// === PUBLIC ===
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t *indices, size_t indices_count, size_t vertices_count, unsigned int cache_size)
+{
+    VertexCacheStats stats = { 0.0f, 0.0f };
+    size_t triangles_count = indices_count / 3;
+    if (triangles_count == 0) return stats;
+
+    std::vector<uint32_t> timestamps = std::vector<uint32_t>(vertices_count, 0);
+    std::vector<bool> used = std::vector<bool>(vertices_count, false);
+    uint32_t time = cache_size + 1;
+    size_t misses = 0, unique = 0;
+    for (size_t t = 0; t < triangles_count; t++)
+    {
+        misses += simulatecache(indices + t * 3, &timestamps, &time, cache_size);
+        for (int i = 0; i < 3; i++)
+            if (!used[indices[t * 3 + i]]) { used[indices[t * 3 + i]] = true; unique++; }
+    }
+
+    stats.acmr = (float)misses / triangles_count;
+    stats.atvr = (float)misses / unique;
+    return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t *indices, size_t indices_count, size_t vertices_count)
+{
+    size_t triangles_count = indices_count / 3;
+    if (triangles_count == 0) return;
+
+    ForsythScores scores = forsythscores();
+
+    // triangles of every vertex, remaining ones are first valence[v] of its list.
+    std::vector<uint32_t> valence = std::vector<uint32_t>(vertices_count, 0);
+    for (size_t i = 0; i < triangles_count * 3; i++) valence[indices[i]]++;
+
+    std::vector<uint32_t> offsets = std::vector<uint32_t>(vertices_count + 1, 0);
+    for (size_t v = 0; v < vertices_count; v++) offsets[v + 1] = offsets[v] + valence[v];
+
+    std::vector<uint32_t> adjacency = std::vector<uint32_t>(triangles_count * 3);
+    std::vector<uint32_t> fill = std::vector<uint32_t>(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < triangles_count * 3; i++) adjacency[fill[indices[i]]++] = i / 3;
+
+    std::vector<int> cachepos = std::vector<int>(vertices_count, -1);
+    std::vector<float> vscore = std::vector<float>(vertices_count);
+    for (size_t v = 0; v < vertices_count; v++) vscore[v] = vertexscore(scores, -1, valence[v]);
+
+    std::vector<float> tscore = std::vector<float>(triangles_count);
+    std::vector<bool> emitted = std::vector<bool>(triangles_count, false);
+    int64_t best = 0;
+    for (size_t t = 0; t < triangles_count; t++)
+    {
+        const uint32_t *tri = indices + t * 3;
+        tscore[t] = vscore[tri[0]] + vscore[tri[1]] + vscore[tri[2]];
+        if (tscore[t] > tscore[best]) best = t;
+    }
+
+    std::vector<uint32_t> out = std::vector<uint32_t>();
+    out.reserve(triangles_count * 3);
+
+    uint32_t cache[FORSYTH_CACHE_SIZE + 3], newcache[FORSYTH_CACHE_SIZE + 3];
+    size_t cachecount = 0;
+    size_t cursor = 0; // dead end continues with the next triangle in input order.
+
+    for (size_t n = 0; n < triangles_count; n++)
+    {
+        if (best < 0)
+        {
+            while (emitted[cursor]) cursor++;
+            best = cursor;
+        }
+
+        const uint32_t *tri = indices + best * 3;
+        emitted[best] = true;
+        out.insert(out.end(), { tri[0], tri[1], tri[2] });
+
+        for (int i = 0; i < 3; i++)
+        {
+            uint32_t v = tri[i];
+            uint32_t *list = adjacency.data() + offsets[v];
+            for (uint32_t k = 0; k < valence[v]; k++)
+            {
+                if (list[k] != best) continue;
+                std::swap(list[k], list[valence[v] - 1]);
+                valence[v]--;
+                break;
+            }
+        }
+
+        // LRU: triangle's vertices go to front, the rest is shifted, ones past cache size fall out.
+        size_t newcount = 0;
+        for (int i = 0; i < 3; i++)
+            if (std::find(newcache, newcache + newcount, tri[i]) == newcache + newcount) newcache[newcount++] = tri[i];
+        for (size_t i = 0; i < cachecount; i++)
+            if (cache[i] != tri[0] && cache[i] != tri[1] && cache[i] != tri[2]) newcache[newcount++] = cache[i];
+
+        for (size_t i = 0; i < newcount; i++)
+        {
+            uint32_t v = newcache[i];
+            cachepos[v] = i < FORSYTH_CACHE_SIZE ? (int)i : -1;
+            vscore[v] = vertexscore(scores, cachepos[v], valence[v]);
+        }
+
+        // only triangles of touched vertices change score, best of them goes next.
+        best = -1;
+        float bestscore = -1.0f;
+        for (size_t i = 0; i < newcount; i++)
+        {
+            uint32_t v = newcache[i];
+            for (uint32_t k = 0; k < valence[v]; k++)
+            {
+                uint32_t t = adjacency[offsets[v] + k];
+                const uint32_t *ttri = indices + t * 3;
+                tscore[t] = vscore[ttri[0]] + vscore[ttri[1]] + vscore[ttri[2]];
+                if (tscore[t] > bestscore) { bestscore = tscore[t]; best = t; }
+            }
+        }
+
+        cachecount = std::min<size_t>(newcount, FORSYTH_CACHE_SIZE);
+        std::copy(newcache, newcache + cachecount, cache);
+    }
+
+    std::copy(out.begin(), out.end(), indices);
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t *indices, size_t indices_count, const glm::vec3 *positions, size_t vertices_count, float threshold)
+{
+    size_t triangles_count = indices_count / 3;
+    if (triangles_count < 2) return;
+
+    const unsigned int cache_size = MESHOPTIMIZER_ANALYZE_CACHE_SIZE;
+    std::vector<uint32_t> timestamps = std::vector<uint32_t>(vertices_count, 0);
+    uint32_t time = cache_size + 1;
+
+    // hard boundaries: triangles that miss all vertices, cutting there costs nothing.
+    std::vector<size_t> hard = std::vector<size_t>();
+    for (size_t t = 0; t < triangles_count; t++)
+        if (simulatecache(indices + t * 3, &timestamps, &time, cache_size) == 3) hard.push_back(t);
+    hard.push_back(triangles_count);
+
+    // soft boundaries: cluster is cut as soon as its ACMR (with cache flushed at start) is within threshold of whole hard cluster's.
+    std::vector<size_t> clusters = std::vector<size_t>();
+    for (size_t h = 0; h + 1 < hard.size(); h++)
+    {
+        size_t start = hard[h], end = hard[h + 1];
+
+        flushcache(&time, cache_size);
+        size_t misses = 0;
+        for (size_t t = start; t < end; t++) misses += simulatecache(indices + t * 3, &timestamps, &time, cache_size);
+        float limit = threshold * misses / (end - start);
+
+        flushcache(&time, cache_size);
+        size_t begin = start, running = 0;
+        clusters.push_back(start);
+        for (size_t t = start; t + 1 < end; t++)
+        {
+            running += simulatecache(indices + t * 3, &timestamps, &time, cache_size);
+            if (running <= limit * (t + 1 - begin))
+            {
+                begin = t + 1;
+                running = 0;
+                clusters.push_back(begin);
+                flushcache(&time, cache_size);
+            }
+        }
+    }
+    clusters.push_back(triangles_count);
+
+    // area weighted centroids and normals.
+    size_t clusters_count = clusters.size() - 1;
+    std::vector<glm::vec3> centroids = std::vector<glm::vec3>(clusters_count, glm::vec3(0.0f));
+    std::vector<glm::vec3> normals = std::vector<glm::vec3>(clusters_count, glm::vec3(0.0f));
+    std::vector<float> areas = std::vector<float>(clusters_count, 0.0f);
+    glm::vec3 center = glm::vec3(0.0f);
+    float total = 0.0f;
+    for (size_t c = 0; c < clusters_count; c++)
+    {
+        for (size_t t = clusters[c]; t < clusters[c + 1]; t++)
+        {
+            glm::vec3 a = positions[indices[t * 3]], b = positions[indices[t * 3 + 1]], d = positions[indices[t * 3 + 2]];
+            glm::vec3 n = glm::cross(b - a, d - a);
+            float area = glm::length(n);
+            centroids[c] += (a + b + d) * (area / 3.0f);
+            normals[c] += n;
+            areas[c] += area;
+        }
+        center += centroids[c];
+        total += areas[c];
+        if (areas[c] > 0.0f) centroids[c] /= areas[c];
+    }
+    if (total > 0.0f) center /= total;
+
+    std::vector<float> keys = std::vector<float>(clusters_count, 0.0f);
+    for (size_t c = 0; c < clusters_count; c++)
+    {
+        float length = glm::length(normals[c]);
+        if (length > 0.0f) keys[c] = glm::dot(centroids[c] - center, normals[c] / length);
+    }
+
+    std::vector<size_t> order = std::vector<size_t>(clusters_count);
+    for (size_t c = 0; c < clusters_count; c++) order[c] = c;
+    std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] > keys[b]; });
+
+    std::vector<uint32_t> out = std::vector<uint32_t>();
+    out.reserve(triangles_count * 3);
+    for (size_t c : order) out.insert(out.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+    std::copy(out.begin(), out.end(), indices);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(UCMESHData *mesh)
+{
+    if (mesh->uvs.size() != mesh->vertices.size()) return;
+
+    std::vector<uint32_t> remap = std::vector<uint32_t>(mesh->vertices.size(), UINT32_MAX);
+    uint32_t next = 0;
+    for (uint32_t &i : mesh->indices) { if (remap[i] == UINT32_MAX) remap[i] = next++; i = remap[i]; }
+    for (UCMESHLOD &lod : mesh->lods)
+        for (uint32_t &i : lod.indices) { if (remap[i] == UINT32_MAX) remap[i] = next++; i = remap[i]; }
+
+    std::vector<glm::vec3> vertices = std::vector<glm::vec3>(next);
+    std::vector<glm::vec2> uvs = std::vector<glm::vec2>(next);
+    for (size_t v = 0; v < remap.size(); v++)
+    {
+        if (remap[v] == UINT32_MAX) continue;
+        vertices[remap[v]] = mesh->vertices[v];
+        uvs[remap[v]] = mesh->uvs[v];
+    }
+    mesh->vertices = std::move(vertices);
+    mesh->uvs = std::move(uvs);
+
+    if (!mesh->IsQuantized()) return;
+    std::vector<uint16_t> positions = std::vector<uint16_t>((size_t)next * 4);
+    std::vector<uint16_t> quvs = std::vector<uint16_t>((size_t)next * 2);
+    for (size_t v = 0; v < remap.size(); v++)
+    {
+        if (remap[v] == UINT32_MAX) continue;
+        memcpy(&positions[(size_t)remap[v] * 4], &mesh->quantizedPositions[v * 4], sizeof(uint16_t) * 4);
+        memcpy(&quvs[(size_t)remap[v] * 2], &mesh->quantizedUVs[v * 2], sizeof(uint16_t) * 2);
+    }
+    mesh->quantizedPositions = std::move(positions);
+    mesh->quantizedUVs = std::move(quvs);
+}
+
+void MeshOptimizer::Optimize(UCMESHData *mesh)
+{
+    size_t count = mesh->vertices.size();
+    OptimizeVertexCache(mesh->indices.data(), mesh->indices.size(), count);
+    OptimizeOverdraw(mesh->indices.data(), mesh->indices.size(), mesh->vertices.data(), count);
+    for (UCMESHLOD &lod : mesh->lods)
+    {
+        OptimizeVertexCache(lod.indices.data(), lod.indices.size(), count);
+        OptimizeOverdraw(lod.indices.data(), lod.indices.size(), mesh->vertices.data(), count);
+    }
+    OptimizeVertexFetch(mesh);
+}
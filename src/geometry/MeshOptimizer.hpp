@@ -0,0 +1,42 @@
+#ifndef MESHOPTIMIZER_HPP
+#define MESHOPTIMIZER_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "../glm.hpp"
+#include "../formats/UCMESHData.hpp"
+
+#define MESHOPTIMIZER_ANALYZE_CACHE_SIZE 16 // FIFO post-transform cache of typical GPU.
+
+struct
+{
+    float acmr; // average cache miss ratio: transformed vertices per triangle, 0.5 is ideal for regular grid, 3 is worst.
+    float atvr; // average transform to vertex ratio: transformed vertices per referenced one, 1 is ideal.
+} typedef VertexCacheStats;
+
+/*
+    Offline passes over triangle lists, applied in this order:
+        vertex cache - Forsyth's "linear-speed vertex cache optimisation" (greedy by LRU position and remaining valence),
+        overdraw - cache optimized list is cut into clusters at cache restarts, clusters are sorted so ones that face
+            away from mesh center (outer surfaces, likely occluders) are drawn first,
+        vertex fetch - vertices are renumbered in order of first use, so vertex buffer is read sequentially.
+*/
+class MeshOptimizer
+{
+  public:
+    static VertexCacheStats AnalyzeVertexCache(const uint32_t *indices, size_t indices_count, size_t vertices_count,
+        unsigned int cache_size = MESHOPTIMIZER_ANALYZE_CACHE_SIZE);
+
+    static void OptimizeVertexCache(uint32_t *indices, size_t indices_count, size_t vertices_count);
+    // indices must be cache optimized, threshold is allowed ACMR growth (1.05 - 5%) for finer clusters.
+    static void OptimizeOverdraw(uint32_t *indices, size_t indices_count, const glm::vec3 *positions, size_t vertices_count, float threshold = 1.05f);
+    // reorders vertices and UVs (and quantized streams) and remaps indices of mesh and its LODs, unused vertices are dropped.
+    static void OptimizeVertexFetch(UCMESHData *mesh);
+
+    // all passes over mesh and its LODs.
+    static void Optimize(UCMESHData *mesh);
+};
+
+#endif
@@ -0,0 +1,380 @@
+#include "MeshSimplifier.hpp"
+
+#include <unordered_map>
+#include <queue>
+#include <algorithm>
+#include <cmath>
+
+#include "../utils.hpp"
+
+// === PRIVATE ===
+
+#define BORDER_WEIGHT 10.0
+
+// plane quadric sum: error(p) = p^T A p + 2 b.p + c, w is total weight (so error / w is mean squared distance).
+struct
+{
+    double a00, a01, a02, a11, a12, a22;
+    double b0, b1, b2;
+    double c;
+    double w;
+} typedef Quadric;
+
+static Quadric planequadric(glm::dvec3 n, double d, double w)
+{
+    return { w * n.x * n.x, w * n.x * n.y, w * n.x * n.z, w * n.y * n.y, w * n.y * n.z, w * n.z * n.z,
+        w * n.x * d, w * n.y * d, w * n.z * d, w * d * d, w };
+}
+
+static void addquadric(Quadric *q, const Quadric *o)
+{
+    q->a00 += o->a00; q->a01 += o->a01; q->a02 += o->a02;
+    q->a11 += o->a11; q->a12 += o->a12; q->a22 += o->a22;
+    q->b0 += o->b0; q->b1 += o->b1; q->b2 += o->b2;
+    q->c += o->c;
+    q->w += o->w;
+}
+
+static double evaluatequadric(const Quadric *q, glm::dvec3 p)
+{
+    double e = q->a00 * p.x * p.x + q->a11 * p.y * p.y + q->a22 * p.z * p.z
+        + 2.0 * (q->a01 * p.x * p.y + q->a02 * p.x * p.z + q->a12 * p.y * p.z)
+        + 2.0 * (q->b0 * p.x + q->b1 * p.y + q->b2 * p.z) + q->c;
+    return q->w > 0.0 ? std::max(e / q->w, 0.0) : 0.0;
+}
+
+struct PositionHash
+{
+    // +0.0f makes -0 and 0 equal, as operator== does.
+    size_t operator()(glm::vec3 v) const { v += glm::vec3(0.0f); return Utils::hash64(&v, sizeof(v)); }
+};
+
+struct
+{
+    float cost; // squared error.
+    uint32_t from, to;
+    uint32_t fromVersion, toVersion;
+} typedef Collapse;
+
+struct CollapseOrder
+{
+    bool operator()(const Collapse &a, const Collapse &b) const { return a.cost > b.cost; }
+};
+
+enum
+{
+    POSITION_BORDER = 1 << 0,
+    POSITION_LOCKED = 1 << 1, // non-manifold.
+    POSITION_REMOVED = 1 << 2
+};
+
+// topology is built over positions (id of position is its first vertex), triangles keep vertex indices.
+struct Simplification
+{
+    const glm::vec3 *positions;
+    std::vector<uint32_t> position; // vertex -> position id.
+    std::vector<uint32_t> triangles;
+    std::vector<uint8_t> alive;
+    size_t aliveCount = 0;
+
+    std::vector<std::vector<uint32_t>> trianglesOf; // by position id, may contain dead triangles.
+    std::vector<Quadric> quadrics;
+    std::vector<uint8_t> flags;
+    std::vector<uint32_t> versions;
+    std::priority_queue<Collapse, std::vector<Collapse>, CollapseOrder> queue;
+
+    std::vector<std::pair<uint32_t, uint32_t>> mapping; // scratch: wedge of removed position -> wedge of kept one.
+    std::vector<uint32_t> neighboursA, neighboursB;
+
+    inline glm::dvec3 pos(uint32_t p) { return glm::dvec3(positions[p]); }
+
+    void neighbours(uint32_t p, std::vector<uint32_t> *out)
+    {
+        out->clear();
+        for (uint32_t t : trianglesOf[p])
+        {
+            if (!alive[t]) continue;
+            for (int k = 0; k < 3; k++)
+                if (position[triangles[t * 3 + k]] != p) out->push_back(position[triangles[t * 3 + k]]);
+        }
+        std::sort(out->begin(), out->end());
+        out->erase(std::unique(out->begin(), out->end()), out->end());
+    }
+
+    void push(uint32_t from, uint32_t to)
+    {
+        Quadric q = quadrics[from];
+        addquadric(&q, &quadrics[to]);
+        queue.push({ (float)evaluatequadric(&q, pos(to)), from, to, versions[from], versions[to] });
+    }
+
+    bool cancollapse(uint32_t a, uint32_t b)
+    {
+        if (flags[a] & POSITION_LOCKED) return false;
+
+        unsigned int edgetriangles = 0;
+        mapping.clear();
+        for (uint32_t t : trianglesOf[a])
+        {
+            if (!alive[t]) continue;
+
+            uint32_t wa = UINT32_MAX, wb = UINT32_MAX;
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t v = triangles[t * 3 + k];
+                if (position[v] == a) wa = v;
+                else if (position[v] == b) wb = v;
+            }
+            if (wb != UINT32_MAX) edgetriangles++;
+
+            // every wedge of a must go to exactly one wedge of b, otherwise collapse crosses UV seam.
+            bool found = false;
+            for (std::pair<uint32_t, uint32_t> &m : mapping)
+            {
+                if (m.first != wa) continue;
+                found = true;
+                if (wb == UINT32_MAX) break;
+                if (m.second == UINT32_MAX) m.second = wb;
+                else if (m.second != wb) return false;
+            }
+            if (!found) mapping.push_back({ wa, wb });
+        }
+
+        if (edgetriangles == 0) return false;
+        if ((flags[a] & POSITION_BORDER) ? edgetriangles != 1 : edgetriangles != 2) return false;
+        for (std::pair<uint32_t, uint32_t> &m : mapping) if (m.second == UINT32_MAX) return false;
+
+        // link condition: shared neighbours are only opposite vertices of edge's triangles, else surface pinches.
+        neighbours(a, &neighboursA);
+        neighbours(b, &neighboursB);
+        unsigned int shared = 0;
+        for (size_t i = 0, j = 0; i < neighboursA.size() && j < neighboursB.size();)
+        {
+            if (neighboursA[i] < neighboursB[j]) i++;
+            else if (neighboursA[i] > neighboursB[j]) j++;
+            else { shared++; i++; j++; }
+        }
+        if (shared > edgetriangles) return false;
+
+        // no triangle may flip.
+        for (uint32_t t : trianglesOf[a])
+        {
+            if (!alive[t]) continue;
+
+            glm::dvec3 p[3], q[3];
+            bool hasb = false;
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t pk = position[triangles[t * 3 + k]];
+                hasb |= pk == b;
+                p[k] = pos(pk);
+                q[k] = pk == a ? pos(b) : p[k];
+            }
+            if (hasb) continue;
+
+            glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+            glm::dvec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+            if (glm::dot(before, after) <= 0.0) return false;
+        }
+
+        return true;
+    }
+
+    void collapse(uint32_t a, uint32_t b)
+    {
+        for (uint32_t t : trianglesOf[a])
+        {
+            if (!alive[t]) continue;
+
+            bool hasb = false;
+            for (int k = 0; k < 3; k++) hasb |= position[triangles[t * 3 + k]] == b;
+            if (hasb)
+            {
+                alive[t] = false;
+                aliveCount--;
+                continue;
+            }
+
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t *v = &triangles[t * 3 + k];
+                if (position[*v] != a) continue;
+                for (std::pair<uint32_t, uint32_t> &m : mapping) if (m.first == *v) { *v = m.second; break; }
+            }
+            trianglesOf[b].push_back(t);
+        }
+        trianglesOf[a] = std::vector<uint32_t>();
+
+        std::vector<uint32_t> *tb = &trianglesOf[b];
+        tb->erase(std::remove_if(tb->begin(), tb->end(), [this](uint32_t t) { return !alive[t]; }), tb->end());
+
+        addquadric(&quadrics[b], &quadrics[a]);
+        flags[a] |= POSITION_REMOVED;
+        versions[b]++;
+    }
+};
+
+// === PUBLIC ===
+
+MeshLODSettings MeshSimplifier::GetDefaultLODSettings()
+{
+    MeshLODSettings s = MeshLODSettings();
+    s.maxLODsCount = 4;
+    s.ratio = 0.5f;
+    s.maxError = 0.05f;
+    s.minTrianglesCount = 32;
+    return s;
+}
+
+float MeshSimplifier::Simplify(const glm::vec3 *positions, size_t vertices_count, const uint32_t *indices, size_t indices_count,
+    size_t target_indices_count, float target_error, std::vector<uint32_t> *out)
+{
+    out->assign(indices, indices + indices_count - indices_count % 3);
+    if (out->size() <= target_indices_count || vertices_count == 0) return 0.0f;
+
+    Simplification s = Simplification();
+    s.positions = positions;
+    s.triangles = *out;
+
+    size_t trianglescount = s.triangles.size() / 3;
+    s.position.resize(vertices_count);
+    {
+        std::unordered_map<glm::vec3, uint32_t, PositionHash> ids = std::unordered_map<glm::vec3, uint32_t, PositionHash>();
+        ids.reserve(vertices_count);
+        for (uint32_t v = 0; v < vertices_count; v++) s.position[v] = ids.emplace(positions[v], v).first->second;
+    }
+
+    s.alive.assign(trianglescount, 1);
+    s.trianglesOf.resize(vertices_count);
+    s.quadrics.assign(vertices_count, Quadric());
+    s.flags.assign(vertices_count, 0);
+    s.versions.assign(vertices_count, 0);
+
+    std::unordered_map<uint64_t, uint32_t> edges = std::unordered_map<uint64_t, uint32_t>(); // position pair -> triangles count.
+    for (size_t t = 0; t < trianglescount; t++)
+    {
+        uint32_t p[3];
+        for (int k = 0; k < 3; k++)
+        {
+            if (s.triangles[t * 3 + k] >= vertices_count) return 0.0f;
+            p[k] = s.position[s.triangles[t * 3 + k]];
+        }
+        if (p[0] == p[1] || p[1] == p[2] || p[0] == p[2]) { s.alive[t] = false; continue; }
+
+        s.aliveCount++;
+        for (int k = 0; k < 3; k++)
+        {
+            s.trianglesOf[p[k]].push_back(t);
+            uint32_t e0 = std::min(p[k], p[(k + 1) % 3]), e1 = std::max(p[k], p[(k + 1) % 3]);
+            edges[((uint64_t)e0 << 32) | e1]++;
+        }
+
+        glm::dvec3 n = glm::cross(s.pos(p[1]) - s.pos(p[0]), s.pos(p[2]) - s.pos(p[0]));
+        double length = glm::length(n);
+        if (length <= 0.0) continue;
+
+        n /= length;
+        Quadric q = planequadric(n, -glm::dot(n, s.pos(p[0])), length * 0.5);
+        for (int k = 0; k < 3; k++) addquadric(&s.quadrics[p[k]], &q);
+    }
+
+    // borders keep their shape by planes perpendicular to the surface through border edges.
+    for (size_t t = 0; t < trianglescount; t++)
+    {
+        if (!s.alive[t]) continue;
+
+        uint32_t p[3];
+        for (int k = 0; k < 3; k++) p[k] = s.position[s.triangles[t * 3 + k]];
+        glm::dvec3 n = glm::cross(s.pos(p[1]) - s.pos(p[0]), s.pos(p[2]) - s.pos(p[0]));
+
+        for (int k = 0; k < 3; k++)
+        {
+            uint32_t a = p[k], b = p[(k + 1) % 3];
+            uint32_t count = edges[((uint64_t)std::min(a, b) << 32) | std::max(a, b)];
+            if (count > 2) { s.flags[a] |= POSITION_LOCKED; s.flags[b] |= POSITION_LOCKED; }
+            if (count != 1) continue;
+
+            s.flags[a] |= POSITION_BORDER;
+            s.flags[b] |= POSITION_BORDER;
+
+            glm::dvec3 edge = s.pos(b) - s.pos(a);
+            glm::dvec3 en = glm::cross(edge, n);
+            double length = glm::length(en);
+            if (length <= 0.0) continue;
+
+            en /= length;
+            Quadric q = planequadric(en, -glm::dot(en, s.pos(a)), glm::dot(edge, edge) * BORDER_WEIGHT);
+            addquadric(&s.quadrics[a], &q);
+            addquadric(&s.quadrics[b], &q);
+        }
+    }
+
+    std::vector<uint32_t> around = std::vector<uint32_t>();
+    for (uint32_t p = 0; p < vertices_count; p++)
+    {
+        if (s.position[p] != p || s.trianglesOf[p].empty()) continue;
+
+        s.neighbours(p, &around);
+        for (uint32_t n : around) s.push(p, n);
+    }
+
+    double maxcost = (double)target_error * target_error;
+    float error = 0.0f;
+    while (s.aliveCount * 3 > target_indices_count && !s.queue.empty())
+    {
+        Collapse c = s.queue.top();
+        s.queue.pop();
+
+        if ((s.flags[c.from] | s.flags[c.to]) & POSITION_REMOVED) continue;
+        if (s.versions[c.from] != c.fromVersion || s.versions[c.to] != c.toVersion) continue;
+        if (c.cost > maxcost) break;
+        if (!s.cancollapse(c.from, c.to)) continue;
+
+        s.collapse(c.from, c.to);
+        error = std::max(error, std::sqrt(c.cost));
+
+        // quadric of c.to changed, every its edge gets new cost.
+        s.neighbours(c.to, &around);
+        for (uint32_t n : around)
+        {
+            s.push(c.to, n);
+            s.push(n, c.to);
+        }
+    }
+
+    out->clear();
+    out->reserve(s.aliveCount * 3);
+    for (size_t t = 0; t < trianglescount; t++)
+        if (s.alive[t]) out->insert(out->end(), { s.triangles[t * 3], s.triangles[t * 3 + 1], s.triangles[t * 3 + 2] });
+
+    return error;
+}
+
+void MeshSimplifier::GenerateLODs(const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices, MeshLODSettings settings, std::vector<UCMESHLOD> *lods)
+{
+    lods->clear();
+    if (positions.empty() || indices.size() < 3) return;
+
+    glm::vec3 bmin = positions[0], bmax = positions[0];
+    for (glm::vec3 v : positions) { bmin = glm::min(bmin, v); bmax = glm::max(bmax, v); }
+    float radius = glm::length(bmax - bmin) * 0.5f;
+
+    // every LOD is made from full mesh, so its error is measured against it and not against previous LOD.
+    size_t previous = indices.size();
+    for (unsigned int i = 0; i < settings.maxLODsCount; i++)
+    {
+        size_t target = (size_t)(previous / 3 * settings.ratio) * 3;
+        if (target / 3 < settings.minTrianglesCount) break;
+
+        UCMESHLOD lod = UCMESHLOD();
+        lod.error = Simplify(positions.data(), positions.size(), indices.data(), indices.size(), target, settings.maxError * radius, &lod.indices);
+
+        // stuck on error limit or topology, next LODs won't be better.
+        if (lod.indices.size() > previous * 9 / 10) break;
+
+        previous = lod.indices.size();
+        lods->push_back(std::move(lod));
+    }
+}
+
+void MeshSimplifier::GenerateLODs(UCMESHData *mesh, MeshLODSettings settings) { GenerateLODs(mesh->vertices, mesh->indices, settings, &mesh->lods); }
@@ -0,0 +1,41 @@
+#ifndef MESHSIMPLIFIER_HPP
+#define MESHSIMPLIFIER_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "../glm.hpp"
+#include "../formats/UCMESHData.hpp"
+
+struct
+{
+    unsigned int maxLODsCount;
+    float ratio; // triangles of every next LOD relative to previous one.
+    float maxError; // relative to mesh radius, chain stops when LOD would be worse.
+    size_t minTrianglesCount; // chain stops when LOD would have less.
+} typedef MeshLODSettings;
+
+/*
+    Quadric error metric simplifier (Garland-Heckbert) with half-edge collapses: vertex is always moved into
+    its neighbour, so result uses subset of original vertices (LODs share vertex buffer and UVs stay exact).
+
+    Vertices with the same position (UV seams) are collapsed together only along the seam, so seams don't tear;
+    border edges are kept by extra quadrics and collapse only along the border; non-manifold vertices are locked.
+*/
+class MeshSimplifier
+{
+  public:
+    static MeshLODSettings GetDefaultLODSettings();
+
+    // writes triangle list with at most target_indices_count indices (unless that requires error above target_error,
+    // in mesh units) to out, returns reached error.
+    static float Simplify(const glm::vec3 *positions, size_t vertices_count, const uint32_t *indices, size_t indices_count,
+        size_t target_indices_count, float target_error, std::vector<uint32_t> *out);
+
+    // replaces mesh LODs with generated chain.
+    static void GenerateLODs(UCMESHData *mesh, MeshLODSettings settings);
+    static void GenerateLODs(const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices, MeshLODSettings settings, std::vector<UCMESHLOD> *lods);
+};
+
+#endif
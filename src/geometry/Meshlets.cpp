@@ -0,0 +1,278 @@
+#include "Meshlets.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MESHLETS_SSE
+#endif
+
+// === PRIVATE ===
+
+struct
+{
+    glm::vec3 boundsmin, boundsmax;
+    std::vector<uint32_t> triangles; // original numbers.
+    std::vector<uint32_t> vertices;
+} typedef BuildState;
+
+// the same id for vertices with equal positions.
+static std::vector<uint32_t> weldpositions(const glm::vec3 *positions, size_t vertices_count, uint32_t *ids_count)
+{
+    std::vector<uint32_t> order = std::vector<uint32_t>(vertices_count);
+    for (uint32_t i = 0; i < vertices_count; i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [positions](uint32_t a, uint32_t b)
+    {
+        const glm::vec3 &pa = positions[a], &pb = positions[b];
+        return pa.x != pb.x ? pa.x < pb.x : pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z;
+    });
+
+    std::vector<uint32_t> ids = std::vector<uint32_t>(vertices_count);
+    uint32_t next = 0;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        if (i > 0 && positions[order[i]] != positions[order[i - 1]]) next++;
+        ids[order[i]] = next;
+    }
+    *ids_count = vertices_count ? next + 1 : 0;
+    return ids;
+}
+
+static void computebounds(const glm::vec3 *positions, const uint32_t *indices, const BuildState *state, Meshlet *m)
+{
+    m->center = (state->boundsmin + state->boundsmax) * 0.5f;
+    float r2 = 0.0f;
+    for (uint32_t v : state->vertices)
+    {
+        glm::vec3 d = positions[v] - m->center;
+        r2 = std::max(r2, glm::dot(d, d));
+    }
+    m->radius = std::sqrt(r2);
+
+    std::vector<glm::vec3> normals = std::vector<glm::vec3>();
+    glm::vec3 sum = glm::vec3(0.0f);
+    for (uint32_t t : state->triangles)
+    {
+        glm::vec3 a = positions[indices[t * 3]], b = positions[indices[t * 3 + 1]], c = positions[indices[t * 3 + 2]];
+        glm::vec3 n = glm::cross(b - a, c - a);
+        float length = glm::length(n);
+        if (length <= 0.0f) continue;
+
+        normals.push_back(n / length);
+        sum += normals.back();
+    }
+
+    float sumlength = glm::length(sum);
+    m->coneAxis = sumlength > 0.0f ? sum / sumlength : glm::vec3(0.0f, 0.0f, 1.0f);
+    m->coneCutoff = 1.0f;
+    if (sumlength <= 0.0f) return;
+
+    float mindot = 1.0f;
+    for (glm::vec3 &n : normals) mindot = std::min(mindot, glm::dot(n, m->coneAxis));
+    // nearly half-sphere cones would cull almost nothing.
+    if (mindot > 0.1f) m->coneCutoff = std::sqrt(1.0f - mindot * mindot);
+}
+
+// === PUBLIC ===
+
+void MeshletBuilder::Build(const glm::vec3 *positions, size_t vertices_count, uint32_t *indices, size_t indices_count, std::vector<Meshlet> *meshlets,
+    unsigned int max_vertices, unsigned int max_triangles)
+{
+    meshlets->clear();
+    size_t triangles_count = indices_count / 3;
+    if (triangles_count == 0 || max_vertices < 3 || max_triangles < 1) return;
+
+    uint32_t ids_count;
+    std::vector<uint32_t> ids = weldpositions(positions, vertices_count, &ids_count);
+
+    // triangles around every position (CSR).
+    std::vector<uint32_t> adjoffsets = std::vector<uint32_t>(ids_count + 1, 0);
+    for (size_t i = 0; i < triangles_count * 3; i++) adjoffsets[ids[indices[i]] + 1]++;
+    for (uint32_t i = 0; i < ids_count; i++) adjoffsets[i + 1] += adjoffsets[i];
+    std::vector<uint32_t> adjacency = std::vector<uint32_t>(adjoffsets[ids_count]);
+    {
+        std::vector<uint32_t> fill = std::vector<uint32_t>(adjoffsets.begin(), adjoffsets.end() - 1);
+        for (size_t i = 0; i < triangles_count * 3; i++) adjacency[fill[ids[indices[i]]]++] = i / 3;
+    }
+
+    std::vector<uint8_t> used = std::vector<uint8_t>(triangles_count, 0);
+    std::vector<uint8_t> candidate = std::vector<uint8_t>(triangles_count, 0);
+    std::vector<uint8_t> inmeshlet = std::vector<uint8_t>(vertices_count, 0);
+    std::vector<uint32_t> candidates = std::vector<uint32_t>();
+    std::vector<uint32_t> order = std::vector<uint32_t>();
+    order.reserve(triangles_count);
+
+    BuildState state = BuildState();
+    size_t cursor = 0;
+    while (true)
+    {
+        while (cursor < triangles_count && used[cursor]) cursor++;
+        if (cursor >= triangles_count) break;
+
+        state.triangles.clear();
+        state.vertices.clear();
+        candidates.clear();
+
+        uint32_t next = cursor;
+        while (true)
+        {
+            used[next] = 1;
+            state.triangles.push_back(next);
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t v = indices[next * 3 + k];
+                if (!inmeshlet[v])
+                {
+                    inmeshlet[v] = 1;
+                    state.vertices.push_back(v);
+                    if (state.vertices.size() == 1) state.boundsmin = state.boundsmax = positions[v];
+                    state.boundsmin = glm::min(state.boundsmin, positions[v]);
+                    state.boundsmax = glm::max(state.boundsmax, positions[v]);
+                }
+
+                uint32_t id = ids[v];
+                for (uint32_t a = adjoffsets[id]; a < adjoffsets[id + 1]; a++)
+                {
+                    uint32_t t = adjacency[a];
+                    if (used[t] || candidate[t]) continue;
+                    candidate[t] = 1;
+                    candidates.push_back(t);
+                }
+            }
+            if (state.triangles.size() >= max_triangles) break;
+
+            // fewest new vertices first, then nearest to meshlet.
+            glm::vec3 center = (state.boundsmin + state.boundsmax) * 0.5f;
+            int64_t best = -1;
+            unsigned int bestextra = 4;
+            float bestdistance = 0.0f;
+            size_t kept = 0;
+            for (size_t c = 0; c < candidates.size(); c++)
+            {
+                uint32_t t = candidates[c];
+                if (used[t]) { candidate[t] = 0; continue; }
+                candidates[kept++] = t;
+
+                unsigned int extra = 0;
+                for (int k = 0; k < 3; k++) extra += !inmeshlet[indices[t * 3 + k]];
+                if (state.vertices.size() + extra > max_vertices || extra > bestextra) continue;
+
+                glm::vec3 d = (positions[indices[t * 3]] + positions[indices[t * 3 + 1]] + positions[indices[t * 3 + 2]]) / 3.0f - center;
+                float distance = glm::dot(d, d);
+                if (extra < bestextra || distance < bestdistance)
+                {
+                    best = t;
+                    bestextra = extra;
+                    bestdistance = distance;
+                }
+            }
+            candidates.resize(kept);
+
+            if (best < 0) break;
+            next = best;
+        }
+
+        for (uint32_t t : candidates) candidate[t] = 0;
+        for (uint32_t v : state.vertices) inmeshlet[v] = 0;
+
+        std::sort(state.triangles.begin(), state.triangles.end());
+
+        Meshlet m = Meshlet();
+        m.indexOffset = order.size() * 3;
+        m.trianglesCount = state.triangles.size();
+        m.verticesCount = state.vertices.size();
+        computebounds(positions, indices, &state, &m);
+        meshlets->push_back(m);
+
+        order.insert(order.end(), state.triangles.begin(), state.triangles.end());
+    }
+
+    std::vector<uint32_t> reordered = std::vector<uint32_t>(triangles_count * 3);
+    for (size_t i = 0; i < order.size(); i++)
+        for (int k = 0; k < 3; k++) reordered[i * 3 + k] = indices[order[i] * 3 + k];
+    std::copy(reordered.begin(), reordered.end(), indices);
+}
+
+void MeshletCuller::SetMeshlets(const Meshlet *meshlets, size_t count)
+{
+    for (std::vector<float> *stream : { &centerX, &centerY, &centerZ, &radius, &axisX, &axisY, &axisZ, &cutoff }) stream->resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const Meshlet &m = meshlets[i];
+        centerX[i] = m.center.x;
+        centerY[i] = m.center.y;
+        centerZ[i] = m.center.z;
+        radius[i] = m.radius;
+        axisX[i] = m.coneAxis.x;
+        axisY[i] = m.coneAxis.y;
+        axisZ[i] = m.coneAxis.z;
+        cutoff[i] = m.coneCutoff;
+    }
+}
+
+void MeshletCuller::Clear() { for (std::vector<float> *stream : { &centerX, &centerY, &centerZ, &radius, &axisX, &axisY, &axisZ, &cutoff }) stream->clear(); }
+
+void MeshletCuller::cullrange(size_t begin, size_t end, const glm::vec4 *planes, glm::vec3 camera, bool backfaces, uint8_t *visible) const
+{
+    size_t i = begin;
+
+#ifdef MESHLETS_SSE
+    __m128 camx = _mm_set1_ps(camera.x), camy = _mm_set1_ps(camera.y), camz = _mm_set1_ps(camera.z);
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 cx = _mm_loadu_ps(&centerX[i]), cy = _mm_loadu_ps(&centerY[i]), cz = _mm_loadu_ps(&centerZ[i]), r = _mm_loadu_ps(&radius[i]);
+
+        __m128 inside = _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps()); // all bits set.
+        for (int p = 0; p < 6; p++)
+        {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(planes[p].x)), _mm_mul_ps(cy, _mm_set1_ps(planes[p].y))),
+                _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(planes[p].z)), _mm_set1_ps(planes[p].w)));
+            inside = _mm_and_ps(inside, _mm_cmpgt_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+        }
+
+        if (backfaces)
+        {
+            __m128 dx = _mm_sub_ps(cx, camx), dy = _mm_sub_ps(cy, camy), dz = _mm_sub_ps(cz, camz);
+            __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+            __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(&axisX[i])), _mm_mul_ps(dy, _mm_loadu_ps(&axisY[i]))),
+                _mm_mul_ps(dz, _mm_loadu_ps(&axisZ[i])));
+            __m128 back = _mm_cmpge_ps(dot, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&cutoff[i]), distance), r));
+            inside = _mm_andnot_ps(back, inside);
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        for (int k = 0; k < 4; k++) visible[i + k] = (mask >> k) & 1;
+    }
+#endif
+
+    for (; i < end; i++)
+    {
+        glm::vec3 c = glm::vec3(centerX[i], centerY[i], centerZ[i]);
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; p++) inside = glm::dot(glm::vec3(planes[p]), c) + planes[p].w + radius[i] > 0.0f;
+
+        if (inside && backfaces)
+        {
+            glm::vec3 d = c - camera;
+            inside = !(glm::dot(d, glm::vec3(axisX[i], axisY[i], axisZ[i])) >= cutoff[i] * glm::length(d) + radius[i]);
+        }
+        visible[i] = inside;
+    }
+}
+
+void MeshletCuller::Cull(glm::mat4 clip, glm::vec3 camera, bool backfaces, uint8_t *visible) const
+{
+    // left, right, bottom, top, near, far (Gribb-Hartmann), normalized so sphere radius can be compared.
+    glm::vec4 planes[6];
+    glm::vec4 rows[4];
+    for (int r = 0; r < 4; r++) rows[r] = glm::vec4(clip[0][r], clip[1][r], clip[2][r], clip[3][r]);
+    for (int p = 0; p < 6; p++)
+    {
+        planes[p] = p % 2 == 0 ? rows[3] + rows[p / 2] : rows[3] - rows[p / 2];
+        float length = glm::length(glm::vec3(planes[p]));
+        if (length > 0.0f) planes[p] /= length;
+    }
+
+    cullrange(0, GetCount(), planes, camera, backfaces, visible);
+}
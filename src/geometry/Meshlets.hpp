@@ -0,0 +1,64 @@
+#ifndef MESHLETS_HPP
+#define MESHLETS_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "../glm.hpp"
+
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+
+// cluster of triangles that lie together in index buffer, bounds are in mesh space.
+struct
+{
+    uint32_t indexOffset; // in indices, not bytes.
+    uint32_t trianglesCount;
+    uint32_t verticesCount; // unique vertices referenced.
+
+    glm::vec3 center; // bounding sphere.
+    float radius;
+    glm::vec3 coneAxis; // average normal (of counter-clockwise triangles).
+    float coneCutoff; // sine of cone half-angle, 1 - cone is too wide to cull.
+} typedef Meshlet;
+
+/*
+    Splits triangle list into meshlets: every meshlet grows from first unused triangle over triangles that share
+    positions with it (so UV seams don't cut it), preferring ones that add fewer vertices and are closer to it.
+    Indices are rewritten in meshlet order, triangles of meshlet keep their relative order (see MeshOptimizer).
+*/
+class MeshletBuilder
+{
+  public:
+    static void Build(const glm::vec3 *positions, size_t vertices_count, uint32_t *indices, size_t indices_count, std::vector<Meshlet> *meshlets,
+        unsigned int max_vertices = MESHLET_MAX_VERTICES, unsigned int max_triangles = MESHLET_MAX_TRIANGLES);
+};
+
+/*
+    Meshlet bounds in SoA layout, four meshlets are tested at once with SSE (scalar code elsewhere).
+
+    Test is done in mesh space: planes are taken from clip matrix (projection * view * model) and camera is
+    transformed by inverse model, so non-uniform scale needs nothing special. Cone test assumes back faces are culled
+    and model doesn't mirror (negative determinant flips winding).
+*/
+class MeshletCuller
+{
+  private:
+    std::vector<float> centerX, centerY, centerZ, radius;
+    std::vector<float> axisX, axisY, axisZ, cutoff;
+
+    void cullrange(size_t begin, size_t end, const glm::vec4 *planes, glm::vec3 camera, bool backfaces, uint8_t *visible) const;
+
+  public:
+    MeshletCuller() {}
+
+    void SetMeshlets(const Meshlet *meshlets, size_t count);
+    void Clear();
+    inline size_t GetCount() const { return radius.size(); }
+
+    // visible[i] is 1 if meshlet i may be seen, runs on calling thread (render thread draws right after it).
+    void Cull(glm::mat4 clip, glm::vec3 camera, bool backfaces, uint8_t *visible) const;
+};
+
+#endif
@@ -0,0 +1,281 @@
+#include "OcclusionBuffer.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define OCCLUSION_SSE
+#endif
+
+// === PRIVATE ===
+
+#define CLIP_PLANES 6 // near, left, right, bottom, top, far (clamped depth beyond it would pull triangle's depth closer).
+#define CLIP_MAX_VERTICES (3 + CLIP_PLANES)
+
+// >= 0 - inside.
+static inline float planedistance(const glm::vec4 &v, int plane)
+{
+    switch (plane)
+    {
+        case 0: return v.z + v.w;
+        case 1: return v.x + v.w;
+        case 2: return v.w - v.x;
+        case 3: return v.y + v.w;
+        case 4: return v.w - v.y;
+        default: return v.w - v.z;
+    }
+}
+
+// Sutherland-Hodgman against one plane, returns new count.
+static int clippolygon(const glm::vec4 *in, int count, glm::vec4 *out, int plane)
+{
+    int n = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const glm::vec4 &a = in[i], &b = in[(i + 1) % count];
+        float da = planedistance(a, plane), db = planedistance(b, plane);
+        if (da >= 0.0f) out[n++] = a;
+        if ((da >= 0.0f) != (db >= 0.0f)) out[n++] = a + (b - a) * (da / (da - db));
+    }
+    return n;
+}
+
+// === PUBLIC ===
+
+OcclusionBuffer::OcclusionBuffer(unsigned int width, unsigned int height)
+{
+    tilesX = std::max(1u, (width + OCCLUSION_TILE_WIDTH - 1) / OCCLUSION_TILE_WIDTH);
+    tilesY = std::max(1u, (height + OCCLUSION_TILE_HEIGHT - 1) / OCCLUSION_TILE_HEIGHT);
+    this->width = tilesX * OCCLUSION_TILE_WIDTH;
+    this->height = tilesY * OCCLUSION_TILE_HEIGHT;
+
+    depth.assign((size_t)this->width * this->height, 1.0f);
+    hiz.assign((size_t)(this->width / OCCLUSION_BLOCK_SIZE) * (this->height / OCCLUSION_BLOCK_SIZE), 1.0f);
+    bins.resize(tilesX * tilesY);
+}
+
+void OcclusionBuffer::Begin(glm::mat4 viewprojection)
+{
+    this->viewprojection = viewprojection;
+    std::fill(depth.begin(), depth.end(), 1.0f);
+    std::fill(hiz.begin(), hiz.end(), 1.0f);
+    triangles.clear();
+    for (std::vector<uint32_t> &bin : bins) bin.clear();
+    stats = OcclusionBufferStats();
+}
+
+void OcclusionBuffer::addtriangle(const glm::vec4 *clip, bool backfaces)
+{
+    glm::vec4 polygon[2][CLIP_MAX_VERTICES];
+    int count = 3;
+    std::copy(clip, clip + 3, polygon[0]);
+
+    int current = 0;
+    for (int plane = 0; plane < CLIP_PLANES && count >= 3; plane++)
+    {
+        bool inside = true;
+        for (int i = 0; i < count && inside; i++) inside = planedistance(polygon[current][i], plane) >= 0.0f;
+        if (inside) continue;
+
+        count = clippolygon(polygon[current], count, polygon[current ^ 1], plane);
+        current ^= 1;
+    }
+    if (count < 3) return;
+
+    glm::vec3 screen[CLIP_MAX_VERTICES];
+    for (int i = 0; i < count; i++)
+    {
+        const glm::vec4 &v = polygon[current][i];
+        float w = std::max(v.w, 1e-7f);
+        screen[i] = glm::vec3((v.x / w * 0.5f + 0.5f) * width, (v.y / w * 0.5f + 0.5f) * height, std::clamp(v.z / w * 0.5f + 0.5f, 0.0f, 1.0f)); // clamp only fixes rounding of clipping.
+    }
+
+    for (int i = 1; i + 1 < count; i++)
+    {
+        Triangle t = { { screen[0], screen[i], screen[i + 1] } };
+        float area = (t.v[1].x - t.v[0].x) * (t.v[2].y - t.v[0].y) - (t.v[2].x - t.v[0].x) * (t.v[1].y - t.v[0].y);
+        if (area == 0.0f || (area < 0.0f && backfaces)) continue;
+        if (area < 0.0f) std::swap(t.v[1], t.v[2]);
+
+        // pixels whose centers are within bounds.
+        float minx = std::min({ t.v[0].x, t.v[1].x, t.v[2].x }), maxx = std::max({ t.v[0].x, t.v[1].x, t.v[2].x });
+        float miny = std::min({ t.v[0].y, t.v[1].y, t.v[2].y }), maxy = std::max({ t.v[0].y, t.v[1].y, t.v[2].y });
+        int x0 = std::max(0, (int)std::ceil(minx - 0.5f)), x1 = std::min((int)width - 1, (int)std::floor(maxx - 0.5f));
+        int y0 = std::max(0, (int)std::ceil(miny - 0.5f)), y1 = std::min((int)height - 1, (int)std::floor(maxy - 0.5f));
+        if (x0 > x1 || y0 > y1) continue;
+
+        uint32_t index = triangles.size();
+        triangles.push_back(t);
+        stats.trianglesCount++;
+        for (int ty = y0 / OCCLUSION_TILE_HEIGHT; ty <= y1 / OCCLUSION_TILE_HEIGHT; ty++)
+            for (int tx = x0 / OCCLUSION_TILE_WIDTH; tx <= x1 / OCCLUSION_TILE_WIDTH; tx++)
+            {
+                bins[ty * tilesX + tx].push_back(index);
+                stats.binnedCount++;
+            }
+    }
+}
+
+void OcclusionBuffer::AddOccluder(const glm::vec3 *positions, size_t vertices_count, const uint32_t *indices, size_t indices_count, glm::mat4 model, bool backfaces)
+{
+    glm::mat4 mvp = viewprojection * model;
+    clipspace.resize(vertices_count);
+
+#ifdef OCCLUSION_SSE
+    __m128 c0 = _mm_loadu_ps(&mvp[0][0]), c1 = _mm_loadu_ps(&mvp[1][0]), c2 = _mm_loadu_ps(&mvp[2][0]), c3 = _mm_loadu_ps(&mvp[3][0]);
+    for (size_t i = 0; i < vertices_count; i++)
+    {
+        const glm::vec3 &p = positions[i];
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(p.x)), _mm_mul_ps(c1, _mm_set1_ps(p.y))), _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(p.z)), c3));
+        _mm_storeu_ps(&clipspace[i].x, r);
+    }
+#else
+    for (size_t i = 0; i < vertices_count; i++) clipspace[i] = mvp * glm::vec4(positions[i], 1.0f);
+#endif
+
+    for (size_t i = 0; i + 2 < indices_count; i += 3)
+    {
+        if (indices[i] >= vertices_count || indices[i + 1] >= vertices_count || indices[i + 2] >= vertices_count) continue;
+        glm::vec4 clip[3] = { clipspace[indices[i]], clipspace[indices[i + 1]], clipspace[indices[i + 2]] };
+
+        // whole triangle outside one plane.
+        bool outside = false;
+        for (int plane = 0; plane < CLIP_PLANES && !outside; plane++)
+            outside = planedistance(clip[0], plane) < 0.0f && planedistance(clip[1], plane) < 0.0f && planedistance(clip[2], plane) < 0.0f;
+        if (!outside) addtriangle(clip, backfaces);
+    }
+
+    stats.occludersCount++;
+}
+
+void OcclusionBuffer::rasterizetile(unsigned int tile)
+{
+    if (bins[tile].empty()) return; // depth and Hi-Z are cleared by Begin().
+
+    int tx0 = (tile % tilesX) * OCCLUSION_TILE_WIDTH, ty0 = (tile / tilesX) * OCCLUSION_TILE_HEIGHT;
+    int tx1 = tx0 + OCCLUSION_TILE_WIDTH - 1, ty1 = ty0 + OCCLUSION_TILE_HEIGHT - 1;
+
+    for (uint32_t index : bins[tile])
+    {
+        const Triangle &t = triangles[index];
+        const glm::vec3 &a = t.v[0], &b = t.v[1], &c = t.v[2];
+
+        // edge functions (>= 0 inside), edge i is opposite to vertex i.
+        float A[3] = { b.y - c.y, c.y - a.y, a.y - b.y };
+        float B[3] = { c.x - b.x, a.x - c.x, b.x - a.x };
+        float C[3] = { -(A[0] * b.x + B[0] * b.y), -(A[1] * c.x + B[1] * c.y), -(A[2] * a.x + B[2] * a.y) };
+        float area = A[0] * a.x + B[0] * a.y + C[0];
+        if (area <= 0.0f) continue;
+
+        // depth is linear in screen space.
+        float zA = (A[0] * a.z + A[1] * b.z + A[2] * c.z) / area;
+        float zB = (B[0] * a.z + B[1] * b.z + B[2] * c.z) / area;
+        float zC = (C[0] * a.z + C[1] * b.z + C[2] * c.z) / area;
+
+        int x0 = std::max(tx0, (int)std::ceil(std::min({ a.x, b.x, c.x }) - 0.5f)) & ~3;
+        int x1 = std::min(tx1, (int)std::floor(std::max({ a.x, b.x, c.x }) - 0.5f));
+        int y0 = std::max(ty0, (int)std::ceil(std::min({ a.y, b.y, c.y }) - 0.5f));
+        int y1 = std::min(ty1, (int)std::floor(std::max({ a.y, b.y, c.y }) - 0.5f));
+        x0 = std::max(x0, tx0);
+
+        for (int y = y0; y <= y1; y++)
+        {
+            float py = y + 0.5f;
+            float *row = &depth[(size_t)y * width];
+
+#ifdef OCCLUSION_SSE
+            __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+            __m128 rowE[3], stepA[3];
+            for (int e = 0; e < 3; e++)
+            {
+                rowE[e] = _mm_set1_ps(B[e] * py + C[e]);
+                stepA[e] = _mm_set1_ps(A[e]);
+            }
+            __m128 rowZ = _mm_set1_ps(zB * py + zC), stepZ = _mm_set1_ps(zA), zero = _mm_setzero_ps();
+
+            for (int x = x0; x <= x1; x += 4)
+            {
+                __m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+                __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(stepA[0], px), rowE[0]), zero);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(stepA[1], px), rowE[1]), zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(stepA[2], px), rowE[2]), zero));
+                if (_mm_movemask_ps(inside) == 0) continue;
+
+                __m128 z = _mm_add_ps(_mm_mul_ps(stepZ, px), rowZ);
+                __m128 old = _mm_loadu_ps(&row[x]);
+                __m128 nearest = _mm_min_ps(old, z);
+                _mm_storeu_ps(&row[x], _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+            }
+#else
+            for (int x = x0; x <= x1; x++)
+            {
+                float px = x + 0.5f;
+                if (A[0] * px + B[0] * py + C[0] < 0.0f || A[1] * px + B[1] * py + C[1] < 0.0f || A[2] * px + B[2] * py + C[2] < 0.0f) continue;
+                row[x] = std::min(row[x], zA * px + zB * py + zC);
+            }
+#endif
+        }
+    }
+
+    // farthest depth of every block.
+    unsigned int blocksperrow = width / OCCLUSION_BLOCK_SIZE;
+    for (int by = ty0; by <= ty1; by += OCCLUSION_BLOCK_SIZE)
+        for (int bx = tx0; bx <= tx1; bx += OCCLUSION_BLOCK_SIZE)
+        {
+            float farthest = 0.0f;
+            for (int y = by; y < by + OCCLUSION_BLOCK_SIZE; y++)
+                for (int x = bx; x < bx + OCCLUSION_BLOCK_SIZE; x++) farthest = std::max(farthest, depth[(size_t)y * width + x]);
+            hiz[(by / OCCLUSION_BLOCK_SIZE) * blocksperrow + bx / OCCLUSION_BLOCK_SIZE] = farthest;
+        }
+}
+
+void OcclusionBuffer::Rasterize(JobSystem *jobs)
+{
+    unsigned int count = tilesX * tilesY;
+    if (!jobs)
+    {
+        for (unsigned int i = 0; i < count; i++) rasterizetile(i);
+        return;
+    }
+
+    jobs->ParallelFor(count, 1, [this](size_t begin, size_t end) { for (size_t i = begin; i < end; i++) rasterizetile(i); });
+}
+
+bool OcclusionBuffer::IsVisible(glm::vec3 boundsmin, glm::vec3 boundsmax, glm::mat4 model) const
+{
+    glm::mat4 mvp = viewprojection * model;
+
+    glm::vec3 ndcmin = glm::vec3(INFINITY), ndcmax = glm::vec3(-INFINITY);
+    for (int i = 0; i < 8; i++)
+    {
+        glm::vec3 corner = glm::vec3(i & 1 ? boundsmax.x : boundsmin.x, i & 2 ? boundsmax.y : boundsmin.y, i & 4 ? boundsmax.z : boundsmin.z);
+        glm::vec4 clip = mvp * glm::vec4(corner, 1.0f);
+        if (clip.w <= 1e-6f || clip.z < -clip.w) return true; // crosses near plane, too close to cull.
+
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        ndcmin = glm::min(ndcmin, ndc);
+        ndcmax = glm::max(ndcmax, ndc);
+    }
+    if (ndcmax.x < -1.0f || ndcmin.x > 1.0f || ndcmax.y < -1.0f || ndcmin.y > 1.0f || ndcmin.z > 1.0f) return false;
+
+    // every pixel box touches.
+    int x0 = std::max(0, (int)std::floor((ndcmin.x * 0.5f + 0.5f) * width)), x1 = std::min((int)width - 1, (int)std::floor((ndcmax.x * 0.5f + 0.5f) * width));
+    int y0 = std::max(0, (int)std::floor((ndcmin.y * 0.5f + 0.5f) * height)), y1 = std::min((int)height - 1, (int)std::floor((ndcmax.y * 0.5f + 0.5f) * height));
+    float nearest = ndcmin.z * 0.5f + 0.5f;
+
+    unsigned int blocksperrow = width / OCCLUSION_BLOCK_SIZE;
+    for (int by = y0 / OCCLUSION_BLOCK_SIZE; by <= y1 / OCCLUSION_BLOCK_SIZE; by++)
+        for (int bx = x0 / OCCLUSION_BLOCK_SIZE; bx <= x1 / OCCLUSION_BLOCK_SIZE; bx++)
+        {
+            if (nearest > hiz[by * blocksperrow + bx]) continue;
+
+            int px0 = std::max(x0, bx * OCCLUSION_BLOCK_SIZE), px1 = std::min(x1, bx * OCCLUSION_BLOCK_SIZE + OCCLUSION_BLOCK_SIZE - 1);
+            int py0 = std::max(y0, by * OCCLUSION_BLOCK_SIZE), py1 = std::min(y1, by * OCCLUSION_BLOCK_SIZE + OCCLUSION_BLOCK_SIZE - 1);
+            for (int y = py0; y <= py1; y++)
+                for (int x = px0; x <= px1; x++)
+                    if (nearest <= depth[(size_t)y * width + x]) return true;
+        }
+
+    return false;
+}
@@ -0,0 +1,78 @@
+#ifndef OCCLUSIONBUFFER_HPP
+#define OCCLUSIONBUFFER_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "../glm.hpp"
+#include "../objects/JobSystem.hpp"
+
+#define OCCLUSION_DEFAULT_WIDTH 256
+#define OCCLUSION_DEFAULT_HEIGHT 128
+#define OCCLUSION_TILE_WIDTH 64 // buffer is rasterized tile by tile in parallel.
+#define OCCLUSION_TILE_HEIGHT 32
+#define OCCLUSION_BLOCK_SIZE 8 // pixels per side of Hi-Z block.
+
+struct
+{
+    unsigned int occludersCount;
+    unsigned int trianglesCount; // rasterized, after clipping and back-face culling.
+    unsigned int binnedCount; // triangle-tile pairs.
+} typedef OcclusionBufferStats;
+
+/*
+    Software depth buffer for occlusion culling, CPU only (no GL), so it runs and can be benchmarked anywhere.
+
+    Every frame: Begin() with view-projection -> AddOccluder() for big closed meshes (walls, floors) -> Rasterize()
+    -> IsVisible() for bounds of everything else. Occluders are transformed with SSE, clipped against frustum and
+    binned into tiles, then tiles are rasterized on JobSystem four pixels at a time (only nearest depth is kept,
+    there is no color). Rasterize() also builds Hi-Z (farthest depth of 8x8 blocks), so most boxes are decided
+    by few block reads.
+
+    Depth is NDC z remapped to [0; 1], row 0 is bottom of screen. Pixels are sampled at centers, so occluders
+    are effectively grown by up to half a pixel: buffer resolution trades culling precision for speed.
+*/
+class OcclusionBuffer
+{
+  private:
+    struct Triangle
+    {
+        glm::vec3 v[3]; // pixels and depth, counter-clockwise.
+    };
+
+    unsigned int width, height, tilesX, tilesY;
+    glm::mat4 viewprojection = glm::mat4(1.0f);
+
+    std::vector<float> depth = std::vector<float>(); // row-major.
+    std::vector<float> hiz = std::vector<float>();
+    std::vector<Triangle> triangles = std::vector<Triangle>();
+    std::vector<std::vector<uint32_t>> bins = std::vector<std::vector<uint32_t>>(); // triangles per tile.
+    std::vector<glm::vec4> clipspace = std::vector<glm::vec4>(); // scratch of AddOccluder().
+
+    OcclusionBufferStats stats = OcclusionBufferStats();
+
+    void addtriangle(const glm::vec4 *clip, bool backfaces);
+    void rasterizetile(unsigned int tile);
+
+  public:
+    // size is rounded up to tiles.
+    OcclusionBuffer(unsigned int width = OCCLUSION_DEFAULT_WIDTH, unsigned int height = OCCLUSION_DEFAULT_HEIGHT);
+
+    // clears buffer, viewprojection is projection * view.
+    void Begin(glm::mat4 viewprojection);
+    // backfaces - skip triangles facing away (counter-clockwise are front), off for open or double-sided meshes.
+    void AddOccluder(const glm::vec3 *positions, size_t vertices_count, const uint32_t *indices, size_t indices_count, glm::mat4 model, bool backfaces = true);
+    // jobs is optional.
+    void Rasterize(JobSystem *jobs = nullptr);
+
+    // false if box (in model space) is entirely behind occluders or off screen, read-only so can be called from any thread.
+    bool IsVisible(glm::vec3 boundsmin, glm::vec3 boundsmax, glm::mat4 model) const;
+
+    inline unsigned int GetWidth() const { return width; }
+    inline unsigned int GetHeight() const { return height; }
+    inline const float *GetDepth() const { return depth.data(); }
+    inline OcclusionBufferStats GetStats() const { return stats; }
+};
+
+#endif
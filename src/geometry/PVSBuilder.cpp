@@ -0,0 +1,307 @@
+#include "PVSBuilder.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+#define PVS_LEAF_TRIANGLES 4
+
+// === PRIVATE ===
+
+static inline glm::vec3 centroid(const glm::vec3 &v0, const glm::vec3 &e1, const glm::vec3 &e2) { return v0 + (e1 + e2) * (1.0f / 3.0f); }
+
+// radical inverse, points of Halton sequence are spread evenly for any count.
+static float halton(uint32_t i, uint32_t base)
+{
+    float f = 1.0f, r = 0.0f;
+    for (; i; i /= base)
+    {
+        f /= base;
+        r += f * (i % base);
+    }
+    return r;
+}
+
+static uint32_t hash32(uint32_t x)
+{
+    x ^= x >> 16; x *= 0x7FEB352Du;
+    x ^= x >> 15; x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+void PVSBuilder::buildnode(uint32_t first, uint32_t count)
+{
+    uint32_t index = nodes.size();
+    nodes.push_back(Node());
+
+    glm::vec3 bmin = glm::vec3(INFINITY), bmax = glm::vec3(-INFINITY), cmin = bmin, cmax = bmax;
+    for (uint32_t i = first; i < first + count; i++)
+    {
+        const Triangle &t = triangles[i];
+        glm::vec3 v1 = t.v0 + t.e1, v2 = t.v0 + t.e2;
+        bmin = glm::min(bmin, glm::min(t.v0, glm::min(v1, v2)));
+        bmax = glm::max(bmax, glm::max(t.v0, glm::max(v1, v2)));
+
+        glm::vec3 c = centroid(t.v0, t.e1, t.e2);
+        cmin = glm::min(cmin, c);
+        cmax = glm::max(cmax, c);
+    }
+    nodes[index].bmin = bmin;
+    nodes[index].bmax = bmax;
+
+    glm::vec3 extent = cmax - cmin;
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+    if (count <= PVS_LEAF_TRIANGLES || extent[axis] <= 0.0f)
+    {
+        nodes[index].first = first;
+        nodes[index].count = count;
+        return;
+    }
+
+    // median split, tree is balanced whatever geometry is.
+    uint32_t half = count / 2;
+    std::nth_element(triangles.begin() + first, triangles.begin() + first + half, triangles.begin() + first + count,
+        [axis](const Triangle &a, const Triangle &b) { return centroid(a.v0, a.e1, a.e2)[axis] < centroid(b.v0, b.e1, b.e2)[axis]; });
+
+    buildnode(first, half);
+    nodes[index].first = nodes.size();
+    nodes[index].count = 0;
+    buildnode(first + half, count - half);
+}
+
+bool PVSBuilder::trace(glm::vec3 from, glm::vec3 dir, bool anyhit, float *t, bool *backface) const
+{
+    const float eps = 1e-4f;
+
+    glm::vec3 invdir = 1.0f / dir; // inf on zero components works with slab test below.
+    float nearest = 1.0f - eps;
+    bool hit = false;
+
+    uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0)
+    {
+        const Node &n = nodes[stack[--top]];
+
+        glm::vec3 t0 = (n.bmin - from) * invdir, t1 = (n.bmax - from) * invdir;
+        glm::vec3 tmin = glm::min(t0, t1), tmax = glm::max(t0, t1);
+        float enter = std::max(std::max(tmin.x, tmin.y), std::max(tmin.z, 0.0f));
+        float exit = std::min(std::min(tmax.x, tmax.y), std::min(tmax.z, nearest));
+        if (!(enter <= exit)) continue;
+
+        if (n.count == 0)
+        {
+            stack[top++] = n.first;
+            stack[top++] = &n - nodes.data() + 1;
+            continue;
+        }
+
+        // Moller-Trumbore, both sides. det > 0 - ray comes from front (counter-clockwise) side.
+        for (uint32_t i = n.first; i < n.first + n.count; i++)
+        {
+            const Triangle &tri = triangles[i];
+            glm::vec3 p = glm::cross(dir, tri.e2);
+            float det = glm::dot(tri.e1, p);
+            if (std::fabs(det) < 1e-12f) continue;
+
+            float inv = 1.0f / det;
+            glm::vec3 s = from - tri.v0;
+            float u = glm::dot(s, p) * inv;
+            if (u < 0.0f || u > 1.0f) continue;
+
+            glm::vec3 q = glm::cross(s, tri.e1);
+            float v = glm::dot(dir, q) * inv;
+            if (v < 0.0f || u + v > 1.0f) continue;
+
+            float d = glm::dot(tri.e2, q) * inv;
+            if (d <= eps || d >= nearest) continue;
+
+            if (anyhit) return true;
+            nearest = d;
+            hit = true;
+            *backface = det < 0.0f;
+        }
+    }
+
+    if (hit) *t = nearest;
+    return hit;
+}
+
+bool PVSBuilder::occluded(glm::vec3 from, glm::vec3 to) const
+{
+    float t;
+    bool backface;
+    return trace(from, to - from, true, &t, &backface);
+}
+
+bool PVSBuilder::isvalidsample(glm::vec3 p, float range) const
+{
+    static const glm::vec3 directions[14] =
+    {
+        { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+        { 1, 1, 1 }, { 1, 1, -1 }, { 1, -1, 1 }, { 1, -1, -1 }, { -1, 1, 1 }, { -1, 1, -1 }, { -1, -1, 1 }, { -1, -1, -1 }
+    };
+
+    float t;
+    bool backface;
+    int backfaces = 0;
+    for (int i = 0; i < 14; i++)
+    {
+        bool hit = trace(p, glm::normalize(directions[i]) * range, false, &t, &backface);
+        if (i == 3 && !hit) return false; // nothing below - under floor or outside of level.
+        if (hit && backface) backfaces++;
+    }
+    return backfaces * 4 <= 14; // inside of wall sees mostly back faces.
+}
+
+// === PUBLIC ===
+
+PVSSettings PVSBuilder::GetDefaultSettings()
+{
+    PVSSettings s = PVSSettings();
+    s.cellSize = glm::vec3(4.0f);
+    s.padding = 0.5f;
+    s.samplesPerCell = 32;
+    s.raysPerPair = 256;
+    return s;
+}
+
+void PVSBuilder::AddMesh(const UCMESHData *mesh, glm::mat4 transform)
+{
+    triangles.reserve(triangles.size() + mesh->indices.size() / 3);
+    for (size_t i = 0; i + 2 < mesh->indices.size(); i += 3)
+    {
+        glm::vec3 v[3];
+        for (int j = 0; j < 3; j++)
+        {
+            v[j] = glm::vec3(transform * glm::vec4(mesh->vertices[mesh->indices[i + j]], 1.0f));
+            boundsMin = glm::min(boundsMin, v[j]);
+            boundsMax = glm::max(boundsMax, v[j]);
+        }
+        triangles.push_back({ v[0], v[1] - v[0], v[2] - v[0] });
+    }
+}
+
+bool PVSBuilder::Build(PVSSettings settings, JobSystem *jobs)
+{
+    stats = PVSStats();
+    visibility.clear();
+    nodes.clear();
+    if (triangles.empty() || glm::any(glm::lessThanEqual(settings.cellSize, glm::vec3(0.0f)))) return false;
+
+    gridMin = boundsMin - settings.padding;
+    cellSize = settings.cellSize;
+    glm::vec3 counts = glm::max(glm::ceil((boundsMax + settings.padding - gridMin) / cellSize), glm::vec3(1.0f));
+    if ((double)counts.x * counts.y * counts.z > PVS_MAX_CELLS) return false;
+
+    cellsCount = glm::uvec3(counts);
+    uint32_t cells = cellsCount.x * cellsCount.y * cellsCount.z;
+    size_t rowsize = GetRowSize();
+
+    nodes.reserve(triangles.size() / PVS_LEAF_TRIANGLES * 2 + 1);
+    buildnode(0, triangles.size());
+
+    // Halton points shifted by per cell offset (wrapped into cell), so cells don't share sample pattern.
+    // samples inside of walls or outside of level are dropped, they would see through walls from behind.
+    uint32_t samplescount = std::max(settings.samplesPerCell, 1u);
+    float range = glm::length(glm::vec3(cellsCount) * cellSize);
+    std::vector<glm::vec3> samples = std::vector<glm::vec3>((size_t)cells * samplescount);
+    std::vector<uint32_t> validcount = std::vector<uint32_t>(cells, 0);
+
+    auto placesamples = [&](size_t begin, size_t end)
+    {
+        for (uint32_t c = begin; c < end; c++)
+        {
+            glm::uvec3 cc = glm::uvec3(c % cellsCount.x, c / cellsCount.x % cellsCount.y, c / cellsCount.x / cellsCount.y);
+            glm::vec3 origin = gridMin + glm::vec3(cc) * cellSize;
+            glm::vec3 shift = glm::vec3(hash32(c * 3), hash32(c * 3 + 1), hash32(c * 3 + 2)) * (1.0f / 4294967296.0f);
+
+            glm::vec3 *out = &samples[(size_t)c * samplescount];
+            for (uint32_t i = 0; i < samplescount; i++)
+            {
+                glm::vec3 h = glm::fract(glm::vec3(halton(i + 1, 2), halton(i + 1, 3), halton(i + 1, 5)) + shift);
+                glm::vec3 p = origin + h * cellSize;
+                if (isvalidsample(p, range)) out[validcount[c]++] = p;
+            }
+        }
+    };
+
+    if (jobs) jobs->ParallelFor(cells, 16, placesamples);
+    else placesamples(0, cells);
+
+    visibility.assign((size_t)cells * rowsize, 0);
+    std::atomic<uint64_t> rayscount = 0;
+
+    // job of cell a writes only its own row (pairs a <= b), lower half is mirrored after.
+    auto testrow = [&](size_t begin, size_t end)
+    {
+        uint64_t localrays = 0;
+        for (uint32_t a = begin; a < end; a++)
+        {
+            uint8_t *row = visibility.data() + (size_t)a * rowsize;
+            glm::ivec3 ca = glm::ivec3(a % cellsCount.x, a / cellsCount.x % cellsCount.y, a / cellsCount.x / cellsCount.y);
+            const glm::vec3 *sa = &samples[(size_t)a * samplescount];
+            uint32_t na = validcount[a];
+
+            for (uint32_t b = a; b < cells; b++)
+            {
+                glm::ivec3 cb = glm::ivec3(b % cellsCount.x, b / cellsCount.x % cellsCount.y, b / cellsCount.x / cellsCount.y);
+                bool visible = glm::all(glm::lessThanEqual(glm::abs(ca - cb), glm::ivec3(1)));
+
+                const glm::vec3 *sb = &samples[(size_t)b * samplescount];
+                uint32_t nb = validcount[b];
+                uint32_t rays = (uint32_t)std::min<uint64_t>(settings.raysPerPair, (uint64_t)na * nb);
+                for (uint32_t k = 0; k < rays && !visible; k++)
+                {
+                    // k walks every (i, i + shift) pair, so repeated rays come only after all pairs are tried.
+                    uint32_t i = k % na, j = (i + k / na) % nb;
+                    visible = !occluded(sa[i], sb[j]);
+                    localrays++;
+                }
+
+                if (visible) row[b >> 3] |= 1 << (b & 7);
+            }
+        }
+        rayscount += localrays;
+    };
+
+    if (jobs) jobs->ParallelFor(cells, 1, testrow);
+    else testrow(0, cells);
+
+    for (uint32_t a = 0; a < cells; a++)
+        for (uint32_t b = 0; b < a; b++)
+            if ((visibility[(size_t)b * rowsize + (a >> 3)] >> (a & 7)) & 1) visibility[(size_t)a * rowsize + (b >> 3)] |= 1 << (b & 7);
+
+    // nobody sees into cells without samples, but camera that got there anyway sees everything.
+    for (uint32_t c = 0; c < cells; c++)
+    {
+        if (validcount[c]) continue;
+
+        uint8_t *row = visibility.data() + (size_t)c * rowsize;
+        memset(row, 0xFF, rowsize);
+        if (cells % 8) row[rowsize - 1] = (1 << (cells % 8)) - 1;
+        stats.emptyCellsCount++;
+    }
+
+    stats.cellsCount = cellsCount;
+    stats.trianglesCount = triangles.size();
+    stats.raysCount = rayscount;
+    for (uint8_t byte : visibility) stats.visiblePairsCount += std::popcount(byte);
+    return true;
+}
+
+void PVSBuilder::Clear()
+{
+    triangles.clear();
+    nodes.clear();
+    visibility.clear();
+    boundsMin = glm::vec3(INFINITY);
+    boundsMax = glm::vec3(-INFINITY);
+    cellsCount = glm::uvec3(0);
+    stats = PVSStats();
+}
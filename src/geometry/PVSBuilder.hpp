@@ -0,0 +1,99 @@
+#ifndef PVSBUILDER_HPP
+#define PVSBUILDER_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "../glm.hpp"
+#include "../formats/UCMESHData.hpp"
+#include "../objects/JobSystem.hpp"
+
+#define PVS_MAX_CELLS 32768 // visibility matrix is built uncompressed (cells count ^ 2 bits).
+
+struct
+{
+    glm::vec3 cellSize;
+    float padding; // added around bounds of geometry.
+    uint32_t samplesPerCell; // points spread over every cell.
+    uint32_t raysPerPair; // sample to sample rays tried before pair of cells is considered hidden.
+} typedef PVSSettings;
+
+struct
+{
+    glm::uvec3 cellsCount;
+    size_t trianglesCount;
+    size_t visiblePairsCount; // including cell itself.
+    size_t emptyCellsCount; // without valid samples (inside of walls or outside of level).
+    uint64_t raysCount;
+} typedef PVSStats;
+
+/*
+    Computes cell-to-cell visibility of static geometry (sample based): bounds of everything added are split
+    into grid of cells, every cell gets jittered sample points and pair of cells is visible if any ray between
+    their samples doesn't hit a triangle (rays are traced through BVH). Pairs are tested on JobSystem, every
+    pair once, result is symmetric. Cell and its 26 neighbours always see each other, so objects standing
+    on cell border aren't lost.
+
+    Samples that have nothing below them or see mostly back faces (inside of walls, behind one-sided level hull)
+    are dropped, otherwise they would see each other around the level. Cell left without samples is seen only
+    by its neighbours and sees everything itself (camera can get there only by clipping through walls).
+
+    It's approximation: gaps thinner than distance between samples can be missed, raise samplesPerCell and
+    raysPerPair if something pops in. Geometry blocks rays from both sides, level must be closed (walls have
+    faces inside of level counter-clockwise) and have floor under every place camera can be.
+*/
+class PVSBuilder
+{
+  private:
+    struct Triangle
+    {
+        glm::vec3 v0, e1, e2;
+    };
+
+    struct Node
+    {
+        glm::vec3 bmin, bmax;
+        uint32_t first; // first triangle for leaves, right child for inner nodes (left is next node).
+        uint32_t count; // 0 - inner node.
+    };
+
+    std::vector<Triangle> triangles = std::vector<Triangle>();
+    std::vector<Node> nodes = std::vector<Node>();
+    glm::vec3 boundsMin = glm::vec3(INFINITY), boundsMax = glm::vec3(-INFINITY);
+
+    glm::uvec3 cellsCount = glm::uvec3(0);
+    glm::vec3 gridMin = glm::vec3(0.0f), cellSize = glm::vec3(1.0f);
+    std::vector<uint8_t> visibility = std::vector<uint8_t>(); // cells count ^ 2 bits, row by row.
+    PVSStats stats = PVSStats();
+
+    void buildnode(uint32_t first, uint32_t count);
+    // segment from -> from + dir, t is in [0; 1], backface - nearest hit is on clockwise side.
+    bool trace(glm::vec3 from, glm::vec3 dir, bool anyhit, float *t, bool *backface) const;
+    bool occluded(glm::vec3 from, glm::vec3 to) const;
+    bool isvalidsample(glm::vec3 p, float range) const;
+
+  public:
+    PVSBuilder() {}
+
+    static PVSSettings GetDefaultSettings();
+
+    // transform is applied to mesh positions, triangles are copied.
+    void AddMesh(const UCMESHData *mesh, glm::mat4 transform);
+    inline size_t GetTrianglesCount() { return triangles.size(); }
+
+    // false if there is no geometry or too many cells (PVS_MAX_CELLS). jobs is optional.
+    bool Build(PVSSettings settings, JobSystem *jobs = nullptr);
+    void Clear();
+
+    inline glm::uvec3 GetCellsCount() { return cellsCount; }
+    inline glm::vec3 GetGridMin() { return gridMin; }
+    inline glm::vec3 GetCellSize() { return cellSize; }
+    inline size_t GetRowSize() { return ((size_t)cellsCount.x * cellsCount.y * cellsCount.z + 7) / 8; }
+    // uncompressed row of cell, (cells count + 7) / 8 bytes.
+    inline const uint8_t *GetRow(uint32_t cell) { return visibility.data() + cell * GetRowSize(); }
+
+    inline PVSStats GetStats() { return stats; }
+};
+
+#endif
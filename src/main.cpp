@@ -9,6 +9,7 @@
 #include <sstream>
 #include <algorithm>
 #include <functional>
+#include <deque>
 #include <cstdlib>
 
 #include <csignal>
@@ -20,26 +21,63 @@
 #include "openal.hpp"
 
 #include "objects.hpp"
-
+#include "objects/TextureStreamer.hpp"
+#include "objects/TexturePacker.hpp"
+#include "objects/FrameScheduler.hpp"
+#include "objects/Renderer.hpp"
+#include "objects/JobSystem.hpp"
+#include "objects/HandlePool.hpp"
+#include "objects/Scene.hpp"
+#include "objects/WorldPartition.hpp"
+#include "objects/OcclusionCuller.hpp"
+#include "objects/PortalSystem.hpp"
+#include "objects/ecs/World.hpp"
+#include "objects/ecs/Systems.hpp"
+
+#include "formats/AssetManifest.hpp"
+#include "formats/UCPACKFile.hpp"
+
+// shader variants sources, FEATURE_* defines are injected by ShaderVariants (see Entity::GetSurfaceShaderFeatures()).
 const char *vertexShaderSource = R"(
 #version 330 core
 
 layout (location = 0) in vec3 vertexPosition;
 layout (location = 1) in vec2 vertexTexturePosition;
+#ifdef FEATURE_INSTANCED
+layout (location = 2) in mat4 instanceModel;
+#endif
 
+#ifdef FEATURE_FOG
 out vec3 globalVertexPosition;
+#endif
+#if defined(FEATURE_TEXTURED) || defined(FEATURE_TEXTURE_ARRAY)
 out vec2 texturePosition;
+#endif
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// mesh buffer quantization, offsets 0 and scales 1 for float attributes.
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+uniform vec4 uvTransform; // offset (xy) and scale (zw).
+
 void main()
 {
-    vec4 globvpos4 = model * vec4(vertexPosition, 1.0);
-
+    vec3 position = positionOffset + vertexPosition * positionScale;
+#ifdef FEATURE_INSTANCED
+    vec4 globvpos4 = model * instanceModel * vec4(position, 1.0);
+#else
+    vec4 globvpos4 = model * vec4(position, 1.0);
+#endif
+
+#ifdef FEATURE_FOG
     globalVertexPosition = vec3(globvpos4.x, globvpos4.y, globvpos4.z);
-    texturePosition = vertexTexturePosition;
+#endif
+#if defined(FEATURE_TEXTURED) || defined(FEATURE_TEXTURE_ARRAY)
+    texturePosition = uvTransform.xy + vertexTexturePosition * uvTransform.zw;
+#endif
 
     //gl_Position = projection * view * model * vec4(vertexPosition, 1.0);
     gl_Position = projection * view * globvpos4;
@@ -49,45 +87,76 @@ void main()
 const char *fragmentShaderSource = R"(
 #version 330 core
 
+#ifdef FEATURE_FOG
 in vec3 globalVertexPosition;
+#endif
+#if defined(FEATURE_TEXTURED) || defined(FEATURE_TEXTURE_ARRAY)
 in vec2 texturePosition;
+#endif
 
 out vec4 FragColor;
 
 uniform vec4 color;
 
-uniform bool hasTexture;
-uniform sampler2D texture;
+#ifdef FEATURE_TEXTURED
+uniform sampler2D mainTexture;
+#endif
+
+#ifdef FEATURE_TEXTURE_ARRAY
+uniform sampler2DArray textureArray;
+uniform float textureLayer;
+uniform vec4 textureRect; // offset (xy) and scale (zw) of texture in atlas layer.
+#endif
 
-uniform bool fogEnabled;
+#ifdef FEATURE_ALPHA_TEST
+uniform float alphaCutoff;
+#endif
+
+#ifdef FEATURE_FOG
 uniform float fogStartDistance;
 uniform float fogEndDistance;
 uniform vec3 fogColor;
 
 uniform vec3 cameraPosition;
-uniform vec3 cameraRotation;
-
-uniform vec3 cameraFront;
-uniform vec3 cameraUp;
-uniform vec3 cameraRight;
+#endif
 
 void main()
 {
-    vec4 vertcol = (hasTexture ? texture2D(texture, texturePosition) : vec4(1.0)) * color;
+    vec4 vertcol = color;
+
+#if defined(FEATURE_TEXTURE_ARRAY)
+    // whole layer keeps hardware wrapping, atlas entry emulates repeat.
+    vec2 uv = textureRect.zw == vec2(1.0) ? texturePosition : textureRect.xy + fract(texturePosition) * textureRect.zw;
+    vertcol *= texture(textureArray, vec3(uv, textureLayer));
+#elif defined(FEATURE_TEXTURED)
+    vertcol *= texture(mainTexture, texturePosition);
+#endif
+
+#ifdef FEATURE_ALPHA_TEST
+    if (vertcol.a < alphaCutoff) discard;
+#endif
 
+#ifdef FEATURE_FOG
     float dist = length(globalVertexPosition - cameraPosition);
     float fog_int_factor = min(1, max(0, (dist - fogStartDistance) / (fogEndDistance - fogStartDistance)));
 
     FragColor = mix(vertcol, vec4(fogColor, 1), fog_int_factor);
+#else
+    FragColor = vertcol;
+#endif
 }
 )";
 
 int initOpenGL(GLFWwindow **window);
 
 const unsigned int SCREEN_HEIGHT = 700;
-const unsigned int FPS = 60;
+const unsigned int FPS = 60; // frame rate cap (when VSYNC is off).
+const unsigned int TICK_RATE = 60; // simulation ticks per second.
+const bool VSYNC = false;
 const float MOUSE_SENSITIVITY = 0.1;
 const float DEFAULT_CAMERA_SPEED = 3.0;
+const size_t TEXTURE_STREAMING_BUDGET = 32 * 1024 * 1024;
+const char *SHADER_CACHE_DIR = "shadercache";
 
 unsigned int windowWidth = 1200;
 unsigned int windowHeight = 700;
@@ -104,8 +173,7 @@ void resizeCallback(GLFWwindow *w, int width, int height)
 {
     windowWidth = width;
     windowHeight = height;
-
-    glViewport(0, 0, windowWidth, windowHeight);
+    // viewport is set by render thread from packet.
 }
 
 void on_signal(int code)
@@ -163,18 +231,47 @@ int main()
     // ========================================
     
     {
-        ShaderProgram sp;
-        
-        sp.LoadVertexShader(vertexShaderSource);
-        sp.LoadFragmentShader(fragmentShaderSource);
+        // engine-wide worker pool, main thread is its worker 0.
+        JobSystem jobs = JobSystem();
+        JobSystem::SetCurrent(&jobs);
 
-        std::string log;
-        if (!sp.CompileVertexShader(&log)) std::cout << "Compiling vertex shader error: \"" << log << "\"." << std::endl;
-        if (!sp.CompileFragmentShader(&log)) std::cout << "Compiling fragment shader error: \"" << log << "\"." << std::endl;
-        if (!sp.LinkShaderProgram(&log)) std::cout << "Linking shader program error: \"" << log << "\"." << std::endl;
+        // cooked assets packed by ucpack are read from archive, ones that aren't in it from separate files.
+        UCPACKFile assets_pack = UCPACKFile();
+        if (assets_pack.Open("assets.ucpack"))
+        {
+            UCPACKFile::Mount(&assets_pack);
+            printf("asset archive: %u entries\n", assets_pack.GetEntriesCount());
+        }
+
+        // written by assetcooker next to cooked assets, cooked files that were changed or removed since are reported.
+        AssetManifest manifest = AssetManifest();
+        if (manifest.Load("assets.ucmanifest"))
+        {
+            size_t invalid = 0;
+            for (size_t i = 0; i < manifest.GetEntriesCount(); i++)
+            {
+                if (manifest.Validate(i, ".")) continue;
+                printf("cooked asset \"%s\" is missing or stale, re-run assetcooker\n", manifest.GetString(manifest.GetEntries()[i].cookedPath));
+                invalid++;
+            }
+            printf("asset manifest: %zu cooked assets, %zu invalid\n", manifest.GetEntriesCount(), invalid);
+        }
+
+        ShaderVariants shaders = ShaderVariants(vertexShaderSource, fragmentShaderSource, SHADER_CACHE_DIR);
+        // variants used by the scene are compiled in background while assets are loading, others are built on first use.
+        std::vector<ShaderFeatures> used_variants = std::vector<ShaderFeatures>();
+        for (ShaderFeatures f : { SHADER_FEATURE_NONE, SHADER_FEATURE_TEXTURED, SHADER_FEATURE_TEXTURE_ARRAY })
+        {
+            used_variants.push_back(f);
+            used_variants.push_back(f | SHADER_FEATURE_FOG);
+        }
+        unsigned int compiling_variants = shaders.BeginPrecompile(used_variants);
+        std::cout << "Compiling " << compiling_variants << " shader variants" << (hasParallelShaderCompile() ? " in parallel." : ".") << std::endl;
 
         Camera cam = Camera();
 
+        TextureStreamer streamer = TextureStreamer(TEXTURE_STREAMING_BUDGET, 64, &jobs);
+
         // ===== MESHES =====
         
         Mesh tri = Mesh();
@@ -261,46 +358,33 @@ int main()
             tex.SetDefaultParametres();
         }
 
+        // small textures are packed into texture arrays/atlases (see packer.Pack() below).
+        TexturePacker packer = TexturePacker();
+
         Texture tex16 = Texture();
-        if (tex16.LoadFromUCTEXFile("tex16bit.uctex"))
-        {
-            std::cout << "Successfully loaded texture 2!" << std::endl;
-            tex16.SetDefaultParametres();
-        }
+        tex16.SetDefaultParametres();
+        if (packer.AddTexture(&tex16, "tex16bit.uctex")) std::cout << "Successfully loaded texture 2!" << std::endl;
 
         Texture tex16_rgb = Texture();
-        if (tex16_rgb.LoadFromUCTEXFile("tex16bit_rgb.uctex"))
-        {
-            std::cout << "Successfully loaded texture 3!" << std::endl;
-            tex16_rgb.SetDefaultParametres();
-        }
+        tex16_rgb.SetDefaultParametres();
+        if (packer.AddTexture(&tex16_rgb, "tex16bit_rgb.uctex")) std::cout << "Successfully loaded texture 3!" << std::endl;
 
         Texture tex_cube = Texture();
-        if (tex_cube.LoadFromUCTEXFile("cube.uctex"))
-        {
-            std::cout << "Successfully loaded texture \"cube.uctex\"!" << std::endl;
-            tex_cube.SetDefaultParametres();
-        }
+        tex_cube.SetDefaultParametres();
+        if (packer.AddTexture(&tex_cube, "cube.uctex")) std::cout << "Successfully loaded texture \"cube.uctex\"!" << std::endl;
 
+        // streamed textures: parametres are set before registration, they are applied when mips arrive.
         Texture crowbar_head_tex = Texture();
-        if (crowbar_head_tex.LoadFromUCTEXFile("./textures/crowbar/head.uctex"))
-        {
-            std::cout << "Successfully loaded texture \"./textures/crowbar/head.uctex\"!" << std::endl;
-            crowbar_head_tex.SetDefaultParametres();
-
-            crowbar_head_tex.SetTextureIntParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            crowbar_head_tex.SetTextureIntParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        }
+        crowbar_head_tex.SetDefaultParametres();
+        crowbar_head_tex.SetTextureIntParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        crowbar_head_tex.SetTextureIntParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        if (streamer.AddTexture(&crowbar_head_tex, "./textures/crowbar/head.uctex")) std::cout << "Streaming texture \"./textures/crowbar/head.uctex\"." << std::endl;
 
         Texture crowbar_cyl_tex = Texture();
-        if (crowbar_cyl_tex.LoadFromUCTEXFile("./textures/crowbar/cyl.uctex"))
-        {
-            std::cout << "Successfully loaded texture \"./textures/crowbar/cyl.uctex\"!" << std::endl;
-            crowbar_cyl_tex.SetDefaultParametres();
-
-            crowbar_cyl_tex.SetTextureIntParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            crowbar_cyl_tex.SetTextureIntParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        }
+        crowbar_cyl_tex.SetDefaultParametres();
+        crowbar_cyl_tex.SetTextureIntParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        crowbar_cyl_tex.SetTextureIntParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        if (streamer.AddTexture(&crowbar_cyl_tex, "./textures/crowbar/cyl.uctex")) std::cout << "Streaming texture \"./textures/crowbar/cyl.uctex\"." << std::endl;
 
         /*
         ===== ===== =====
@@ -320,6 +404,7 @@ int main()
 
         Entity e4 = Entity(Transform({0, 0, -13}, glm::quat(glm::vec3(0)), {3.0f, 1.0f, 1.0f}));
         e4.surfaces.push_back(Surface(&tex_cube, &cube));
+        e4.surfaces[0].occluder = true; // wide box, hides what is behind it from software occlusion culling.
 
         Entity crowbar = Entity(Transform({-10, 0, 0}, glm::quat({0, 0, 0}), {0.1, 0.1, 0.1}));
         crowbar.surfaces.push_back(Surface(&crowbar_head, &crowbar_head_tex));
@@ -368,16 +453,18 @@ int main()
 
 
         Texture maxwellcat_tex = Texture();
-        if (maxwellcat_tex.LoadFromUCTEXFile("textures/maxwell.uctex"))
-        {
-            printf("loaded \"textures/maxwell.uctex\"\n");
-
-            maxwellcat_tex.SetDefaultParametres();
-            maxwellcat_tex.SetLinearSmoothing();
-        }
+        maxwellcat_tex.SetDefaultParametres();
+        maxwellcat_tex.SetLinearSmoothing();
+        if (streamer.AddTexture(&maxwellcat_tex, "textures/maxwell.uctex")) printf("streaming \"textures/maxwell.uctex\"\n");
 
         Mesh maxwellcat_mesh = Mesh();
-        if (maxwellcat_mesh.LoadFromUCMESHFile("models/maxwell_the_cat.ucmesh")) printf("loaded \"models/maxwell_the_cat.ucmesh\"\n");
+        if (maxwellcat_mesh.ReadUCMESHFile("models/maxwell_the_cat.ucmesh"))
+        {
+            // old file without LOD chain, build it at load time.
+            if (maxwellcat_mesh.GetLODsCount() == 0) maxwellcat_mesh.GenerateLODs();
+            maxwellcat_mesh.GenerateBuffers();
+            printf("loaded \"models/maxwell_the_cat.ucmesh\" (%u LODs)\n", maxwellcat_mesh.GetLODsCount());
+        }
 
         glm::vec3 maxwellcat_default_scale = glm::vec3(0.05);//glm::vec3(0.0005);
         Entity maxwellcat = Entity(Transform({0, 0, -5}, glm::quat(glm::vec3(0)), maxwellcat_default_scale));
@@ -470,35 +557,31 @@ int main()
 
 
         Texture btn4_off = Texture();
-        if (btn4_off.LoadFromUCTEXFile("textures/button/4_off.uctex"))
-        {
-            std::cout << "loaded \"textures/button/4_off.uctex\"" << std::endl;
-            btn4_off.SetDefaultParametres();
-            btn4_off.SetLinearSmoothing();
-        }
+        btn4_off.SetDefaultParametres();
+        btn4_off.SetLinearSmoothing();
+        if (packer.AddTexture(&btn4_off, "textures/button/4_off.uctex")) std::cout << "loaded \"textures/button/4_off.uctex\"" << std::endl;
 
         Texture btn4_on = Texture();
-        if (btn4_on.LoadFromUCTEXFile("textures/button/4_on.uctex"))
-        {
-            std::cout << "loaded \"textures/button/4_on.uctex\"" << std::endl;
-            btn4_on.SetDefaultParametres();
-            btn4_on.SetLinearSmoothing();
-        }
+        btn4_on.SetDefaultParametres();
+        btn4_on.SetLinearSmoothing();
+        if (packer.AddTexture(&btn4_on, "textures/button/4_on.uctex")) std::cout << "loaded \"textures/button/4_on.uctex\"" << std::endl;
 
         Texture btn3_off = Texture();
-        if (btn3_off.LoadFromUCTEXFile("textures/button/3_off.uctex"))
-        {
-            std::cout << "loaded \"textures/button/3_off.uctex\"" << std::endl;
-            btn3_off.SetDefaultParametres();
-            btn3_off.SetLinearSmoothing();
-        }
+        btn3_off.SetDefaultParametres();
+        btn3_off.SetLinearSmoothing();
+        if (packer.AddTexture(&btn3_off, "textures/button/3_off.uctex")) std::cout << "loaded \"textures/button/3_off.uctex\"" << std::endl;
 
         Texture btn3_on = Texture();
-        if (btn3_on.LoadFromUCTEXFile("textures/button/3_on.uctex"))
+        btn3_on.SetDefaultParametres();
+        btn3_on.SetLinearSmoothing();
+        if (packer.AddTexture(&btn3_on, "textures/button/3_on.uctex")) std::cout << "loaded \"textures/button/3_on.uctex\"" << std::endl;
+
         {
-            std::cout << "loaded \"textures/button/3_on.uctex\"" << std::endl;
-            btn3_on.SetDefaultParametres();
-            btn3_on.SetLinearSmoothing();
+            packer.Pack();
+
+            TexturePackerStats ps = packer.GetStats();
+            printf("Packed %u textures: %u layered, %u atlased, %u standalone (%u arrays, %u layers, %zu KiB).\n",
+                ps.texturesCount, ps.layeredCount, ps.atlasedCount, ps.standaloneCount, ps.arraysCount, ps.layersCount, ps.arraysSizeInBytes / 1024);
         }
 
 
@@ -564,81 +647,270 @@ int main()
         fogs.fogEndDistance = 20;
 
         bool f_pressed = false;
+        bool t_pressed = false;
+        bool p_pressed = false;
+        bool g_pressed = false;
+        bool h_pressed = false;
+        unsigned long long update_frame_allocations = 0;
+
+        // render order, transparent entities last.
+        Entity *scene[] = { &e, &e3, &e4, &crowbar, &e_cube_surfrottest, &relsys_e_parent, &relsys_e_child, &btn, &btn2, &maxwellcat, &e2 };
+
+        // runtime spawned props (G spawns one in front of camera, H removes oldest), addressed only by handles.
+        HandlePool<Entity> props = HandlePool<Entity>();
+        std::deque<Handle<Entity>> props_order = std::deque<Handle<Entity>>();
+
+        // data driven part of level, everything above is still built by hand.
+        Scene level = Scene();
+        if (level.LoadFromUCSCENEFile("scenes/main.ucscene")) printf("loaded \"scenes/main.ucscene\" (%zu objects)\n", level.GetObjectsCount());
+        if (level.GetPVS()->IsLoaded())
+        {
+            glm::ivec3 c = level.GetPVS()->GetCellsCount();
+            printf("loaded \"scenes/main.ucpvs\" (%dx%dx%d cells)\n", c.x, c.y, c.z);
+        }
+
+        // open world around it is streamed by cells from "scenes/world" as camera moves.
+        WorldPartition partition = WorldPartition("scenes/world", WorldPartition::GetDefaultSettings(), &jobs);
+
+        // items hidden behind occluder surfaces are dropped before submit.
+        OcclusionCuller occlusion = OcclusionCuller();
+
+        // indoor rooms (cells) joined by doorways (portals), entities added to cells are drawn only when seen through open portals.
+        PortalSystem portals = PortalSystem();
+
+        // ECS test: ring of spinning cubes that light up near camera and reverse on E, maxwellcat is visible to it through bridge.
+        struct SpinComponent { glm::vec3 angularVelocity; };
+
+        World world = World();
+        for (int i = 0; i < 64; i++)
+        {
+            float a = glm::radians(360.0f / 64 * i);
+            EntityID id = world.CreateEntity();
+            world.AddComponent<TransformComponent>(id, TransformComponent::FromTransform(Transform({glm::cos(a) * 12, -1, glm::sin(a) * 12}, glm::quat(glm::vec3(0)), glm::vec3(0.3f))));
+            world.AddComponent<SpinComponent>(id, { glm::vec3(0, glm::radians(30.0f + i * 2), 0) });
+
+            RenderableComponent r = RenderableComponent();
+            r.mesh = &cube;
+            r.texture = &tex_cube;
+            world.AddComponent<RenderableComponent>(id, r);
+
+            InteractableComponent ic = InteractableComponent();
+            ic.radius = 2;
+            world.AddComponent<InteractableComponent>(id, ic);
+        }
+        ECSSystems::BindGameObject(&world, &maxwellcat);
+
+        glm::vec3 ecs_viewer = glm::vec3(0);
+        bool ecs_use = false;
+        double ecs_time = 0;
+
+        ComponentMask transform_mask = ComponentRegistry::GetMask<TransformComponent>();
+        world.AddSystem("save transforms", 0, transform_mask, [](World *w, double) { ECSSystems::SaveTransformStates(w); });
+        world.AddSystem("sync from game objects", ComponentRegistry::GetMask<GameObjectComponent>(), transform_mask, [](World *w, double) { ECSSystems::SyncFromGameObjects(w); }, true);
+        world.AddSystem("spin", ComponentRegistry::GetMask<SpinComponent>(), transform_mask, [](World *w, double delta)
+        {
+            w->ParallelForEach<TransformComponent, SpinComponent>([delta](EntityID, TransformComponent &t, SpinComponent &s)
+            { t.rotation = glm::quat(s.angularVelocity * (float)delta) * t.rotation; });
+        });
+        world.AddSystem("interact", transform_mask, ComponentRegistry::GetMask<InteractableComponent>(), [&](World *w, double)
+        { ECSSystems::UpdateInteractables(w, ecs_viewer, ecs_use, ecs_time); });
+        world.AddSystem("react", ComponentRegistry::GetMask<InteractableComponent>(), ComponentRegistry::GetMask<RenderableComponent, SpinComponent>(), [](World *w, double)
+        {
+            w->ParallelForEach<InteractableComponent, RenderableComponent, SpinComponent>([](EntityID, InteractableComponent &i, RenderableComponent &r, SpinComponent &s)
+            {
+                r.color = i.inRange ? glm::vec4(1, 1, 0.3f, 1) : glm::vec4(1);
+                if (i.interacted) s.angularVelocity = -s.angularVelocity;
+            });
+        });
+
+        {
+            unsigned int built = shaders.FinishPending();
+            std::cout << "Compiled " << built << "/" << compiling_variants << " shader variants." << std::endl;
+            for (ShaderFeatures f : used_variants)
+                if (!shaders.HasVariant(f)) std::cout << shaders.GetVariantError(f) << std::endl;
+        }
 
         bool lmb_pressed = false;
         float lastX = windowWidth / 2, lastY = windowHeight / 2;
         glfwSetCursorPos(window, lastX, lastY);
-        glfwSetTime(0);
-        double prev_time = glfwGetTime();
+
+        FrameScheduler scheduler = FrameScheduler(TICK_RATE, VSYNC ? 0 : FPS);
+
+        // GL context belongs to render thread until renderer.Stop(), main thread only simulates and fills packets.
+        Renderer renderer = Renderer(window, &shaders, VSYNC);
+        renderer.SetFrameCallback([&](RenderPacket *packet)
+        {
+            streamer.BeginFrame(packet->camera, packet->cameraFOV, packet->viewportHeight);
+            for (RenderItem &item : packet->items) streamer.RequestRenderItem(&item);
+            streamer.Update();
+        });
+        partition.SetRenderer(&renderer);
+        renderer.Start();
+
         while (!glfwWindowShouldClose(window))
         {
-            double delta = glfwGetTime() - prev_time;
+            glfwPollEvents();
+
+            // nothing to show, don't waste CPU.
+            if (glfwGetWindowAttrib(window, GLFW_ICONIFIED))
+            {
+                glfwWaitEventsTimeout(0.1);
+                continue;
+            }
+
+            scheduler.BeginFrame();
+            double frame_delta = scheduler.GetFrameDelta();
+
+            FrameArena::GetThreadArena()->Reset();
+            unsigned long long frame_allocations_start = Memory::GetThreadAllocationStats().allocationsCount;
+
             if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) glfwSetWindowShouldClose(window, true);
-            if (delta >= 1.0f / FPS)
+
+            // ===== CONTROLS =====
+            if (glfwGetInputMode(window, GLFW_CURSOR) != GLFW_CURSOR_NORMAL)
             {
-                prev_time = glfwGetTime();
+                float speed;
+                if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) speed = cameraSpeed * 2.0;
+                else if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS) speed = cameraSpeed / 2.0;
+                else speed = cameraSpeed;
+
+                Transform *t = &cam.transform;
 
-                // ===== CONTROLS =====
-                if (glfwGetInputMode(window, GLFW_CURSOR) != GLFW_CURSOR_NORMAL)
+                if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) t->Translate(t->GetFront() * glm::vec3(speed * frame_delta));
+                if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) t->Translate(-t->GetFront() * glm::vec3(speed * frame_delta));
+                if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) t->Translate(-t->GetRight() * glm::vec3(speed * frame_delta));
+                if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) t->Translate(t->GetRight() * glm::vec3(speed * frame_delta));
+
+                if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) t->Translate(glm::vec3(0, speed * frame_delta, 0));
+                if (glfwGetKey(window, GLFW_KEY_LEFT_ALT) == GLFW_PRESS) t->Translate(glm::vec3(0, -speed * frame_delta, 0));
+
+                if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE) == GLFW_PRESS) cameraSpeed = DEFAULT_CAMERA_SPEED;
+
+                double mouseX, mouseY;
+                glfwGetCursorPos(window, &mouseX, &mouseY);
+
+                float mxoff = -glm::radians((mouseX - lastX) * MOUSE_SENSITIVITY);
+                float myoff = -glm::radians((mouseY - lastY) * MOUSE_SENSITIVITY);
                 {
-                    float speed;
-                    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) speed = cameraSpeed * 2.0;
-                    else if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS) speed = cameraSpeed / 2.0;
-                    else speed = cameraSpeed;
+                    glm::quat delta_pitch = glm::angleAxis(myoff, glm::vec3(1, 0, 0));
+                    glm::quat delta_yaw = glm::angleAxis(mxoff, glm::vec3(0, 1, 0));
 
-                    Transform *t = &cam.transform;
+                    glm::quat new_rotation = delta_yaw * t->GetRotation() * delta_pitch;
 
-                    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) t->Translate(t->GetFront() * glm::vec3(speed * delta));
-                    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) t->Translate(-t->GetFront() * glm::vec3(speed * delta));
-                    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) t->Translate(-t->GetRight() * glm::vec3(speed * delta));
-                    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) t->Translate(t->GetRight() * glm::vec3(speed * delta));
+                    glm::vec3 front = new_rotation * glm::vec3(0, 0, -1);
+                    glm::vec3 front_xz = glm::normalize(glm::vec3(front.x, 0, front.z));
 
-                    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) t->Translate(glm::vec3(0, speed * delta, 0));
-                    if (glfwGetKey(window, GLFW_KEY_LEFT_ALT) == GLFW_PRESS) t->Translate(glm::vec3(0, -speed * delta, 0));
+                    if (glm::dot(front, front_xz) >= glm::cos(glm::radians(60.0f))) t->SetRotation(new_rotation);
+                    else t->Rotate(delta_yaw);
+                }
 
-                    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE) == GLFW_PRESS) cameraSpeed = DEFAULT_CAMERA_SPEED;
+                lastX = mouseX;
+                lastY = mouseY;
 
-                    double mouseX, mouseY;
-                    glfwGetCursorPos(window, &mouseX, &mouseY);
+                if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS && !f_pressed)
+                {
+                    f_pressed = true;
 
-                    float mxoff = -glm::radians((mouseX - lastX) * MOUSE_SENSITIVITY);
-                    float myoff = -glm::radians((mouseY - lastY) * MOUSE_SENSITIVITY);
+                    AudioSourceState st = zapsrc.GetState();
+                    if (st == PAUSED)
+                    {
+                        zapsrc.Play();
+                        printf("Resumed zapsrc.\n");
+                    }
+                    else if (st == PLAYING)
                     {
-                        glm::quat delta_pitch = glm::angleAxis(myoff, glm::vec3(1, 0, 0));
-                        glm::quat delta_yaw = glm::angleAxis(mxoff, glm::vec3(0, 1, 0));
+                        zapsrc.Pause();
+                        printf("Paused zapsrc.\n");
+                    }
+                }
+                else if (glfwGetKey(window, GLFW_KEY_F) == GLFW_RELEASE && f_pressed) f_pressed = false;
 
-                        glm::quat new_rotation = delta_yaw * t->GetRotation() * delta_pitch;
+                if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS && !t_pressed)
+                {
+                    t_pressed = true;
 
-                        glm::vec3 front = new_rotation * glm::vec3(0, 0, -1);
-                        glm::vec3 front_xz = glm::normalize(glm::vec3(front.x, 0, front.z));
+                    // streamer is owned by render thread.
+                    renderer.Enqueue([&]()
+                    {
+                        TextureStreamingStats st = streamer.GetStats();
+                        printf("Texture streaming: %zu/%zu KiB resident (%zu KiB pending), %u textures, %u fully resident, %u loads, %u budget limited, %llu in / %llu out.\n",
+                            st.residentBytes / 1024, st.budgetBytes / 1024, st.pendingBytes / 1024, st.texturesCount, st.fullyResidentCount,
+                            st.pendingLoadsCount, st.budgetLimitedCount, st.streamedInCount, st.streamedOutCount);
+                    });
+                }
+                else if (glfwGetKey(window, GLFW_KEY_T) == GLFW_RELEASE && t_pressed) t_pressed = false;
 
-                        if (glm::dot(front, front_xz) >= glm::cos(glm::radians(60.0f))) t->SetRotation(new_rotation);
-                        else t->Rotate(delta_yaw);
-                    }
+                if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS && !p_pressed)
+                {
+                    p_pressed = true;
 
-                    lastX = mouseX;
-                    lastY = mouseY;
+                    FrameStats st = scheduler.GetStats();
+                    printf("Frames: %.1f fps, frame time avg %.2f / min %.2f / max %.2f / 99%% %.2f ms, busy %.2f ms, sleep overshoot %.3f ms, %llu frames, %llu ticks (%llu dropped).\n",
+                        st.fps, st.frameTimeAverage * 1000, st.frameTimeMin * 1000, st.frameTimeMax * 1000, st.frameTimePercentile99 * 1000,
+                        st.busyTimeAverage * 1000, st.sleepOvershootAverage * 1000, (unsigned long long)st.framesCount, (unsigned long long)st.ticksCount, (unsigned long long)st.droppedTicksCount);
 
-                    if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS && !f_pressed)
+                    printf("Heap allocations in last frame: %llu update, %llu render (frame arena peak %zu KiB).\n",
+                        update_frame_allocations, renderer.GetLastFrameAllocationsCount(), FrameArena::GetThreadArena()->GetPeakBytes() / 1024);
+
+                    JobSystemStats js = jobs.GetStats();
+                    printf("Jobs: %u threads, %llu scheduled, %llu executed, %llu stolen.\n", jobs.GetThreadsCount(), js.scheduledCount, js.executedCount, js.stolenCount);
+
+                    WorldStats ws = world.GetStats();
+                    printf("ECS: %zu entities, %zu archetypes, %zu chunks, %zu systems in %zu phases.\n", ws.entitiesCount, ws.archetypesCount, ws.chunksCount, ws.systemsCount, ws.phasesCount);
+
+                    WorldPartitionStats wps = partition.GetStats();
+                    printf("World partition: %u cells, %u proxies (%u loading, %u loaded, %u active, %u proxies drawn), %u assets, %zu/%zu KiB (%u cells over budget), %llu loads, %llu unloads.\n",
+                        wps.cellsCount, wps.proxiesCount, wps.loadingCount, wps.loadedCount, wps.activeCount, wps.visibleProxiesCount, wps.assetsCount,
+                        wps.residentBytes / 1024, wps.budgetBytes / 1024, wps.budgetLimitedCount, wps.loadsCount, wps.unloadsCount);
+
+                    PortalStats ps = portals.GetStats();
+                    printf("Portals: %zu cells, %zu portals, %u visits (%u/%u portals passed), %u/%u entities drawn.\n",
+                        portals.GetCellsCount(), portals.GetPortalsCount(), ps.visitsCount, ps.portalsPassed, ps.portalsTested, ps.entitiesDrawn, ps.entitiesTested);
+
+                    OcclusionCullerStats os = occlusion.GetStats();
+                    printf("Occlusion: %u occluders (%u triangles, %u binned), %u items tested, %u culled.\n",
+                        os.buffer.occludersCount, os.buffer.trianglesCount, os.buffer.binnedCount, os.testedCount, os.culledCount);
+                }
+                else if (glfwGetKey(window, GLFW_KEY_P) == GLFW_RELEASE && p_pressed) p_pressed = false;
+
+                if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS && !g_pressed)
+                {
+                    g_pressed = true;
+
+                    Transform camt = cam.GetGlobalTransform();
+                    Handle<Entity> h = props.Create(Transform(camt.GetPosition() + camt.GetFront() * glm::vec3(3), glm::quat(glm::vec3(0)), glm::vec3(0.5f)));
+                    props.Get(h)->surfaces.push_back(Surface(&cube, &tex_cube));
+                    props_order.push_back(h);
+
+                    printf("Spawned prop %u:%u (%u alive).\n", h.index, h.generation, props.GetCount());
+                }
+                else if (glfwGetKey(window, GLFW_KEY_G) == GLFW_RELEASE && g_pressed) g_pressed = false;
+
+                if (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS && !h_pressed)
+                {
+                    h_pressed = true;
+
+                    if (!props_order.empty())
                     {
-                        f_pressed = true;
-
-                        AudioSourceState st = zapsrc.GetState();
-                        if (st == PAUSED)
-                        {
-                            zapsrc.Play();
-                            printf("Resumed zapsrc.\n");
-                        }
-                        else if (st == PLAYING)
-                        {
-                            zapsrc.Pause();
-                            printf("Paused zapsrc.\n");
-                        }
+                        Handle<Entity> h = props_order.front();
+                        props_order.pop_front();
+                        props.Destroy(h);
+
+                        printf("Removed prop %u:%u (%u alive, stale handle resolves to %p).\n", h.index, h.generation, props.GetCount(), (void *)props.Get(h));
                     }
-                    else if (glfwGetKey(window, GLFW_KEY_F) == GLFW_RELEASE && f_pressed) f_pressed = false;
                 }
+                else if (glfwGetKey(window, GLFW_KEY_H) == GLFW_RELEASE && h_pressed) h_pressed = false;
+            }
+
+            // ===== MAIN =====
 
-                // ===== MAIN =====
+            while (scheduler.Tick())
+            {
+                double delta = scheduler.GetTickDelta();
+                for (Entity *ent : scene) ent->SaveTransformState();
+                props.ForEach([](Entity *ent) { ent->SaveTransformState(); });
+                level.SaveTransformStates();
+                partition.SaveTransformStates();
 
                 btn.Update(delta, &cam.transform);
                 btn2.Update(delta, &cam.transform);
@@ -675,14 +947,9 @@ int main()
                 btn2.locked = ams_run_progress != 1;
                 if (btn2.IsEnabled() && ams_run_progress < 1) btn2.SetEnabled(false);
                 btn.locked = (ams_run_progress != 0 && ams_run_progress != 1) || btn2.IsEnabled();
-                
-                //glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-                glClearColor(fogs.fogColor.x, fogs.fogColor.y, fogs.fogColor.z, 1.0f);
-                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
 
                 maxwellcat.transform.Rotate(glm::vec3(0, ams_run_progress * glm::radians(360.0f * 4 * 4) * delta, glm::radians(45.0f) * delta * (btn2.IsEnabled() ? 1 : 0)));
-                if (btn2.IsEnabled()) maxwellcat.transform.SetScale(maxwellcat_default_scale + maxwellcat_default_scale * glm::vec3(0, glm::sin(glm::radians(90 * glfwGetTime())), 0));
+                if (btn2.IsEnabled()) maxwellcat.transform.SetScale(maxwellcat_default_scale + maxwellcat_default_scale * glm::vec3(0, glm::sin(glm::radians(90 * scheduler.GetSimulationTime())), 0));
 
 
                 e_cube_surfrottest.surfaces[0].transform.Rotate(glm::vec3(glm::radians(360.0f) * delta, 0, 0));
@@ -692,34 +959,57 @@ int main()
                 
                 relsys_e_parent.transform.Rotate(glm::quat({0, glm::radians(45.0f) * delta, 0}));
 
+                props.ForEach([delta](Entity *ent) { ent->transform.Rotate(glm::vec3(0, glm::radians(90.0f) * delta, 0)); });
 
-                glm::mat4 view = cam.GetViewMatrix();
-                glm::mat4 proj = cam.GetProjectionMatrix(windowWidth, windowHeight);
-                Transform camt = cam.GetGlobalTransform();
+                ecs_viewer = cam.GetGlobalTransform().GetPosition();
+                ecs_use = glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS;
+                ecs_time = scheduler.GetSimulationTime();
+                world.RunSystems(delta, &jobs);
 
-                e.Render(&sp, &view, &proj, &camt, &fogs);
-                e3.Render(&sp, &view, &proj, &camt, &fogs);
-                e4.Render(&sp, &view, &proj, &camt, &fogs);
+                partition.Update(cam.GetGlobalTransform().GetPosition());
+            }
+            GameObject::SetInterpolationAlpha(scheduler.GetInterpolationAlpha());
 
-                crowbar.Render(&sp, &view, &proj, &camt, &fogs);
+            // ===== RENDER =====
 
-                e_cube_surfrottest.Render(&sp, &view, &proj, &camt, &fogs);
+            RenderPacket *packet = renderer.BeginPacket();
 
-                relsys_e_parent.Render(&sp, &view, &proj, &camt, &fogs);
-                relsys_e_child.Render(&sp, &view, &proj, &camt, &fogs);
+            packet->view = cam.GetViewMatrix();
+            packet->projection = cam.GetProjectionMatrix(windowWidth, windowHeight);
+            packet->camera = cam.GetGlobalTransform();
+            packet->cameraFOV = cam.GetFOV();
 
-                btn.Render(&sp, &view, &proj, &camt, &fogs);
-                btn2.Render(&sp, &view, &proj, &camt, &fogs);
+            packet->fog = fogs;
+            //packet->clearColor = glm::vec4(0.1f, 0.1f, 0.1f, 1.0f);
+            packet->clearColor = glm::vec4(fogs.fogColor, 1.0f);
 
-                maxwellcat.Render(&sp, &view, &proj, &camt, &fogs);
+            packet->viewportWidth = windowWidth;
+            packet->viewportHeight = windowHeight;
 
-                e2.Render(&sp, &view, &proj, &camt, &fogs);
-                
-                glfwSwapBuffers(window);
+            Mesh::SetLODView(packet->camera, packet->cameraFOV, windowHeight);
 
-            }
-            glfwPollEvents();
+            // props are opaque, they go before scene's transparent tail.
+            props.ForEach([packet](Entity *ent) { ent->CollectRenderItems(&packet->items); });
+            level.SetViewPosition(packet->camera.GetPosition());
+            level.CollectRenderItems(&packet->items);
+            portals.Update(packet->projection * packet->view, packet->camera.GetPosition());
+            portals.CollectRenderItems(&packet->items);
+            partition.CollectRenderItems(&packet->items);
+            ECSSystems::CollectRenderItems(&world, &packet->items, GameObject::GetInterpolationAlpha());
+            for (Entity *ent : scene) ent->CollectRenderItems(&packet->items);
+
+            occlusion.Cull(&packet->items, packet->projection * packet->view, &jobs);
+
+            renderer.SubmitPacket();
+
+            // key handlers (printing stats) allocate, they aren't steady state.
+            update_frame_allocations = Memory::GetThreadAllocationStats().allocationsCount - frame_allocations_start;
+
+            scheduler.EndFrame();
         }
+
+        // context goes back to main thread, GL objects are deleted there.
+        renderer.Stop();
     }
 
     quit:
@@ -771,6 +1061,10 @@ int initOpenGL(GLFWwindow **window)
         return 1;
     }
 
+    // optional, engine works without them.
+    initGLExtensions();
+    if (hasParallelShaderCompile()) glMaxShaderCompilerThreadsKHR(0xFFFFFFFF); // let driver choose threads count.
+
     *window = w;
     
     glViewport(0, 0, windowWidth, windowHeight);
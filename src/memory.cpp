@@ -0,0 +1,201 @@
+#include "memory.hpp"
+
+#include <cstdlib>
+#include <atomic>
+#include <algorithm>
+
+// === ALLOCATION COUNTERS ===
+
+static thread_local Memory::AllocationStats threadstats = { 0, 0, 0 };
+static std::atomic<unsigned long long> globalallocations = 0, globalbytes = 0, globalfrees = 0;
+
+static inline void countalloc(size_t size)
+{
+    threadstats.allocationsCount++;
+    threadstats.allocatedBytes += size;
+    globalallocations.fetch_add(1, std::memory_order_relaxed);
+    globalbytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+static inline void countfree()
+{
+    threadstats.freesCount++;
+    globalfrees.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void *allocate(size_t size)
+{
+    if (size == 0) size = 1;
+    void *p = std::malloc(size);
+    if (p) countalloc(size);
+    return p;
+}
+
+static void *allocatealigned(size_t size, size_t alignment)
+{
+    if (size == 0) size = 1;
+#ifdef _WIN32
+    void *p = _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc wants size multiple of alignment.
+    void *p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+    if (p) countalloc(size);
+    return p;
+}
+
+static void deallocate(void *p)
+{
+    if (!p) return;
+    countfree();
+    std::free(p);
+}
+
+static void deallocatealigned(void *p)
+{
+    if (!p) return;
+    countfree();
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void *operator new(size_t size)
+{
+    void *p = allocate(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    void *p = allocate(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    void *p = allocatealigned(size, (size_t)alignment);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size, std::align_val_t alignment)
+{
+    void *p = allocatealigned(size, (size_t)alignment);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return allocatealigned(size, (size_t)alignment); }
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return allocatealigned(size, (size_t)alignment); }
+
+void operator delete(void *p) noexcept { deallocate(p); }
+void operator delete[](void *p) noexcept { deallocate(p); }
+void operator delete(void *p, size_t) noexcept { deallocate(p); }
+void operator delete[](void *p, size_t) noexcept { deallocate(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { deallocate(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { deallocate(p); }
+
+void operator delete(void *p, std::align_val_t) noexcept { deallocatealigned(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { deallocatealigned(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { deallocatealigned(p); }
+void operator delete[](void *p, size_t, std::align_val_t) noexcept { deallocatealigned(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { deallocatealigned(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { deallocatealigned(p); }
+
+Memory::AllocationStats Memory::GetThreadAllocationStats() { return threadstats; }
+
+Memory::AllocationStats Memory::GetGlobalAllocationStats()
+{ return { globalallocations.load(std::memory_order_relaxed), globalbytes.load(std::memory_order_relaxed), globalfrees.load(std::memory_order_relaxed) }; }
+
+// === FRAME ARENA ===
+
+// === PRIVATE ===
+
+void FrameArena::newblock(size_t min_size)
+{
+    size_t size = std::max(blockSize, min_size);
+    blocks.push_back({ new uint8_t[size], size });
+}
+
+// === PUBLIC ===
+
+FrameArena::FrameArena(size_t block_size) : blockSize(block_size > 0 ? block_size : 1) {}
+
+FrameArena::~FrameArena() { for (Block &b : blocks) delete[] b.data; }
+
+void *FrameArena::Allocate(size_t size, size_t alignment)
+{
+    if (size == 0) size = 1;
+
+    while (true)
+    {
+        if (blockIndex < blocks.size())
+        {
+            Block *b = &blocks[blockIndex];
+            size_t aligned = (size_t)((uintptr_t)(b->data + offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - (size_t)(uintptr_t)b->data;
+            if (aligned + size <= b->size)
+            {
+                usedBytes += aligned + size - offset;
+                peakBytes = std::max(peakBytes, usedBytes);
+                offset = aligned + size;
+                return b->data + aligned;
+            }
+
+            // rest of block is wasted, it's fine for per-frame data.
+            if (blockIndex + 1 < blocks.size())
+            {
+                blockIndex++;
+                offset = 0;
+                continue;
+            }
+        }
+
+        newblock(size + alignment);
+        blockIndex = blocks.size() - 1;
+        offset = 0;
+    }
+}
+
+void FrameArena::Reset()
+{
+    // several blocks -> one block of total size, so next frame fits without growing.
+    if (blocks.size() > 1)
+    {
+        size_t total = GetCapacity();
+        for (Block &b : blocks) delete[] b.data;
+        blocks.clear();
+        newblock(total);
+    }
+
+    blockIndex = 0;
+    offset = 0;
+    usedBytes = 0;
+}
+
+void FrameArena::Rewind(FrameArena::Marker marker)
+{
+    blockIndex = marker.blockIndex;
+    offset = marker.offset;
+    usedBytes = marker.usedBytes;
+}
+
+size_t FrameArena::GetCapacity()
+{
+    size_t total = 0;
+    for (Block &b : blocks) total += b.size;
+    return total;
+}
+
+FrameArena *FrameArena::GetThreadArena()
+{
+    static thread_local FrameArena arena = FrameArena();
+    return &arena;
+}
@@ -0,0 +1,107 @@
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <new>
+
+/*
+    General heap (operator new) allocations counters and per-frame linear arena.
+
+    Counters are maintained by replaced global operator new/delete (memory.cpp), so they include every
+    C++ allocation (containers, std::function, strings), but not malloc() calls of C libraries (GLFW, drivers).
+*/
+namespace Memory
+{
+    struct
+    {
+        unsigned long long allocationsCount;
+        unsigned long long allocatedBytes;
+        unsigned long long freesCount;
+    } typedef AllocationStats;
+
+    // totals of calling thread since its start.
+    AllocationStats GetThreadAllocationStats();
+    // totals of all threads.
+    AllocationStats GetGlobalAllocationStats();
+}
+
+/*
+    Bump allocator for temporaries that live no longer than one frame (or one job).
+    Reset() keeps memory, and if last frame needed several blocks they are merged into one,
+    so steady state frame doesn't touch general heap at all. Deallocation is no-op.
+
+    Every thread has own arena (GetThreadArena()): update and render threads reset it on frame start,
+    job system rewinds it to marker after every job.
+*/
+class FrameArena
+{
+  private:
+    struct Block
+    {
+        uint8_t *data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks = std::vector<Block>();
+    size_t blockIndex = 0;
+    size_t offset = 0;
+    size_t blockSize;
+
+    size_t usedBytes = 0; // since last reset.
+    size_t peakBytes = 0;
+
+    void newblock(size_t min_size);
+
+  public:
+    struct Marker
+    {
+        size_t blockIndex;
+        size_t offset;
+        size_t usedBytes;
+    };
+
+    FrameArena(size_t block_size = 256 * 1024);
+    ~FrameArena();
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    void *Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    template <typename T> inline T *AllocateArray(size_t count) { return (T *)Allocate(sizeof(T) * count, alignof(T)); }
+
+    void Reset();
+    inline Marker GetMarker() { return { blockIndex, offset, usedBytes }; }
+    void Rewind(Marker marker);
+
+    inline size_t GetUsedBytes() { return usedBytes; }
+    inline size_t GetPeakBytes() { return peakBytes; }
+    size_t GetCapacity();
+
+    static FrameArena *GetThreadArena();
+};
+
+// std allocator on top of FrameArena (thread arena by default), memory is freed only by arena reset.
+template <typename T>
+class ArenaAllocator
+{
+  public:
+    typedef T value_type;
+
+    FrameArena *arena;
+
+    ArenaAllocator() : arena(FrameArena::GetThreadArena()) {}
+    ArenaAllocator(FrameArena *arena) : arena(arena) {}
+    template <typename U> ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    inline T *allocate(size_t count) { return arena->AllocateArray<T>(count); }
+    inline void deallocate(T *, size_t) {}
+
+    template <typename U> inline bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+    template <typename U> inline bool operator!=(const ArenaAllocator<U> &other) const { return arena != other.arena; }
+};
+
+template <typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif
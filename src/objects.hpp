@@ -1,26 +1,32 @@
+#ifndef OBJECTS_HPP
+#define OBJECTS_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+
+#include "opengl.hpp"
+#include "glm.hpp"
+
 #include "utils.hpp"
+#include "memory.hpp"
 
 #include "objects/ShaderProgram.hpp"
+#include "objects/ShaderVariants.hpp"
 #include "objects/Transform.hpp"
 #include "objects/GameObject.hpp"
 
 #include "audio.hpp"
 
-struct
-{
-    float x, y, z;
-    float u, v;
-} typedef UCMESHVertexInfo;
-
-struct
-{
-    unsigned int v0, v1, v2;
-} typedef UCMESHTriangleInfo;
-
-struct
-{
-    unsigned int v0, v1, v2, v3;
-} typedef UCMESHQuadInfo;
+#include "formats/UCTEXImage.hpp"
+#include "formats/UCMESHData.hpp"
+#include "geometry/MeshSimplifier.hpp"
+#include "geometry/MeshOptimizer.hpp"
+#include "geometry/Meshlets.hpp"
 
 class Mesh
 {
@@ -29,12 +35,76 @@ class Mesh
     std::vector<unsigned int> indices;
     std::vector<glm::vec2> uvs;
 
+    // quantized streams of mesh loaded from UCMESH version 2, they replace vertices and uvs until geometry is changed.
+    std::vector<uint16_t> qpositions = std::vector<uint16_t>(); // x, y, z, 0 per vertex.
+    std::vector<uint16_t> quvs = std::vector<uint16_t>();
+    UCMESHQuantization quantization = UCMESHData::GetIdentityQuantization();
+    std::vector<glm::vec3> decodedpositions = std::vector<glm::vec3>(); // of quantized mesh, made by GetPositions().
+
     bool hasbuffers = false;
     GLuint VAO, VBO_VERTEX, VBO_UV, EBO;
+    UCMESHQuantization bufferquantization = UCMESHData::GetIdentityQuantization(); // of attributes in buffers.
+    GLenum indextype = GL_UNSIGNED_INT;
+    size_t indexsize = sizeof(unsigned int);
 
     bool lockbuffers = false;
     inline void updatebuffers() { if (!lockbuffers) RegenerateBuffers(); }
 
+    glm::vec3 boundsmin = glm::vec3(0.0f), boundsmax = glm::vec3(0.0f);
+    float boundsradius = 0.0f;
+
+    // simplified versions of indices, stored in EBO right after full mesh.
+    std::vector<UCMESHLOD> lods = std::vector<UCMESHLOD>();
+
+    static inline glm::vec3 lodViewer = glm::vec3(0.0f);
+    static inline float lodPixelsPerUnit = 0.0f; // at distance 1, 0 - LODs are disabled.
+    static inline float lodThreshold = 1.0f; // max screen error in pixels.
+    static inline float lodHysteresis = 0.25f; // part of threshold that screen error must drop below to switch to coarser LOD.
+
+    // clusters of full mesh triangles (contiguous in EBO), drawn with per-cluster culling instead of LOD 0.
+    std::vector<Meshlet> meshlets = std::vector<Meshlet>();
+    MeshletCuller meshletculler = MeshletCuller();
+    static inline unsigned int meshletsMinTriangles = 4096; // meshes loaded by ReadUCMESHFile() get meshlets from that size, 0 - never.
+
+    // (offset in bytes, indices count) of LOD in EBO, lod 0 is full mesh.
+    std::pair<size_t, size_t> lodrange(unsigned int lod)
+    {
+        if (lod == 0 || lod > lods.size()) return { 0, indices.size() };
+
+        size_t offset = indices.size();
+        for (unsigned int i = 0; i < lod - 1; i++) offset += lods[i].indices.size();
+        return { offset * indexsize, lods[lod - 1].indices.size() };
+    }
+
+    inline bool quantized() { return !qpositions.empty(); }
+    inline size_t verticescount() { return quantized() ? qpositions.size() / 4 : vertices.size(); }
+    inline glm::vec3 position(size_t i) { return quantized() ? UCMESHData::DequantizePosition(quantization, &qpositions[i * 4]) : vertices[i]; }
+
+    // geometry is about to be read or changed as floats.
+    void dequantize()
+    {
+        if (!quantized()) return;
+
+        vertices.resize(qpositions.size() / 4);
+        uvs.resize(quvs.size() / 2);
+        for (size_t i = 0; i < vertices.size(); i++) vertices[i] = UCMESHData::DequantizePosition(quantization, &qpositions[i * 4]);
+        for (size_t i = 0; i < uvs.size(); i++) uvs[i] = UCMESHData::DequantizeUV(quantization, &quvs[i * 2]);
+
+        qpositions.clear();
+        quvs.clear();
+        decodedpositions.clear();
+        quantization = UCMESHData::GetIdentityQuantization();
+    }
+
+    // indices of mesh and its LODs as they are stored in EBO.
+    template <typename T>
+    std::vector<T> packindices()
+    {
+        std::vector<T> packed = std::vector<T>(indices.begin(), indices.end());
+        for (UCMESHLOD &lod : lods) packed.insert(packed.end(), lod.indices.begin(), lod.indices.end());
+        return packed;
+    }
+
   public:
     Mesh(std::vector<glm::vec3> _vertices, std::vector<unsigned int> _indices, std::vector<glm::vec2> _uvs)
     {
@@ -50,16 +120,17 @@ class Mesh
 
     inline Mesh Copy() { return *this; }
 
-    inline void ClearVertices() { vertices.clear(); DeleteBuffers(); }
-    inline void ClearIndices() { indices.clear(); DeleteBuffers(); }
-    inline void ClearUVs() { uvs.clear(); DeleteBuffers(); }
+    inline void ClearVertices() { dequantize(); vertices.clear(); DeleteBuffers(); }
+    inline void ClearIndices() { indices.clear(); lods.clear(); ClearMeshlets(); DeleteBuffers(); }
+    inline void ClearUVs() { dequantize(); uvs.clear(); DeleteBuffers(); }
     inline void ClearMesh() { ClearVertices(); ClearIndices(); ClearUVs(); }
 
-    inline void AddVertexWithUV(glm::vec3 vertex, glm::vec2 uv) { vertices.push_back(vertex); uvs.push_back(uv); }
+    inline void AddVertexWithUV(glm::vec3 vertex, glm::vec2 uv) { dequantize(); vertices.push_back(vertex); uvs.push_back(uv); }
     inline void AddVertexWithUV(float x, float y, float z, float u, float v) { AddVertexWithUV(glm::vec3(x, y, z), glm::vec2(u, v)); }
 
     void AddTriangle(unsigned int v0, unsigned int v1, unsigned int v2)
     {
+        ClearMeshlets();
         indices.push_back(v0);
         indices.push_back(v1);
         indices.push_back(v2);
@@ -78,10 +149,28 @@ class Mesh
     */
     inline void AddQuad(unsigned int v0, unsigned int v1, unsigned int v2, unsigned int v3) { AddTriangle(v3, v0, v1); AddTriangle(v1, v2, v3); }
 
-    inline std::vector<glm::vec3> GetVertices() { return vertices; }
-    inline std::vector<unsigned int> GetIndices() { return indices; }
+    // quantized mesh is converted to floats (buffers keep quantized attributes until they are regenerated).
+    inline const std::vector<glm::vec3> &GetVertices() { dequantize(); return vertices; }
+    inline const std::vector<unsigned int> &GetIndices() { return indices; }
     inline size_t GetIndicesCount() { return indices.size(); }
-    inline std::vector<glm::vec2> GetUVs() { return uvs; }
+    inline const std::vector<glm::vec2> &GetUVs() { dequantize(); return uvs; }
+
+    inline bool IsQuantized() { return quantized(); }
+    inline size_t GetVerticesCount() { return verticescount(); }
+
+    // positions for CPU-side work (occlusion), quantized mesh stays quantized and decodes them once.
+    const glm::vec3 *GetPositions()
+    {
+        if (!quantized()) return vertices.data();
+        if (decodedpositions.size() != verticescount())
+        {
+            decodedpositions.resize(verticescount());
+            for (size_t i = 0; i < decodedpositions.size(); i++) decodedpositions[i] = position(i);
+        }
+        return decodedpositions.data();
+    }
+    // positions in buffers are positionOffset + attribute * positionScale, UVs the same way (see main shader).
+    inline const UCMESHQuantization &GetBufferQuantization() { return bufferquantization; }
 
     inline bool IsBuffersLocked() { return lockbuffers; }
     inline void SetBuffersLock(bool state) { lockbuffers = state; }
@@ -91,10 +180,46 @@ class Mesh
     inline bool HasBuffers() { return hasbuffers; }
     //inline GLuint GetVAO() { return VAO; }
 
+    // local space bounds, updated on buffers generation (or manually by UpdateBounds()).
+    inline glm::vec3 GetBoundsMin() { return boundsmin; }
+    inline glm::vec3 GetBoundsMax() { return boundsmax; }
+    inline glm::vec3 GetBoundingSphereCenter() { return (boundsmin + boundsmax) * 0.5f; }
+    inline float GetBoundingSphereRadius() { return boundsradius; }
+
+    void UpdateBounds()
+    {
+        size_t count = verticescount();
+        if (count == 0)
+        {
+            boundsmin = boundsmax = glm::vec3(0.0f);
+            boundsradius = 0.0f;
+            return;
+        }
+
+        boundsmin = boundsmax = position(0);
+        for (size_t i = 0; i < count; i++)
+        {
+            glm::vec3 v = position(i);
+            boundsmin = glm::min(boundsmin, v);
+            boundsmax = glm::max(boundsmax, v);
+        }
+
+        glm::vec3 center = GetBoundingSphereCenter();
+        float r2 = 0.0f;
+        for (size_t i = 0; i < count; i++)
+        {
+            glm::vec3 d = position(i) - center;
+            r2 = glm::max(r2, glm::dot(d, d));
+        }
+        boundsradius = glm::sqrt(r2);
+    }
+
     bool GenerateBuffers()
     {
         if (hasbuffers /*|| vertices.size() == 0 || uvs.size() == 0 || indices.size() == 0*/) return false;
 
+        UpdateBounds();
+
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO_VERTEX);
         glGenBuffers(1, &VBO_UV);
@@ -102,18 +227,50 @@ class Mesh
 
         glBindVertexArray(VAO);
 
+        // quantized attributes are normalized unorm16, shader scales them back by buffer quantization.
         glBindBuffer(GL_ARRAY_BUFFER, VBO_VERTEX);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+        if (quantized())
+        {
+            glBufferData(GL_ARRAY_BUFFER, qpositions.size() * sizeof(uint16_t), qpositions.data(), GL_STATIC_DRAW);
+            glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(uint16_t) * 4, (void*)0);
+        }
+        else
+        {
+            glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+        }
         glEnableVertexAttribArray(0);
 
         glBindBuffer(GL_ARRAY_BUFFER, VBO_UV);
-        glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(glm::vec2), uvs.data(), GL_STATIC_DRAW);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+        if (quantized())
+        {
+            glBufferData(GL_ARRAY_BUFFER, quvs.size() * sizeof(uint16_t), quvs.data(), GL_STATIC_DRAW);
+            glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(uint16_t) * 2, (void*)0);
+        }
+        else
+        {
+            glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(glm::vec2), uvs.data(), GL_STATIC_DRAW);
+            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+        }
         glEnableVertexAttribArray(1);
+        bufferquantization = quantization;
 
+        // 16-bit indices are enough for most meshes and halve index fetch.
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        if (verticescount() <= 65536)
+        {
+            indextype = GL_UNSIGNED_SHORT;
+            indexsize = sizeof(uint16_t);
+            std::vector<uint16_t> packed = packindices<uint16_t>();
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, packed.size() * sizeof(uint16_t), packed.data(), GL_STATIC_DRAW);
+        }
+        else
+        {
+            indextype = GL_UNSIGNED_INT;
+            indexsize = sizeof(unsigned int);
+            std::vector<unsigned int> packed = packindices<unsigned int>();
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, packed.size() * sizeof(unsigned int), packed.data(), GL_STATIC_DRAW);
+        }
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
@@ -139,6 +296,8 @@ class Mesh
 
     void ApplyTransformation(glm::mat4 mat)
     {
+        dequantize();
+        ClearMeshlets();
         for (size_t i = 0; i < vertices.size(); i++)
         {
             glm::vec4 v = mat * glm::vec4(vertices[i].x, vertices[i].y, vertices[i].z, 0);
@@ -149,105 +308,326 @@ class Mesh
     }
     inline void ApplyTransformation(Transform t) { ApplyTransformation(t.GetTransformationMatrix()); }
 
-    bool LoadFromUCMESHFile(std::string filename)
+    // only fills vertices/indices, doesn't touch OpenGL (so can be called from any thread), GenerateBuffers() uploads them.
+    bool ReadUCMESHFile(std::string filename)
     {
-        if (!std::filesystem::is_regular_file(filename)) return false;
+        UCMESHData data = UCMESHData();
+        if (!data.LoadFromUCMESHFile(filename)) return false;
 
-        FILE *f = fopen(filename.c_str(), "rb");
-        if (!f) return false;
+        SetData(&data);
+        if (meshletsMinTriangles > 0 && indices.size() / 3 >= meshletsMinTriangles) GenerateMeshlets();
+        return true;
+    }
 
-        char sig[6];
-        fread(&sig, sizeof(char), 6, f);
-        if (feof(f) || strncmp(sig, "UCMESH", 6)) goto fileerrorquit;
+    // takes geometry out of data, old buffers are deleted and new ones are made only by GenerateBuffers().
+    // only quantized streams are kept of quantized data.
+    void SetData(UCMESHData *data)
+    {
+        ClearMesh();
+        if (data->IsQuantized())
+        {
+            qpositions = std::move(data->quantizedPositions);
+            quvs = std::move(data->quantizedUVs);
+            quantization = data->quantization;
+        }
+        else
+        {
+            vertices = std::move(data->vertices);
+            uvs = std::move(data->uvs);
+        }
+        indices = std::move(data->indices);
+        lods = std::move(data->lods);
+        data->Clear();
+    }
 
-        uint16_t version;
-        fread(&version, sizeof(version), 1, f);
-        if (feof(f) || version != 0) goto fileerrorquit;
+    bool LoadFromUCMESHFile(std::string filename)
+    {
+        if (!ReadUCMESHFile(filename)) return false;
 
-        uint32_t vertices_count;
-        fread(&vertices_count, sizeof(vertices_count), 1, f);
-        if (feof(f)) goto fileerrorquit;
+        GenerateBuffers();
+        return true;
+    }
 
-        uint32_t primitives_count;
-        fread(&primitives_count, sizeof(primitives_count), 1, f);
-        if (feof(f)) goto fileerrorquit;
+    // approximate CPU-side size of mesh data.
+    size_t GetSizeInBytes()
+    {
+        size_t size = vertices.size() * sizeof(glm::vec3) + uvs.size() * sizeof(glm::vec2) + (qpositions.size() + quvs.size()) * sizeof(uint16_t) +
+            indices.size() * sizeof(unsigned int);
+        for (UCMESHLOD &lod : lods) size += lod.indices.size() * sizeof(unsigned int);
+        return size;
+    }
 
-        ClearMesh();
-        LockBuffers();
+    // LOD 0 is full mesh, LODs 1..GetLODsCount() are simplified ones.
+    inline unsigned int GetLODsCount() { return lods.size(); }
+    inline const std::vector<UCMESHLOD> &GetLODs() { return lods; }
 
-        UCMESHVertexInfo v;
-        for (uint32_t i = 0; i < vertices_count; i++)
-        {
-            fread(&v, sizeof(v), 1, f);
-            if (feof(f)) goto readmesherrorquit;
+    // replaces LOD chain (for meshes stored without one), like SetData() it must be done before GenerateBuffers().
+    // simplified triangles come in arbitrary order, so they are reordered for vertex cache and overdraw.
+    void GenerateLODs(MeshLODSettings settings)
+    {
+        std::vector<glm::vec3> positions = std::vector<glm::vec3>(verticescount());
+        for (size_t i = 0; i < positions.size(); i++) positions[i] = position(i);
 
-            AddVertexWithUV(v.x, v.y, v.z, v.u, v.v);
+        MeshSimplifier::GenerateLODs(positions, indices, settings, &lods);
+        for (UCMESHLOD &lod : lods)
+        {
+            MeshOptimizer::OptimizeVertexCache(lod.indices.data(), lod.indices.size(), positions.size());
+            MeshOptimizer::OptimizeOverdraw(lod.indices.data(), lod.indices.size(), positions.data(), positions.size());
         }
+    }
+    inline void GenerateLODs() { GenerateLODs(MeshSimplifier::GetDefaultLODSettings()); }
+
+    // reorders full mesh triangles into meshlets, like SetData() it must be done before GenerateBuffers().
+    void GenerateMeshlets()
+    {
+        std::vector<glm::vec3> positions = std::vector<glm::vec3>(verticescount());
+        for (size_t i = 0; i < positions.size(); i++) positions[i] = position(i);
+
+        MeshletBuilder::Build(positions.data(), positions.size(), indices.data(), indices.size(), &meshlets);
+        meshletculler.SetMeshlets(meshlets.data(), meshlets.size());
+    }
+    inline void ClearMeshlets() { meshlets.clear(); meshletculler.Clear(); }
+    inline bool HasMeshlets() { return !meshlets.empty(); }
+    inline const std::vector<Meshlet> &GetMeshlets() { return meshlets; }
+
+    static inline void SetMeshletsThreshold(unsigned int min_triangles) { meshletsMinTriangles = min_triangles; }
+
+    // camera for SelectLOD(), set once per frame before collecting render items.
+    static void SetLODView(Transform cameraTransform, float fov, unsigned int screen_height)
+    {
+        lodViewer = cameraTransform.GetPosition();
+        lodPixelsPerUnit = (float)screen_height / (2.0f * glm::tan(fov / 2.0f));
+    }
+
+    static inline void SetLODThreshold(float pixels, float hysteresis) { lodThreshold = pixels; lodHysteresis = hysteresis; }
+    static inline void DisableLODs() { lodPixelsPerUnit = 0.0f; }
+
+    // coarsest LOD whose error projects to at most threshold pixels, current is LOD chosen last frame (for hysteresis).
+    unsigned int SelectLOD(unsigned int current, glm::mat4 model)
+    {
+        if (lods.empty() || lodPixelsPerUnit <= 0.0f) return 0;
+
+        float scale = glm::max(glm::length(glm::vec3(model[0])), glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        glm::vec3 center = glm::vec3(model * glm::vec4(GetBoundingSphereCenter(), 1.0f));
+        float distance = glm::length(center - lodViewer) - boundsradius * scale;
+        if (distance <= 0.0f) return 0;
 
-        uint8_t prim_type;
-        for (uint32_t i = 0; i < primitives_count; i++)
+        float pixels = scale / distance * lodPixelsPerUnit; // per mesh unit.
+        for (unsigned int i = lods.size(); i > 0; i--)
         {
-            fread(&prim_type, sizeof(prim_type), 1, f);
-            if (feof(f)) goto readmesherrorquit;
+            float threshold = i > current ? lodThreshold * (1.0f - lodHysteresis) : lodThreshold;
+            if (lods[i - 1].error * pixels <= threshold) return i;
+        }
+        return 0;
+    }
 
-            switch (prim_type)
-            {
-                case 0: // triangle.
-                    UCMESHTriangleInfo tri;
-                    fread(&tri, sizeof(tri), 1, f);
-                    if (feof(f)) goto readmesherrorquit;
+    bool RenderMesh(unsigned int lod = 0)
+    {
+        if (!HasBuffers()) return false;
 
-                    if (tri.v0 >= vertices_count || tri.v1 >= vertices_count || tri.v2 >= vertices_count) continue;
+        std::pair<size_t, size_t> range = lodrange(lod);
+        glBindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, range.second, indextype, (void *)range.first);
 
-                    AddTriangle(tri.v0, tri.v1, tri.v2);
-                    break;
+        return true;
+    }
 
-                case 1: // quad.
-                    UCMESHQuadInfo quad;
-                    fread(&quad, sizeof(quad), 1, f);
-                    if (feof(f)) goto readmesherrorquit;
+    // full mesh without meshlets that are off frustum (or back-facing if backfaces are culled), neighbouring visible
+    // meshlets are merged into one range of multi-draw. clip is projection * view * model, camera is in mesh space.
+    bool RenderMeshlets(glm::mat4 clip, glm::vec3 camera, bool backfaces)
+    {
+        if (!HasBuffers()) return false;
+        if (!HasMeshlets()) return RenderMesh(0);
 
-                    if (quad.v0 >= vertices_count || quad.v1 >= vertices_count || quad.v2 >= vertices_count || quad.v3 >= vertices_count) continue;
+        FrameArena *arena = FrameArena::GetThreadArena();
+        FrameArena::Marker marker = arena->GetMarker();
 
-                    AddQuad(quad.v0, quad.v1, quad.v2, quad.v3);
-                    break;
+        size_t count = meshlets.size();
+        uint8_t *visible = arena->AllocateArray<uint8_t>(count);
+        GLsizei *counts = arena->AllocateArray<GLsizei>(count);
+        const void **offsets = arena->AllocateArray<const void *>(count);
+        meshletculler.Cull(clip, camera, backfaces, visible);
 
-                default:
-                    goto readmesherrorquit;
+        GLsizei draws = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!visible[i]) continue;
+
+            const Meshlet &m = meshlets[i];
+            if (i > 0 && visible[i - 1]) counts[draws - 1] += m.trianglesCount * 3;
+            else
+            {
+                counts[draws] = m.trianglesCount * 3;
+                offsets[draws] = (const void *)((size_t)m.indexOffset * indexsize);
+                draws++;
             }
         }
 
-        UnlockBuffers();
-        GenerateBuffers();
+        if (draws > 0)
+        {
+            glBindVertexArray(VAO);
+            glMultiDrawElements(GL_TRIANGLES, counts, indextype, offsets, draws);
+        }
 
-        fclose(f);
+        arena->Rewind(marker);
         return true;
-
-        readmesherrorquit:
-            ClearMesh();
-            UnlockBuffers();
-        fileerrorquit:
-            fclose(f);
-        return false;
     }
 
-    bool RenderMesh()
+    // instance_buffer contains glm::mat4 per instance, it's fed to attributes 2-5 (see FEATURE_INSTANCED shader variant).
+    bool RenderMeshInstanced(GLuint instance_buffer, GLsizei count, unsigned int lod = 0)
     {
-        if (!HasBuffers()) return false;
+        if (!HasBuffers() || count <= 0) return false;
 
         glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, GetIndicesCount(), GL_UNSIGNED_INT, nullptr);
+        glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+        for (GLuint i = 0; i < 4; i++)
+        {
+            glVertexAttribPointer(2 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void *)(sizeof(glm::vec4) * i));
+            glVertexAttribDivisor(2 + i, 1);
+            glEnableVertexAttribArray(2 + i);
+        }
+
+        std::pair<size_t, size_t> range = lodrange(lod);
+        glDrawElementsInstanced(GL_TRIANGLES, range.second, indextype, (void *)range.first, count);
+
+        for (GLuint i = 0; i < 4; i++) glDisableVertexAttribArray(2 + i);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        return true;
+    }
+};
+
+#define TEXTURE_UNIT 0
+#define TEXTURE_ARRAY_UNIT 1
+
+// GL_TEXTURE_2D_ARRAY of same sized RGBA8 layers (without mips), bound to its own texture unit.
+class TextureArray
+{
+  private:
+    bool hasTexture = false;
+    GLuint texture;
+
+    uint32_t width = 0, height = 0, layers = 0;
+
+    static inline TextureArray *bound = nullptr;
+
+  public:
+    TextureArray() {}
+    ~TextureArray() { DeleteTextureArray(); }
+
+    inline bool HasTexture() { return hasTexture; }
+    inline uint32_t GetWidth() { return width; }
+    inline uint32_t GetHeight() { return height; }
+    inline uint32_t GetLayersCount() { return layers; }
+    inline size_t GetSizeInBytes() { return hasTexture ? (size_t)width * height * layers * sizeof(uint32_t) : 0; }
+
+    bool Create(uint32_t _width, uint32_t _height, uint32_t _layers)
+    {
+        if (_width == 0 || _height == 0 || _layers == 0) return false;
+
+        DeleteTextureArray();
+
+        width = _width;
+        height = _height;
+        layers = _layers;
+
+        glGenTextures(1, &texture);
+        hasTexture = true;
+
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_ARRAY_UNIT);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+        bound = nullptr;
+
+        return true;
+    }
+
+    bool SetLayer(uint32_t layer, UCTEXImage *image)
+    {
+        if (!HasTexture() || layer >= layers || image->GetWidth() != width || image->GetHeight() != height) return false;
+
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_ARRAY_UNIT);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, image->GetPixels());
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+        bound = nullptr;
+
+        return true;
+    }
+
+    bool SetTextureIntParameter(GLenum param, GLint value)
+    {
+        if (!HasTexture()) return false;
+
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_ARRAY_UNIT);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, param, value);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+        bound = nullptr;
+
+        return true;
+    }
+
+    // binds to TEXTURE_ARRAY_UNIT, does nothing if this array is bound already.
+    bool BindTextureArray()
+    {
+        if (!HasTexture()) return false;
+        if (bound == this) return true;
+
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_ARRAY_UNIT);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+        bound = this;
+
+        return true;
+    }
+
+    bool DeleteTextureArray()
+    {
+        if (!HasTexture()) return false;
+        if (bound == this) bound = nullptr;
 
+        glDeleteTextures(1, &texture);
+        hasTexture = false;
+        width = height = layers = 0;
         return true;
     }
 };
 
+class TextureStreamer;
+class TexturePacker;
+
 class Texture
 {
+    friend class TextureStreamer;
+    friend class TexturePacker;
+
   private:
     bool hasTexture = false;
     GLuint texture;
 
+    // set when texture was moved into texture array layer (or part of atlas layer) by TexturePacker.
+    TextureArray *packedarray = nullptr;
+    uint32_t packedlayer = 0;
+    glm::vec4 packedrect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f); // UV offset (xy) and scale (zw) inside of layer.
+
+    uint32_t width = 0, height = 0;
+    unsigned int levels = 0;
+
+    // remembered so they survive texture object recreation (streaming) and can be set before loading.
+    std::vector<std::pair<GLenum, GLint>> intparams = std::vector<std::pair<GLenum, GLint>>();
+
+    void applyparams()
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels > 0 ? levels - 1 : 0);
+        for (std::pair<GLenum, GLint> p : intparams) glTexParameteri(GL_TEXTURE_2D, p.first, p.second);
+    }
+
   public:
     Texture() {}
     ~Texture() { DeleteTexture(); }
@@ -255,6 +635,16 @@ class Texture
     inline Texture Copy() { return *this; }
 
     inline bool HasTexture() { return hasTexture; }
+    inline bool IsPacked() { return packedarray != nullptr; }
+    inline TextureArray *GetPackedArray() { return packedarray; }
+    inline uint32_t GetPackedLayer() { return packedlayer; }
+    inline glm::vec4 GetPackedRect() { return packedrect; }
+
+    inline uint32_t GetWidth() { return width; }
+    inline uint32_t GetHeight() { return height; }
+    inline unsigned int GetMipLevelsCount() { return levels; }
+    inline size_t GetSizeInBytes() { return hasTexture ? UCTEXImage::GetMipChainSizeInBytes(width, height, 0) - UCTEXImage::GetMipChainSizeInBytes(width, height, levels) : 0; }
+
     bool BindTexture()
     {
         if (!HasTexture()) return false;
@@ -269,142 +659,56 @@ class Texture
         if (!HasTexture()) return false;
         glDeleteTextures(1, &texture);
         hasTexture = false;
+        width = height = 0;
+        levels = 0;
         return true;
     }
 
-    bool LoadFromUCTEXFile(std::string filename)
+    // mips[0] becomes level 0, every next image must be the next mip of previous one.
+    bool LoadFromImages(UCTEXImage *mips, size_t count)
     {
-        if (!std::filesystem::is_regular_file(filename)) return false;
-
-        FILE *f = fopen(filename.c_str(), "rb");
-        if (!f) return false;
-
-        char sig[5];
-        fread(&sig, sizeof(char), 5, f);
-        if (feof(f) || strncmp(sig, "UCTEX", 5)) { fclose(f); return false; }
-
-        uint16_t version;
-        fread(&version, sizeof(version), 1, f);
-        if (feof(f) || version != 0) { fclose(f); return false; }
-
-        uint8_t type;
-        fread(&type, sizeof(type), 1, f);
-        if (feof(f) || (type > 3)) { fclose(f); return false; }
-
-        uint16_t width16, height16;
-        fread(&width16, sizeof(width16), 1, f);
-        fread(&height16, sizeof(height16), 1, f);
-        if (feof(f)) { fclose(f); return false; }
-        uint32_t width = width16 + 1;
-        uint32_t height = height16 + 1;
+        if (count == 0 || mips[0].IsEmpty()) return false;
 
         DeleteTexture();
+        packedarray = nullptr;
 
         glGenTextures(1, &texture);
         glBindTexture(GL_TEXTURE_2D, texture);
         hasTexture = true;
 
-        bool texmiss_y = false;
-        std::vector<uint32_t> pixels;
-        switch (type)
-        {
-            case 0: // RGBA (0xAABBGGRR).
-                for (uint32_t y = 0; y < height; y++)
-                {
-                    bool texmiss_x = texmiss_y;
-                    for (uint32_t x = 0; x < width; x++)
-                    {
-                        uint32_t pixel;
-                        fread(&pixel, sizeof(uint32_t), 1, f);
-                        if (feof(f))
-                        {
-                            if (texmiss_x) pixel = 0xFFFF00FF;
-                            else pixel = 0xFF000000;
-                        }
-                        pixels.push_back(pixel);
-
-                        texmiss_x = !texmiss_x;
-                    }
-                    texmiss_y = !texmiss_y;
-                }
-                break;
+        width = mips[0].GetWidth();
+        height = mips[0].GetHeight();
+        levels = count;
 
-            case 1: // RGB (0xBBGGRR).
-                for (uint32_t y = 0; y < height; y++)
-                {
-                    bool texmiss_x = texmiss_y;
-                    for (uint32_t x = 0; x < width; x++)
-                    {
-                        uint8_t r, g, b;
-                        fread(&r, sizeof(uint8_t), 1, f);
-                        fread(&g, sizeof(uint8_t), 1, f);
-                        fread(&b, sizeof(uint8_t), 1, f);
-                        if (feof(f))
-                        {
-                            if (texmiss_x) { r = 0; g = 255; b = 0; }
-                            else { r = 255; g = 255; b = 255; }
-                        }
-                        pixels.push_back((0xFF << 24) | (b << 16) | (g << 8) | r);
-
-                        texmiss_x = !texmiss_x;
-                    }
-                    texmiss_y = !texmiss_y;
-                }
-                break;
-            
-            case 2: // 16-bit depth RGBA (1 bit alpha). (0bABBBBBGGGGGRRRRR)
-                for (uint32_t y = 0; y < height; y++)
-                {
-                    bool texmiss_x = texmiss_y;
-                    for (uint32_t x = 0; x < width; x++)
-                    {
-                        uint16_t pixel;
-                        fread(&pixel, sizeof(uint16_t), 1, f);
-                        if (feof(f))
-                        {
-                            if (texmiss_x) pixel = 0b1000001111111111;
-                            else pixel = 0b1111110000000000;
-                        }
-                        pixels.push_back((((pixel >> 15) * 255) << 24) | ((pixel & 0b11111) << 3) | ((pixel & (0b11111 << 5)) << 6) | ((pixel & (0b11111 << 10)) << 9));
-
-                        texmiss_x = !texmiss_x;
-                    }
-                    texmiss_y = !texmiss_y;
-                }
-                break;
-
-            case 3: // 16-bit depth RGB (0b0BBBBBGGGGGRRRRR).
-                for (uint32_t y = 0; y < height; y++)
-                {
-                    bool texmiss_x = texmiss_y;
-                    for (uint32_t x = 0; x < width; x++)
-                    {
-                        uint16_t pixel;
-                        fread(&pixel, sizeof(uint16_t), 1, f);
-                        if (feof(f))
-                        {
-                            if (texmiss_x) pixel = 0b0111111111100000;
-                            else pixel = 0b0000000000011111;
-                        }
-                        pixels.push_back((0xFF << 24) | ((pixel & 0b11111) << 3) | ((pixel & (0b11111 << 5)) << 6) | ((pixel & (0b11111 << 10)) << 9));
-
-                        texmiss_x = !texmiss_x;
-                    }
-                    texmiss_y = !texmiss_y;
-                }
-                break;
-        }
-
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        for (size_t i = 0; i < count; i++)
+            glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, mips[i].GetWidth(), mips[i].GetHeight(), 0, GL_RGBA, GL_UNSIGNED_BYTE, mips[i].GetPixels());
 
+        applyparams();
         glBindTexture(GL_TEXTURE_2D, 0);
-        fclose(f);
 
         return true;
     }
+    inline bool LoadFromImage(UCTEXImage *image) { return LoadFromImages(image, 1); }
+
+    // mips stored in file are loaded too, none are generated.
+    bool LoadFromUCTEXFile(std::string filename)
+    {
+        UCTEXHeader header;
+        std::vector<UCTEXImage> mips = std::vector<UCTEXImage>();
+        if (!UCTEXImage::ReadUCTEXHeader(filename, &header) || !UCTEXImage::LoadMipsFromUCTEXFile(filename, 0, header.levels, &mips)) return false;
+
+        return LoadFromImages(mips.data(), mips.size());
+    }
 
     bool SetTextureIntParameter(GLenum param, GLint value)
     {
+        bool found = false;
+        for (std::pair<GLenum, GLint> &p : intparams)
+        {
+            if (p.first == param) { p.second = value; found = true; break; }
+        }
+        if (!found) intparams.push_back(std::pair<GLenum, GLint>(param, value));
+
         if (!HasTexture()) return false;
 
         glBindTexture(GL_TEXTURE_2D, texture);
@@ -449,6 +753,9 @@ class Surface
     Transform transform = Transform();
     glm::vec4 color = glm::vec4(1.0f);
     bool enableRender = true;
+    float alphaCutoff = 0.0f; // fragments with lower alpha are discarded (0 - disabled).
+    unsigned int lod = 0; // chosen by Mesh::SelectLOD() on collection.
+    bool occluder = false; // rendered into software depth buffer (see OcclusionCuller), for big closed meshes like walls.
 
     Surface(Transform tr, Texture *t, Mesh *m, FaceCullingType c)
     { transform = tr; texture = t; mesh = m; culling = c; }
@@ -564,8 +871,63 @@ struct
     glm::vec3 fogColor;
 } typedef FogRenderSettings;
 
+// snapshot of one surface for deferred drawing (see Renderer), pointed mesh and texture must outlive it.
+struct
+{
+    Mesh *mesh;
+    Texture *texture;
+    glm::mat4 model;
+    glm::vec4 color;
+    FaceCullingType culling;
+    float alphaCutoff;
+    unsigned int lod;
+    bool occluder;
+} typedef RenderItem;
+
 class Entity : public GameObject
 {
+  private:
+    static void setframeuniforms(ShaderProgram *sp, glm::mat4 *view, glm::mat4 *projection, Transform *cameraTransform, FogRenderSettings *fogRenderSettings)
+    {
+        sp->SetUniformMatrix4x4("projection", *projection);
+        sp->SetUniformMatrix4x4("view", *view);
+
+        sp->SetUniformInteger("mainTexture", TEXTURE_UNIT);
+        sp->SetUniformInteger("textureArray", TEXTURE_ARRAY_UNIT);
+
+        sp->SetUniformVector3("cameraPosition", cameraTransform->GetPosition());
+
+        sp->SetUniformFloat("fogStartDistance", fogRenderSettings->fogStartDistance);
+        sp->SetUniformFloat("fogEndDistance", fogRenderSettings->fogEndDistance);
+        sp->SetUniformVector3("fogColor", fogRenderSettings->fogColor);
+    }
+
+    static ShaderFeatures getfeatures(Texture *texture, float alphacutoff, FogRenderSettings *fogRenderSettings)
+    {
+        ShaderFeatures features = SHADER_FEATURE_NONE;
+
+        if (texture && texture->IsPacked()) features |= SHADER_FEATURE_TEXTURE_ARRAY;
+        else if (texture && texture->HasTexture()) features |= SHADER_FEATURE_TEXTURED;
+
+        if (fogRenderSettings && fogRenderSettings->fogEnabled) features |= SHADER_FEATURE_FOG;
+        if (alphacutoff > 0.0f) features |= SHADER_FEATURE_ALPHA_TEST;
+
+        return features;
+    }
+
+    void render(ShaderProgram *fixedsp, ShaderVariants *variants, glm::mat4 *view, glm::mat4 *projection, Transform *cameraTransform, FogRenderSettings *fogRenderSettings)
+    {
+        FrameArena *arena = FrameArena::GetThreadArena();
+        FrameArena::Marker marker = arena->GetMarker();
+        {
+            ArenaVector<RenderItem> items = ArenaVector<RenderItem>(ArenaAllocator<RenderItem>(arena));
+            items.reserve(surfaces.size());
+            CollectRenderItems(&items);
+            RenderItems(items.data(), items.size(), fixedsp, variants, view, projection, cameraTransform, fogRenderSettings);
+        }
+        arena->Rewind(marker);
+    }
+
   public:
     const GameObjectType type = ENTITY;
 
@@ -578,45 +940,73 @@ class Entity : public GameObject
 
     ~Entity() {}
 
-    void Render(ShaderProgram *sp, glm::mat4 *view, glm::mat4 *projection, Transform *cameraTransform, FogRenderSettings *fogRenderSettings)
-    {
-        if (!enableRender) return;
+    // minimal shader variant that can draw given surface.
+    static ShaderFeatures GetSurfaceShaderFeatures(Surface *surface, FogRenderSettings *fogRenderSettings)
+    { return getfeatures(surface->GetTexture(), surface->alphaCutoff, fogRenderSettings); }
 
-        sp->UseThisProgram();
+    static ShaderFeatures GetRenderItemShaderFeatures(RenderItem *item, FogRenderSettings *fogRenderSettings)
+    { return getfeatures(item->texture, item->alphaCutoff, fogRenderSettings); }
 
-        sp->SetUniformMatrix4x4("projection", *projection);
-        sp->SetUniformMatrix4x4("view", *view);
-
-        sp->SetUniformInteger("texture", 0);
-        glActiveTexture(GL_TEXTURE0);
-
-        sp->SetUniformVector3("cameraPosition", cameraTransform->GetPosition());
-        sp->SetUniformVector3("cameraRotation", glm::eulerAngles(cameraTransform->GetRotation()));
-
-        sp->SetUniformVector3("cameraFront", cameraTransform->GetFront());
-        sp->SetUniformVector3("cameraUp", cameraTransform->GetUp());
-        sp->SetUniformVector3("cameraRight", cameraTransform->GetRight());
-
-        sp->SetUniformInteger("fogEnabled", fogRenderSettings->fogEnabled ? GL_TRUE : GL_FALSE);
-        sp->SetUniformFloat("fogStartDistance", fogRenderSettings->fogStartDistance);
-        sp->SetUniformFloat("fogEndDistance", fogRenderSettings->fogEndDistance);
-        sp->SetUniformVector3("fogColor", fogRenderSettings->fogColor);
+    // appends drawable surfaces with their final (interpolated) model matrices, doesn't touch GL.
+    // items is std::vector or ArenaVector of RenderItem.
+    template <typename Vector>
+    void CollectRenderItems(Vector *items)
+    {
+        if (!enableRender) return;
 
-        for (Surface surface : surfaces)
+        glm::mat4 model = GetInterpolatedGlobalTransform().GetTransformationMatrix();
+        for (Surface &surface : surfaces)
         {
             if (!surface.enableRender) continue;
 
-            Texture *texture = surface.GetTexture();
             Mesh *mesh = surface.GetMesh();
             FaceCullingType culling = surface.GetFaceCullingType();
             if (!(mesh && mesh->HasBuffers() && culling != BothFaces)) continue;
 
-            if (culling == NoCulling) glDisable(GL_CULL_FACE);
+            //model = GetParentGlobalTransform().GetTransformationMatrix() * transform.GetTransformationMatrix() * surface.transform.GetTransformationMatrix();
+            glm::mat4 surfacemodel = model * surface.transform.GetTransformationMatrix();
+            surface.lod = mesh->SelectLOD(surface.lod, surfacemodel);
+            items->push_back({ mesh, surface.GetTexture(), surfacemodel, color * surface.color, culling, surface.alphaCutoff, surface.lod, surface.occluder });
+        }
+    }
+
+    // fixedsp == nullptr -> program is chosen per item from variants.
+    static void RenderItems(RenderItem *items, size_t count, ShaderProgram *fixedsp, ShaderVariants *variants, glm::mat4 *view, glm::mat4 *projection, Transform *cameraTransform, FogRenderSettings *fogRenderSettings)
+    {
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+
+        ShaderProgram *current = nullptr;
+        Mesh *currentmesh = nullptr;
+        for (size_t i = 0; i < count; i++)
+        {
+            RenderItem *item = &items[i];
+            Texture *texture = item->texture;
+
+            ShaderProgram *sp = fixedsp ? fixedsp : variants->GetVariant(GetRenderItemShaderFeatures(item, fogRenderSettings));
+            if (!sp) continue;
+            if (sp != current)
+            {
+                sp->UseThisProgram();
+                setframeuniforms(sp, view, projection, cameraTransform, fogRenderSettings);
+                current = sp;
+                currentmesh = nullptr;
+            }
+
+            if (item->mesh != currentmesh)
+            {
+                const UCMESHQuantization &q = item->mesh->GetBufferQuantization();
+                sp->SetUniformVector3("positionOffset", glm::vec3(q.positionOffset[0], q.positionOffset[1], q.positionOffset[2]));
+                sp->SetUniformVector3("positionScale", glm::vec3(q.positionScale[0], q.positionScale[1], q.positionScale[2]));
+                sp->SetUniformVector4("uvTransform", glm::vec4(q.uvOffset[0], q.uvOffset[1], q.uvScale[0], q.uvScale[1]));
+                currentmesh = item->mesh;
+            }
+
+            if (item->culling == NoCulling) glDisable(GL_CULL_FACE);
             else
             {
                 glEnable(GL_CULL_FACE);
 
-                switch (culling)
+                switch (item->culling)
                 {
                     case BackFace:
                         glCullFace(GL_BACK);
@@ -625,23 +1015,43 @@ class Entity : public GameObject
                     case FrontFace:
                         glCullFace(GL_FRONT);
                         break;
+
+                    default: // BothFaces is never collected.
+                        break;
                 }
             }
 
-            if (texture && texture->HasTexture())
+            if (texture && texture->IsPacked())
             {
-                sp->SetUniformInteger("hasTexture", GL_TRUE);
-                texture->BindTexture();
+                sp->SetUniformFloat("textureLayer", texture->GetPackedLayer());
+                sp->SetUniformVector4("textureRect", texture->GetPackedRect());
+                texture->GetPackedArray()->BindTextureArray();
             }
-            else sp->SetUniformInteger("hasTexture", GL_FALSE);
+            else if (texture && texture->HasTexture()) texture->BindTexture();
+
+            if (item->alphaCutoff > 0.0f) sp->SetUniformFloat("alphaCutoff", item->alphaCutoff);
 
-            //sp->SetUniformMatrix4x4("model", GetParentGlobalTransform().GetTransformationMatrix() * transform.GetTransformationMatrix() * surface.transform.GetTransformationMatrix());
-            sp->SetUniformMatrix4x4("model", GetGlobalTransform().GetTransformationMatrix() * surface.transform.GetTransformationMatrix());
-            sp->SetUniformVector4("color", color * surface.color);
+            sp->SetUniformMatrix4x4("model", item->model);
+            sp->SetUniformVector4("color", item->color);
 
-            mesh->RenderMesh();
+            if (item->lod == 0 && item->mesh->HasMeshlets())
+            {
+                // mirroring model flips winding, so normal cones can't be trusted then.
+                bool backfaces = item->culling == BackFace && glm::determinant(glm::mat3(item->model)) > 0.0f;
+                glm::vec3 camera = glm::vec3(glm::inverse(item->model) * glm::vec4(cameraTransform->GetPosition(), 1.0f));
+                item->mesh->RenderMeshlets(*projection * *view * item->model, camera, backfaces);
+            }
+            else item->mesh->RenderMesh(item->lod);
         }
     }
+
+    // one program for all surfaces (it has to handle every case itself).
+    inline void Render(ShaderProgram *sp, glm::mat4 *view, glm::mat4 *projection, Transform *cameraTransform, FogRenderSettings *fogRenderSettings)
+    { render(sp, nullptr, view, projection, cameraTransform, fogRenderSettings); }
+
+    // every surface is drawn with its minimal variant.
+    inline void Render(ShaderVariants *variants, glm::mat4 *view, glm::mat4 *projection, Transform *cameraTransform, FogRenderSettings *fogRenderSettings)
+    { render(nullptr, variants, view, projection, cameraTransform, fogRenderSettings); }
 };
 
 class Camera : public GameObject
@@ -683,4 +1093,6 @@ class Camera : public GameObject
     { return glm::lookAt(transform.GetPosition(), transform.GetPosition() + transform.GetFront(), transform.GetUp()); }
     inline glm::mat4 GetProjectionMatrix(unsigned int screen_width, unsigned int screen_height)
     { return glm::perspective(fov, (float)screen_width / (float)screen_height, neardist, fardist); }
-};
\ No newline at end of file
+};
+
+#endif
@@ -0,0 +1,153 @@
+#include "FrameScheduler.hpp"
+
+#include <thread>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <timeapi.h>
+#endif
+
+// === PRIVATE ===
+
+double FrameScheduler::seconds(clock::duration d) { return std::chrono::duration<double>(d).count(); }
+
+void FrameScheduler::wait(clock::time_point deadline)
+{
+    while (true)
+    {
+        clock::time_point now = clock::now();
+        double remaining = seconds(deadline - now);
+        if (remaining <= 0) return;
+
+        if (remaining > spinThreshold)
+        {
+            double asked = remaining - spinThreshold;
+            std::this_thread::sleep_for(std::chrono::duration<double>(asked));
+
+            // adapt threshold to actual timer granularity.
+            double overshoot = std::max(0.0, seconds(clock::now() - now) - asked);
+            sleepOvershoot = sleepOvershoot * 0.9 + overshoot * 0.1;
+            spinThreshold = std::clamp(sleepOvershoot * 2.0, 0.0005, 0.004);
+        }
+        else std::this_thread::yield();
+    }
+}
+
+void FrameScheduler::pushstats(double frametime, double busytime)
+{
+    if (frameTimes.size() < STATS_WINDOW)
+    {
+        frameTimes.push_back(frametime);
+        busyTimes.push_back(busytime);
+    }
+    else
+    {
+        frameTimes[statsCursor] = frametime;
+        busyTimes[statsCursor] = busytime;
+        statsCursor = (statsCursor + 1) % STATS_WINDOW;
+    }
+    framesCount++;
+}
+
+// === PUBLIC ===
+
+FrameScheduler::FrameScheduler(double tick_rate, double max_fps)
+{
+    tickDelta = tick_rate > 0 ? 1.0 / tick_rate : 1.0 / 60;
+    SetMaxFPS(max_fps);
+
+#ifdef _WIN32
+    // default scheduler granularity is ~15.6 ms, which is whole frame.
+    timeBeginPeriod(1);
+#endif
+
+    startTime = clock::now();
+}
+
+FrameScheduler::~FrameScheduler()
+{
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+}
+
+double FrameScheduler::GetTime() { return seconds(clock::now() - startTime); }
+
+void FrameScheduler::BeginFrame()
+{
+    clock::time_point now = clock::now();
+    if (!started)
+    {
+        started = true;
+        frameStart = nextDeadline = now;
+        frameDelta = 0;
+        return;
+    }
+
+    frameDelta = seconds(now - frameStart);
+    frameStart = now;
+
+    accumulator += frameDelta;
+
+    // long stall (loading, window dragging) mustn't cause burst of ticks.
+    double maxaccumulated = tickDelta * maxTicksPerFrame;
+    if (accumulator > maxaccumulated)
+    {
+        droppedTicks += (uint64_t)((accumulator - maxaccumulated) / tickDelta);
+        accumulator = maxaccumulated;
+    }
+}
+
+bool FrameScheduler::Tick()
+{
+    if (accumulator < tickDelta) return false;
+
+    accumulator -= tickDelta;
+    ticks++;
+    return true;
+}
+
+void FrameScheduler::EndFrame()
+{
+    clock::time_point workend = clock::now();
+    double busytime = seconds(workend - frameStart);
+
+    if (maxFPS > 0)
+    {
+        clock::duration period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / maxFPS));
+
+        // fixed deadlines keep average rate exact, but missed ones aren't caught up.
+        nextDeadline += period;
+        if (nextDeadline < workend) nextDeadline = workend;
+        else wait(nextDeadline);
+    }
+
+    pushstats(seconds(clock::now() - frameStart), busytime);
+}
+
+FrameStats FrameScheduler::GetStats()
+{
+    FrameStats st = FrameStats();
+    st.framesCount = framesCount;
+    st.ticksCount = ticks;
+    st.droppedTicksCount = droppedTicks;
+    st.sleepOvershootAverage = sleepOvershoot;
+    if (frameTimes.empty()) return st;
+
+    std::vector<double> sorted = frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0, busysum = 0;
+    for (double t : frameTimes) sum += t;
+    for (double t : busyTimes) busysum += t;
+
+    st.frameTimeAverage = sum / frameTimes.size();
+    st.frameTimeMin = sorted.front();
+    st.frameTimeMax = sorted.back();
+    st.frameTimePercentile99 = sorted[std::min(sorted.size() - 1, (size_t)(sorted.size() * 0.99))];
+    st.busyTimeAverage = busysum / busyTimes.size();
+    st.fps = st.frameTimeAverage > 0 ? 1.0 / st.frameTimeAverage : 0;
+
+    return st;
+}
@@ -0,0 +1,96 @@
+#ifndef FRAMESCHEDULER_HPP
+#define FRAMESCHEDULER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+struct
+{
+    uint64_t framesCount;
+    uint64_t ticksCount;
+    uint64_t droppedTicksCount; // ticks skipped because frame was too long (simulation slowed down).
+
+    // over last frames window, in seconds.
+    double frameTimeAverage;
+    double frameTimeMin;
+    double frameTimeMax;
+    double frameTimePercentile99;
+    double busyTimeAverage; // part of frame spent on work (not waiting).
+    double sleepOvershootAverage; // how late OS sleep wakes up.
+
+    double fps;
+} typedef FrameStats;
+
+/*
+    Main loop pacing:
+        - simulation runs with fixed tick (while (scheduler.Tick()) { ... }), so physics and animations don't depend on frame rate;
+        - rendering uses GetInterpolationAlpha() to blend between two last ticks;
+        - EndFrame() waits until next frame deadline, sleeping most of time and spinning only last bit
+          (sleep granularity is measured at runtime), so idle loop doesn't hold CPU core.
+
+    maxFPS == 0 means no waiting at all (useful with vsync, when glfwSwapBuffers() already blocks).
+*/
+class FrameScheduler
+{
+  private:
+    typedef std::chrono::steady_clock clock;
+
+    double tickDelta;
+    double maxFPS;
+    unsigned int maxTicksPerFrame = 5;
+
+    clock::time_point startTime;
+    clock::time_point frameStart;
+    clock::time_point nextDeadline;
+    bool started = false;
+
+    double frameDelta = 0;
+    double accumulator = 0;
+    uint64_t ticks = 0;
+
+    // sleep_for() may return this much later than asked, last part of wait is spun.
+    double spinThreshold = 0.002;
+
+    static const unsigned int STATS_WINDOW = 128;
+    std::vector<double> frameTimes = std::vector<double>();
+    std::vector<double> busyTimes = std::vector<double>();
+    unsigned int statsCursor = 0;
+    uint64_t framesCount = 0;
+    uint64_t droppedTicks = 0;
+    double sleepOvershoot = 0;
+
+    static double seconds(clock::duration d);
+    void wait(clock::time_point deadline);
+    void pushstats(double frametime, double busytime);
+
+  public:
+    FrameScheduler(double tick_rate = 60, double max_fps = 60);
+    ~FrameScheduler();
+
+    // starts new frame, measures time passed since previous one.
+    void BeginFrame();
+    // returns true while there is simulation tick to run in this frame.
+    bool Tick();
+    // finishes frame, waits for next frame deadline.
+    void EndFrame();
+
+    inline double GetTickDelta() { return tickDelta; }
+    inline double GetFrameDelta() { return frameDelta; }
+    inline uint64_t GetTicksCount() { return ticks; }
+    // simulation time, advances only by ticks.
+    inline double GetSimulationTime() { return ticks * tickDelta; }
+    double GetTime();
+
+    // 0..1, part of tick passed after last simulated one.
+    inline float GetInterpolationAlpha() { return tickDelta > 0 ? (float)(accumulator / tickDelta) : 1.0f; }
+
+    inline double GetMaxFPS() { return maxFPS; }
+    inline void SetMaxFPS(double fps) { maxFPS = fps > 0 ? fps : 0; }
+    inline unsigned int GetMaxTicksPerFrame() { return maxTicksPerFrame; }
+    inline void SetMaxTicksPerFrame(unsigned int count) { maxTicksPerFrame = count > 0 ? count : 1; }
+
+    FrameStats GetStats();
+};
+
+#endif
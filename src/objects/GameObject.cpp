@@ -1,16 +1,49 @@
 #include "GameObject.hpp"
 
-#include <algorithm>
-#include <iterator>
-
 #include <iostream>
 
 // === PRIVATE ===
 
-void GameObject::OnLocalTransformChanged() { OnGlobalTransformChanged(); }
-void GameObject::OnParentTransformChanged() { OnGlobalTransformChanged(); }
+void GameObject::unlink()
+{
+    if (!parent) return;
+
+    if (prevSibling) prevSibling->nextSibling = nextSibling;
+    else parent->firstChild = nextSibling;
+
+    if (nextSibling) nextSibling->prevSibling = prevSibling;
+    else parent->lastChild = prevSibling;
+
+    parent->childrenCount--;
+    prevSibling = nextSibling = nullptr;
+    parent = nullptr;
+}
+
+void GameObject::link(GameObject *new_parent)
+{
+    parent = new_parent;
+    if (!parent) return;
+
+    prevSibling = parent->lastChild;
+    nextSibling = nullptr;
+
+    if (prevSibling) prevSibling->nextSibling = this;
+    else parent->firstChild = this;
 
-void GameObject::OnGlobalTransformChanged() { for (GameObject *obj : children) obj->OnParentTransformChanged(); }
+    parent->lastChild = this;
+    parent->childrenCount++;
+}
+
+void GameObject::invalidateglobal()
+{
+    globalTransformDirty = true;
+    for (GameObject *obj = firstChild; obj; obj = obj->nextSibling) obj->invalidateglobal();
+}
+
+void GameObject::OnLocalTransformChanged() { globalTransformDirty = true; OnGlobalTransformChanged(); }
+void GameObject::OnParentTransformChanged() { globalTransformDirty = true; OnGlobalTransformChanged(); }
+
+void GameObject::OnGlobalTransformChanged() { for (GameObject *obj = firstChild; obj; obj = obj->nextSibling) obj->OnParentTransformChanged(); }
 
 // === PUBLIC ===
 
@@ -20,37 +53,56 @@ GameObject::GameObject() : transform(this) { /*OnLocalTransformChanged();*/ }
 GameObject::~GameObject()
 {
     SetParent(nullptr, false);
-    for (GameObject *obj : children) obj->SetParent(nullptr);
+    // SetParent() unlinks child from this list, so always take the head.
+    while (firstChild) firstChild->SetParent(nullptr);
 }
 
 //GameObject GameObject::Copy() { return *this; }
 
 size_t GameObject::SetParent(GameObject *new_parent, bool save_global_pos)
 {
-    size_t index = -1; // yea, i know that size_t is an unsigned type, but vector can't contain 2^64 - 1 elements, so i can use that magic number as "special return code/value".
+    size_t index = -1; // yea, i know that size_t is an unsigned type, but no object can have 2^64 - 1 children, so i can use that magic number as "special return code/value".
     if (new_parent == this) return -1;
-    
-    if (parent) parent->children.erase(std::remove(parent->children.begin(), parent->children.end(), this), parent->children.end());
-    if (new_parent)
-    {
-        new_parent->children.push_back(this);
-        index = new_parent->children.size() - 1;
-    }
+
+    Transform globt = save_global_pos ? GetGlobalTransform() : Transform();
+
+    unlink();
+    link(new_parent);
+    if (new_parent) index = new_parent->childrenCount - 1;
 
     OnParentTransformChanged();
 
-    if (save_global_pos)
-    {
-        Transform globt = GetGlobalTransform();
-        transform = globt.GlobalToLocal(new_parent->GetGlobalTransform()); //globt - new_parent->GetGlobalTransform();
-    }
+    if (save_global_pos) transform = new_parent ? globt.GlobalToLocal(new_parent->GetGlobalTransform()) : globt; //globt - new_parent->GetGlobalTransform();
 
-    parent = new_parent;
+    invalidateglobal();
     return index;
 }
 
-Transform GameObject::GetParentGlobalTransform()
-{ return parent ? (Transform)parent->transform.LocalToGlobal(parent->GetParentGlobalTransform()) : Transform(); }
+Transform GameObject::GetParentGlobalTransform() { return parent ? parent->GetGlobalTransform() : Transform(); }
 
 Transform GameObject::GetGlobalTransform()
-{ return (Transform)transform.LocalToGlobal(GetParentGlobalTransform()); }
\ No newline at end of file
+{
+    if (globalTransformDirty)
+    {
+        globalTransform = transform.LocalToGlobal(parent ? parent->GetGlobalTransform() : Transform());
+        globalTransformDirty = false;
+    }
+    return globalTransform;
+}
+
+void GameObject::SaveTransformState()
+{
+    previousTransform = transform.Copy();
+    hasPreviousTransform = true;
+}
+
+void GameObject::ResetTransformState() { hasPreviousTransform = false; }
+
+Transform GameObject::GetInterpolatedTransform()
+{ return hasPreviousTransform ? Transform::Interpolate(previousTransform, transform.Copy(), interpolationAlpha) : transform.Copy(); }
+
+Transform GameObject::GetInterpolatedGlobalTransform()
+{ return GetInterpolatedTransform().LocalToGlobal(parent ? parent->GetInterpolatedGlobalTransform() : Transform()); }
+
+void GameObject::SetInterpolationAlpha(float alpha) { interpolationAlpha = glm::clamp(alpha, 0.0f, 1.0f); }
+float GameObject::GetInterpolationAlpha() { return interpolationAlpha; }
\ No newline at end of file
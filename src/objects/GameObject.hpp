@@ -22,8 +22,27 @@ class GameObject
     friend class GameObjectTransform;
 
     protected:
+        // children are intrusive doubly linked list, so unlinking child doesn't search or shift anything.
         GameObject *parent = nullptr;
-        std::vector<GameObject *> children = std::vector<GameObject *>();
+        GameObject *firstChild = nullptr;
+        GameObject *lastChild = nullptr;
+        GameObject *prevSibling = nullptr;
+        GameObject *nextSibling = nullptr;
+        size_t childrenCount = 0;
+
+        void unlink();
+        void link(GameObject *new_parent);
+
+        // parent chain is walked only after something in it has changed.
+        Transform globalTransform = Transform();
+        bool globalTransformDirty = true;
+        void invalidateglobal();
+
+        // local transform at the start of current simulation tick.
+        Transform previousTransform = Transform();
+        bool hasPreviousTransform = false;
+
+        static inline float interpolationAlpha = 1.0f;
 
         virtual void OnLocalTransformChanged();
         virtual void OnParentTransformChanged();
@@ -41,9 +60,31 @@ class GameObject
 
         //GameObject Copy();
 
+        // returns index of object among new parent's children (it's always last one), -1 when unparented.
         size_t SetParent(GameObject *new_parent, bool save_global_pos = true);
+
+        inline GameObject *GetParent() { return parent; }
+        inline GameObject *GetFirstChild() { return firstChild; }
+        inline GameObject *GetNextSibling() { return nextSibling; }
+        inline size_t GetChildrenCount() { return childrenCount; }
+
         Transform GetParentGlobalTransform();
         Transform GetGlobalTransform();
+
+        /*
+            Fixed timestep interpolation: SaveTransformState() is called before every simulation tick,
+            render uses transform interpolated between saved and current one by global alpha (see FrameScheduler).
+            Objects that never saved state are rendered as is.
+        */
+        void SaveTransformState();
+        // forget previous state (e.g. after teleport) so object doesn't slide from old place.
+        void ResetTransformState();
+
+        Transform GetInterpolatedTransform();
+        Transform GetInterpolatedGlobalTransform();
+
+        static void SetInterpolationAlpha(float alpha);
+        static float GetInterpolationAlpha();
 };
 
 #endif
\ No newline at end of file
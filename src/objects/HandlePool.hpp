@@ -0,0 +1,193 @@
+#ifndef HANDLEPOOL_HPP
+#define HANDLEPOOL_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// index + generation, generation of slot is bumped on every destroy so old handles stop resolving.
+template <typename T>
+struct Handle
+{
+    static constexpr uint32_t NULL_INDEX = UINT32_MAX;
+
+    uint32_t index = NULL_INDEX;
+    uint32_t generation = 0;
+
+    inline bool IsNull() const { return index == NULL_INDEX; }
+
+    inline bool operator==(const Handle &other) const { return index == other.index && generation == other.generation; }
+    inline bool operator!=(const Handle &other) const { return !(*this == other); }
+};
+
+/*
+    Pooled storage of objects addressed by generational handles.
+
+    Objects live in fixed size chunks and never move, so raw pointers (parent/child links, GameObjectTransform's
+    back-pointer) stay valid until object is destroyed. Freed slots are reused before pool grows, so live objects
+    stay packed in few chunks and ForEach() walks mostly contiguous memory.
+
+    Get() of destroyed (or never created) object returns nullptr instead of dangling pointer.
+*/
+template <typename T, uint32_t CHUNK_SIZE = 256>
+class HandlePool
+{
+  private:
+    struct Slot
+    {
+        alignas(T) unsigned char storage[sizeof(T)];
+        uint32_t generation;
+        uint32_t nextFree;
+        bool alive;
+    };
+
+    std::vector<Slot *> chunks = std::vector<Slot *>();
+    uint32_t slotsCount = 0; // slots ever used, every slot above this one is untouched.
+    uint32_t freeHead = Handle<T>::NULL_INDEX;
+    uint32_t aliveCount = 0;
+
+    inline Slot *slot(uint32_t index) const { return &chunks[index / CHUNK_SIZE][index % CHUNK_SIZE]; }
+    inline static T *object(Slot *s) { return std::launder(reinterpret_cast<T *>(s->storage)); }
+
+    uint32_t allocate()
+    {
+        if (freeHead != Handle<T>::NULL_INDEX)
+        {
+            uint32_t index = freeHead;
+            freeHead = slot(index)->nextFree;
+            return index;
+        }
+
+        if (slotsCount == chunks.size() * CHUNK_SIZE) chunks.push_back(new Slot[CHUNK_SIZE]);
+
+        Slot *s = slot(slotsCount);
+        s->generation = 0;
+        s->alive = false;
+        return slotsCount++;
+    }
+
+  public:
+    HandlePool() {}
+    ~HandlePool()
+    {
+        Clear();
+        for (Slot *chunk : chunks) delete[] chunk;
+    }
+
+    HandlePool(const HandlePool &) = delete;
+    HandlePool &operator=(const HandlePool &) = delete;
+
+    template <typename... Args>
+    Handle<T> Create(Args &&...args)
+    {
+        uint32_t index = allocate();
+        Slot *s = slot(index);
+
+        new (s->storage) T(std::forward<Args>(args)...);
+        s->alive = true;
+        aliveCount++;
+
+        Handle<T> h;
+        h.index = index;
+        h.generation = s->generation;
+        return h;
+    }
+
+    // returns false if handle is already stale.
+    bool Destroy(Handle<T> handle)
+    {
+        if (!IsValid(handle)) return false;
+
+        Slot *s = slot(handle.index);
+        s->alive = false;
+        s->generation++;
+        object(s)->~T();
+
+        s->nextFree = freeHead;
+        freeHead = handle.index;
+        aliveCount--;
+        return true;
+    }
+
+    bool IsValid(Handle<T> handle) const
+    {
+        if (handle.index >= slotsCount) return false;
+        Slot *s = slot(handle.index);
+        return s->alive && s->generation == handle.generation;
+    }
+
+    T *Get(Handle<T> handle) const { return IsValid(handle) ? object(slot(handle.index)) : nullptr; }
+
+    // null handle if object isn't from this pool. Walks chunks, not intended for hot paths.
+    Handle<T> GetHandle(const T *obj) const
+    {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(obj);
+        for (size_t c = 0; c < chunks.size(); c++)
+        {
+            const unsigned char *begin = reinterpret_cast<const unsigned char *>(chunks[c]);
+            const unsigned char *end = reinterpret_cast<const unsigned char *>(chunks[c] + CHUNK_SIZE);
+            if (p < begin || p >= end) continue;
+
+            uint32_t index = c * CHUNK_SIZE + (p - begin) / sizeof(Slot);
+            Slot *s = slot(index);
+            if (!s->alive || object(s) != obj) break;
+
+            Handle<T> h;
+            h.index = index;
+            h.generation = s->generation;
+            return h;
+        }
+        return Handle<T>();
+    }
+
+    // f(T *) for every alive object in slot order. Objects must not be created or destroyed from f.
+    template <typename F>
+    void ForEach(F f)
+    {
+        uint32_t left = aliveCount;
+        for (uint32_t i = 0; i < slotsCount && left > 0; i++)
+        {
+            Slot *s = slot(i);
+            if (!s->alive) continue;
+            f(object(s));
+            left--;
+        }
+    }
+
+    // destroys all objects, all handles become stale.
+    void Clear()
+    {
+        for (uint32_t i = 0; i < slotsCount; i++)
+        {
+            Slot *s = slot(i);
+            if (!s->alive) continue;
+
+            s->alive = false;
+            s->generation++;
+            object(s)->~T();
+        }
+
+        // rebuild free list in order, so next objects are packed from the beginning again.
+        freeHead = Handle<T>::NULL_INDEX;
+        for (uint32_t i = slotsCount; i > 0; i--)
+        {
+            slot(i - 1)->nextFree = freeHead;
+            freeHead = i - 1;
+        }
+        aliveCount = 0;
+    }
+
+    // allocates chunks for count objects ahead, so bulk creation doesn't grow pool one chunk at a time.
+    void Reserve(uint32_t count)
+    {
+        chunks.reserve((count + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        while (chunks.size() * CHUNK_SIZE < count) chunks.push_back(new Slot[CHUNK_SIZE]);
+    }
+
+    inline uint32_t GetCount() const { return aliveCount; }
+    inline uint32_t GetCapacity() const { return chunks.size() * CHUNK_SIZE; }
+};
+
+#endif
@@ -0,0 +1,195 @@
+#include "JobSystem.hpp"
+
+#include <algorithm>
+
+#include "../memory.hpp"
+
+// === PRIVATE ===
+
+void JobSystem::workerloop(unsigned int index)
+{
+    tlsSystem = this;
+    tlsIndex = index;
+
+    while (true)
+    {
+        if (RunPendingJob()) continue;
+
+        std::unique_lock<std::mutex> lock(sleepmutex);
+        sleepcv.wait(lock, [this]() { return stopping || queuedCount.load(std::memory_order_acquire) > 0; });
+        if (stopping) return;
+    }
+}
+
+void JobSystem::push(Job job)
+{
+    unsigned int index;
+    if (tlsSystem == this) index = tlsIndex;
+    else index = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->jobs.push_back(std::move(job));
+    }
+    queuedCount.fetch_add(1, std::memory_order_release);
+    scheduledCount++;
+
+    // lock prevents lost wakeup between worker's check and wait.
+    {
+        std::lock_guard<std::mutex> lock(sleepmutex);
+    }
+    sleepcv.notify_one();
+}
+
+bool JobSystem::pop(Job *job)
+{
+    if (queuedCount.load(std::memory_order_acquire) <= 0) return false;
+
+    unsigned int own = tlsSystem == this ? tlsIndex : 0;
+    {
+        WorkerQueue *q = queues[own];
+        std::lock_guard<std::mutex> lock(q->mutex);
+        if (!q->jobs.empty())
+        {
+            *job = std::move(q->jobs.back());
+            q->jobs.pop_back();
+            queuedCount.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    for (unsigned int i = 1; i < queues.size(); i++)
+    {
+        WorkerQueue *q = queues[(own + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(q->mutex);
+        if (q->jobs.empty()) continue;
+
+        *job = std::move(q->jobs.front());
+        q->jobs.pop_front();
+        queuedCount.fetch_sub(1, std::memory_order_relaxed);
+        stolenCount++;
+        return true;
+    }
+
+    return false;
+}
+
+void JobSystem::execute(Job *job)
+{
+    // job may use thread arena, but it can be run inside of other job's Wait().
+    FrameArena *arena = FrameArena::GetThreadArena();
+    FrameArena::Marker marker = arena->GetMarker();
+
+    job->function();
+    arena->Rewind(marker);
+    executedCount++;
+    if (job->counter) finish(job->counter);
+}
+
+void JobSystem::finish(JobCounter *counter)
+{
+    // decrement is done under lock, so Wait() (which takes same lock) can't return while counter is still in use here.
+    std::vector<JobCounter::Continuation> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        if (counter->count.fetch_sub(1, std::memory_order_acq_rel) == 1) ready.swap(counter->continuations);
+    }
+    for (JobCounter::Continuation &c : ready) push({ std::move(c.function), c.counter });
+}
+
+// === PUBLIC ===
+
+JobSystem::JobSystem(unsigned int threads_count)
+{
+    if (threads_count == 0) threads_count = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned int i = 0; i < threads_count; i++) queues.push_back(new WorkerQueue());
+
+    // creator is worker 0.
+    tlsSystem = this;
+    tlsIndex = 0;
+
+    for (unsigned int i = 1; i < threads_count; i++) workers.push_back(std::thread(&JobSystem::workerloop, this, i));
+}
+
+JobSystem::~JobSystem()
+{
+    // jobs left in queues are finished by creator.
+    while (RunPendingJob()) continue;
+
+    {
+        std::lock_guard<std::mutex> lock(sleepmutex);
+        stopping = true;
+    }
+    sleepcv.notify_all();
+    for (std::thread &t : workers) t.join();
+
+    for (WorkerQueue *q : queues) delete q;
+    if (tlsSystem == this) tlsSystem = nullptr;
+    if (current == this) current = nullptr;
+}
+
+int JobSystem::GetCurrentThreadIndex() { return tlsSystem == this ? (int)tlsIndex : -1; }
+
+void JobSystem::Schedule(std::function<void()> function, JobCounter *counter)
+{
+    if (counter) counter->count.fetch_add(1, std::memory_order_relaxed);
+    push({ std::move(function), counter });
+}
+
+void JobSystem::ScheduleAfter(JobCounter *dependency, std::function<void()> function, JobCounter *counter)
+{
+    if (counter) counter->count.fetch_add(1, std::memory_order_relaxed);
+    if (dependency)
+    {
+        std::lock_guard<std::mutex> lock(dependency->mutex);
+        // count is rechecked under lock, finish() takes continuations under same lock.
+        if (dependency->count.load(std::memory_order_acquire) > 0)
+        {
+            dependency->continuations.push_back({ std::move(function), counter });
+            return;
+        }
+    }
+    push({ std::move(function), counter });
+}
+
+void JobSystem::Wait(JobCounter *counter)
+{
+    while (!counter->IsDone())
+        if (!RunPendingJob()) std::this_thread::yield(); // remaining jobs are running on other threads.
+
+    // last finisher may still hold the lock, counter can be destroyed right after return.
+    std::lock_guard<std::mutex> lock(counter->mutex);
+}
+
+bool JobSystem::RunPendingJob()
+{
+    Job job;
+    if (!pop(&job)) return false;
+
+    execute(&job);
+    return true;
+}
+
+void JobSystem::ParallelFor(size_t count, size_t batch_size, std::function<void(size_t begin, size_t end)> function)
+{
+    if (count == 0) return;
+    if (batch_size == 0) batch_size = std::max((size_t)1, count / (queues.size() * 4));
+
+    // single batch isn't worth queueing.
+    if (count <= batch_size)
+    {
+        function(0, count);
+        return;
+    }
+
+    JobCounter counter;
+    for (size_t begin = 0; begin < count; begin += batch_size)
+    {
+        size_t end = std::min(count, begin + batch_size);
+        Schedule([&function, begin, end]() { function(begin, end); }, &counter);
+    }
+    Wait(&counter);
+}
+
+JobSystemStats JobSystem::GetStats() { return { scheduledCount.load(), executedCount.load(), stolenCount.load() }; }
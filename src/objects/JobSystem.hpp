@@ -0,0 +1,128 @@
+#ifndef JOBSYSTEM_HPP
+#define JOBSYSTEM_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+
+class JobSystem;
+
+// count of unfinished jobs attached to it, jobs scheduled "after" counter start when it drops to zero.
+// counter must not be destroyed until JobSystem::Wait() on it returned.
+class JobCounter
+{
+    friend class JobSystem;
+
+  private:
+    struct Continuation
+    {
+        std::function<void()> function;
+        JobCounter *counter;
+    };
+
+    std::atomic<int> count = 0;
+    std::mutex mutex;
+    std::vector<Continuation> continuations = std::vector<Continuation>();
+
+  public:
+    JobCounter() {}
+    JobCounter(const JobCounter &) = delete;
+    JobCounter &operator=(const JobCounter &) = delete;
+
+    inline int GetCount() { return count.load(std::memory_order_acquire); }
+    inline bool IsDone() { return GetCount() == 0; }
+};
+
+struct
+{
+    unsigned long long scheduledCount;
+    unsigned long long executedCount;
+    unsigned long long stolenCount; // jobs executed by thread that didn't queue them.
+} typedef JobSystemStats;
+
+/*
+    Work-stealing job scheduler.
+
+    Every worker (and thread that created job system, index 0) has own deque: owner pushes and pops from back
+    (newest first, hot in cache), idle workers steal from front of other deques (oldest, usually biggest jobs).
+    Jobs scheduled from other threads (render thread etc.) are spread over deques round-robin.
+
+    Wait() never blocks while there is work - waiting thread runs jobs itself, so main thread participates
+    and nested waits inside jobs don't deadlock.
+
+    Job functions must not throw.
+*/
+class JobSystem
+{
+  private:
+    struct Job
+    {
+        std::function<void()> function;
+        JobCounter *counter;
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    static inline JobSystem *current = nullptr;
+    static thread_local inline JobSystem *tlsSystem = nullptr;
+    static thread_local inline unsigned int tlsIndex = 0;
+
+    std::vector<WorkerQueue *> queues = std::vector<WorkerQueue *>();
+    std::vector<std::thread> workers = std::vector<std::thread>();
+
+    std::mutex sleepmutex;
+    std::condition_variable sleepcv;
+    std::atomic<int> queuedCount = 0;
+    std::atomic<unsigned int> nextQueue = 0;
+    bool stopping = false;
+
+    std::atomic<unsigned long long> scheduledCount = 0, executedCount = 0, stolenCount = 0;
+
+    void workerloop(unsigned int index);
+    void push(Job job);
+    bool pop(Job *job);
+    void execute(Job *job);
+    void finish(JobCounter *counter);
+
+  public:
+    // threads_count - total threads including creator, 0 - hardware concurrency.
+    JobSystem(unsigned int threads_count = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    // global instance for code that has no job system passed to it (nullptr -> run inline).
+    static inline JobSystem *GetCurrent() { return current; }
+    static inline void SetCurrent(JobSystem *jobs) { current = jobs; }
+
+    inline unsigned int GetThreadsCount() { return queues.size(); }
+    // index of calling thread in this job system, -1 for foreign threads.
+    int GetCurrentThreadIndex();
+
+    // counter (optional) is incremented now and decremented when job finishes.
+    void Schedule(std::function<void()> function, JobCounter *counter = nullptr);
+    // job is queued only when dependency counter reaches zero.
+    void ScheduleAfter(JobCounter *dependency, std::function<void()> function, JobCounter *counter = nullptr);
+
+    // runs other jobs until counter reaches zero.
+    void Wait(JobCounter *counter);
+    // runs one queued job on calling thread, returns false if there was nothing to run.
+    bool RunPendingJob();
+
+    // splits [0; count) into batches of batch_size and waits for all of them.
+    void ParallelFor(size_t count, size_t batch_size, std::function<void(size_t begin, size_t end)> function);
+
+    JobSystemStats GetStats();
+};
+
+#endif
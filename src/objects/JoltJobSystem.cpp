@@ -0,0 +1,33 @@
+#include "JoltJobSystem.hpp"
+
+// === PRIVATE ===
+
+void JoltJobSystem::QueueJob(Job *job)
+{
+    // reference keeps job alive until it's executed.
+    job->AddRef();
+    jobs->Schedule([job]()
+    {
+        job->Execute();
+        job->Release();
+    });
+}
+
+void JoltJobSystem::QueueJobs(Job **list, JPH::uint count) { for (JPH::uint i = 0; i < count; i++) QueueJob(list[i]); }
+
+void JoltJobSystem::FreeJob(Job *job) { delete job; }
+
+// === PUBLIC ===
+
+JoltJobSystem::JoltJobSystem(::JobSystem *jobs, JPH::uint max_barriers) : JobSystemWithBarrier(max_barriers), jobs(jobs) {}
+
+int JoltJobSystem::GetMaxConcurrency() const { return jobs->GetThreadsCount(); }
+
+JoltJobSystem::JobHandle JoltJobSystem::CreateJob(const char *name, JPH::ColorArg color, const JobFunction &function, JPH::uint32 dependencies)
+{
+    Job *job = new Job(name, color, this, function, dependencies);
+    JobHandle handle = JobHandle(job);
+
+    if (dependencies == 0) QueueJob(job);
+    return handle;
+}
@@ -0,0 +1,31 @@
+#ifndef JOLTJOBSYSTEM_HPP
+#define JOLTJOBSYSTEM_HPP
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
+
+#include "JobSystem.hpp"
+
+/*
+    Jolt's JPH::JobSystem on top of engine JobSystem, so physics update runs on the same workers as engine jobs
+    instead of separate JPH::JobSystemThreadPool threads. Jolt tracks dependencies itself,
+    only ready jobs are queued here. Jolt allocator must be registered (JPH::RegisterDefaultAllocator()).
+*/
+class JoltJobSystem final : public JPH::JobSystemWithBarrier
+{
+  private:
+    ::JobSystem *jobs; // JobSystem alone is Jolt's base class here.
+
+  protected:
+    void QueueJob(Job *job) override;
+    void QueueJobs(Job **jobs, JPH::uint count) override;
+    void FreeJob(Job *job) override;
+
+  public:
+    JoltJobSystem(::JobSystem *jobs, JPH::uint max_barriers = 8);
+
+    int GetMaxConcurrency() const override;
+    JobHandle CreateJob(const char *name, JPH::ColorArg color, const JobFunction &function, JPH::uint32 dependencies = 0) override;
+};
+
+#endif
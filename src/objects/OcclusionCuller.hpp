@@ -0,0 +1,73 @@
+#ifndef OCCLUSIONCULLER_HPP
+#define OCCLUSIONCULLER_HPP
+
+#include <cstddef>
+
+#include "../glm.hpp"
+#include "../objects.hpp"
+#include "../geometry/OcclusionBuffer.hpp"
+#include "JobSystem.hpp"
+
+struct
+{
+    OcclusionBufferStats buffer;
+    unsigned int testedCount;
+    unsigned int culledCount;
+} typedef OcclusionCullerStats;
+
+/*
+    Removes render items hidden behind occluders (items of surfaces with occluder flag) before they are submitted,
+    on update thread: occluders are rasterized into OcclusionBuffer, then mesh bounds of other items are tested.
+    Order of kept items doesn't change (transparent tail stays last).
+*/
+class OcclusionCuller
+{
+  private:
+    OcclusionBuffer buffer;
+    OcclusionCullerStats stats = OcclusionCullerStats();
+
+  public:
+    bool enabled = true;
+
+    OcclusionCuller(unsigned int width = OCCLUSION_DEFAULT_WIDTH, unsigned int height = OCCLUSION_DEFAULT_HEIGHT) : buffer(width, height) {}
+
+    // items is std::vector or ArenaVector of RenderItem, viewprojection is projection * view, jobs is optional.
+    template <typename Vector>
+    void Cull(Vector *items, glm::mat4 viewprojection, JobSystem *jobs)
+    {
+        stats = OcclusionCullerStats();
+        if (!enabled) return;
+
+        buffer.Begin(viewprojection);
+        for (RenderItem &item : *items)
+        {
+            if (!item.occluder) continue;
+
+            Mesh *m = item.mesh;
+            buffer.AddOccluder(m->GetPositions(), m->GetVerticesCount(), m->GetIndices().data(), m->GetIndicesCount(), item.model, item.culling == BackFace);
+        }
+        stats.buffer = buffer.GetStats();
+        if (stats.buffer.occludersCount == 0) return;
+
+        buffer.Rasterize(jobs);
+
+        size_t kept = 0;
+        for (size_t i = 0; i < items->size(); i++)
+        {
+            RenderItem &item = (*items)[i];
+            if (!item.occluder)
+            {
+                stats.testedCount++;
+                if (!buffer.IsVisible(item.mesh->GetBoundsMin(), item.mesh->GetBoundsMax(), item.model)) continue;
+            }
+            (*items)[kept++] = item;
+        }
+        stats.culledCount = items->size() - kept;
+        items->resize(kept);
+    }
+
+    inline const OcclusionBuffer *GetBuffer() { return &buffer; }
+    inline OcclusionCullerStats GetStats() { return stats; }
+};
+
+#endif
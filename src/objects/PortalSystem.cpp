@@ -0,0 +1,278 @@
+#include "PortalSystem.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+// === PRIVATE ===
+
+void PortalSystem::visit(uint32_t cell, uint32_t firstplane, uint32_t planescount, uint32_t from, unsigned int depth)
+{
+    visits.push_back({ cell, firstplane, planescount });
+    cells[cell].frame = frame;
+    stats.visitsCount++;
+    if (depth >= PORTAL_MAX_DEPTH) return;
+
+    for (uint32_t index : cells[cell].portals)
+    {
+        const Portal *p = &portals[index];
+        if (index == from || !p->open) continue;
+        stats.portalsTested++;
+
+        uint32_t next = p->cells[0] == cell ? p->cells[1] : p->cells[0];
+        float distance = glm::dot(glm::vec3(p->plane), camera) + p->plane.w;
+
+        // camera is in doorway, portal can't narrow anything (and near plane would clip it away).
+        if (std::fabs(distance) < PORTAL_PASS_DISTANCE && glm::distance(camera, p->center) < p->radius + PORTAL_PASS_DISTANCE)
+        {
+            stats.portalsPassed++;
+            visit(next, firstplane, planescount, index, depth + 1);
+            continue;
+        }
+
+        if (!clipportal(p, firstplane, planescount)) continue;
+        stats.portalsPassed++;
+
+        // portal's plane faces away from camera, so only what's behind portal is inside.
+        uint32_t first = planes.size();
+        glm::vec4 portalplane = distance > 0.0f ? -p->plane : p->plane;
+        planes.push_back(portalplane);
+
+        glm::vec3 centroid = glm::vec3(0.0f);
+        for (glm::vec3 v : clipped) centroid += v;
+        centroid /= (float)clipped.size();
+
+        for (size_t i = 0; i < clipped.size(); i++)
+        {
+            glm::vec3 n = glm::cross(clipped[i] - camera, clipped[(i + 1) % clipped.size()] - camera);
+            float length = glm::length(n);
+            if (length < 1e-8f) continue;
+
+            n /= length;
+            if (glm::dot(n, centroid - camera) < 0.0f) n = -n;
+            planes.push_back(glm::vec4(n, -glm::dot(n, camera)));
+        }
+
+        visit(next, first, planes.size() - first, index, depth + 1);
+    }
+}
+
+bool PortalSystem::clipportal(const Portal *portal, uint32_t firstplane, uint32_t planescount)
+{
+    clipped.assign(portal->vertices.begin(), portal->vertices.end());
+
+    // Sutherland-Hodgman against every plane of current frustum.
+    for (uint32_t i = firstplane; i < firstplane + planescount && clipped.size() >= 3; i++)
+    {
+        glm::vec4 plane = planes[i];
+        cliptemp.clear();
+        for (size_t v = 0; v < clipped.size(); v++)
+        {
+            glm::vec3 a = clipped[v], b = clipped[(v + 1) % clipped.size()];
+            float da = glm::dot(glm::vec3(plane), a) + plane.w, db = glm::dot(glm::vec3(plane), b) + plane.w;
+
+            if (da >= 0.0f) cliptemp.push_back(a);
+            if ((da >= 0.0f) != (db >= 0.0f)) cliptemp.push_back(a + (b - a) * (da / (da - db)));
+        }
+        clipped.swap(cliptemp);
+    }
+    return clipped.size() >= 3;
+}
+
+bool PortalSystem::isboxinside(const glm::vec4 *p, uint32_t count, glm::vec3 bmin, glm::vec3 bmax)
+{
+    if (bmin.x > bmax.x) return false; // entity without meshes.
+
+    // corner farthest along plane's normal is enough.
+    for (uint32_t i = 0; i < count; i++)
+    {
+        glm::vec3 corner = glm::vec3(p[i].x >= 0.0f ? bmax.x : bmin.x, p[i].y >= 0.0f ? bmax.y : bmin.y, p[i].z >= 0.0f ? bmax.z : bmin.z);
+        if (glm::dot(glm::vec3(p[i]), corner) + p[i].w < 0.0f) return false;
+    }
+    return true;
+}
+
+void PortalSystem::updatebounds(Record *r)
+{
+    r->bmin = glm::vec3(INFINITY);
+    r->bmax = glm::vec3(-INFINITY);
+
+    glm::mat4 model = r->entity->GetInterpolatedGlobalTransform().GetTransformationMatrix();
+    for (Surface &surface : r->entity->surfaces)
+    {
+        Mesh *mesh = surface.GetMesh();
+        if (!mesh) continue;
+
+        // center is transformed, extent by absolute matrix.
+        glm::mat4 m = model * surface.transform.GetTransformationMatrix();
+        glm::vec3 center = (mesh->GetBoundsMin() + mesh->GetBoundsMax()) * 0.5f;
+        glm::vec3 extent = (mesh->GetBoundsMax() - mesh->GetBoundsMin()) * 0.5f;
+        glm::vec3 wcenter = glm::vec3(m * glm::vec4(center, 1.0f));
+        glm::vec3 wextent = glm::abs(glm::vec3(m[0])) * extent.x + glm::abs(glm::vec3(m[1])) * extent.y + glm::abs(glm::vec3(m[2])) * extent.z;
+
+        r->bmin = glm::min(r->bmin, wcenter - wextent);
+        r->bmax = glm::max(r->bmax, wcenter + wextent);
+    }
+}
+
+// === PUBLIC ===
+
+uint32_t PortalSystem::AddCell(glm::vec3 boundsmin, glm::vec3 boundsmax)
+{
+    Cell c = Cell();
+    c.bmin = glm::min(boundsmin, boundsmax);
+    c.bmax = glm::max(boundsmin, boundsmax);
+    c.frame = 0;
+    cells.push_back(c);
+    return cells.size() - 1;
+}
+
+uint32_t PortalSystem::AddPortal(uint32_t cell_a, uint32_t cell_b, const glm::vec3 *vertices, size_t count, bool open)
+{
+    if (cell_a >= cells.size() || cell_b >= cells.size() || cell_a == cell_b || count < 3) return PORTAL_NONE;
+
+    Portal p = Portal();
+    p.cells[0] = cell_a;
+    p.cells[1] = cell_b;
+    p.vertices.assign(vertices, vertices + count);
+    p.open = open;
+
+    // Newell's normal, robust for any convex polygon with collinear vertices.
+    glm::vec3 n = glm::vec3(0.0f);
+    p.center = glm::vec3(0.0f);
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::vec3 a = vertices[i], b = vertices[(i + 1) % count];
+        n += glm::vec3((a.y - b.y) * (a.z + b.z), (a.z - b.z) * (a.x + b.x), (a.x - b.x) * (a.y + b.y));
+        p.center += a;
+    }
+    p.center /= (float)count;
+
+    float length = glm::length(n);
+    if (length < 1e-8f) return PORTAL_NONE;
+    n /= length;
+    p.plane = glm::vec4(n, -glm::dot(n, p.center));
+
+    p.radius = 0.0f;
+    for (size_t i = 0; i < count; i++) p.radius = std::max(p.radius, glm::distance(vertices[i], p.center));
+
+    portals.push_back(p);
+    uint32_t index = portals.size() - 1;
+    cells[cell_a].portals.push_back(index);
+    cells[cell_b].portals.push_back(index);
+    return index;
+}
+
+void PortalSystem::Clear()
+{
+    cells.clear();
+    portals.clear();
+    records.clear();
+    freeRecords.clear();
+    entityRecords.clear();
+    visits.clear();
+    planes.clear();
+    cameraCell = PORTAL_NONE;
+    stats = PortalStats();
+}
+
+uint32_t PortalSystem::FindCell(glm::vec3 position)
+{
+    for (uint32_t i = 0; i < cells.size(); i++)
+        if (glm::all(glm::greaterThanEqual(position, cells[i].bmin)) && glm::all(glm::lessThanEqual(position, cells[i].bmax))) return i;
+    return PORTAL_NONE;
+}
+
+bool PortalSystem::AddEntity(Entity *entity, uint32_t cell)
+{
+    if (!entity || cell >= cells.size()) return false;
+
+    uint32_t index;
+    std::unordered_map<Entity *, uint32_t>::iterator it = entityRecords.find(entity);
+    if (it != entityRecords.end()) index = it->second;
+    else
+    {
+        if (freeRecords.empty())
+        {
+            index = records.size();
+            records.push_back(Record());
+        }
+        else
+        {
+            index = freeRecords.back();
+            freeRecords.pop_back();
+        }
+
+        Record *r = &records[index];
+        r->entity = entity;
+        r->cells.clear();
+        r->frame = 0;
+        r->drawn = false;
+        entityRecords[entity] = index;
+    }
+
+    Record *r = &records[index];
+    if (std::find(r->cells.begin(), r->cells.end(), cell) != r->cells.end()) return true;
+    r->cells.push_back(cell);
+    cells[cell].entities.push_back(index);
+    return true;
+}
+
+uint32_t PortalSystem::AddEntity(Entity *entity)
+{
+    if (!entity) return PORTAL_NONE;
+
+    uint32_t cell = FindCell(entity->GetGlobalTransform().GetPosition());
+    if (cell != PORTAL_NONE) AddEntity(entity, cell);
+    return cell;
+}
+
+void PortalSystem::RemoveEntity(Entity *entity)
+{
+    std::unordered_map<Entity *, uint32_t>::iterator it = entityRecords.find(entity);
+    if (it == entityRecords.end()) return;
+
+    uint32_t index = it->second;
+    for (uint32_t c : records[index].cells)
+    {
+        std::vector<uint32_t> &list = cells[c].entities;
+        list.erase(std::find(list.begin(), list.end(), index));
+    }
+
+    records[index].entity = nullptr;
+    records[index].cells.clear();
+    freeRecords.push_back(index);
+    entityRecords.erase(it);
+}
+
+void PortalSystem::Update(glm::mat4 viewprojection, glm::vec3 camera)
+{
+    frame++;
+    stats = PortalStats();
+    visits.clear();
+    planes.clear();
+    this->camera = camera;
+
+    // left, right, bottom, top, near, far (Gribb-Hartmann), normalized so portal distances are in world units.
+    glm::vec4 rows[4];
+    for (int r = 0; r < 4; r++) rows[r] = glm::vec4(viewprojection[0][r], viewprojection[1][r], viewprojection[2][r], viewprojection[3][r]);
+    for (int p = 0; p < 6; p++)
+    {
+        glm::vec4 plane = p % 2 == 0 ? rows[3] + rows[p / 2] : rows[3] - rows[p / 2];
+        float length = glm::length(glm::vec3(plane));
+        planes.push_back(length > 0.0f ? plane / length : plane);
+    }
+
+    cameraCell = FindCell(camera);
+    if (cameraCell != PORTAL_NONE)
+    {
+        visit(cameraCell, 0, 6, PORTAL_NONE, 0);
+        return;
+    }
+
+    for (uint32_t c = 0; c < cells.size(); c++)
+    {
+        visits.push_back({ c, 0, 6 });
+        cells[c].frame = frame;
+        stats.visitsCount++;
+    }
+}
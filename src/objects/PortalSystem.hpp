@@ -0,0 +1,154 @@
+#ifndef PORTALSYSTEM_HPP
+#define PORTALSYSTEM_HPP
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+#include "../glm.hpp"
+#include "../objects.hpp"
+
+#define PORTAL_NONE UINT32_MAX
+#define PORTAL_MAX_DEPTH 16 // portals passed in a row, stops endless loops through rings of cells.
+#define PORTAL_PASS_DISTANCE 0.25f // camera closer to portal's plane sees through it with unchanged frustum.
+
+struct
+{
+    unsigned int visitsCount; // cell can be visited several times through different portals.
+    unsigned int portalsTested;
+    unsigned int portalsPassed;
+    unsigned int entitiesTested;
+    unsigned int entitiesDrawn;
+} typedef PortalStats;
+
+/*
+    Cells and portals for indoor visibility: cells are boxes (rooms, corridors), portals are convex polygons
+    (doorways, windows) on their borders that can be opened and closed at runtime (doors).
+
+    Update() starts in camera's cell with view frustum and walks open portals: every portal is clipped by
+    current frustum, and if anything is left, cell behind it is visited with frustum narrowed to what is left
+    (planes through camera and edges of clipped polygon, plus portal's plane). CollectRenderItems() then
+    draws entities of visited cells whose bounds touch frustum of any visit. No GPU queries are used.
+
+    Entities are assigned to cells explicitly (large ones can be in several cells) or by position, moving
+    ones have to be reassigned when they cross into another cell. Entities that aren't in any cell aren't
+    drawn by portal system. Camera outside of every cell sees every cell through view frustum.
+*/
+class PortalSystem
+{
+  private:
+    struct Cell
+    {
+        glm::vec3 bmin, bmax;
+        std::vector<uint32_t> portals = std::vector<uint32_t>();
+        std::vector<uint32_t> entities = std::vector<uint32_t>(); // records.
+        uint32_t frame; // of last visit.
+    };
+
+    struct Portal
+    {
+        uint32_t cells[2];
+        std::vector<glm::vec3> vertices = std::vector<glm::vec3>();
+        glm::vec4 plane; // normalized.
+        glm::vec3 center;
+        float radius;
+        bool open;
+    };
+
+    struct Record
+    {
+        Entity *entity;
+        std::vector<uint32_t> cells;
+        uint32_t frame; // of last test, bounds and drawn are valid only in that frame.
+        bool drawn;
+        glm::vec3 bmin, bmax;
+    };
+
+    struct Visit
+    {
+        uint32_t cell;
+        uint32_t firstPlane, planesCount;
+    };
+
+    std::vector<Cell> cells = std::vector<Cell>();
+    std::vector<Portal> portals = std::vector<Portal>();
+    std::vector<Record> records = std::vector<Record>();
+    std::vector<uint32_t> freeRecords = std::vector<uint32_t>();
+    std::unordered_map<Entity *, uint32_t> entityRecords = std::unordered_map<Entity *, uint32_t>();
+
+    std::vector<Visit> visits = std::vector<Visit>();
+    std::vector<glm::vec4> planes = std::vector<glm::vec4>(); // of visits, inside is dot(n, p) + d >= 0.
+    std::vector<glm::vec3> clipped = std::vector<glm::vec3>(), cliptemp = std::vector<glm::vec3>(); // scratch of traversal.
+    glm::vec3 camera = glm::vec3(0.0f);
+    uint32_t cameraCell = PORTAL_NONE;
+    uint32_t frame = 0;
+
+    PortalStats stats = PortalStats();
+
+    void visit(uint32_t cell, uint32_t firstplane, uint32_t planescount, uint32_t from, unsigned int depth);
+    // result is in clipped, it's needed only until planes of next visit are made from it.
+    bool clipportal(const Portal *portal, uint32_t firstplane, uint32_t planescount);
+    static bool isboxinside(const glm::vec4 *p, uint32_t count, glm::vec3 bmin, glm::vec3 bmax);
+    void updatebounds(Record *r);
+
+  public:
+    PortalSystem() {}
+
+    // cell is convex box, returns its index.
+    uint32_t AddCell(glm::vec3 boundsmin, glm::vec3 boundsmax);
+    // vertices of convex polygon in order (either winding), PORTAL_NONE on bad cells or less than 3 vertices.
+    uint32_t AddPortal(uint32_t cell_a, uint32_t cell_b, const glm::vec3 *vertices, size_t count, bool open = true);
+    void Clear();
+
+    inline size_t GetCellsCount() { return cells.size(); }
+    inline size_t GetPortalsCount() { return portals.size(); }
+
+    inline void SetPortalOpen(uint32_t portal, bool open) { if (portal < portals.size()) portals[portal].open = open; }
+    inline bool IsPortalOpen(uint32_t portal) { return portal < portals.size() && portals[portal].open; }
+
+    // first cell that contains position, PORTAL_NONE if there is no such cell.
+    uint32_t FindCell(glm::vec3 position);
+
+    // entity can be added to several cells, it's drawn once anyway.
+    bool AddEntity(Entity *entity, uint32_t cell);
+    // by global position of entity, returns cell or PORTAL_NONE if entity is outside of every cell.
+    uint32_t AddEntity(Entity *entity);
+    void RemoveEntity(Entity *entity);
+    // removes entity from cells it's in and adds it by its current position.
+    inline uint32_t UpdateEntity(Entity *entity) { RemoveEntity(entity); return AddEntity(entity); }
+
+    // viewprojection is projection * view, camera is position of camera in world.
+    void Update(glm::mat4 viewprojection, glm::vec3 camera);
+    inline uint32_t GetCameraCell() { return cameraCell; }
+    // cell was visited in last Update().
+    inline bool IsCellVisible(uint32_t cell) { return cell < cells.size() && cells[cell].frame == frame; }
+
+    // appends render items of entities seen in last Update(), every entity once per Update().
+    // items is std::vector or ArenaVector of RenderItem.
+    template <typename Vector>
+    void CollectRenderItems(Vector *items)
+    {
+        for (Visit &v : visits)
+            for (uint32_t index : cells[v.cell].entities)
+            {
+                Record *r = &records[index];
+                if (r->frame != frame)
+                {
+                    r->frame = frame;
+                    r->drawn = false;
+                    updatebounds(r);
+                    stats.entitiesTested++;
+                }
+                if (r->drawn || !isboxinside(&planes[v.firstPlane], v.planesCount, r->bmin, r->bmax)) continue;
+
+                r->drawn = true;
+                stats.entitiesDrawn++;
+                r->entity->CollectRenderItems(items);
+            }
+    }
+
+    inline PortalStats GetStats() { return stats; }
+};
+
+#endif
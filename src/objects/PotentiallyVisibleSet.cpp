@@ -0,0 +1,66 @@
+#include "PotentiallyVisibleSet.hpp"
+
+#include <cstdio>
+#include <cmath>
+
+// === PUBLIC ===
+
+bool PotentiallyVisibleSet::LoadFromUCPVSFile(std::string filename)
+{
+    Clear();
+    if (!file.Open(filename)) return false;
+
+    boundsMin = file.GetBoundsMin();
+    invCellSize = 1.0f / file.GetCellSize();
+    cellsCount = glm::ivec3(file.GetCellsCount());
+    row.resize(file.GetRowSize());
+    return true;
+}
+
+void PotentiallyVisibleSet::Clear()
+{
+    file.Close();
+    row.clear();
+    cell = -1;
+    cellsCount = glm::ivec3(0);
+}
+
+int64_t PotentiallyVisibleSet::GetCell(glm::vec3 position)
+{
+    if (!IsLoaded()) return -1;
+
+    glm::vec3 p = (position - boundsMin) * invCellSize;
+    if (!(p.x >= 0.0f && p.y >= 0.0f && p.z >= 0.0f)) return -1; // NaN is outside too.
+
+    glm::ivec3 c = glm::ivec3(glm::floor(p));
+    if (c.x >= cellsCount.x || c.y >= cellsCount.y || c.z >= cellsCount.z) return -1;
+    return c.x + (int64_t)cellsCount.x * (c.y + (int64_t)cellsCount.y * c.z);
+}
+
+void PotentiallyVisibleSet::SetViewPosition(glm::vec3 position)
+{
+    int64_t c = GetCell(position);
+    if (c == cell) return;
+
+    cell = c;
+    if (cell >= 0 && !file.DecompressRow(cell, row.data())) printf("Warning: PVS row of cell %lld is broken.\n", (long long)cell);
+}
+
+bool PotentiallyVisibleSet::IsBoxVisible(glm::vec3 boundsmin, glm::vec3 boundsmax)
+{
+    if (cell < 0) return true;
+
+    glm::vec3 lo = (boundsmin - boundsMin) * invCellSize, hi = (boundsmax - boundsMin) * invCellSize;
+    if (!(lo.x >= 0.0f && lo.y >= 0.0f && lo.z >= 0.0f)) return true;
+    if (!(hi.x < cellsCount.x && hi.y < cellsCount.y && hi.z < cellsCount.z)) return true;
+
+    glm::ivec3 a = glm::ivec3(glm::floor(lo)), b = glm::min(glm::ivec3(glm::floor(hi)), cellsCount - 1);
+    for (int z = a.z; z <= b.z; z++)
+        for (int y = a.y; y <= b.y; y++)
+        {
+            uint32_t c = a.x + cellsCount.x * (y + cellsCount.y * z);
+            for (int x = a.x; x <= b.x; x++, c++)
+                if ((row[c >> 3] >> (c & 7)) & 1) return true;
+        }
+    return false;
+}
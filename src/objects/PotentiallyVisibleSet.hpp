@@ -0,0 +1,77 @@
+#ifndef POTENTIALLYVISIBLESET_HPP
+#define POTENTIALLYVISIBLESET_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "../glm.hpp"
+#include "../objects.hpp"
+#include "../formats/UCPVSFile.hpp"
+
+/*
+    Runtime of UCPVS file (see pvsbuilder): SetViewPosition() finds camera's cell in O(1) and unpacks its row
+    only when cell changes, then every visibility query is few bit reads.
+
+    Anything outside of grid or touching its border isn't covered by precomputed data and is always visible,
+    camera outside of grid sees everything too.
+*/
+class PotentiallyVisibleSet
+{
+  private:
+    UCPVSFile file;
+    std::vector<uint8_t> row = std::vector<uint8_t>(); // of current cell.
+    int64_t cell = -1; // -1 - camera is outside, everything is visible.
+
+    glm::vec3 boundsMin = glm::vec3(0.0f), invCellSize = glm::vec3(1.0f);
+    glm::ivec3 cellsCount = glm::ivec3(0);
+
+  public:
+    PotentiallyVisibleSet() {}
+
+    bool LoadFromUCPVSFile(std::string filename);
+    void Clear();
+    inline bool IsLoaded() { return file.IsOpen(); }
+
+    // -1 if position is outside of grid.
+    int64_t GetCell(glm::vec3 position);
+    inline int64_t GetCurrentCell() { return cell; }
+    inline glm::ivec3 GetCellsCount() { return cellsCount; }
+
+    void SetViewPosition(glm::vec3 position);
+
+    inline bool IsCellVisible(uint32_t c) { return cell < 0 || (row[c >> 3] >> (c & 7)) & 1; }
+    // box is in world space.
+    bool IsBoxVisible(glm::vec3 boundsmin, glm::vec3 boundsmax);
+
+    // removes items appended after first whose mesh bounds are in hidden cells, order of kept items doesn't change.
+    // items is std::vector or ArenaVector of RenderItem.
+    template <typename Vector>
+    size_t Cull(Vector *items, size_t first = 0)
+    {
+        if (!IsLoaded() || cell < 0) return 0;
+
+        size_t kept = first;
+        for (size_t i = first; i < items->size(); i++)
+        {
+            RenderItem &item = (*items)[i];
+
+            // world bounds of transformed box: center is transformed, extent by absolute matrix.
+            glm::vec3 center = (item.mesh->GetBoundsMin() + item.mesh->GetBoundsMax()) * 0.5f;
+            glm::vec3 extent = (item.mesh->GetBoundsMax() - item.mesh->GetBoundsMin()) * 0.5f;
+            glm::mat3 m = glm::mat3(item.model);
+            glm::vec3 wcenter = glm::vec3(item.model * glm::vec4(center, 1.0f));
+            glm::vec3 wextent = glm::abs(m[0]) * extent.x + glm::abs(m[1]) * extent.y + glm::abs(m[2]) * extent.z;
+
+            if (!IsBoxVisible(wcenter - wextent, wcenter + wextent)) continue;
+            (*items)[kept++] = item;
+        }
+
+        size_t culled = items->size() - kept;
+        items->resize(kept);
+        return culled;
+    }
+};
+
+#endif
@@ -0,0 +1,174 @@
+#include "Renderer.hpp"
+
+// === PRIVATE ===
+
+void Renderer::runcommands(uint64_t frame)
+{
+    std::vector<std::function<void()>> list;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        list.swap(commands);
+
+        // releases are queued in submission order. Packet with frame equal to mark may have been begun
+        // (and filled) before release was enqueued, so only later ones are safe.
+        size_t ready = 0;
+        while (ready < releases.size() && releases[ready].first < frame) ready++;
+        for (size_t i = 0; i < ready; i++) list.push_back(std::move(releases[i].second));
+        if (ready > 0) releases.erase(releases.begin(), releases.begin() + ready);
+    }
+    for (std::function<void()> &cmd : list) cmd();
+}
+
+void Renderer::draw(RenderPacket *packet)
+{
+    unsigned long long allocations = Memory::GetThreadAllocationStats().allocationsCount;
+    FrameArena::GetThreadArena()->Reset();
+
+    runcommands(packet->frame);
+    if (frameCallback) frameCallback(packet);
+
+    if (packet->viewportWidth != viewportWidth || packet->viewportHeight != viewportHeight)
+    {
+        viewportWidth = packet->viewportWidth;
+        viewportHeight = packet->viewportHeight;
+        glViewport(0, 0, viewportWidth, viewportHeight);
+    }
+
+    glClearColor(packet->clearColor.r, packet->clearColor.g, packet->clearColor.b, packet->clearColor.a);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    Entity::RenderItems(packet->items.data(), packet->items.size(), nullptr, variants, &packet->view, &packet->projection, &packet->camera, &packet->fog);
+
+    glfwSwapBuffers(window);
+    renderedCount++;
+
+    lastFrameAllocations = Memory::GetThreadAllocationStats().allocationsCount - allocations;
+}
+
+void Renderer::threadfunc()
+{
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(vsync ? 1 : 0);
+
+    while (true)
+    {
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this]() { return stopping || submittedIndex >= 0; });
+            if (submittedIndex < 0) break; // stopping and nothing left.
+
+            index = renderingIndex = submittedIndex;
+            submittedIndex = -1;
+        }
+        cv.notify_all();
+
+        draw(&packets[index]);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            renderingIndex = -1;
+        }
+        cv.notify_all();
+    }
+
+    // commands enqueued after last frame (e.g. deleting of GL objects) still have to run.
+    runcommands(UINT64_MAX);
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+// === PUBLIC ===
+
+Renderer::Renderer(GLFWwindow *window, ShaderVariants *variants, bool vsync) : window(window), variants(variants), vsync(vsync)
+{
+    for (RenderPacket &p : packets) p = RenderPacket();
+}
+
+Renderer::~Renderer() { Stop(); }
+
+bool Renderer::Start()
+{
+    if (running) return false;
+
+    glfwMakeContextCurrent(nullptr);
+
+    stopping = false;
+    running = true;
+    thread = std::thread(&Renderer::threadfunc, this);
+
+    return true;
+}
+
+void Renderer::Stop()
+{
+    if (!running) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    thread.join();
+
+    running = false;
+    glfwMakeContextCurrent(window);
+}
+
+RenderPacket *Renderer::BeginPacket()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this]() { return writeIndex != renderingIndex && writeIndex != submittedIndex; });
+
+    RenderPacket *packet = &packets[writeIndex];
+    packet->items.clear(); // capacity is kept between frames.
+    packet->frame = submittedCount;
+    return packet;
+}
+
+void Renderer::SubmitPacket()
+{
+    if (!running)
+    {
+        draw(&packets[writeIndex]);
+        submittedCount++;
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        // previous packet must be taken first, frames are never dropped.
+        cv.wait(lock, [this]() { return submittedIndex < 0; });
+
+        submittedIndex = writeIndex;
+        writeIndex ^= 1;
+        submittedCount++;
+    }
+    cv.notify_all();
+}
+
+void Renderer::SetFrameCallback(std::function<void(RenderPacket *)> callback) { frameCallback = callback; }
+
+void Renderer::Enqueue(std::function<void()> command)
+{
+    if (!running)
+    {
+        command();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    commands.push_back(command);
+}
+
+void Renderer::EnqueueRelease(std::function<void()> command)
+{
+    if (!running)
+    {
+        command();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    releases.push_back({ submittedCount, command });
+}
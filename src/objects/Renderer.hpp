@@ -0,0 +1,107 @@
+#ifndef RENDERER_HPP
+#define RENDERER_HPP
+
+#include <vector>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+
+#include "../opengl.hpp"
+#include "../glm.hpp"
+#include "../memory.hpp"
+#include "../objects.hpp"
+#include "ShaderVariants.hpp"
+
+// everything render thread needs to draw one frame, it's filled by update thread and isn't changed after submit.
+struct
+{
+    uint64_t frame;
+
+    glm::mat4 view;
+    glm::mat4 projection;
+    Transform camera;
+    float cameraFOV;
+
+    FogRenderSettings fog;
+    glm::vec4 clearColor;
+
+    unsigned int viewportWidth;
+    unsigned int viewportHeight;
+
+    std::vector<RenderItem> items;
+} typedef RenderPacket;
+
+/*
+    Render thread that owns OpenGL context.
+
+    Update thread fills packet from BeginPacket() and hands it over by SubmitPacket(), render thread draws it
+    and swaps buffers meanwhile next packet is being filled (two packets, so update runs at most one frame ahead).
+    Any other GL work during frame loop (texture streaming, deleting objects) must go through
+    SetFrameCallback() or Enqueue().
+
+    Before Start() (or after Stop()) SubmitPacket() draws on calling thread, so renderer may be used single-threaded.
+*/
+class Renderer
+{
+  private:
+    GLFWwindow *window;
+    ShaderVariants *variants;
+    bool vsync;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool running = false;
+    bool stopping = false;
+
+    RenderPacket packets[2];
+    int writeIndex = 0;
+    int submittedIndex = -1;
+    int renderingIndex = -1;
+    uint64_t submittedCount = 0;
+
+    std::vector<std::function<void()>> commands = std::vector<std::function<void()>>();
+    std::vector<std::pair<uint64_t, std::function<void()>>> releases = std::vector<std::pair<uint64_t, std::function<void()>>>(); // submitted frames count at enqueue.
+    std::function<void(RenderPacket *)> frameCallback = nullptr;
+
+    unsigned int viewportWidth = 0, viewportHeight = 0;
+    std::atomic<uint64_t> renderedCount = 0;
+    std::atomic<unsigned long long> lastFrameAllocations = 0;
+
+    void threadfunc();
+    // releases are run only before packets begun after them (frame > their mark).
+    void runcommands(uint64_t frame);
+    void draw(RenderPacket *packet);
+
+  public:
+    Renderer(GLFWwindow *window, ShaderVariants *variants, bool vsync = false);
+    ~Renderer();
+
+    // context must be current on calling thread, it's moved to render thread.
+    bool Start();
+    // waits for last frame and makes context current on calling thread again.
+    void Stop();
+    inline bool IsRunning() { return running; }
+
+    // waits until render thread doesn't read the packet, returned packet is cleared.
+    RenderPacket *BeginPacket();
+    void SubmitPacket();
+
+    // called on render thread before drawing of each packet.
+    void SetFrameCallback(std::function<void(RenderPacket *)> callback);
+    // runs on render thread before next frame.
+    void Enqueue(std::function<void()> command);
+    // runs on render thread once every packet submitted so far is drawn, for deleting GL objects they may still reference.
+    void EnqueueRelease(std::function<void()> command);
+
+    inline uint64_t GetSubmittedFramesCount() { return submittedCount; }
+    inline uint64_t GetRenderedFramesCount() { return renderedCount; }
+    // general heap allocations made by render thread during last frame (should be 0 in steady state).
+    inline unsigned long long GetLastFrameAllocationsCount() { return lastFrameAllocations; }
+};
+
+#endif
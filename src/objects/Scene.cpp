@@ -0,0 +1,241 @@
+#include "Scene.hpp"
+
+// === PRIVATE ===
+
+static Transform totransform(const UCSCENETransform *t)
+{
+    return Transform(glm::vec3(t->position[0], t->position[1], t->position[2]),
+        glm::quat(t->rotation[3], t->rotation[0], t->rotation[1], t->rotation[2]),
+        glm::vec3(t->scale[0], t->scale[1], t->scale[2]));
+}
+
+void Scene::resolveassets()
+{
+    const UCSCENEAsset *table = file.GetAssets();
+    uint32_t count = file.GetCount(UCSCENE_TABLE_ASSETS);
+    assets.assign(count, nullptr);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const UCSCENEAsset *a = &table[i];
+        const char *path = file.GetString(a->path);
+
+        switch (a->type)
+        {
+            case UCSCENE_ASSET_MESH:
+                if (resolver.mesh) assets[i] = resolver.mesh(a->id, path);
+                else
+                {
+                    Mesh *m = new Mesh();
+                    if (m->LoadFromUCMESHFile(path)) { ownedMeshes.push_back(m); assets[i] = m; }
+                    else delete m;
+                }
+                break;
+
+            case UCSCENE_ASSET_TEXTURE:
+                if (resolver.texture) assets[i] = resolver.texture(a->id, path);
+                else
+                {
+                    Texture *t = new Texture();
+                    t->SetDefaultParametres();
+                    if (t->LoadFromUCTEXFile(path)) { ownedTextures.push_back(t); assets[i] = t; }
+                    else delete t;
+                }
+                break;
+
+            case UCSCENE_ASSET_AUDIOCLIP:
+                if (resolver.clip) assets[i] = resolver.clip(a->id, path);
+                else
+                {
+                    AudioClip *c = new AudioClip();
+                    if (c->LoadFromUCSOUNDFile(path)) { ownedClips.push_back(c); assets[i] = c; }
+                    else delete c;
+                }
+                break;
+        }
+    }
+}
+
+void *Scene::getasset(uint64_t id, UCSCENEAssetType type)
+{
+    if (id == 0) return nullptr;
+    int64_t i = file.FindAsset(id);
+    return i < 0 || file.GetAssets()[i].type != type ? nullptr : assets[i];
+}
+
+GameObject *Scene::createnode(const UCSCENENode *node, GameObject *parent)
+{
+    Transform t = totransform(&node->transform);
+    GameObject *obj;
+
+    switch (node->type)
+    {
+        case UCSCENE_NODE_ENTITY:
+        {
+            Entity *e = entities.Get(entities.Create(t));
+            e->color = glm::vec4(node->color[0], node->color[1], node->color[2], node->color[3]);
+            e->enableRender = !(node->flags & UCSCENE_NODE_HIDDEN);
+
+            const UCSCENESurface *surfaces = file.GetSurfaces() + node->firstSurface;
+            e->surfaces.reserve(node->surfacesCount);
+            for (uint32_t i = 0; i < node->surfacesCount; i++)
+            {
+                const UCSCENESurface *s = &surfaces[i];
+                Surface surface = Surface(totransform(&s->transform), (Mesh *)getasset(s->mesh, UCSCENE_ASSET_MESH), (Texture *)getasset(s->texture, UCSCENE_ASSET_TEXTURE), (FaceCullingType)s->culling);
+                surface.color = glm::vec4(s->color[0], s->color[1], s->color[2], s->color[3]);
+                surface.alphaCutoff = s->alphaCutoff;
+                surface.occluder = node->flags & UCSCENE_NODE_OCCLUDER;
+                e->surfaces.push_back(surface);
+            }
+            obj = e;
+            break;
+        }
+
+        case UCSCENE_NODE_AUDIOSOURCE:
+        {
+            AudioSource *src = audioSources.Get(audioSources.Create(t));
+            const UCSCENEAudioSource *info = &file.GetAudioSources()[node->audioSource];
+
+            src->SetSourceFloat(AL_GAIN, info->gain);
+            src->SetSourceFloat(AL_PITCH, info->pitch);
+            src->SetSourceFloat(AL_REFERENCE_DISTANCE, info->referenceDistance);
+            src->SetSourceFloat(AL_MAX_DISTANCE, info->maxDistance);
+            src->SetLooping(info->flags & UCSCENE_AUDIO_LOOPING);
+            if (info->effectSlot != UCSCENE_NONE) effectSlots[info->effectSlot]->AddSource(src);
+
+            AudioClip *clip = (AudioClip *)getasset(info->clip, UCSCENE_ASSET_AUDIOCLIP);
+            if (clip)
+            {
+                src->SetCurrentClip(clip);
+                if (info->flags & UCSCENE_AUDIO_AUTOPLAY) src->Play();
+            }
+            obj = src;
+            break;
+        }
+
+        default:
+            obj = empties.Get(empties.Create(t));
+            break;
+    }
+
+    if (parent) obj->SetParent(parent, false);
+    return obj;
+}
+
+GameObject *Scene::instantiate(const UCSCENEPrefab *prefab, Transform t, GameObject *parent)
+{
+    GameObject *root = empties.Get(empties.Create(t));
+    if (parent) root->SetParent(parent, false);
+
+    // parents always come first, so created objects of this instance are enough to link hierarchy.
+    FrameArena *arena = FrameArena::GetThreadArena();
+    FrameArena::Marker marker = arena->GetMarker();
+    {
+        GameObject **created = arena->AllocateArray<GameObject *>(prefab->nodesCount);
+        const UCSCENENode *n = file.GetNodes() + prefab->firstNode;
+        for (uint32_t i = 0; i < prefab->nodesCount; i++)
+            created[i] = createnode(&n[i], n[i].parent < 0 ? root : created[n[i].parent - prefab->firstNode]);
+    }
+    arena->Rewind(marker);
+
+    return root;
+}
+
+// === PUBLIC ===
+
+Scene::~Scene() { Clear(); }
+
+bool Scene::LoadFromUCSCENEFile(std::string filename)
+{
+    Clear();
+    if (!file.Open(filename)) return false;
+
+    resolveassets();
+
+    const UCSCENEEffectSlot *slots = file.GetEffectSlots();
+    const UCSCENEEffectParam *params = file.GetEffectParams();
+    for (uint32_t i = 0; i < file.GetCount(UCSCENE_TABLE_EFFECTSLOTS); i++)
+    {
+        AudioEffectProperties eff = AudioEffectProperties();
+        eff.SetEffectType(slots[i].effectType);
+        for (uint32_t p = 0; p < slots[i].paramsCount; p++) eff.SetEffectFloat(params[slots[i].firstParam + p].param, params[slots[i].firstParam + p].value);
+
+        AudioEffectSlot *slot = new AudioEffectSlot();
+        slot->ApplyEffect(eff);
+        effectSlots.push_back(slot);
+    }
+
+    // pools are sized once for whole scene including instances.
+    uint32_t counts[3] = { 0, 0, 0 };
+    const UCSCENENode *n = file.GetNodes();
+    for (uint32_t i = 0; i < file.GetSceneNodesCount(); i++) counts[n[i].type]++;
+
+    const UCSCENEInstance *instances = file.GetInstances();
+    uint32_t instancescount = file.GetCount(UCSCENE_TABLE_INSTANCES);
+    for (uint32_t i = 0; i < instancescount; i++)
+    {
+        int64_t p = file.FindPrefab(instances[i].prefab);
+        if (p < 0) continue;
+
+        const UCSCENEPrefab *prefab = &file.GetPrefabs()[p];
+        counts[UCSCENE_NODE_EMPTY]++;
+        for (uint32_t j = 0; j < prefab->nodesCount; j++) counts[n[prefab->firstNode + j].type]++;
+    }
+    empties.Reserve(counts[UCSCENE_NODE_EMPTY]);
+    entities.Reserve(counts[UCSCENE_NODE_ENTITY]);
+    audioSources.Reserve(counts[UCSCENE_NODE_AUDIOSOURCE]);
+
+    nodes.resize(file.GetSceneNodesCount());
+    for (uint32_t i = 0; i < nodes.size(); i++) nodes[i] = createnode(&n[i], n[i].parent < 0 ? nullptr : nodes[n[i].parent]);
+
+    for (uint32_t i = 0; i < instancescount; i++)
+    {
+        const UCSCENEInstance *inst = &instances[i];
+        Instantiate(inst->prefab, totransform(&inst->transform), inst->parent < 0 ? nullptr : nodes[inst->parent]);
+    }
+
+    // optional, "level.ucscene" -> "level.ucpvs".
+    size_t dot = filename.find_last_of('.');
+    if (dot != std::string::npos && filename.find_first_of("/\\", dot) == std::string::npos) pvs.LoadFromUCPVSFile(filename.substr(0, dot) + ".ucpvs");
+
+    return true;
+}
+
+void Scene::Clear()
+{
+    // sources first (they detach from slots), children are unparented by their parents' destructors.
+    audioSources.Clear();
+    entities.Clear();
+    empties.Clear();
+    nodes.clear();
+    pvs.Clear();
+
+    for (AudioEffectSlot *s : effectSlots) delete s;
+    effectSlots.clear();
+
+    for (Mesh *m : ownedMeshes) delete m;
+    for (Texture *t : ownedTextures) delete t;
+    for (AudioClip *c : ownedClips) delete c;
+    ownedMeshes.clear();
+    ownedTextures.clear();
+    ownedClips.clear();
+    assets.clear();
+
+    file.Close();
+}
+
+GameObject *Scene::Instantiate(uint64_t prefab, Transform t, GameObject *parent)
+{
+    if (!file.IsOpen()) return nullptr;
+
+    int64_t p = file.FindPrefab(prefab);
+    if (p < 0) return nullptr;
+    return instantiate(&file.GetPrefabs()[p], t, parent);
+}
+
+void Scene::SaveTransformStates()
+{
+    empties.ForEach([](GameObject *o) { o->SaveTransformState(); });
+    entities.ForEach([](Entity *e) { e->SaveTransformState(); });
+    audioSources.ForEach([](AudioSource *s) { s->SaveTransformState(); });
+}
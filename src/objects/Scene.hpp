@@ -0,0 +1,96 @@
+#ifndef SCENE_HPP
+#define SCENE_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+#include "../objects.hpp"
+#include "../formats/UCSCENEFile.hpp"
+#include "HandlePool.hpp"
+#include "PotentiallyVisibleSet.hpp"
+
+// resolves asset id (path is given for loaders that need it) to already loaded asset, nullptr - missing.
+struct
+{
+    std::function<Mesh *(uint64_t id, const char *path)> mesh;
+    std::function<Texture *(uint64_t id, const char *path)> texture;
+    std::function<AudioClip *(uint64_t id, const char *path)> clip;
+} typedef SceneAssetResolver;
+
+/*
+    Runtime of UCSCENE file: objects are bulk constructed into pools right from mapped records,
+    every asset is resolved once per file (not per reference). File stays mapped while scene is loaded,
+    so prefabs can be instantiated later without reading anything.
+
+    Assets without resolver (or when resolver's function is empty) are loaded synchronously and owned by scene.
+    Objects are owned by scene, pointers given out are valid until Clear().
+
+    If there is UCPVS file next to scene file (see pvsbuilder), render items of scene are limited to what can be
+    seen from cell of position given to SetViewPosition().
+*/
+class Scene
+{
+  private:
+    UCSCENEFile file;
+    PotentiallyVisibleSet pvs;
+    SceneAssetResolver resolver = SceneAssetResolver();
+
+    std::vector<void *> assets = std::vector<void *>(); // by index in asset table.
+    std::vector<Mesh *> ownedMeshes = std::vector<Mesh *>();
+    std::vector<Texture *> ownedTextures = std::vector<Texture *>();
+    std::vector<AudioClip *> ownedClips = std::vector<AudioClip *>();
+
+    HandlePool<GameObject> empties = HandlePool<GameObject>();
+    HandlePool<Entity> entities = HandlePool<Entity>();
+    HandlePool<AudioSource> audioSources = HandlePool<AudioSource>();
+    std::vector<AudioEffectSlot *> effectSlots = std::vector<AudioEffectSlot *>();
+
+    std::vector<GameObject *> nodes = std::vector<GameObject *>(); // scene nodes by index.
+
+    void resolveassets();
+    // nullptr if asset is missing or of other type.
+    void *getasset(uint64_t id, UCSCENEAssetType type);
+    GameObject *createnode(const UCSCENENode *node, GameObject *parent);
+    GameObject *instantiate(const UCSCENEPrefab *prefab, Transform t, GameObject *parent);
+
+  public:
+    Scene() {}
+    ~Scene();
+
+    Scene(const Scene &) = delete;
+    Scene &operator=(const Scene &) = delete;
+
+    // used by following LoadFromUCSCENEFile() calls.
+    inline void SetAssetResolver(SceneAssetResolver r) { resolver = r; }
+
+    // replaces current scene.
+    bool LoadFromUCSCENEFile(std::string filename);
+    void Clear();
+    inline bool IsLoaded() { return file.IsOpen(); }
+
+    // prefab id is Utils::hash64() of its name, returns root of instance or nullptr if there is no such prefab.
+    GameObject *Instantiate(uint64_t prefab, Transform t, GameObject *parent = nullptr);
+
+    inline GameObject *GetNodeObject(uint32_t node) { return node < nodes.size() ? nodes[node] : nullptr; }
+    inline size_t GetNodesCount() { return nodes.size(); }
+    inline size_t GetObjectsCount() { return empties.GetCount() + entities.GetCount() + audioSources.GetCount(); }
+
+    void SaveTransformStates();
+
+    inline PotentiallyVisibleSet *GetPVS() { return &pvs; }
+    // camera position for following CollectRenderItems() calls.
+    inline void SetViewPosition(glm::vec3 position) { pvs.SetViewPosition(position); }
+
+    // items is std::vector or ArenaVector of RenderItem.
+    template <typename Vector>
+    void CollectRenderItems(Vector *items)
+    {
+        size_t first = items->size();
+        entities.ForEach([items](Entity *e) { e->CollectRenderItems(items); });
+        pvs.Cull(items, first);
+    }
+};
+
+#endif
@@ -1,5 +1,81 @@
 #include "ShaderProgram.hpp"
 
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <filesystem>
+
+#include "../utils.hpp"
+
+// === PRIVATE ===
+
+#define SHADER_CACHE_VERSION 1
+
+static std::string glstring(GLenum name)
+{
+    const GLubyte *str = glGetString(name);
+    return str ? std::string((const char *)str) : std::string();
+}
+
+GLint ShaderProgram::uniformlocation(const char *name)
+{
+    if (!HasShaderProgram()) return -1;
+
+    for (std::pair<std::string, GLint> &u : uniformLocations)
+        if (u.first == name) return u.second;
+
+    GLint location = glGetUniformLocation(shaderProgram, name);
+    uniformLocations.push_back({ name, location });
+    return location;
+}
+
+std::string ShaderProgram::cachefilename(std::string cachedir)
+{ return (std::filesystem::path(cachedir) / (Utils::tohex(GetBinaryCacheKey()) + ".ucshbin")).string(); }
+
+static void writestring(FILE *f, std::string str)
+{
+    uint32_t len = str.size();
+    fwrite(&len, sizeof(len), 1, f);
+    fwrite(str.data(), sizeof(char), len, f);
+}
+
+static bool readstring(FILE *f, std::string *str)
+{
+    uint32_t len;
+    fread(&len, sizeof(len), 1, f);
+    if (feof(f) || len > 0xFFFFFF) return false; // shader sources are stored too.
+
+    str->resize(len);
+    if (len > 0 && fread(str->data(), sizeof(char), len, f) != len) return false;
+    return true;
+}
+
+static std::string shaderlog(GLuint shader)
+{
+    GLint length = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+    if (length <= 0) return "";
+
+    std::string log = std::string(length, '\0');
+    glGetShaderInfoLog(shader, length, &length, log.data());
+    log.resize(length);
+    return log;
+}
+
+static std::string programlog(GLuint program)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+    if (length <= 0) return "";
+
+    std::string log = std::string(length, '\0');
+    glGetProgramInfoLog(program, length, &length, log.data());
+    log.resize(length);
+    return log;
+}
+
+// === PUBLIC ===
+
 ShaderProgram::ShaderProgram() {}
 ShaderProgram::~ShaderProgram()
 {
@@ -21,6 +97,7 @@ bool ShaderProgram::DeleteShaderProgram()
     if (!HasShaderProgram()) return false;
     glDeleteProgram(shaderProgram);
     hasShaderProgram = false;
+    uniformLocations.clear();
     return true;
 }
 
@@ -46,6 +123,8 @@ bool ShaderProgram::LoadVertexShader(std::string source)
 {
     if (HasVertexShader()) return false;
 
+    vertexSource = source;
+
     const char *source_ptr = source.c_str();
     vertexShader = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(vertexShader, 1, &source_ptr, NULL);
@@ -58,6 +137,8 @@ bool ShaderProgram::LoadFragmentShader(std::string source)
 {
     if (HasFragmentShader()) return false;
 
+    fragmentSource = source;
+
     const char *source_ptr = source.c_str();
     fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
     glShaderSource(fragmentShader, 1, &source_ptr, NULL);
@@ -139,6 +220,7 @@ bool ShaderProgram::LinkShaderProgram(std::string *errorlog)
     glAttachShader(shaderProgram, vertexShader);
     glAttachShader(shaderProgram, fragmentShader);
 
+    glProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(shaderProgram);
 
     GLint success;
@@ -163,63 +245,268 @@ bool ShaderProgram::LinkShaderProgram(std::string *errorlog)
     return true;
 }
 
-bool ShaderProgram::UseThisProgram()
+uint64_t ShaderProgram::GetBinaryCacheKey()
 {
-    if (!HasShaderProgram()) return false;
+    uint64_t hash = Utils::hash64(vertexSource);
+    hash = Utils::hash64("\0", 1, hash);
+    hash = Utils::hash64(fragmentSource, hash);
 
-    glUseProgram(shaderProgram);
+    hash = Utils::hash64(glstring(GL_VENDOR), hash);
+    hash = Utils::hash64(glstring(GL_RENDERER), hash);
+    hash = Utils::hash64(glstring(GL_VERSION), hash);
+
+    return hash;
+}
+
+bool ShaderProgram::LoadFromBinaryCache(std::string cachedir)
+{
+    if (HasShaderProgram() || vertexSource.empty() || fragmentSource.empty()) return false;
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) return false;
+
+    std::string filename = cachefilename(cachedir);
+    if (!std::filesystem::is_regular_file(filename)) return false;
+
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+
+    std::string vendor, renderer, version;
+    GLenum format;
+    uint32_t length;
+    std::string vs, fs;
+    std::vector<uint8_t> binary;
+
+    char sig[7];
+    fread(&sig, sizeof(char), 7, f);
+    if (feof(f) || strncmp(sig, "UCSHBIN", 7)) goto cachemiss;
+
+    uint16_t cacheversion;
+    fread(&cacheversion, sizeof(cacheversion), 1, f);
+    if (feof(f) || cacheversion != SHADER_CACHE_VERSION) goto cachemiss;
+
+    // full sources are stored, so collision of 64-bit key (file name) can't load binary of other program.
+    if (!readstring(f, &vs) || !readstring(f, &fs) || vs != vertexSource || fs != fragmentSource) goto cachemiss;
+
+    if (!readstring(f, &vendor) || !readstring(f, &renderer) || !readstring(f, &version)) goto cachemiss;
+    if (vendor != glstring(GL_VENDOR) || renderer != glstring(GL_RENDERER) || version != glstring(GL_VERSION)) goto cachemiss;
+
+    fread(&format, sizeof(format), 1, f);
+    fread(&length, sizeof(length), 1, f);
+    if (feof(f) || length == 0) goto cachemiss;
+
+    binary.resize(length);
+    if (fread(binary.data(), sizeof(uint8_t), length, f) != length) goto cachemiss;
+    fclose(f);
+
+    shaderProgram = glCreateProgram();
+    glProgramBinary(shaderProgram, format, binary.data(), length);
+
+    GLint success;
+    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+    if (success == GL_FALSE)
+    {
+        // driver rejected binary (format changed), stale entry is removed.
+        glDeleteProgram(shaderProgram);
+        std::error_code ec;
+        std::filesystem::remove(filename, ec);
+        return false;
+    }
+    hasShaderProgram = true;
+
+    // shaders objects aren't needed anymore, sources are still kept.
+    DeleteVertexShader();
+    DeleteFragmentShader();
+
+    return true;
+
+    cachemiss:
+        fclose(f);
+    return false;
+}
+
+bool ShaderProgram::SaveToBinaryCache(std::string cachedir)
+{
+    if (!HasShaderProgram() || compilePending) return false;
+
+    GLint linked;
+    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE) return false;
+
+    GLint length = 0;
+    glGetProgramiv(shaderProgram, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return false;
+
+    std::vector<uint8_t> binary = std::vector<uint8_t>(length);
+    GLenum format;
+    glGetProgramBinary(shaderProgram, length, &length, &format, binary.data());
+    if (length <= 0) return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(cachedir, ec);
+
+    // written to temporary file first, so interrupted write never leaves broken entry.
+    std::string filename = cachefilename(cachedir);
+    std::string tmpfilename = filename + ".tmp";
+
+    FILE *f = fopen(tmpfilename.c_str(), "wb");
+    if (!f) return false;
+
+    uint16_t cacheversion = SHADER_CACHE_VERSION;
+    uint32_t len32 = length;
+
+    fwrite("UCSHBIN", sizeof(char), 7, f);
+    fwrite(&cacheversion, sizeof(cacheversion), 1, f);
+    writestring(f, vertexSource);
+    writestring(f, fragmentSource);
+    writestring(f, glstring(GL_VENDOR));
+    writestring(f, glstring(GL_RENDERER));
+    writestring(f, glstring(GL_VERSION));
+    fwrite(&format, sizeof(format), 1, f);
+    fwrite(&len32, sizeof(len32), 1, f);
+    bool ok = fwrite(binary.data(), sizeof(uint8_t), len32, f) == len32;
+
+    if (fclose(f) != 0) ok = false;
+    if (ok) std::filesystem::rename(tmpfilename, filename, ec);
+    if (!ok || ec)
+    {
+        std::filesystem::remove(tmpfilename, ec);
+        return false;
+    }
 
     return true;
 }
 
-bool ShaderProgram::HasUniform(std::string name)
+bool ShaderProgram::BeginCompile()
 {
+    if (compilePending || HasShaderProgram() || !HasVertexShader() || !HasFragmentShader()) return false;
+    if (IsVertexShaderCompiled() || IsFragmentShaderCompiled()) return false;
+
+    glCompileShader(vertexShader);
+    glCompileShader(fragmentShader);
+
+    // linking right after compiling is allowed, errors of shaders are reported by link status.
+    shaderProgram = glCreateProgram();
+    hasShaderProgram = true;
+
+    glAttachShader(shaderProgram, vertexShader);
+    glAttachShader(shaderProgram, fragmentShader);
+
+    glProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(shaderProgram);
+
+    compilePending = true;
+    return true;
+}
+
+bool ShaderProgram::IsCompilePending() { return compilePending; }
+
+bool ShaderProgram::IsCompileCompleted()
+{
+    if (!compilePending || !hasParallelShaderCompile()) return true;
+
+    GLint completed = GL_FALSE;
+    glGetProgramiv(shaderProgram, GL_COMPLETION_STATUS_KHR, &completed);
+    return completed == GL_TRUE;
+}
+
+bool ShaderProgram::FinishCompile(std::string *errorlog)
+{
+    if (errorlog) *errorlog = "";
+    if (!compilePending) return false;
+    compilePending = false;
+
+    GLint success;
+    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+    if (success == GL_FALSE)
+    {
+        if (errorlog) *errorlog = shaderlog(vertexShader);
+        DeleteShaderProgram();
+        DeleteVertexShader();
+        return false;
+    }
+    vertexShaderCompiled = true;
+
+    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+    if (success == GL_FALSE)
+    {
+        if (errorlog) *errorlog = shaderlog(fragmentShader);
+        DeleteShaderProgram();
+        DeleteFragmentShader();
+        return false;
+    }
+    fragmentShaderCompiled = true;
+
+    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+    if (success == GL_FALSE)
+    {
+        if (errorlog) *errorlog = programlog(shaderProgram);
+        DeleteShaderProgram();
+        return false;
+    }
+
+    return true;
+}
+
+bool ShaderProgram::UseThisProgram()
+{
+    if (compilePending && !FinishCompile()) return false;
     if (!HasShaderProgram()) return false;
 
-    return glGetUniformLocation(shaderProgram, name.c_str()) != -1;
+    glUseProgram(shaderProgram);
+
+    return true;
 }
 
-bool ShaderProgram::SetUniformInteger(std::string name, int value)
+bool ShaderProgram::HasUniform(const char *name) { return uniformlocation(name) != -1; }
+
+bool ShaderProgram::SetUniformInteger(const char *name, int value)
 {
-    if (!HasUniform(name)) return false;
+    GLint location = uniformlocation(name);
+    if (location == -1) return false;
 
-    glUniform1i(glGetUniformLocation(shaderProgram, name.c_str()), value);
+    glUniform1i(location, value);
 
     return true;
 }
 
-bool ShaderProgram::SetUniformFloat(std::string name, float value)
+bool ShaderProgram::SetUniformFloat(const char *name, float value)
 {
-    if (!HasUniform(name)) return false;
+    GLint location = uniformlocation(name);
+    if (location == -1) return false;
 
-    glUniform1f(glGetUniformLocation(shaderProgram, name.c_str()), value);
+    glUniform1f(location, value);
 
     return true;
 }
 
-bool ShaderProgram::SetUniformVector3(std::string name, glm::vec3 value)
+bool ShaderProgram::SetUniformVector3(const char *name, glm::vec3 value)
 {
-    if (!HasUniform(name)) return false;
+    GLint location = uniformlocation(name);
+    if (location == -1) return false;
 
-    glUniform3fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, glm::value_ptr(value));
+    glUniform3fv(location, 1, glm::value_ptr(value));
 
     return true;
 }
 
-bool ShaderProgram::SetUniformVector4(std::string name, glm::vec4 value)
+bool ShaderProgram::SetUniformVector4(const char *name, glm::vec4 value)
 {
-    if (!HasUniform(name)) return false;
+    GLint location = uniformlocation(name);
+    if (location == -1) return false;
 
-    glUniform4fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, glm::value_ptr(value));
+    glUniform4fv(location, 1, glm::value_ptr(value));
 
     return true;
 }
 
-bool ShaderProgram::SetUniformMatrix4x4(std::string name, glm::mat4 value)
+bool ShaderProgram::SetUniformMatrix4x4(const char *name, glm::mat4 value)
 {
-    if (!HasUniform(name)) return false;
+    GLint location = uniformlocation(name);
+    if (location == -1) return false;
 
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
 
     return true;
 }
\ No newline at end of file
@@ -2,6 +2,9 @@
 #define SHADERPROGRAM_HPP
 
 #include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
 
 #include "../opengl.hpp"
 #include "../glm.hpp"
@@ -20,6 +23,19 @@ class ShaderProgram
     bool hasFragmentShader = false;
     bool fragmentShaderCompiled = false;
 
+    // kept for binary cache key.
+    std::string vertexSource = "";
+    std::string fragmentSource = "";
+
+    // BeginCompile() was called, but statuses weren't queried yet.
+    bool compilePending = false;
+
+    // uniform locations (-1 too) of current program, linear search is cheaper than hashing for few uniforms.
+    std::vector<std::pair<std::string, GLint>> uniformLocations = std::vector<std::pair<std::string, GLint>>();
+
+    std::string cachefilename(std::string cachedir);
+    GLint uniformlocation(const char *name);
+
   public:
     ShaderProgram();
     ~ShaderProgram();
@@ -44,12 +60,36 @@ class ShaderProgram
     bool LinkShaderProgram(std::string *errorlog = nullptr);
     bool UseThisProgram();
 
-    bool HasUniform(std::string name);
-    bool SetUniformInteger(std::string name, int value);
-    bool SetUniformFloat(std::string name, float value);
-    bool SetUniformVector3(std::string name, glm::vec3 value);
-    bool SetUniformVector4(std::string name, glm::vec4 value);
-    bool SetUniformMatrix4x4(std::string name, glm::mat4 value);
+    /*
+        Asynchronous compilation: BeginCompile() issues compile and link of both loaded shaders without
+        querying any status, so driver can build them in background (KHR_parallel_shader_compile) while
+        CPU does something else. IsCompileCompleted() polls without blocking when extension is available
+        (otherwise it always returns true, as there is no way to check it). FinishCompile() waits for result,
+        UseThisProgram() calls it implicitly if it wasn't called yet.
+    */
+    bool BeginCompile();
+    bool IsCompilePending();
+    bool IsCompileCompleted();
+    bool FinishCompile(std::string *errorlog = nullptr);
+
+    /*
+        Program binary cache (glGetProgramBinary/glProgramBinary).
+        Cache entry is keyed by shader sources and GL vendor/renderer/version strings, so driver
+        update or source change just makes a miss. Sources must be loaded before using cache.
+    */
+    uint64_t GetBinaryCacheKey();
+    // on success program is ready to use (shaders compilation is skipped), on any mismatch returns false.
+    bool LoadFromBinaryCache(std::string cachedir);
+    // program must be linked.
+    bool SaveToBinaryCache(std::string cachedir);
+
+    // names are C strings, so setting uniforms every draw allocates nothing.
+    bool HasUniform(const char *name);
+    bool SetUniformInteger(const char *name, int value);
+    bool SetUniformFloat(const char *name, float value);
+    bool SetUniformVector3(const char *name, glm::vec3 value);
+    bool SetUniformVector4(const char *name, glm::vec4 value);
+    bool SetUniformMatrix4x4(const char *name, glm::mat4 value);
 };
 
 
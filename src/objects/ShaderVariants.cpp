@@ -0,0 +1,165 @@
+#include "ShaderVariants.hpp"
+
+// === PRIVATE ===
+
+std::string ShaderVariants::injectdefines(std::string source, ShaderFeatures features)
+{
+    std::string defines = "";
+    for (unsigned int i = 0; i < SHADER_FEATURES_COUNT; i++)
+        if (features & (1 << i)) defines += std::string("#define ") + GetFeatureDefine((ShaderFeature)(1 << i)) + "\n";
+
+    // #version must stay first directive.
+    size_t pos = source.find("#version");
+    if (pos == std::string::npos) return defines + source;
+
+    size_t eol = source.find('\n', pos);
+    if (eol == std::string::npos) return source + "\n" + defines;
+
+    return source.substr(0, eol + 1) + defines + source.substr(eol + 1);
+}
+
+// loads variant from cache (ready) or begins its compilation (pending).
+ShaderProgram *ShaderVariants::create(ShaderFeatures features)
+{
+    ShaderProgram *sp = new ShaderProgram();
+    sp->LoadVertexShader(injectdefines(vertexSource, features));
+    sp->LoadFragmentShader(injectdefines(fragmentSource, features));
+
+    if (!cachedir.empty() && sp->LoadFromBinaryCache(cachedir)) return sp;
+
+    sp->BeginCompile();
+    return sp;
+}
+
+ShaderProgram *ShaderVariants::finish(ShaderFeatures features, ShaderProgram *sp)
+{
+    if (sp->IsCompilePending())
+    {
+        std::string log;
+        if (!sp->FinishCompile(&log))
+        {
+            failed[features] = "building variant " + GetFeaturesString(features) + " error: " + log;
+            delete sp;
+            return nullptr;
+        }
+        if (!cachedir.empty()) sp->SaveToBinaryCache(cachedir);
+    }
+
+    variants[features] = sp;
+    return sp;
+}
+
+// === PUBLIC ===
+
+ShaderVariants::ShaderVariants(std::string vertex_source, std::string fragment_source, std::string cache_dir)
+    : vertexSource(vertex_source), fragmentSource(fragment_source), cachedir(cache_dir) {}
+
+ShaderVariants::~ShaderVariants()
+{
+    for (std::pair<const ShaderFeatures, ShaderProgram *> &p : variants) delete p.second;
+    for (std::pair<const ShaderFeatures, ShaderProgram *> &p : pending) delete p.second;
+}
+
+const char *ShaderVariants::GetFeatureDefine(ShaderFeature feature)
+{
+    switch (feature)
+    {
+        case SHADER_FEATURE_TEXTURED: return "FEATURE_TEXTURED";
+        case SHADER_FEATURE_TEXTURE_ARRAY: return "FEATURE_TEXTURE_ARRAY";
+        case SHADER_FEATURE_FOG: return "FEATURE_FOG";
+        case SHADER_FEATURE_ALPHA_TEST: return "FEATURE_ALPHA_TEST";
+        case SHADER_FEATURE_INSTANCED: return "FEATURE_INSTANCED";
+        default: return "FEATURE_UNKNOWN";
+    }
+}
+
+std::string ShaderVariants::GetFeaturesString(ShaderFeatures features)
+{
+    if (features == SHADER_FEATURE_NONE) return "[]";
+
+    std::string ret = "[";
+    for (unsigned int i = 0; i < SHADER_FEATURES_COUNT; i++)
+    {
+        if (!(features & (1 << i))) continue;
+        if (ret.size() > 1) ret += ", ";
+        ret += GetFeatureDefine((ShaderFeature)(1 << i));
+    }
+    return ret + "]";
+}
+
+ShaderProgram *ShaderVariants::GetVariant(ShaderFeatures features)
+{
+    auto it = variants.find(features);
+    if (it != variants.end()) return it->second;
+    if (failed.count(features)) return nullptr; // don't retry broken variant every draw.
+
+    ShaderProgram *sp;
+    auto pit = pending.find(features);
+    if (pit != pending.end())
+    {
+        sp = pit->second;
+        pending.erase(pit);
+    }
+    else sp = create(features);
+
+    return finish(features, sp);
+}
+
+bool ShaderVariants::HasVariant(ShaderFeatures features) { return variants.count(features) > 0; }
+
+std::string ShaderVariants::GetVariantError(ShaderFeatures features)
+{
+    auto it = failed.find(features);
+    return it != failed.end() ? it->second : "";
+}
+
+unsigned int ShaderVariants::Precompile(std::vector<ShaderFeatures> list)
+{
+    // all compilations are started first, so they can overlap.
+    BeginPrecompile(list);
+
+    unsigned int count = 0;
+    for (ShaderFeatures f : list) if (GetVariant(f)) count++;
+    return count;
+}
+
+unsigned int ShaderVariants::BeginPrecompile(std::vector<ShaderFeatures> list)
+{
+    unsigned int count = 0;
+    for (ShaderFeatures f : list)
+    {
+        if (variants.count(f) || pending.count(f) || failed.count(f)) continue;
+
+        ShaderProgram *sp = create(f);
+        if (sp->IsCompilePending())
+        {
+            pending[f] = sp;
+            count++;
+        }
+        else variants[f] = sp;
+    }
+    return count;
+}
+
+unsigned int ShaderVariants::Update()
+{
+    // without extension any status query would block.
+    if (!hasParallelShaderCompile()) return pending.size();
+
+    for (auto it = pending.begin(); it != pending.end();)
+    {
+        if (!it->second->IsCompileCompleted()) { it++; continue; }
+
+        finish(it->first, it->second);
+        it = pending.erase(it);
+    }
+    return pending.size();
+}
+
+unsigned int ShaderVariants::FinishPending()
+{
+    unsigned int count = 0;
+    for (std::pair<const ShaderFeatures, ShaderProgram *> &p : pending) if (finish(p.first, p.second)) count++;
+    pending.clear();
+    return count;
+}
@@ -0,0 +1,79 @@
+#ifndef SHADERVARIANTS_HPP
+#define SHADERVARIANTS_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "ShaderProgram.hpp"
+
+enum
+{
+    SHADER_FEATURE_NONE = 0,
+    SHADER_FEATURE_TEXTURED = 1 << 0, // FEATURE_TEXTURED
+    SHADER_FEATURE_TEXTURE_ARRAY = 1 << 1, // FEATURE_TEXTURE_ARRAY
+    SHADER_FEATURE_FOG = 1 << 2, // FEATURE_FOG
+    SHADER_FEATURE_ALPHA_TEST = 1 << 3, // FEATURE_ALPHA_TEST
+    SHADER_FEATURE_INSTANCED = 1 << 4, // FEATURE_INSTANCED
+
+    SHADER_FEATURES_COUNT = 5
+} typedef ShaderFeature;
+
+typedef uint32_t ShaderFeatures;
+
+/*
+    Set of ShaderProgram permutations of one vertex/fragment source pair.
+    Every enabled feature is injected into both sources as "#define FEATURE_<NAME>" right after #version line,
+    so sources select code with #ifdef instead of branching on uniforms at runtime.
+
+    Variants are compiled on first request (or ahead of time by Precompile()) and go through binary cache
+    when cache folder is given.
+
+    BeginPrecompile() only starts compilation of variants that aren't in cache, with KHR_parallel_shader_compile
+    driver builds them in background, Update() collects finished ones without blocking, and GetVariant()
+    waits only for variant it's asked for.
+*/
+class ShaderVariants
+{
+  private:
+    std::string vertexSource;
+    std::string fragmentSource;
+    std::string cachedir;
+
+    std::unordered_map<ShaderFeatures, ShaderProgram *> variants = std::unordered_map<ShaderFeatures, ShaderProgram *>();
+    std::unordered_map<ShaderFeatures, std::string> failed = std::unordered_map<ShaderFeatures, std::string>();
+    std::unordered_map<ShaderFeatures, ShaderProgram *> pending = std::unordered_map<ShaderFeatures, ShaderProgram *>();
+
+    static std::string injectdefines(std::string source, ShaderFeatures features);
+    ShaderProgram *create(ShaderFeatures features);
+    ShaderProgram *finish(ShaderFeatures features, ShaderProgram *sp);
+
+  public:
+    ShaderVariants(std::string vertex_source, std::string fragment_source, std::string cache_dir = "");
+    ~ShaderVariants();
+
+    static const char *GetFeatureDefine(ShaderFeature feature);
+    static std::string GetFeaturesString(ShaderFeatures features);
+
+    // nullptr if variant can't be built, error is available from GetVariantError(). Pending variant is waited for.
+    ShaderProgram *GetVariant(ShaderFeatures features);
+    bool HasVariant(ShaderFeatures features);
+    std::string GetVariantError(ShaderFeatures features);
+
+    // returns count of successfully built variants.
+    unsigned int Precompile(std::vector<ShaderFeatures> list);
+
+    // returns count of variants which compilation has started (cached ones are ready immediately).
+    unsigned int BeginPrecompile(std::vector<ShaderFeatures> list);
+    // collects variants which compilation has completed, returns count of still pending ones.
+    unsigned int Update();
+    // waits for all pending variants, returns count of successfully built ones.
+    unsigned int FinishPending();
+
+    inline size_t GetPendingCount() { return pending.size(); }
+
+    inline size_t GetVariantsCount() { return variants.size(); }
+};
+
+#endif
@@ -0,0 +1,272 @@
+#include "TexturePacker.hpp"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <functional>
+
+// === PRIVATE ===
+
+static bool isparam(std::vector<std::pair<GLenum, GLint>> *params, GLenum param)
+{
+    for (std::pair<GLenum, GLint> p : *params)
+        if (p.first == param) return true;
+    return false;
+}
+
+TextureArray *TexturePacker::newarray(uint32_t width, uint32_t height, uint32_t layers, std::vector<std::pair<GLenum, GLint>> *params)
+{
+    TextureArray *arr = new TextureArray();
+    if (!arr->Create(width, height, layers)) { delete arr; return nullptr; }
+
+    for (std::pair<GLenum, GLint> p : *params)
+    {
+        if (p.first == GL_TEXTURE_MAX_LEVEL) continue;
+        arr->SetTextureIntParameter(p.first, p.second);
+    }
+    // default GL min filter needs mips, arrays have only one level.
+    if (!isparam(params, GL_TEXTURE_MIN_FILTER)) arr->SetTextureIntParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+    arrays.push_back(arr);
+    stats.arraysCount++;
+    stats.layersCount += layers;
+    stats.arraysSizeInBytes += arr->GetSizeInBytes();
+
+    return arr;
+}
+
+void TexturePacker::packlayers(std::vector<PackEntry *> *group)
+{
+    GLint maxlayers;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxlayers);
+    if (maxlayers < 1) maxlayers = 1;
+
+    for (size_t first = 0; first < group->size(); first += maxlayers)
+    {
+        uint32_t count = std::min(group->size() - first, (size_t)maxlayers);
+        PackEntry *head = (*group)[first];
+
+        TextureArray *arr = newarray(head->image.GetWidth(), head->image.GetHeight(), count, &head->params);
+        if (!arr) continue;
+
+        for (uint32_t l = 0; l < count; l++)
+        {
+            PackEntry *e = (*group)[first + l];
+            arr->SetLayer(l, &e->image);
+
+            e->texture->DeleteTexture();
+            e->texture->packedarray = arr;
+            e->texture->packedlayer = l;
+            e->texture->packedrect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+            e->texture->width = e->image.GetWidth();
+            e->texture->height = e->image.GetHeight();
+            packed.push_back(e->texture);
+
+            stats.layeredCount++;
+        }
+    }
+}
+
+void TexturePacker::packatlas(std::vector<PackEntry *> *group)
+{
+    // shelf packing, tallest textures first.
+    std::sort(group->begin(), group->end(), [](PackEntry *a, PackEntry *b) { return a->image.GetHeight() > b->image.GetHeight(); });
+
+    struct
+    {
+        PackEntry *entry;
+        uint32_t layer, x, y;
+    } typedef Placement;
+
+    std::vector<Placement> placements = std::vector<Placement>();
+    uint32_t layer = 0, shelfx = 0, shelfy = 0, shelfh = 0;
+    for (PackEntry *e : *group)
+    {
+        uint32_t w = e->image.GetWidth() + atlasPadding * 2;
+        uint32_t h = e->image.GetHeight() + atlasPadding * 2;
+
+        if (shelfx + w > atlasSize) { shelfy += shelfh; shelfx = 0; shelfh = 0; }
+        if (shelfy + h > atlasSize) { layer++; shelfx = shelfy = shelfh = 0; }
+
+        placements.push_back({ e, layer, shelfx + atlasPadding, shelfy + atlasPadding });
+        shelfx += w;
+        shelfh = std::max(shelfh, h);
+    }
+    if (placements.empty()) return;
+
+    // last layer is cropped to used height when it is the only one.
+    uint32_t height = layer == 0 ? std::min(atlasSize, shelfy + shelfh) : atlasSize;
+
+    TextureArray *arr = newarray(atlasSize, height, layer + 1, &(*group)[0]->params);
+    if (!arr) return;
+
+    std::vector<UCTEXImage> layers = std::vector<UCTEXImage>(layer + 1, UCTEXImage(atlasSize, height));
+    for (Placement &p : placements)
+    {
+        UCTEXImage *src = &p.entry->image;
+        UCTEXImage *dst = &layers[p.layer];
+        uint32_t w = src->GetWidth(), h = src->GetHeight();
+
+        // copy with edge replication into gutter.
+        int pad = atlasPadding;
+        for (int y = -pad; y < (int)h + pad; y++)
+        {
+            uint32_t sy = (uint32_t)std::clamp(y, 0, (int)h - 1);
+            for (int x = -pad; x < (int)w + pad; x++)
+            {
+                uint32_t sx = (uint32_t)std::clamp(x, 0, (int)w - 1);
+                dst->SetPixel(p.x + x, p.y + y, src->GetPixel(sx, sy));
+            }
+        }
+
+        Texture *t = p.entry->texture;
+        t->DeleteTexture();
+        t->packedarray = arr;
+        t->packedlayer = p.layer;
+        t->packedrect = glm::vec4((float)p.x / atlasSize, (float)p.y / height, (float)w / atlasSize, (float)h / height);
+        t->width = w;
+        t->height = h;
+        packed.push_back(t);
+
+        stats.atlasedCount++;
+    }
+
+    for (uint32_t l = 0; l <= layer; l++) arr->SetLayer(l, &layers[l]);
+}
+
+void TexturePacker::decodeentries()
+{
+    std::vector<PackEntry *> todecode = std::vector<PackEntry *>();
+    for (PackEntry &e : entries) if (!e.filename.empty()) todecode.push_back(&e);
+
+    std::function<void(size_t, size_t)> decode = [&todecode](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            PackEntry *e = todecode[i];
+            if (!e->image.LoadFromUCTEXFile(e->filename)) e->image = UCTEXImage();
+        }
+    };
+
+    JobSystem *jobs = JobSystem::GetCurrent();
+    if (jobs) jobs->ParallelFor(todecode.size(), 1, decode);
+    else decode(0, todecode.size());
+
+    // broken files are dropped, their textures stay unloaded.
+    size_t before = entries.size();
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [](PackEntry &e) { return e.image.IsEmpty(); }), entries.end());
+    stats.texturesCount -= before - entries.size();
+}
+
+// === PUBLIC ===
+
+TexturePacker::TexturePacker(uint32_t atlas_size, uint32_t atlas_max_texture_size) : atlasSize(atlas_size), atlasMaxTextureSize(atlas_max_texture_size)
+{
+    if (atlasMaxTextureSize + atlasPadding * 2 > atlasSize) atlasMaxTextureSize = atlasSize > atlasPadding * 2 ? atlasSize - atlasPadding * 2 : 0;
+    stats = TexturePackerStats();
+}
+
+// textures may be already destroyed here, so only arrays are freed.
+TexturePacker::~TexturePacker() { for (TextureArray *arr : arrays) delete arr; }
+
+bool TexturePacker::AddTexture(Texture *texture, std::string filename)
+{
+    if (!texture) return false;
+    for (PackEntry &e : entries) if (e.texture == texture) return false;
+
+    UCTEXHeader header;
+    if (!UCTEXImage::ReadUCTEXHeader(filename, &header)) return false;
+
+    PackEntry e;
+    e.texture = texture;
+    e.filename = filename;
+    e.params = texture->intparams;
+    std::sort(e.params.begin(), e.params.end());
+
+    entries.push_back(std::move(e));
+    stats.texturesCount++;
+    return true;
+}
+
+bool TexturePacker::AddImage(Texture *texture, UCTEXImage image)
+{
+    if (!texture || image.IsEmpty()) return false;
+    for (PackEntry &e : entries) if (e.texture == texture) return false;
+
+    PackEntry e;
+    e.texture = texture;
+    e.image = std::move(image);
+    e.params = texture->intparams;
+    std::sort(e.params.begin(), e.params.end());
+
+    entries.push_back(std::move(e));
+    stats.texturesCount++;
+    return true;
+}
+
+unsigned int TexturePacker::Pack()
+{
+    unsigned int arrayscount = arrays.size();
+
+    decodeentries();
+
+    // same size + type + parametres -> candidates for whole layers.
+    std::map<std::tuple<uint32_t, uint32_t, uint8_t, std::vector<std::pair<GLenum, GLint>>>, std::vector<PackEntry *>> layergroups;
+    for (PackEntry &e : entries) layergroups[{ e.image.GetWidth(), e.image.GetHeight(), e.image.GetSourceType(), e.params }].push_back(&e);
+
+    std::map<std::vector<std::pair<GLenum, GLint>>, std::vector<PackEntry *>> atlasgroups;
+    for (auto &g : layergroups)
+    {
+        if (g.second.size() >= minLayerGroupSize)
+        {
+            packlayers(&g.second);
+            continue;
+        }
+
+        for (PackEntry *e : g.second)
+        {
+            if (e->image.GetWidth() <= atlasMaxTextureSize && e->image.GetHeight() <= atlasMaxTextureSize) atlasgroups[e->params].push_back(e);
+            else
+            {
+                e->texture->LoadFromImage(&e->image);
+                stats.standaloneCount++;
+            }
+        }
+    }
+
+    for (auto &g : atlasgroups)
+    {
+        // single small texture doesn't save any bind.
+        if (g.second.size() == 1)
+        {
+            g.second[0]->texture->LoadFromImage(&g.second[0]->image);
+            stats.standaloneCount++;
+            continue;
+        }
+        packatlas(&g.second);
+    }
+
+    entries.clear();
+    return arrays.size() - arrayscount;
+}
+
+void TexturePacker::Clear()
+{
+    for (Texture *t : packed)
+    {
+        // texture may be reloaded or repacked by someone else since.
+        if (std::find(arrays.begin(), arrays.end(), t->packedarray) == arrays.end()) continue;
+
+        t->packedarray = nullptr;
+        t->packedlayer = 0;
+        t->packedrect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+        t->width = t->height = 0;
+    }
+    packed.clear();
+
+    for (TextureArray *arr : arrays) delete arr;
+    arrays.clear();
+
+    entries.clear();
+    stats = TexturePackerStats();
+}
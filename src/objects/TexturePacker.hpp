@@ -0,0 +1,85 @@
+#ifndef TEXTUREPACKER_HPP
+#define TEXTUREPACKER_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "../objects.hpp"
+#include "../formats/UCTEXImage.hpp"
+#include "JobSystem.hpp"
+
+struct
+{
+    unsigned int texturesCount; // textures added to packer.
+    unsigned int layeredCount; // textures that got whole array layer.
+    unsigned int atlasedCount; // textures placed into atlas layers.
+    unsigned int standaloneCount; // textures that left as ordinary GL_TEXTURE_2D.
+
+    unsigned int arraysCount;
+    unsigned int layersCount;
+    size_t arraysSizeInBytes;
+} typedef TexturePackerStats;
+
+/*
+    Load-time packer that collapses many small GL_TEXTURE_2D binds into few GL_TEXTURE_2D_ARRAY ones:
+        - textures of same size, source UCTEX type and parametres (at least minLayerGroupSize of them) become layers of one array;
+        - rest of small textures (both dimensions <= atlasMaxTextureSize) are shelf packed into atlas layers with UV remapping;
+        - everything else is loaded as usual.
+
+    Atlas entries have edge-replicating gutter, repeat wrapping is emulated in shader with fract(),
+    so filtering across wrap seam of atlased texture is only approximate.
+
+    Packed textures reference arrays owned by packer, so packer must outlive surfaces that use them
+    (call Clear() first if textures should stay usable after packer's destruction).
+*/
+class TexturePacker
+{
+  private:
+    struct PackEntry
+    {
+        Texture *texture;
+        std::string filename; // decoded in Pack(), empty for AddImage().
+        UCTEXImage image;
+        std::vector<std::pair<GLenum, GLint>> params;
+    };
+
+    uint32_t atlasSize;
+    uint32_t atlasMaxTextureSize;
+    uint32_t atlasPadding = 2;
+    unsigned int minLayerGroupSize = 2;
+
+    std::vector<PackEntry> entries = std::vector<PackEntry>();
+    std::vector<TextureArray *> arrays = std::vector<TextureArray *>();
+    std::vector<Texture *> packed = std::vector<Texture *>();
+
+    TexturePackerStats stats;
+
+    TextureArray *newarray(uint32_t width, uint32_t height, uint32_t layers, std::vector<std::pair<GLenum, GLint>> *params);
+    void packlayers(std::vector<PackEntry *> *group);
+    void packatlas(std::vector<PackEntry *> *group);
+    void decodeentries();
+
+  public:
+    TexturePacker(uint32_t atlas_size = 1024, uint32_t atlas_max_texture_size = 128);
+    ~TexturePacker();
+
+    inline unsigned int GetMinLayerGroupSize() { return minLayerGroupSize; }
+    inline void SetMinLayerGroupSize(unsigned int size) { minLayerGroupSize = size > 1 ? size : 1; }
+
+    // texture parametres (filtering, wrapping) must be set before AddTexture(), textures with different parametres never share array.
+    // only header is checked here, files are decoded in Pack() in parallel (on JobSystem::GetCurrent() if any).
+    bool AddTexture(Texture *texture, std::string filename);
+    bool AddImage(Texture *texture, UCTEXImage image);
+
+    // packs all added textures, returns count of created arrays.
+    unsigned int Pack();
+
+    // returns all packed textures to unloaded state and deletes arrays.
+    void Clear();
+
+    inline std::vector<TextureArray *> GetArrays() { return arrays; }
+    inline TexturePackerStats GetStats() { return stats; }
+};
+
+#endif
@@ -0,0 +1,398 @@
+#include "TextureStreamer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// === PRIVATE ===
+
+void TextureStreamer::load(LoadRequest *req, LoadResult *res)
+{
+    res->id = req->id;
+    res->firstMip = req->firstMip;
+    res->success = false;
+
+    // stored mips are read directly, missing ones are downsampled.
+    res->success = UCTEXImage::LoadMipsFromUCTEXFile(req->filename, req->firstMip, req->endMip, &res->mips);
+}
+
+void TextureStreamer::workerloop()
+{
+    while (true)
+    {
+        LoadRequest req;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condvar.wait(lock, [this] { return stopworker || !requests.empty(); });
+            if (stopworker) return;
+
+            req = requests.front();
+            requests.pop_front();
+        }
+
+        LoadResult res;
+        load(&req, &res);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        results.push_back(std::move(res));
+    }
+}
+
+void TextureStreamer::queueload(StreamedTexture *st, unsigned int first_mip, unsigned int end_mip)
+{
+    st->loadingMip = first_mip;
+
+    LoadRequest req;
+    req.id = st->id;
+    req.filename = st->filename;
+    req.firstMip = first_mip;
+    req.endMip = end_mip;
+
+    if (jobs)
+    {
+        jobs->Schedule([this, req]() mutable
+        {
+            LoadResult res;
+            load(&req, &res);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(std::move(res));
+        }, &jobsCounter);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.push_back(req);
+    }
+    condvar.notify_one();
+}
+
+size_t TextureStreamer::residentsize(StreamedTexture *st)
+{ return st->residentMip < st->levels ? chainsize(st, st->residentMip) : 0; }
+
+// builds new texture object with levels [first_mip; levels): new_mips are uploaded from memory, rest is copied from old texture on GPU.
+bool TextureStreamer::replacechain(StreamedTexture *st, unsigned int first_mip, UCTEXImage *new_mips, size_t new_mips_count)
+{
+    Texture *tex = st->texture;
+    bool hasold = tex->HasTexture() && st->residentMip < st->levels;
+    if (!hasold && first_mip + new_mips_count < st->levels) return false;
+
+    GLuint newtex;
+    glGenTextures(1, &newtex);
+    glBindTexture(GL_TEXTURE_2D, newtex);
+
+    unsigned int count = st->levels - first_mip;
+    for (unsigned int l = 0; l < count; l++)
+    {
+        unsigned int mip = first_mip + l;
+        uint32_t w = UCTEXImage::GetMipDimension(st->width, mip);
+        uint32_t h = UCTEXImage::GetMipDimension(st->height, mip);
+
+        const void *data = l < new_mips_count ? new_mips[l].GetPixels() : nullptr;
+        glTexImage2D(GL_TEXTURE_2D, l, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+
+        if (l >= new_mips_count && hasold)
+        {
+            unsigned int oldlevel = mip - st->residentMip;
+            glCopyImageSubData(tex->texture, GL_TEXTURE_2D, oldlevel, 0, 0, 0, newtex, GL_TEXTURE_2D, l, 0, 0, 0, w, h, 1);
+        }
+    }
+
+    tex->DeleteTexture();
+
+    tex->texture = newtex;
+    tex->hasTexture = true;
+    tex->width = UCTEXImage::GetMipDimension(st->width, first_mip);
+    tex->height = UCTEXImage::GetMipDimension(st->height, first_mip);
+    tex->levels = count;
+    tex->applyparams();
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    st->residentMip = first_mip;
+    return true;
+}
+
+bool TextureStreamer::shrink(StreamedTexture *st, unsigned int new_first_mip)
+{
+    if (new_first_mip <= st->residentMip || new_first_mip >= st->levels) return false;
+    if (!replacechain(st, new_first_mip, nullptr, 0)) return false;
+
+    stats.streamedOutCount++;
+    return true;
+}
+
+void TextureStreamer::applyresult(LoadResult *result)
+{
+    auto it = texturesById.find(result->id);
+    if (it == texturesById.end()) return; // texture was removed while loading.
+
+    StreamedTexture *st = it->second;
+    st->loadingMip = st->levels;
+    if (!result->success || result->mips.empty()) return;
+
+    // only levels that aren't resident now are uploaded.
+    unsigned int first = result->firstMip;
+    size_t newcount = result->mips.size();
+    if (st->residentMip < st->levels)
+    {
+        if (first >= st->residentMip) return;
+        newcount = std::min(newcount, (size_t)(st->residentMip - first));
+    }
+
+    if (replacechain(st, first, result->mips.data(), newcount)) stats.streamedInCount++;
+}
+
+// === PUBLIC ===
+
+TextureStreamer::TextureStreamer(size_t budget_bytes, uint32_t initial_max_size, JobSystem *jobs)
+    : budget(budget_bytes), initialMaxSize(initial_max_size > 0 ? initial_max_size : 1), jobs(jobs)
+{
+    stats = TextureStreamingStats();
+    if (!jobs) worker = std::thread(&TextureStreamer::workerloop, this);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    if (jobs) jobs->Wait(&jobsCounter);
+    else
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopworker = true;
+        }
+        condvar.notify_all();
+        worker.join();
+    }
+
+    for (std::pair<Texture * const, StreamedTexture *> &p : textures) delete p.second;
+}
+
+bool TextureStreamer::AddTexture(Texture *texture, std::string filename)
+{
+    if (!texture || HasTexture(texture)) return false;
+
+    UCTEXHeader header;
+    if (!UCTEXImage::ReadUCTEXHeader(filename, &header)) return false;
+
+    texture->DeleteTexture();
+
+    StreamedTexture *st = new StreamedTexture();
+    st->id = nextid++;
+    st->texture = texture;
+    st->filename = filename;
+    st->width = header.width;
+    st->height = header.height;
+    st->levels = UCTEXImage::GetMipLevelsCount(header.width, header.height);
+
+    st->initialMip = 0;
+    while (st->initialMip + 1 < st->levels &&
+        std::max(UCTEXImage::GetMipDimension(st->width, st->initialMip), UCTEXImage::GetMipDimension(st->height, st->initialMip)) > initialMaxSize) st->initialMip++;
+
+    st->residentMip = st->levels;
+    st->wantedMip = st->initialMip;
+    st->loadingMip = st->levels;
+    st->lastRequestFrame = 0;
+    st->screenSize = 0.0f;
+
+    textures[texture] = st;
+    texturesById[st->id] = st;
+
+    queueload(st, st->initialMip, st->levels);
+    return true;
+}
+
+bool TextureStreamer::RemoveTexture(Texture *texture)
+{
+    auto it = textures.find(texture);
+    if (it == textures.end()) return false;
+
+    texturesById.erase(it->second->id);
+    delete it->second;
+    textures.erase(it);
+    return true;
+}
+
+int TextureStreamer::GetResidentMip(Texture *texture)
+{
+    auto it = textures.find(texture);
+    if (it == textures.end() || it->second->residentMip >= it->second->levels) return -1;
+    return it->second->residentMip;
+}
+
+void TextureStreamer::BeginFrame(Camera *camera, unsigned int screen_height)
+{ BeginFrame(camera->GetGlobalTransform(), camera->GetFOV(), screen_height); }
+
+void TextureStreamer::BeginFrame(Transform cameraTransform, float fov, unsigned int screen_height)
+{
+    frame++;
+
+    camPosition = cameraTransform.GetPosition();
+    camFront = cameraTransform.GetFront();
+
+    // projected size (px) = world size / distance * pixelsPerUnitAtDistance1.
+    pixelsPerUnitAtDistance1 = (float)screen_height / (2.0f * glm::tan(fov / 2.0f));
+
+    for (std::pair<Texture * const, StreamedTexture *> &p : textures) p.second->screenSize = 0.0f;
+}
+
+void TextureStreamer::RequestTexture(Texture *texture, glm::vec3 world_center, float world_radius)
+{
+    auto it = textures.find(texture);
+    if (it == textures.end()) return;
+    StreamedTexture *st = it->second;
+
+    glm::vec3 tocenter = world_center - camPosition;
+    if (glm::dot(tocenter, camFront) < -world_radius) return; // behind camera.
+
+    float dist = glm::length(tocenter);
+    float size;
+    if (dist <= world_radius) size = INFINITY;
+    else size = 2.0f * world_radius / dist * pixelsPerUnitAtDistance1;
+
+    if (size <= st->screenSize && st->lastRequestFrame == frame) return;
+
+    unsigned int mip = 0;
+    float texsize = (float)std::max(st->width, st->height);
+    if (size > 0.0f && size < texsize) mip = (unsigned int)glm::floor(glm::log2(texsize / size));
+    mip = std::min(mip, st->initialMip);
+
+    if (st->lastRequestFrame != frame || mip < st->wantedMip) st->wantedMip = mip;
+    st->screenSize = std::max(st->screenSize, size);
+    st->lastRequestFrame = frame;
+}
+
+void TextureStreamer::RequestMesh(Texture *texture, Mesh *mesh, glm::mat4 model)
+{
+    if (!texture || !mesh) return;
+
+    glm::vec3 center = glm::vec3(model * glm::vec4(mesh->GetBoundingSphereCenter(), 1.0f));
+    float scale = glm::max(glm::length(glm::vec3(model[0])), glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+    RequestTexture(texture, center, mesh->GetBoundingSphereRadius() * scale);
+}
+
+void TextureStreamer::RequestSurface(Surface *surface, glm::mat4 model)
+{
+    if (!surface->enableRender) return;
+    RequestMesh(surface->GetTexture(), surface->GetMesh(), model);
+}
+
+void TextureStreamer::RequestEntity(Entity *entity)
+{
+    if (!entity->enableRender) return;
+
+    glm::mat4 model = entity->GetGlobalTransform().GetTransformationMatrix();
+    for (Surface &surface : entity->surfaces) RequestSurface(&surface, model * surface.transform.GetTransformationMatrix());
+}
+
+void TextureStreamer::RequestRenderItem(RenderItem *item) { RequestMesh(item->texture, item->mesh, item->model); }
+
+void TextureStreamer::Update()
+{
+    std::vector<LoadResult> done;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.swap(results);
+    }
+    for (LoadResult &res : done) applyresult(&res);
+
+    // frame temporary, lives in thread arena until end of Update().
+    FrameArena *arena = FrameArena::GetThreadArena();
+    FrameArena::Marker marker = arena->GetMarker();
+    ArenaVector<StreamedTexture *> list = ArenaVector<StreamedTexture *>(ArenaAllocator<StreamedTexture *>(arena));
+    list.reserve(textures.size());
+
+    size_t resident = 0, pending = 0;
+    unsigned int loads = 0;
+    for (std::pair<Texture * const, StreamedTexture *> &p : textures)
+    {
+        StreamedTexture *st = p.second;
+
+        // textures out of sight for long time are allowed to drop to their initial mip.
+        if (frame - st->lastRequestFrame > evictionDelayFrames) st->wantedMip = st->initialMip;
+
+        resident += residentsize(st);
+        if (st->loadingMip < st->levels)
+        {
+            loads++;
+            if (st->residentMip < st->levels) pending += chainsize(st, st->loadingMip) - residentsize(st);
+        }
+
+        list.push_back(st);
+    }
+
+    // most visible textures are streamed in first, least visible ones are evicted first.
+    std::sort(list.begin(), list.end(), [](StreamedTexture *a, StreamedTexture *b) { return a->screenSize > b->screenSize; });
+
+    unsigned int limited = 0;
+    for (StreamedTexture *st : list)
+    {
+        if (st->loadingMip < st->levels || st->residentMip >= st->levels || st->wantedMip >= st->residentMip) continue;
+        if (loads >= maxPendingLoads) { limited++; continue; }
+
+        unsigned int target = st->wantedMip;
+        size_t cost = chainsize(st, target) - residentsize(st);
+
+        // make room by dropping over-resident textures (lowest priority first).
+        for (auto it = list.rbegin(); it != list.rend() && resident + pending + cost > budget; it++)
+        {
+            StreamedTexture *victim = *it;
+            if (victim == st || victim->loadingMip < victim->levels || victim->residentMip >= victim->wantedMip) continue;
+
+            size_t before = residentsize(victim);
+            if (shrink(victim, victim->wantedMip)) resident -= before - residentsize(victim);
+        }
+
+        while (target < st->residentMip && resident + pending + cost > budget)
+        {
+            target++;
+            cost = chainsize(st, target) - residentsize(st);
+        }
+
+        if (target != st->wantedMip) limited++;
+        if (target >= st->residentMip) continue;
+
+        queueload(st, target, st->residentMip);
+        pending += cost;
+        loads++;
+    }
+
+    // over budget (e.g. budget was lowered) - drop over-resident textures anyway.
+    for (auto it = list.rbegin(); it != list.rend() && resident > budget; it++)
+    {
+        StreamedTexture *st = *it;
+        if (st->loadingMip < st->levels || st->residentMip >= st->wantedMip) continue;
+
+        size_t before = residentsize(st);
+        if (shrink(st, st->wantedMip)) resident -= before - residentsize(st);
+    }
+
+    stats.budgetLimitedCount = limited;
+    arena->Rewind(marker); // deallocation of list is no-op, so it's safe before its destruction.
+}
+
+TextureStreamingStats TextureStreamer::GetStats()
+{
+    stats.budgetBytes = budget;
+    stats.residentBytes = 0;
+    stats.pendingBytes = 0;
+    stats.texturesCount = textures.size();
+    stats.fullyResidentCount = 0;
+    stats.pendingLoadsCount = 0;
+
+    for (std::pair<Texture * const, StreamedTexture *> &p : textures)
+    {
+        StreamedTexture *st = p.second;
+
+        stats.residentBytes += residentsize(st);
+        if (st->residentMip == 0) stats.fullyResidentCount++;
+        if (st->loadingMip < st->levels)
+        {
+            stats.pendingLoadsCount++;
+            stats.pendingBytes += chainsize(st, st->loadingMip) - residentsize(st);
+        }
+    }
+
+    return stats;
+}
@@ -0,0 +1,153 @@
+#ifndef TEXTURESTREAMER_HPP
+#define TEXTURESTREAMER_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "../objects.hpp"
+#include "../formats/UCTEXImage.hpp"
+#include "JobSystem.hpp"
+
+struct
+{
+    size_t budgetBytes;
+    size_t residentBytes;
+    size_t pendingBytes; // bytes that will be added by loads that are in flight now.
+
+    unsigned int texturesCount;
+    unsigned int fullyResidentCount; // textures that have all mips (including level 0) in VRAM.
+    unsigned int pendingLoadsCount;
+    unsigned int budgetLimitedCount; // textures that want more mips than budget allows (last update).
+
+    unsigned long long streamedInCount; // totals since streamer creation.
+    unsigned long long streamedOutCount;
+} typedef TextureStreamingStats;
+
+/*
+    Keeps only needed mips of registered textures in VRAM.
+
+    Texture files are read and decoded (mips missing in file are generated) on background thread (or as jobs of given JobSystem),
+    all OpenGL work is done in Update() that must be called from thread that owns OpenGL context.
+
+    Usage per frame:
+        BeginFrame(camera, screen height) -> RequestEntity()/RequestSurface()/RequestRenderItem() for visible things -> Update().
+
+    With Renderer all calls belong to render thread (see Renderer::SetFrameCallback()).
+*/
+class TextureStreamer
+{
+  private:
+    struct StreamedTexture
+    {
+        unsigned long long id;
+        Texture *texture;
+        std::string filename;
+
+        uint32_t width, height; // full resolution (mip 0).
+        unsigned int levels; // full mip chain levels count.
+        unsigned int initialMip; // lowest detail level that always stays resident.
+
+        unsigned int residentMip; // most detailed resident level (== levels if nothing resident yet).
+        unsigned int wantedMip;
+        unsigned int loadingMip; // == levels if there is no load in flight.
+
+        unsigned long long lastRequestFrame;
+        float screenSize; // biggest on-screen size (in pixels) requested during current frame.
+    };
+
+    struct
+    {
+        unsigned long long id;
+        std::string filename;
+        unsigned int firstMip;
+        unsigned int endMip;
+    } typedef LoadRequest;
+
+    struct
+    {
+        unsigned long long id;
+        unsigned int firstMip;
+        bool success;
+        std::vector<UCTEXImage> mips;
+    } typedef LoadResult;
+
+    size_t budget;
+    uint32_t initialMaxSize;
+    unsigned int maxPendingLoads = 4;
+    unsigned long long evictionDelayFrames = 120;
+
+    unsigned long long nextid = 1;
+    unsigned long long frame = 0;
+    std::unordered_map<Texture *, StreamedTexture *> textures = std::unordered_map<Texture *, StreamedTexture *>();
+    std::unordered_map<unsigned long long, StreamedTexture *> texturesById = std::unordered_map<unsigned long long, StreamedTexture *>();
+
+    glm::vec3 camPosition = glm::vec3(0.0f), camFront = glm::vec3(0, 0, -1);
+    float pixelsPerUnitAtDistance1 = 1.0f;
+
+    TextureStreamingStats stats;
+
+    JobSystem *jobs;
+    JobCounter jobsCounter;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable condvar;
+    bool stopworker = false;
+    std::deque<LoadRequest> requests = std::deque<LoadRequest>();
+    std::vector<LoadResult> results = std::vector<LoadResult>();
+
+    void workerloop();
+    static void load(LoadRequest *req, LoadResult *res);
+
+    void queueload(StreamedTexture *st, unsigned int first_mip, unsigned int end_mip);
+    void applyresult(LoadResult *result);
+    bool replacechain(StreamedTexture *st, unsigned int first_mip, UCTEXImage *new_mips, size_t new_mips_count);
+    bool shrink(StreamedTexture *st, unsigned int new_first_mip);
+
+    size_t residentsize(StreamedTexture *st);
+    inline size_t chainsize(StreamedTexture *st, unsigned int first_mip) { return UCTEXImage::GetMipChainSizeInBytes(st->width, st->height, first_mip); }
+
+  public:
+    // initial_max_size - max dimension of mip that is loaded on registration and never evicted.
+    // jobs == nullptr -> streamer uses own loading thread.
+    TextureStreamer(size_t budget_bytes, uint32_t initial_max_size = 64, JobSystem *jobs = nullptr);
+    ~TextureStreamer();
+
+    inline size_t GetBudget() { return budget; }
+    inline void SetBudget(size_t budget_bytes) { budget = budget_bytes; }
+
+    inline unsigned int GetMaxPendingLoads() { return maxPendingLoads; }
+    inline void SetMaxPendingLoads(unsigned int count) { maxPendingLoads = count > 0 ? count : 1; }
+
+    // textures that weren't requested for that count of frames fall back to initial mip when budget is needed.
+    inline unsigned long long GetEvictionDelayFrames() { return evictionDelayFrames; }
+    inline void SetEvictionDelayFrames(unsigned long long frames) { evictionDelayFrames = frames; }
+
+    // texture will be (re)loaded from given file, streaming starts from low mips.
+    bool AddTexture(Texture *texture, std::string filename);
+    bool RemoveTexture(Texture *texture);
+    inline bool HasTexture(Texture *texture) { return textures.count(texture) > 0; }
+
+    // returns -1 if texture isn't streamed or nothing is resident yet.
+    int GetResidentMip(Texture *texture);
+
+    void BeginFrame(Camera *camera, unsigned int screen_height);
+    void BeginFrame(Transform cameraTransform, float fov, unsigned int screen_height);
+
+    void RequestTexture(Texture *texture, glm::vec3 world_center, float world_radius);
+    void RequestMesh(Texture *texture, Mesh *mesh, glm::mat4 model);
+    void RequestSurface(Surface *surface, glm::mat4 model);
+    void RequestEntity(Entity *entity);
+    void RequestRenderItem(RenderItem *item);
+
+    void Update();
+
+    TextureStreamingStats GetStats();
+};
+
+#endif
@@ -105,6 +105,11 @@ Transform Transform::GlobalToLocal(Transform origin) { return GlobalToLocal(&ori
 
 // ================================
 
+Transform Transform::Interpolate(Transform a, Transform b, float t)
+{ return Transform(glm::mix(a.position, b.position, t), glm::slerp(a.rotation, b.rotation, t), glm::mix(a.scale, b.scale, t)); }
+
+// ================================
+
 Transform *Transform::operator=(Transform other)
 {
     position = other.position;
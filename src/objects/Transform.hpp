@@ -73,6 +73,11 @@ class Transform
 
         // ================================
 
+        // t = 0 -> a, t = 1 -> b (rotation is slerped), used for rendering between fixed simulation ticks.
+        static Transform Interpolate(Transform a, Transform b, float t);
+
+        // ================================
+
         Transform *operator=(Transform other);
 };
 
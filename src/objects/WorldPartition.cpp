@@ -0,0 +1,437 @@
+#include "WorldPartition.hpp"
+
+#include <filesystem>
+#include <algorithm>
+#include <cstdio>
+#include <climits>
+
+// === PRIVATE ===
+
+float WorldPartition::celldistance(Cell *cell, glm::vec3 position)
+{
+    // distance to cell's square, 0 inside of it. Cells covered by proxy use whole region, so they go together.
+    if (cell->region) cell = cell->region;
+
+    float size = cell->size * settings.cellSize;
+    float minx = cell->x * size, minz = cell->z * size;
+    float dx = std::max(std::max(minx - position.x, position.x - (minx + size)), 0.0f);
+    float dz = std::max(std::max(minz - position.z, position.z - (minz + size)), 0.0f);
+    return glm::sqrt(dx * dx + dz * dz);
+}
+
+void WorldPartition::load(WorldPartition *wp, Cell *cell)
+{
+    UCSCENEFile file = UCSCENEFile();
+    if (!file.Open(cell->filename))
+    {
+        cell->failed = true;
+        cell->loadDone.store(true, std::memory_order_release);
+        return;
+    }
+
+    // assets already known (loaded or being loaded by other cell) are only referenced, rest is decoded here.
+    std::vector<Asset *> created = std::vector<Asset *>();
+    const UCSCENEAsset *table = file.GetAssets();
+    {
+        std::lock_guard<std::mutex> lock(wp->assetsMutex);
+        for (uint32_t i = 0; i < file.GetCount(UCSCENE_TABLE_ASSETS); i++)
+        {
+            Asset *a;
+            std::unordered_map<uint64_t, Asset *>::iterator it = wp->assets.find(table[i].id);
+            if (it != wp->assets.end()) a = it->second;
+            else
+            {
+                a = new Asset();
+                a->id = table[i].id;
+                a->type = table[i].type;
+                a->path = file.GetString(table[i].path);
+                wp->assets[a->id] = a;
+                created.push_back(a);
+            }
+
+            a->refs++;
+            cell->assets.push_back(a);
+        }
+    }
+
+    for (Asset *a : created) wp->decode(a);
+    cell->loadDone.store(true, std::memory_order_release);
+}
+
+void WorldPartition::decode(Asset *asset)
+{
+    switch (asset->type)
+    {
+        case UCSCENE_ASSET_MESH:
+        {
+            Mesh *m = new Mesh();
+            if (m->ReadUCMESHFile(asset->path)) { asset->mesh = m; asset->bytes = m->GetSizeInBytes(); }
+            else delete m;
+            break;
+        }
+
+        case UCSCENE_ASSET_TEXTURE:
+        {
+            if (!UCTEXImage::LoadMipsFromUCTEXFile(asset->path, 0, UINT_MAX, &asset->mips)) break;
+
+            // parameters are only remembered while there is no GL texture.
+            asset->texture = new Texture();
+            asset->texture->SetDefaultParametres();
+            asset->bytes = UCTEXImage::GetMipChainSizeInBytes(asset->mips[0].GetWidth(), asset->mips[0].GetHeight(), 0);
+            break;
+        }
+
+        case UCSCENE_ASSET_AUDIOCLIP:
+        {
+            // OpenAL calls are thread safe, clip is ready to use right after loading.
+            AudioClip *c = new AudioClip();
+            if (c->LoadFromUCSOUNDFile(asset->path)) asset->clip = c;
+            else delete c;
+            break;
+        }
+    }
+
+    residentBytes += asset->bytes;
+    asset->ready.store(true, std::memory_order_release);
+}
+
+WorldPartition::Asset *WorldPartition::findasset(uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(assetsMutex);
+    std::unordered_map<uint64_t, Asset *>::iterator it = assets.find(id);
+    return it == assets.end() ? nullptr : it->second;
+}
+
+void WorldPartition::upload(Asset *asset)
+{
+    if (asset->mesh) asset->mesh->GenerateBuffers();
+    if (asset->texture)
+    {
+        asset->texture->LoadFromImages(asset->mips.data(), asset->mips.size());
+        asset->mips = std::vector<UCTEXImage>();
+    }
+    asset->uploaded.store(true, std::memory_order_release);
+}
+
+bool WorldPartition::queueuploads(Cell *cell)
+{
+    bool done = true;
+    for (Asset *a : cell->assets)
+    {
+        if (a->uploaded.load(std::memory_order_acquire)) continue;
+        done = false;
+
+        // assets shared with cell that is still loading wait for it.
+        if (a->uploadQueued || !a->ready.load(std::memory_order_acquire)) continue;
+        a->uploadQueued = true;
+
+        if (!a->mesh && !a->texture) a->uploaded = true;
+        else if (renderer && renderer->IsRunning()) renderer->Enqueue([this, a]() { upload(a); });
+        else upload(a);
+    }
+
+    if (done) return true;
+    for (Asset *a : cell->assets) if (!a->uploaded.load(std::memory_order_acquire)) return false;
+    return true;
+}
+
+void WorldPartition::releaseassets(Cell *cell)
+{
+    std::vector<Asset *> unused = std::vector<Asset *>();
+    {
+        std::lock_guard<std::mutex> lock(assetsMutex);
+        for (Asset *a : cell->assets)
+        {
+            if (--a->refs > 0) continue;
+            assets.erase(a->id);
+            unused.push_back(a);
+        }
+    }
+    cell->assets.clear();
+
+    for (Asset *a : unused) freeasset(a);
+}
+
+void WorldPartition::freeasset(Asset *asset)
+{
+    residentBytes -= asset->bytes;
+
+    // sources that played clip were destroyed with cell's scene.
+    delete asset->clip;
+    asset->clip = nullptr;
+
+    // render thread may still draw packets with this mesh/texture or have queued upload of them.
+    std::function<void()> release = [asset]()
+    {
+        delete asset->mesh;
+        delete asset->texture;
+        delete asset;
+    };
+    if (renderer) renderer->EnqueueRelease(release);
+    else release();
+}
+
+bool WorldPartition::activate(Cell *cell)
+{
+    SceneAssetResolver resolver = SceneAssetResolver();
+    resolver.mesh = [this](uint64_t id, const char *) -> Mesh * { Asset *a = findasset(id); return a ? a->mesh : nullptr; };
+    resolver.texture = [this](uint64_t id, const char *) -> Texture * { Asset *a = findasset(id); return a ? a->texture : nullptr; };
+    resolver.clip = [this](uint64_t id, const char *) -> AudioClip * { Asset *a = findasset(id); return a ? a->clip : nullptr; };
+
+    cell->scene = new Scene();
+    cell->scene->SetAssetResolver(resolver);
+    if (!cell->scene->LoadFromUCSCENEFile(cell->filename))
+    {
+        delete cell->scene;
+        cell->scene = nullptr;
+        return false;
+    }
+
+    cell->state = WORLDCELL_ACTIVE;
+    stats.activationsCount++;
+    return true;
+}
+
+void WorldPartition::deactivate(Cell *cell)
+{
+    delete cell->scene;
+    cell->scene = nullptr;
+
+    cell->state = WORLDCELL_LOADED;
+    stats.deactivationsCount++;
+}
+
+void WorldPartition::unload(Cell *cell)
+{
+    if (cell->state == WORLDCELL_ACTIVE) deactivate(cell);
+    releaseassets(cell);
+
+    cell->state = WORLDCELL_UNLOADED;
+    cell->loadDone = false;
+    stats.unloadsCount++;
+}
+
+// === PUBLIC ===
+
+WorldPartition::WorldPartition(std::string _directory, WorldPartitionSettings _settings, JobSystem *_jobs)
+{
+    directory = _directory;
+    settings = _settings;
+    jobs = _jobs;
+    stats = WorldPartitionStats();
+
+    std::vector<Cell *> proxies = std::vector<Cell *>();
+    std::error_code ec;
+    for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(directory, ec))
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ".ucscene") continue;
+
+        int x, z, size = 1, length = 0;
+        std::string name = entry.path().stem().string();
+        bool proxy = sscanf(name.c_str(), "hlod_%d_%d_%d%n", &size, &x, &z, &length) == 3 && length == (int)name.size();
+        if (!proxy && (sscanf(name.c_str(), "cell_%d_%d%n", &x, &z, &length) != 2 || length != (int)name.size())) continue;
+
+        if (proxy && (settings.hlodRadius <= 0.0f || size < 1)) continue;
+        if (!proxy && cellsByCoords.count(cellkey(x, z))) continue;
+
+        Cell *cell = new Cell();
+        cell->x = x;
+        cell->z = z;
+        cell->size = size;
+        cell->proxy = proxy;
+        cell->filename = entry.path().string();
+        if (proxy) proxies.push_back(cell);
+        else
+        {
+            cells.push_back(cell);
+            cellsByCoords[cellkey(x, z)] = cell;
+        }
+    }
+
+    // cell covered by several proxies (built with different region sizes) belongs to the first one.
+    for (Cell *p : proxies)
+    {
+        for (int z = 0; z < p->size; z++)
+            for (int x = 0; x < p->size; x++)
+            {
+                std::unordered_map<uint64_t, Cell *>::iterator it = cellsByCoords.find(cellkey(p->x * p->size + x, p->z * p->size + z));
+                if (it == cellsByCoords.end() || it->second->region) continue;
+
+                it->second->region = p;
+                p->covered.push_back(it->second);
+            }
+
+        if (p->covered.empty()) delete p;
+        else cells.push_back(p);
+    }
+}
+
+WorldPartition::~WorldPartition()
+{
+    if (jobs) jobs->Wait(&jobsCounter);
+
+    for (Cell *c : cells)
+    {
+        delete c->scene;
+        delete c;
+    }
+
+    // called without render thread, so deletes are done right away.
+    for (std::pair<const uint64_t, Asset *> &p : assets)
+    {
+        delete p.second->mesh;
+        delete p.second->texture;
+        delete p.second->clip;
+        delete p.second;
+    }
+}
+
+WorldPartitionSettings WorldPartition::GetDefaultSettings()
+{
+    WorldPartitionSettings s = WorldPartitionSettings();
+    s.cellSize = 64.0f;
+    s.loadRadius = 128.0f;
+    s.activeRadius = 64.0f;
+    s.hysteresis = 16.0f;
+    s.hlodRadius = 512.0f;
+    s.budgetBytes = 256 * 1024 * 1024;
+    s.maxConcurrentLoads = 4;
+    s.maxActivationsPerUpdate = 1;
+    return s;
+}
+
+void WorldPartition::Update(glm::vec3 position)
+{
+    unsigned int loading = 0;
+    for (Cell *c : resident)
+    {
+        c->distance = celldistance(c, position);
+
+        if (c->state == WORLDCELL_LOADING && c->loadDone.load(std::memory_order_acquire))
+        {
+            c->state = WORLDCELL_LOADED;
+            stats.loadsCount++;
+        }
+        if (c->state == WORLDCELL_LOADING) loading++;
+    }
+
+    // going out of range, with hysteresis so cells on the border don't flip every frame.
+    for (Cell *c : resident)
+    {
+        if (c->state == WORLDCELL_ACTIVE && c->distance > activeradius(c) + settings.hysteresis) deactivate(c);
+        if (c->state == WORLDCELL_UPLOADING && c->distance > activeradius(c) + settings.hysteresis) c->state = WORLDCELL_LOADED;
+
+        if ((c->state == WORLDCELL_LOADED && (c->failed || c->distance > loadradius(c) + settings.hysteresis)) ||
+            (c->state == WORLDCELL_ACTIVE && c->distance > loadradius(c) + settings.hysteresis))
+            unload(c);
+    }
+    resident.erase(std::remove_if(resident.begin(), resident.end(), [](Cell *c) { return c->state == WORLDCELL_UNLOADED; }), resident.end());
+
+    // nearest cells are activated first, uploads of several cells can be in flight.
+    std::vector<Cell *> candidates = std::vector<Cell *>();
+    for (Cell *c : resident)
+        if ((c->state == WORLDCELL_LOADED || c->state == WORLDCELL_UPLOADING) && c->distance <= activeradius(c)) candidates.push_back(c);
+    std::sort(candidates.begin(), candidates.end(), [](Cell *a, Cell *b) { return a->distance < b->distance; });
+
+    unsigned int activations = 0;
+    for (Cell *c : candidates)
+    {
+        if (activations >= settings.maxActivationsPerUpdate) break;
+
+        c->state = WORLDCELL_UPLOADING;
+        if (!queueuploads(c)) continue;
+
+        if (!activate(c))
+        {
+            c->failed = true;
+            c->state = WORLDCELL_LOADED;
+        }
+        activations++;
+    }
+
+    // proxy is hidden only when every cell it covers is active (broken ones stay represented by it).
+    for (Cell *c : resident)
+    {
+        if (!c->proxy) continue;
+
+        c->visible = false;
+        for (Cell *cc : c->covered)
+            if (cc->state != WORLDCELL_ACTIVE && !cc->failed) { c->visible = true; break; }
+    }
+
+    // load priority queue: unloaded cells in range, nearest first.
+    candidates.clear();
+    for (Cell *c : cells)
+    {
+        if (c->state != WORLDCELL_UNLOADED || c->failed) continue;
+
+        c->distance = celldistance(c, position);
+        if (c->distance <= loadradius(c)) candidates.push_back(c);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](Cell *a, Cell *b) { return a->distance < b->distance; });
+
+    stats.budgetLimitedCount = 0;
+    for (Cell *c : candidates)
+    {
+        if (loading >= settings.maxConcurrentLoads) break;
+
+        // over budget: evict farthest loaded (not active) cell that is farther than this one.
+        while (residentBytes.load() > settings.budgetBytes)
+        {
+            Cell *farthest = nullptr;
+            for (Cell *r : resident)
+                if ((r->state == WORLDCELL_LOADED || r->state == WORLDCELL_UPLOADING) && r->distance > c->distance && (!farthest || r->distance > farthest->distance)) farthest = r;
+            if (!farthest) break;
+
+            unload(farthest);
+            resident.erase(std::find(resident.begin(), resident.end(), farthest));
+        }
+        if (residentBytes.load() > settings.budgetBytes)
+        {
+            stats.budgetLimitedCount = candidates.end() - std::find(candidates.begin(), candidates.end(), c);
+            break;
+        }
+
+        c->state = WORLDCELL_LOADING;
+        resident.push_back(c);
+        loading++;
+
+        if (jobs) jobs->Schedule([this, c]() { load(this, c); }, &jobsCounter);
+        else load(this, c);
+    }
+}
+
+void WorldPartition::SaveTransformStates()
+{
+    for (Cell *c : resident) if (c->state == WORLDCELL_ACTIVE) c->scene->SaveTransformStates();
+}
+
+WorldCellState WorldPartition::GetCellState(int x, int z)
+{
+    std::unordered_map<uint64_t, Cell *>::iterator it = cellsByCoords.find(cellkey(x, z));
+    return it == cellsByCoords.end() ? WORLDCELL_UNLOADED : it->second->state;
+}
+
+WorldPartitionStats WorldPartition::GetStats()
+{
+    WorldPartitionStats s = stats;
+    s.cellsCount = cellsByCoords.size();
+    s.proxiesCount = cells.size() - cellsByCoords.size();
+    s.loadingCount = s.loadedCount = s.activeCount = s.visibleProxiesCount = 0;
+    for (Cell *c : resident)
+    {
+        if (c->state == WORLDCELL_LOADING) s.loadingCount++;
+        else if (c->state == WORLDCELL_ACTIVE) s.activeCount++;
+        else s.loadedCount++;
+
+        if (c->proxy && c->state == WORLDCELL_ACTIVE && c->visible) s.visibleProxiesCount++;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(assetsMutex);
+        s.assetsCount = assets.size();
+    }
+    s.residentBytes = residentBytes.load();
+    s.budgetBytes = settings.budgetBytes;
+    return s;
+}
@@ -0,0 +1,179 @@
+#ifndef WORLDPARTITION_HPP
+#define WORLDPARTITION_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "../objects.hpp"
+#include "../formats/UCTEXImage.hpp"
+#include "../formats/UCSCENEFile.hpp"
+#include "Scene.hpp"
+#include "Renderer.hpp"
+#include "JobSystem.hpp"
+
+enum
+{
+    WORLDCELL_UNLOADED = 0,
+    WORLDCELL_LOADING = 1, // file and assets are read and decoded in background.
+    WORLDCELL_LOADED = 2, // assets are in memory, nothing is created.
+    WORLDCELL_UPLOADING = 3, // assets are uploaded to GL by render thread.
+    WORLDCELL_ACTIVE = 4 // objects exist, are simulated and rendered.
+} typedef WorldCellState;
+
+struct
+{
+    float cellSize;
+    float loadRadius; // cells closer than that are loaded (distance is measured in XZ to cell's square).
+    float activeRadius; // cells closer than that are activated, must be <= loadRadius.
+    float hysteresis; // cells are deactivated/unloaded only after moving that much further than radius.
+    float hlodRadius; // region proxies closer than that are loaded and drawn instead of inactive cells, must be >= loadRadius (0 - no proxies).
+
+    size_t budgetBytes; // decoded assets memory, cells beyond activeRadius are evicted to stay in it.
+    unsigned int maxConcurrentLoads;
+    unsigned int maxActivationsPerUpdate; // objects creation is done on update thread, so it's spread over frames.
+} typedef WorldPartitionSettings;
+
+struct
+{
+    unsigned int cellsCount;
+    unsigned int proxiesCount;
+    unsigned int loadingCount; // cells and proxies.
+    unsigned int loadedCount; // including uploading ones.
+    unsigned int activeCount;
+    unsigned int visibleProxiesCount;
+
+    unsigned int assetsCount;
+    size_t residentBytes;
+    size_t budgetBytes;
+    unsigned int budgetLimitedCount; // cells that wanted to load but didn't fit budget (last update).
+
+    unsigned long long loadsCount; // totals.
+    unsigned long long unloadsCount;
+    unsigned long long activationsCount;
+    unsigned long long deactivationsCount;
+} typedef WorldPartitionStats;
+
+/*
+    Open world split into square cells on XZ plane, every cell is own UCSCENE file "cell_<x>_<z>.ucscene"
+    (authored in world space) in one directory.
+
+    Update() is called by update thread with camera position. Cells are loaded on JobSystem (file mapping,
+    meshes and textures decoding, audio clips), nearest first and within memory budget, then uploaded to GL
+    on render thread (Renderer::Enqueue()), then their objects are created - all without blocking update thread.
+    Assets used by several cells are shared and loaded once.
+
+    HLOD: proxy "hlod_<N>_<x>_<z>.ucscene" (see tools/hlodbuilder.cpp) covers region of NxN cells. Proxies stream like
+    cells but within hlodRadius, cells of region with proxy are loaded and activated together (by distance to region),
+    and proxy is drawn until all of them are active, so far field costs one draw per region and there are no holes.
+
+    Without renderer (or before Renderer::Start()) GL work is done right in Update().
+    Context must be current on thread that destroys partition.
+*/
+class WorldPartition
+{
+  private:
+    struct Asset
+    {
+        uint64_t id;
+        uint32_t type; // UCSCENEAssetType.
+        std::string path;
+
+        Mesh *mesh = nullptr;
+        Texture *texture = nullptr;
+        AudioClip *clip = nullptr;
+        std::vector<UCTEXImage> mips = std::vector<UCTEXImage>(); // decoded texture waiting for upload.
+        size_t bytes = 0;
+
+        unsigned int refs = 0; // cells that use asset, guarded by assetsMutex.
+        std::atomic<bool> ready = false; // decoded (or failed).
+        std::atomic<bool> uploaded = false;
+        bool uploadQueued = false;
+    };
+
+    struct Cell
+    {
+        int x, z; // in cells, or in regions for proxy.
+        int size = 1; // cells per side.
+        std::string filename;
+        WorldCellState state = WORLDCELL_UNLOADED;
+        float distance = 0.0f;
+
+        std::vector<Asset *> assets = std::vector<Asset *>(); // written by loading job until loadDone.
+        std::atomic<bool> loadDone = false;
+        bool failed = false; // broken cells are never retried.
+
+        Scene *scene = nullptr;
+
+        bool proxy = false;
+        Cell *region = nullptr; // proxy that covers cell.
+        std::vector<Cell *> covered = std::vector<Cell *>(); // cells covered by proxy.
+        bool visible = false; // proxy isn't replaced by cells yet.
+    };
+
+    std::string directory;
+    WorldPartitionSettings settings;
+    JobSystem *jobs;
+    JobCounter jobsCounter;
+    Renderer *renderer = nullptr;
+
+    std::vector<Cell *> cells = std::vector<Cell *>();
+    std::unordered_map<uint64_t, Cell *> cellsByCoords = std::unordered_map<uint64_t, Cell *>();
+    std::vector<Cell *> resident = std::vector<Cell *>(); // cells in any state except unloaded.
+
+    std::mutex assetsMutex;
+    std::unordered_map<uint64_t, Asset *> assets = std::unordered_map<uint64_t, Asset *>();
+    std::atomic<size_t> residentBytes = 0;
+
+    WorldPartitionStats stats;
+
+    static inline uint64_t cellkey(int x, int z) { return ((uint64_t)(uint32_t)x << 32) | (uint32_t)z; }
+    float celldistance(Cell *cell, glm::vec3 position);
+    inline float loadradius(Cell *cell) { return cell->proxy ? settings.hlodRadius : settings.loadRadius; }
+    inline float activeradius(Cell *cell) { return cell->proxy ? settings.hlodRadius : settings.activeRadius; }
+
+    static void load(WorldPartition *wp, Cell *cell);
+    void decode(Asset *asset);
+    Asset *findasset(uint64_t id);
+
+    void upload(Asset *asset);
+    bool queueuploads(Cell *cell);
+    void releaseassets(Cell *cell);
+    void freeasset(Asset *asset);
+
+    bool activate(Cell *cell);
+    void deactivate(Cell *cell);
+    void unload(Cell *cell);
+
+  public:
+    WorldPartition(std::string directory, WorldPartitionSettings settings, JobSystem *jobs = JobSystem::GetCurrent());
+    ~WorldPartition();
+
+    WorldPartition(const WorldPartition &) = delete;
+    WorldPartition &operator=(const WorldPartition &) = delete;
+
+    static WorldPartitionSettings GetDefaultSettings();
+
+    // GL uploads and deletes go through renderer while it runs.
+    inline void SetRenderer(Renderer *r) { renderer = r; }
+
+    void Update(glm::vec3 position);
+
+    void SaveTransformStates();
+
+    // items is std::vector or ArenaVector of RenderItem.
+    template <typename Vector>
+    void CollectRenderItems(Vector *items)
+    {
+        for (Cell *c : resident)
+            if (c->state == WORLDCELL_ACTIVE && (!c->proxy || c->visible)) c->scene->CollectRenderItems(items);
+    }
+
+    WorldCellState GetCellState(int x, int z);
+    WorldPartitionStats GetStats();
+};
+
+#endif
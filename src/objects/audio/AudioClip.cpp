@@ -1,11 +1,11 @@
 #include "AudioClip.hpp"
 
-#include <cstdio>
 #include <cstdint>
 #include <cstring>
-#include <filesystem>
 
 #include "AudioSource.hpp"
+#include "../../formats/AssetFile.hpp"
+#include "../../utils.hpp"
 
 // === PRIVATE ===
 
@@ -27,22 +27,22 @@ AudioClip::~AudioClip()
 
 bool AudioClip::LoadFromUCSOUNDFile(std::string filename)
 {
-    if (!std::filesystem::is_regular_file(filename)) return false;
+    AssetFile file = AssetFile();
+    return file.Open(filename) && LoadFromUCSOUND(file.GetData(), file.GetSize());
+}
 
-    FILE *f = fopen(filename.c_str(), "rb");
-    if (!f) return false;
+bool AudioClip::LoadFromUCSOUND(const uint8_t *data, size_t size)
+{
+    const uint8_t *p = data, *end = data + size;
 
     char sig[7];
-    fread(&sig, sizeof(char), 7, f);
-    if (feof(f) || strncmp(sig, "UCSOUND", 7)) { fclose(f); return false; }
+    if (!Utils::readbytes(&p, end, sig, 7) || strncmp(sig, "UCSOUND", 7)) return false;
 
     uint16_t version;
-    fread(&version, sizeof(version), 1, f);
-    if (feof(f) || version != 0) { fclose(f); return false; }
+    if (!Utils::readbytes(&p, end, &version, sizeof(version)) || version != 0) return false;
 
     uint8_t type;
-    fread(&type, sizeof(type), 1, f);
-    if (feof(f)) { fclose(f); return false; }
+    if (!Utils::readbytes(&p, end, &type, sizeof(type))) return false;
 
     ALenum altype;
     switch (type)
@@ -64,26 +64,13 @@ bool AudioClip::LoadFromUCSOUNDFile(std::string filename)
             break;
 
         default:
-            fclose(f);
             return false;
     }
 
     uint16_t frequency;
-    fread(&frequency, sizeof(frequency), 1, f);
-    if (feof(f)) { fclose(f); return false; }
-
-    std::vector<uint8_t> data = std::vector<uint8_t>();
-    while (true)
-    {
-        uint8_t byte;
-        fread(&byte, sizeof(byte), 1, f);
-        if (feof(f)) break;
+    if (!Utils::readbytes(&p, end, &frequency, sizeof(frequency))) return false;
 
-        data.push_back(byte);
-    }
-
-    updatebuff(altype, data.data(), data.size(), frequency);
-
-    fclose(f);
+    // samples go to OpenAL right from file data.
+    updatebuff(altype, p, end - p, frequency);
     return true;
-}
\ No newline at end of file
+}
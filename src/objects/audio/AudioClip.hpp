@@ -5,6 +5,8 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
+#include <cstddef>
 
 class AudioSource;
 
@@ -22,7 +24,9 @@ class AudioClip
         AudioClip();
         ~AudioClip();
 
+        // file can be in mounted UCPACK archive (see AssetFile).
         bool LoadFromUCSOUNDFile(std::string filename);
+        bool LoadFromUCSOUND(const uint8_t *data, size_t size);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,101 @@
+#ifndef COMPONENTS_HPP
+#define COMPONENTS_HPP
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Physics/Body/BodyID.h>
+
+#include "../../glm.hpp"
+#include "../../objects.hpp"
+
+// world space transform, ECS has no hierarchy (GameObject parents are resolved by bridge).
+struct TransformComponent
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(glm::vec3(0.0f));
+    glm::vec3 scale = glm::vec3(1.0f);
+
+    // state at the start of current simulation tick (see GameObject::SaveTransformState()).
+    glm::vec3 previousPosition = glm::vec3(0.0f);
+    glm::quat previousRotation = glm::quat(glm::vec3(0.0f));
+    glm::vec3 previousScale = glm::vec3(1.0f);
+    bool hasPrevious = false;
+
+    static TransformComponent FromTransform(Transform t)
+    {
+        TransformComponent c = TransformComponent();
+        c.position = t.GetPosition();
+        c.rotation = t.GetRotation();
+        c.scale = t.GetScale();
+        return c;
+    }
+
+    inline Transform ToTransform() { return Transform(position, rotation, scale); }
+
+    inline void SaveState()
+    {
+        previousPosition = position;
+        previousRotation = rotation;
+        previousScale = scale;
+        hasPrevious = true;
+    }
+
+    glm::mat4 GetInterpolatedMatrix(float alpha)
+    {
+        glm::vec3 p = position;
+        glm::quat r = rotation;
+        glm::vec3 s = scale;
+        if (hasPrevious)
+        {
+            p = glm::mix(previousPosition, position, alpha);
+            r = glm::slerp(previousRotation, rotation, alpha);
+            s = glm::mix(previousScale, scale, alpha);
+        }
+        return glm::scale(glm::translate(glm::mat4(1), p) * glm::mat4_cast(r), s);
+    }
+};
+
+// one drawable surface, pointed mesh and texture must outlive entity.
+struct RenderableComponent
+{
+    Mesh *mesh = nullptr;
+    Texture *texture = nullptr;
+    glm::vec4 color = glm::vec4(1.0f);
+    FaceCullingType culling = BackFace;
+    float alphaCutoff = 0.0f;
+    bool enableRender = true;
+    unsigned int lod = 0; // last chosen by Mesh::SelectLOD().
+};
+
+// source follows entity's TransformComponent, source itself stays owned by whoever created it.
+struct AudioEmitterComponent
+{
+    AudioSource *source = nullptr;
+};
+
+// inRange is updated by ECSSystems::UpdateInteractables(), interacted is set for one tick after use.
+struct InteractableComponent
+{
+    float radius = 1.0f;
+    double cooldown = 1.0;
+    double lastInteractionTime = -1.0;
+    bool locked = false;
+
+    bool inRange = false;
+    bool interacted = false;
+};
+
+// body lives in JPH::PhysicsSystem, kinematic bodies are driven by TransformComponent, dynamic ones drive it.
+struct PhysicsBodyComponent
+{
+    JPH::BodyID body = JPH::BodyID();
+    bool kinematic = false;
+};
+
+// bridge to not yet migrated GameObject (see ECSSystems::BindGameObject()).
+struct GameObjectComponent
+{
+    GameObject *object = nullptr;
+    bool drivenByECS = false; // false - object's transform is copied into entity, true - entity's transform into object.
+};
+
+#endif
@@ -0,0 +1,76 @@
+#include "Systems.hpp"
+
+// === PRIVATE ===
+
+void ECSSystems::setglobaltransform(GameObject *object, Transform t)
+{
+    GameObject *parent = object->GetParent();
+    object->transform = parent ? t.GlobalToLocal(parent->GetGlobalTransform()) : t;
+}
+
+// === PUBLIC ===
+
+EntityID ECSSystems::BindGameObject(World *world, GameObject *object, bool driven_by_ecs)
+{
+    EntityID id = world->CreateEntity();
+    world->AddComponent<TransformComponent>(id, TransformComponent::FromTransform(object->GetGlobalTransform()));
+
+    GameObjectComponent link = GameObjectComponent();
+    link.object = object;
+    link.drivenByECS = driven_by_ecs;
+    world->AddComponent<GameObjectComponent>(id, link);
+
+    return id;
+}
+
+void ECSSystems::SyncFromGameObjects(World *world)
+{
+    world->ForEach<TransformComponent, GameObjectComponent>([](EntityID, TransformComponent &t, GameObjectComponent &link)
+    {
+        if (link.drivenByECS || !link.object) return;
+
+        Transform g = link.object->GetGlobalTransform();
+        t.position = g.GetPosition();
+        t.rotation = g.GetRotation();
+        t.scale = g.GetScale();
+    });
+}
+
+void ECSSystems::SyncToGameObjects(World *world)
+{
+    world->ForEach<TransformComponent, GameObjectComponent>([](EntityID, TransformComponent &t, GameObjectComponent &link)
+    {
+        if (!link.drivenByECS || !link.object) return;
+        setglobaltransform(link.object, t.ToTransform());
+    });
+}
+
+void ECSSystems::SyncAudioEmitters(World *world)
+{
+    world->ForEach<TransformComponent, AudioEmitterComponent>([](EntityID, TransformComponent &t, AudioEmitterComponent &e)
+    {
+        if (!e.source) return;
+
+        // setting transform updates AL position, skip sources that didn't move.
+        Transform g = e.source->GetGlobalTransform();
+        if (g.GetPosition() == t.position && g.GetRotation() == t.rotation) return;
+        setglobaltransform(e.source, t.ToTransform());
+    });
+}
+
+void ECSSystems::SaveTransformStates(World *world)
+{ world->ParallelForEach<TransformComponent>([](EntityID, TransformComponent &t) { t.SaveState(); }); }
+
+void ECSSystems::UpdateInteractables(World *world, glm::vec3 viewer, bool use, double time)
+{
+    world->ParallelForEach<TransformComponent, InteractableComponent>([viewer, use, time](EntityID, TransformComponent &t, InteractableComponent &i)
+    {
+        glm::vec3 d = t.position - viewer;
+        i.inRange = glm::dot(d, d) <= i.radius * i.radius;
+        i.interacted = false;
+
+        if (!use || !i.inRange || i.locked || time < i.lastInteractionTime + i.cooldown) return;
+        i.interacted = true;
+        i.lastInteractionTime = time;
+    });
+}
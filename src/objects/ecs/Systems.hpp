@@ -0,0 +1,49 @@
+#ifndef SYSTEMS_HPP
+#define SYSTEMS_HPP
+
+#include "World.hpp"
+#include "Components.hpp"
+
+/*
+    Common systems and GameObject bridge.
+
+    Not yet migrated GameObject subclasses are bound to entity with TransformComponent + GameObjectComponent:
+    objects that keep their own behaviour are copied into world by SyncFromGameObjects() (so ECS systems see them),
+    objects whose behaviour was moved into systems get result back by SyncToGameObjects() (so their children,
+    audio and old render path follow). Both touch GameObjects, so they must be registered as exclusive systems.
+*/
+class ECSSystems
+{
+  private:
+    static void setglobaltransform(GameObject *object, Transform t);
+
+  public:
+    // entity mirroring object, object must outlive entity (or entity must be destroyed first).
+    static EntityID BindGameObject(World *world, GameObject *object, bool driven_by_ecs = false);
+
+    static void SyncFromGameObjects(World *world);
+    static void SyncToGameObjects(World *world);
+    static void SyncAudioEmitters(World *world);
+
+    // call at the start of every simulation tick, before systems that move entities.
+    static void SaveTransformStates(World *world);
+
+    // entities within radius of viewer become inRange, use == true interacts with them (respecting cooldown and lock).
+    static void UpdateInteractables(World *world, glm::vec3 viewer, bool use, double time);
+
+    // appends RenderItems of TransformComponent + RenderableComponent entities, interpolated by alpha.
+    // items is std::vector or ArenaVector of RenderItem.
+    template <typename Vector>
+    static void CollectRenderItems(World *world, Vector *items, float alpha)
+    {
+        world->ForEach<TransformComponent, RenderableComponent>([items, alpha](EntityID, TransformComponent &t, RenderableComponent &r)
+        {
+            if (!r.enableRender || !(r.mesh && r.mesh->HasBuffers() && r.culling != BothFaces)) return;
+            glm::mat4 model = t.GetInterpolatedMatrix(alpha);
+            r.lod = r.mesh->SelectLOD(r.lod, model);
+            items->push_back({ r.mesh, r.texture, model, r.color, r.culling, r.alphaCutoff, r.lod, false }); // ECS renderables aren't occluders.
+        });
+    }
+};
+
+#endif
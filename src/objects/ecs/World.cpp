@@ -0,0 +1,334 @@
+#include "World.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+
+// === PRIVATE ===
+
+static std::mutex registrymutex;
+static ComponentInfo registry[MAX_COMPONENT_TYPES];
+static uint32_t registrycount = 0;
+
+uint32_t ComponentRegistry::registercomponent(ComponentInfo info)
+{
+    std::lock_guard<std::mutex> lock(registrymutex);
+    if (registrycount >= MAX_COMPONENT_TYPES)
+    {
+        // masks are fixed width, there is no way to continue.
+        std::cerr << "too many component types, can't register \"" << info.name << "\"" << std::endl;
+        std::abort();
+    }
+
+    registry[registrycount] = info;
+    return registrycount++;
+}
+
+Archetype::Archetype(ComponentMask component_mask) : mask(component_mask)
+{
+    size_t rowsize = sizeof(EntityID);
+    for (uint32_t id = 0; id < MAX_COMPONENT_TYPES; id++)
+    {
+        if (!(mask & (ComponentMask(1) << id))) continue;
+        components.push_back(id);
+        rowsize += ComponentRegistry::GetInfo(id)->size;
+    }
+
+    // arrays are aligned, so padding may not fit - shrink until layout does.
+    capacity = std::max((size_t)1, CHUNK_BYTES / rowsize);
+    while (true)
+    {
+        size_t offset = sizeof(EntityID) * capacity;
+        for (uint32_t id : components)
+        {
+            const ComponentInfo *info = ComponentRegistry::GetInfo(id);
+            offset = (offset + info->alignment - 1) / info->alignment * info->alignment;
+            offsets[id] = offset;
+            offset += info->size * capacity;
+        }
+
+        if (offset <= CHUNK_BYTES || capacity == 1) break;
+        capacity--;
+    }
+}
+
+Archetype::~Archetype()
+{
+    for (Chunk &c : chunks)
+    {
+        for (uint32_t id : components)
+            for (uint32_t row = 0; row < c.count; row++) ComponentRegistry::GetInfo(id)->destroy(c.data + offsets[id] + row * ComponentRegistry::GetInfo(id)->size);
+        ::operator delete(c.data, std::align_val_t(64));
+    }
+}
+
+void Archetype::allocaterow(EntityID id, uint32_t *chunk, uint32_t *row)
+{
+    if (chunks.empty() || chunks.back().count == capacity)
+    {
+        // single component row may be bigger than CHUNK_BYTES.
+        size_t bytes = CHUNK_BYTES;
+        for (uint32_t c : components) bytes = std::max(bytes, offsets[c] + ComponentRegistry::GetInfo(c)->size * capacity);
+        chunks.push_back({ static_cast<unsigned char *>(::operator new(bytes, std::align_val_t(64))), 0 });
+    }
+
+    *chunk = chunks.size() - 1;
+    *row = chunks.back().count++;
+    GetEntities(*chunk)[*row] = id;
+    entitiesCount++;
+}
+
+Archetype *World::getarchetype(ComponentMask mask)
+{
+    auto it = archetypesByMask.find(mask);
+    if (it != archetypesByMask.end()) return it->second;
+
+    Archetype *a = new Archetype(mask);
+    archetypes.push_back(a);
+    archetypesByMask[mask] = a;
+    return a;
+}
+
+void World::moveentity(Record *record, Archetype *to)
+{
+    Archetype *from = record->archetype;
+    uint32_t chunk, row;
+    to->allocaterow(from->GetEntities(record->chunk)[record->row], &chunk, &row);
+
+    for (uint32_t id : from->components)
+    {
+        void *src = from->component(id, record->chunk, record->row);
+        if (to->mask & (ComponentMask(1) << id)) ComponentRegistry::GetInfo(id)->moveconstruct(to->component(id, chunk, row), src);
+        ComponentRegistry::GetInfo(id)->destroy(src);
+    }
+
+    removerow(from, record->chunk, record->row);
+
+    record->archetype = to;
+    record->chunk = chunk;
+    record->row = row;
+}
+
+void World::removerow(Archetype *archetype, uint32_t chunk, uint32_t row)
+{
+    Archetype::Chunk &last = archetype->chunks.back();
+    uint32_t lastchunk = archetype->chunks.size() - 1;
+    uint32_t lastrow = last.count - 1;
+
+    if (lastchunk != chunk || lastrow != row)
+    {
+        EntityID moved = archetype->GetEntities(lastchunk)[lastrow];
+        for (uint32_t id : archetype->components)
+        {
+            void *src = archetype->component(id, lastchunk, lastrow);
+            ComponentRegistry::GetInfo(id)->moveconstruct(archetype->component(id, chunk, row), src);
+            ComponentRegistry::GetInfo(id)->destroy(src);
+        }
+        archetype->GetEntities(chunk)[row] = moved;
+
+        Record *r = &records[moved.index];
+        r->chunk = chunk;
+        r->row = row;
+    }
+
+    last.count--;
+    archetype->entitiesCount--;
+    if (last.count == 0)
+    {
+        ::operator delete(last.data, std::align_val_t(64));
+        archetype->chunks.pop_back();
+    }
+}
+
+void *World::addcomponent(EntityID id, uint32_t component)
+{
+    if (!IsAlive(id)) return nullptr;
+    Record *r = &records[id.index];
+
+    ComponentMask bit = ComponentMask(1) << component;
+    if (r->archetype->mask & bit)
+    {
+        void *place = r->archetype->component(component, r->chunk, r->row);
+        ComponentRegistry::GetInfo(component)->destroy(place);
+        return place;
+    }
+
+    moveentity(r, getarchetype(r->archetype->mask | bit));
+    return r->archetype->component(component, r->chunk, r->row);
+}
+
+bool World::removecomponent(EntityID id, uint32_t component)
+{
+    if (!IsAlive(id)) return false;
+    Record *r = &records[id.index];
+
+    ComponentMask bit = ComponentMask(1) << component;
+    if (!(r->archetype->mask & bit)) return false;
+
+    moveentity(r, getarchetype(r->archetype->mask & ~bit));
+    return true;
+}
+
+void *World::getcomponent(EntityID id, uint32_t component)
+{
+    if (!IsAlive(id)) return nullptr;
+    Record *r = &records[id.index];
+
+    if (!(r->archetype->mask & (ComponentMask(1) << component))) return nullptr;
+    return r->archetype->component(component, r->chunk, r->row);
+}
+
+const std::vector<Archetype *> *World::query(ComponentMask mask)
+{
+    std::lock_guard<std::mutex> lock(queriesMutex);
+
+    QueryCache &q = queries[mask];
+    for (; q.checked < archetypes.size(); q.checked++)
+        if (archetypes[q.checked]->HasComponents(mask)) q.archetypes.push_back(archetypes[q.checked]);
+
+    return &q.archetypes;
+}
+
+void World::buildphases()
+{
+    // system goes right after last earlier system it conflicts with, so conflicting ones keep registration order.
+    std::vector<size_t> phaseof = std::vector<size_t>(systems.size());
+    phases.clear();
+
+    for (size_t i = 0; i < systems.size(); i++)
+    {
+        System *s = &systems[i];
+        size_t phase = 0;
+        for (size_t j = 0; j < i; j++)
+        {
+            System *o = &systems[j];
+            bool conflict = s->exclusive || o->exclusive || (s->writes & (o->reads | o->writes)) || (o->writes & s->reads);
+            if (conflict) phase = std::max(phase, phaseof[j] + 1);
+        }
+
+        phaseof[i] = phase;
+        if (phases.size() <= phase) phases.resize(phase + 1);
+        phases[phase].push_back(i);
+    }
+
+    phasesDirty = false;
+}
+
+// === PUBLIC ===
+
+const ComponentInfo *ComponentRegistry::GetInfo(uint32_t id) { return &registry[id]; }
+
+uint32_t ComponentRegistry::GetCount()
+{
+    std::lock_guard<std::mutex> lock(registrymutex);
+    return registrycount;
+}
+
+World::~World() { for (Archetype *a : archetypes) delete a; }
+
+EntityID World::CreateEntity()
+{
+    uint32_t index;
+    if (freeHead != EntityID::NULL_INDEX)
+    {
+        index = freeHead;
+        freeHead = records[index].nextFree;
+    }
+    else
+    {
+        index = records.size();
+        records.push_back({ nullptr, 0, 0, 0, EntityID::NULL_INDEX, false });
+    }
+
+    Record *r = &records[index];
+    r->alive = true;
+    aliveCount++;
+
+    EntityID id;
+    id.index = index;
+    id.generation = r->generation;
+
+    r->archetype = getarchetype(0);
+    r->archetype->allocaterow(id, &r->chunk, &r->row);
+    return id;
+}
+
+bool World::DestroyEntity(EntityID id)
+{
+    if (!IsAlive(id)) return false;
+    Record *r = &records[id.index];
+
+    for (uint32_t c : r->archetype->components) ComponentRegistry::GetInfo(c)->destroy(r->archetype->component(c, r->chunk, r->row));
+    removerow(r->archetype, r->chunk, r->row);
+
+    r->archetype = nullptr;
+    r->alive = false;
+    r->generation++;
+    r->nextFree = freeHead;
+    freeHead = id.index;
+    aliveCount--;
+    return true;
+}
+
+bool World::IsAlive(EntityID id) { return id.index < records.size() && records[id.index].alive && records[id.index].generation == id.generation; }
+
+void World::AddSystem(std::string name, ComponentMask reads, ComponentMask writes, std::function<void(World *, double)> update, bool exclusive)
+{
+    systems.push_back({ name, reads, writes, exclusive, update });
+    phasesDirty = true;
+}
+
+void World::RunSystems(double delta, JobSystem *jobs)
+{
+    if (phasesDirty) buildphases();
+    runDelta = delta;
+
+    for (std::vector<size_t> &phase : phases)
+    {
+        if (!jobs || phase.size() == 1 || systems[phase[0]].exclusive)
+        {
+            for (size_t i : phase) systems[i].update(this, delta);
+            continue;
+        }
+
+        JobCounter counter;
+        for (size_t i : phase)
+        {
+            System *s = &systems[i];
+            // two pointers fit into std::function without allocation.
+            jobs->Schedule([this, s]() { s->update(this, runDelta); }, &counter);
+        }
+        jobs->Wait(&counter);
+    }
+
+    FlushDeferred();
+}
+
+void World::Defer(std::function<void(World *)> command)
+{
+    std::lock_guard<std::mutex> lock(deferredMutex);
+    deferred.push_back(std::move(command));
+}
+
+void World::FlushDeferred()
+{
+    std::vector<std::function<void(World *)>> commands;
+    {
+        std::lock_guard<std::mutex> lock(deferredMutex);
+        if (deferred.empty()) return;
+        commands.swap(deferred);
+    }
+    for (std::function<void(World *)> &c : commands) c(this);
+}
+
+WorldStats World::GetStats()
+{
+    WorldStats st = WorldStats();
+    st.entitiesCount = aliveCount;
+    st.archetypesCount = archetypes.size();
+    for (Archetype *a : archetypes) st.chunksCount += a->GetChunksCount();
+    st.systemsCount = systems.size();
+    if (phasesDirty) buildphases();
+    st.phasesCount = phases.size();
+    return st;
+}
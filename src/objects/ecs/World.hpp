@@ -0,0 +1,283 @@
+#ifndef WORLD_HPP
+#define WORLD_HPP
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <unordered_map>
+#include <mutex>
+#include <tuple>
+#include <new>
+#include <utility>
+#include <typeinfo>
+#include <cstdint>
+#include <cstddef>
+
+#include "../../memory.hpp"
+#include "../HandlePool.hpp"
+#include "../JobSystem.hpp"
+
+struct EntityTag;
+typedef Handle<EntityTag> EntityID;
+
+typedef uint64_t ComponentMask;
+#define MAX_COMPONENT_TYPES 64
+
+struct
+{
+    const char *name;
+    size_t size;
+    size_t alignment;
+    void (*moveconstruct)(void *dst, void *src);
+    void (*destroy)(void *ptr);
+} typedef ComponentInfo;
+
+// any movable type can be component, ids are given on first use (at most MAX_COMPONENT_TYPES per process).
+class ComponentRegistry
+{
+  private:
+    static uint32_t registercomponent(ComponentInfo info);
+
+  public:
+    template <typename T>
+    static uint32_t GetID()
+    {
+        static const uint32_t id = registercomponent({ typeid(T).name(), sizeof(T), alignof(T),
+            [](void *dst, void *src) { new (dst) T(std::move(*static_cast<T *>(src))); },
+            [](void *ptr) { static_cast<T *>(ptr)->~T(); } });
+        return id;
+    }
+
+    template <typename... Ts>
+    static ComponentMask GetMask() { return (ComponentMask(0) | ... | (ComponentMask(1) << GetID<Ts>())); }
+
+    static const ComponentInfo *GetInfo(uint32_t id);
+    static uint32_t GetCount();
+};
+
+/*
+    All entities with exactly the same set of components.
+    Components are stored in fixed size chunks as separate arrays (one per component type, plus entity ids),
+    all chunks except the last one are full, so iteration walks dense arrays without holes.
+*/
+class Archetype
+{
+    friend class World;
+
+  private:
+    struct Chunk
+    {
+        unsigned char *data;
+        uint32_t count;
+    };
+
+    static constexpr size_t CHUNK_BYTES = 16 * 1024;
+
+    ComponentMask mask;
+    std::vector<uint32_t> components = std::vector<uint32_t>();
+    size_t offsets[MAX_COMPONENT_TYPES];
+    uint32_t capacity;
+
+    std::vector<Chunk> chunks = std::vector<Chunk>();
+    size_t entitiesCount = 0;
+
+    Archetype(ComponentMask component_mask);
+    ~Archetype();
+
+    inline void *component(uint32_t id, uint32_t chunk, uint32_t row) { return chunks[chunk].data + offsets[id] + row * ComponentRegistry::GetInfo(id)->size; }
+
+    // returns place for new entity, components there are not constructed yet.
+    void allocaterow(EntityID id, uint32_t *chunk, uint32_t *row);
+
+  public:
+    Archetype(const Archetype &) = delete;
+    Archetype &operator=(const Archetype &) = delete;
+
+    inline ComponentMask GetMask() { return mask; }
+    inline bool HasComponents(ComponentMask m) { return (mask & m) == m; }
+
+    inline size_t GetEntitiesCount() { return entitiesCount; }
+    inline size_t GetChunksCount() { return chunks.size(); }
+    inline uint32_t GetChunkCapacity() { return capacity; }
+    inline uint32_t GetChunkSize(size_t chunk) { return chunks[chunk].count; }
+
+    inline EntityID *GetEntities(size_t chunk) { return reinterpret_cast<EntityID *>(chunks[chunk].data); }
+    template <typename T>
+    inline T *GetComponents(size_t chunk) { return reinterpret_cast<T *>(chunks[chunk].data + offsets[ComponentRegistry::GetID<T>()]); }
+};
+
+struct
+{
+    size_t entitiesCount;
+    size_t archetypesCount;
+    size_t chunksCount;
+    size_t systemsCount;
+    size_t phasesCount; // groups of systems that run in parallel.
+} typedef WorldStats;
+
+/*
+    Archetype based entity-component storage.
+
+    Entity is only an id, its data are components. Adding or removing component moves entity to archetype
+    of new component set, so that is "structural change" and invalidates component pointers. Structural changes
+    are not allowed while world is iterated (ForEach(), systems) - use Defer() there.
+
+    Queries are cached per component mask and only check archetypes created since last call.
+
+    Systems declare component masks they read and write. RunSystems() keeps registration order for conflicting
+    systems and runs non conflicting ones at the same time on JobSystem. Exclusive systems (that touch anything
+    outside of world - GameObjects, OpenAL, GL) run alone on calling thread.
+*/
+class World
+{
+  private:
+    struct Record
+    {
+        Archetype *archetype;
+        uint32_t chunk;
+        uint32_t row;
+        uint32_t generation;
+        uint32_t nextFree;
+        bool alive;
+    };
+
+    struct QueryCache
+    {
+        std::vector<Archetype *> archetypes;
+        size_t checked; // archetypes are never removed, so only new ones need check.
+    };
+
+    struct System
+    {
+        std::string name;
+        ComponentMask reads;
+        ComponentMask writes;
+        bool exclusive;
+        std::function<void(World *, double)> update;
+    };
+
+    std::vector<Record> records = std::vector<Record>();
+    uint32_t freeHead = EntityID::NULL_INDEX;
+    size_t aliveCount = 0;
+
+    std::vector<Archetype *> archetypes = std::vector<Archetype *>();
+    std::unordered_map<ComponentMask, Archetype *> archetypesByMask = std::unordered_map<ComponentMask, Archetype *>();
+
+    std::mutex queriesMutex;
+    std::unordered_map<ComponentMask, QueryCache> queries = std::unordered_map<ComponentMask, QueryCache>();
+
+    std::vector<System> systems = std::vector<System>();
+    std::vector<std::vector<size_t>> phases = std::vector<std::vector<size_t>>();
+    bool phasesDirty = false;
+    double runDelta = 0.0;
+
+    std::mutex deferredMutex;
+    std::vector<std::function<void(World *)>> deferred = std::vector<std::function<void(World *)>>();
+
+    Archetype *getarchetype(ComponentMask mask);
+    // moves entity with all components both archetypes have, components only new one has are left unconstructed.
+    void moveentity(Record *record, Archetype *to);
+    // swaps last entity of archetype into freed row, components of removed row must be already destroyed or moved.
+    void removerow(Archetype *archetype, uint32_t chunk, uint32_t row);
+    void *addcomponent(EntityID id, uint32_t component);
+    bool removecomponent(EntityID id, uint32_t component);
+    void *getcomponent(EntityID id, uint32_t component);
+
+    const std::vector<Archetype *> *query(ComponentMask mask);
+    void buildphases();
+
+    template <typename... Ts, typename F>
+    static void foreachinchunk(Archetype *archetype, size_t chunk, F &f)
+    {
+        uint32_t count = archetype->GetChunkSize(chunk);
+        EntityID *ids = archetype->GetEntities(chunk);
+        std::tuple<Ts *...> arrays = std::tuple<Ts *...>(archetype->GetComponents<Ts>(chunk)...);
+        for (uint32_t i = 0; i < count; i++) f(ids[i], std::get<Ts *>(arrays)[i]...);
+    }
+
+  public:
+    World() {}
+    ~World();
+
+    World(const World &) = delete;
+    World &operator=(const World &) = delete;
+
+    EntityID CreateEntity();
+    // returns false if entity is already destroyed.
+    bool DestroyEntity(EntityID id);
+    bool IsAlive(EntityID id);
+
+    // replaces component if entity already has it, returns nullptr for dead entity.
+    // pointer is valid until next structural change.
+    template <typename T>
+    T *AddComponent(EntityID id, T value = T())
+    {
+        void *place = addcomponent(id, ComponentRegistry::GetID<T>());
+        if (!place) return nullptr;
+        return new (place) T(std::move(value));
+    }
+
+    template <typename T>
+    bool RemoveComponent(EntityID id) { return removecomponent(id, ComponentRegistry::GetID<T>()); }
+
+    template <typename T>
+    T *GetComponent(EntityID id) { return static_cast<T *>(getcomponent(id, ComponentRegistry::GetID<T>())); }
+
+    template <typename T>
+    bool HasComponent(EntityID id) { return getcomponent(id, ComponentRegistry::GetID<T>()) != nullptr; }
+
+    // f(EntityID, Ts &...) for every entity that has all Ts.
+    template <typename... Ts, typename F>
+    void ForEach(F f)
+    {
+        for (Archetype *a : *query(ComponentRegistry::GetMask<Ts...>()))
+            for (size_t c = 0; c < a->GetChunksCount(); c++) foreachinchunk<Ts...>(a, c, f);
+    }
+
+    // same as ForEach() but chunks are spread over jobs (jobs == nullptr -> inline), f must be thread safe.
+    template <typename... Ts, typename F>
+    void ParallelForEach(F f, JobSystem *jobs = JobSystem::GetCurrent())
+    {
+        const std::vector<Archetype *> *matched = query(ComponentRegistry::GetMask<Ts...>());
+        if (!jobs)
+        {
+            for (Archetype *a : *matched)
+                for (size_t c = 0; c < a->GetChunksCount(); c++) foreachinchunk<Ts...>(a, c, f);
+            return;
+        }
+
+        FrameArena *arena = FrameArena::GetThreadArena();
+        FrameArena::Marker marker = arena->GetMarker();
+        {
+            ArenaVector<std::pair<Archetype *, size_t>> work = ArenaVector<std::pair<Archetype *, size_t>>(ArenaAllocator<std::pair<Archetype *, size_t>>(arena));
+            for (Archetype *a : *matched)
+                for (size_t c = 0; c < a->GetChunksCount(); c++) work.push_back({ a, c });
+
+            jobs->ParallelFor(work.size(), 1, [&work, &f](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++) foreachinchunk<Ts...>(work[i].first, work[i].second, f);
+            });
+        }
+        arena->Rewind(marker);
+    }
+
+    template <typename... Ts>
+    size_t Count()
+    {
+        size_t count = 0;
+        for (Archetype *a : *query(ComponentRegistry::GetMask<Ts...>())) count += a->GetEntitiesCount();
+        return count;
+    }
+
+    // reads/writes - ComponentRegistry::GetMask<...>() of components system accesses.
+    void AddSystem(std::string name, ComponentMask reads, ComponentMask writes, std::function<void(World *, double)> update, bool exclusive = false);
+    void RunSystems(double delta, JobSystem *jobs = JobSystem::GetCurrent());
+
+    // structural change from inside iteration or system, applied at the end of RunSystems() or by FlushDeferred().
+    void Defer(std::function<void(World *)> command);
+    void FlushDeferred();
+
+    WorldStats GetStats();
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include "opengl.hpp"
+
+#define OPENGL_HPP_EXTERN
+OPENGL_EXTENSIONS_FUNCTIONS
+
+#define LOADFUNC(type, name, fname)\
+    name = (type)glfwGetProcAddress(fname);\
+    if (!name) return false;
+
+static bool parallelShaderCompile = false;
+
+static bool initparallelshadercompile()
+{
+    if (glfwExtensionSupported("GL_KHR_parallel_shader_compile"))
+    {
+        LOADFUNC(PFNGLMAXSHADERCOMPILERTHREADSKHRPROC, glMaxShaderCompilerThreadsKHR, "glMaxShaderCompilerThreadsKHR");
+        return true;
+    }
+    if (glfwExtensionSupported("GL_ARB_parallel_shader_compile"))
+    {
+        LOADFUNC(PFNGLMAXSHADERCOMPILERTHREADSKHRPROC, glMaxShaderCompilerThreadsKHR, "glMaxShaderCompilerThreadsARB");
+        return true;
+    }
+    return false;
+}
+
+bool initGLExtensions()
+{
+    parallelShaderCompile = initparallelshadercompile();
+
+    return parallelShaderCompile;
+}
+
+bool hasParallelShaderCompile() { return parallelShaderCompile; }
@@ -1,2 +1,32 @@
+#ifndef OPENGL_HPP
+#define OPENGL_HPP
+
 #include <glad/glad.h>
-#include <GLFW/glfw3.h>
\ No newline at end of file
+#include <GLFW/glfw3.h>
+
+// KHR_parallel_shader_compile (ARB variant has same values), glad is generated without extensions.
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+#define OPENGL_HPP_EXTERN extern
+
+#define OPENGL_EXTENSIONS_FUNCTIONS \
+    OPENGL_HPP_EXTERN PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glMaxShaderCompilerThreadsKHR;
+
+OPENGL_EXTENSIONS_FUNCTIONS
+
+#undef OPENGL_HPP_EXTERN
+
+// context must be current, returns false if no extension is supported (engine works without them).
+bool initGLExtensions();
+
+// GL_COMPLETION_STATUS_KHR can be queried without blocking.
+bool hasParallelShaderCompile();
+
+#endif
@@ -0,0 +1,301 @@
+/*
+    Incremental asset cooker: converts sources found in source directory (recursively) into output directory keeping their
+    relative paths: .obj -> .ucmesh, .png -> .uctex, .wav -> .ucsound. Result is listed in <output>/assets.ucmanifest.
+
+    Asset is cooked again only if hash of its content or converter settings differs from manifest or its cooked file
+    is missing (or has other size). Sources with unchanged size and modification time aren't read at all,
+    so incremental run over untouched content costs one directory scan. Dirty assets are cooked in parallel.
+
+    Usage: assetcooker <source directory> <output directory> [options]
+    Options:
+        -force - cook everything;
+        -verify - also compare content hash of cooked files (reads all of them);
+        -lods - generate mesh LOD chains;
+        -nooptimize - don't optimize mesh index and vertex order (see MeshOptimizer);
+        -quantize - write meshes as quantized UCMESH version 2;
+        -texture-type <auto|rgba8|rgb8|rgb5a1|rgb5>, -nodither, -nomips - texture settings as in png2uctex.
+*/
+
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+
+#include "../utils.hpp"
+#include "../formats/MappedFile.hpp"
+#include "../formats/AssetManifest.hpp"
+#include "../formats/UCSCENEFile.hpp"
+#include "../formats/PNGReader.hpp"
+#include "../formats/WAVReader.hpp"
+#include "../formats/UCTEXImage.hpp"
+#include "../formats/UCSOUNDData.hpp"
+#include "../geometry/MeshCooker.hpp"
+#include "../objects/JobSystem.hpp"
+
+#define MANIFEST_FILENAME "assets.ucmanifest"
+
+// bump when converter output changes, every asset of that type is cooked again.
+#define MESH_CONVERTER_VERSION 2
+#define TEXTURE_CONVERTER_VERSION 1
+#define SOUND_CONVERTER_VERSION 1
+
+struct
+{
+    MeshCookSettings mesh;
+    int textureType; // UCTEXType or UCTEX_TYPE_AUTO.
+    bool dither;
+    bool mips;
+} typedef CookSettings;
+
+struct
+{
+    std::string source, cooked; // relative.
+    uint32_t type;
+    uint64_t size;
+    int64_t time;
+
+    int64_t previous; // entry in old manifest, -1 - none.
+    bool hashed;
+    uint64_t hash;
+    uint64_t settingsHash;
+
+    bool dirty;
+    bool ok;
+    std::string error;
+    uint64_t cookedHash, cookedSize;
+} typedef CookItem;
+
+static uint64_t settingshash(uint32_t type, CookSettings *s)
+{
+    int32_t values[5] = { (int32_t)type, 0, 0, 0, 0 };
+    switch (type)
+    {
+        case UCSCENE_ASSET_MESH:
+            values[1] = MESH_CONVERTER_VERSION;
+            values[2] = s->mesh.lods;
+            values[3] = s->mesh.optimize;
+            values[4] = s->mesh.quantize;
+            break;
+
+        case UCSCENE_ASSET_TEXTURE:
+            values[1] = TEXTURE_CONVERTER_VERSION;
+            values[2] = s->textureType;
+            values[3] = s->dither;
+            values[4] = s->mips;
+            break;
+
+        case UCSCENE_ASSET_AUDIOCLIP:
+            values[1] = SOUND_CONVERTER_VERSION;
+            break;
+    }
+    return Utils::hash64(values, sizeof(values));
+}
+
+static bool hashfile(std::string filename, uint64_t *hash, uint64_t *size)
+{
+    MappedFile file = MappedFile();
+    if (!file.Open(filename)) return false;
+
+    *hash = Utils::hash64(file.GetData(), file.GetSize());
+    *size = file.GetSize();
+    return true;
+}
+
+static bool cooktexture(std::string input, std::string output, CookSettings *s, std::string *error)
+{
+    UCTEXImage image = UCTEXImage();
+    if (!PNGReader::ReadPNGFile(input, &image, error)) return false;
+    if (!image.SaveCookedUCTEXFile(output, s->textureType, s->dither, s->mips)) { *error = "can't write file"; return false; }
+    return true;
+}
+
+static bool cooksound(std::string input, std::string output, std::string *error)
+{
+    UCSOUNDData sound = UCSOUNDData();
+    if (!WAVReader::ReadWAVFile(input, &sound, error)) return false;
+    if (!sound.SaveToUCSOUNDFile(output)) { *error = "can't write file"; return false; }
+    return true;
+}
+
+static void cook(CookItem *item, std::filesystem::path source_dir, std::filesystem::path output_dir, CookSettings *s)
+{
+    std::filesystem::path input = source_dir / item->source, output = output_dir / item->cooked;
+
+    std::error_code ec;
+    std::filesystem::create_directories(output.parent_path(), ec);
+
+    bool ok = false;
+    switch (item->type)
+    {
+        case UCSCENE_ASSET_MESH: ok = MeshCooker::CookOBJFile(input.string(), output.string(), s->mesh, nullptr, &item->error); break;
+        case UCSCENE_ASSET_TEXTURE: ok = cooktexture(input.string(), output.string(), s, &item->error); break;
+        case UCSCENE_ASSET_AUDIOCLIP: ok = cooksound(input.string(), output.string(), &item->error); break;
+    }
+
+    if (ok && !hashfile(output.string(), &item->cookedHash, &item->cookedSize))
+    {
+        item->error = "can't read cooked file";
+        ok = false;
+    }
+    item->ok = ok;
+}
+
+int main(int argc, char **argv)
+{
+    CookSettings settings = CookSettings();
+    settings.mesh = MeshCooker::GetDefaultSettings();
+    settings.textureType = UCTEX_TYPE_AUTO;
+    settings.dither = true;
+    settings.mips = true;
+    bool force = false, verify = false;
+    std::vector<std::string> directories = std::vector<std::string>();
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-force")) force = true;
+        else if (!strcmp(argv[i], "-verify")) verify = true;
+        else if (!strcmp(argv[i], "-lods")) settings.mesh.lods = true;
+        else if (!strcmp(argv[i], "-nooptimize")) settings.mesh.optimize = false;
+        else if (!strcmp(argv[i], "-quantize")) settings.mesh.quantize = true;
+        else if (!strcmp(argv[i], "-nodither")) settings.dither = false;
+        else if (!strcmp(argv[i], "-nomips")) settings.mips = false;
+        else if (!strcmp(argv[i], "-texture-type") && i + 1 < argc)
+        {
+            i++;
+            if (!UCTEXImage::ParseTypeName(argv[i], &settings.textureType))
+            {
+                printf("Unknown texture type \"%s\".\n", argv[i]);
+                return 1;
+            }
+        }
+        else directories.push_back(argv[i]);
+    }
+
+    if (directories.size() != 2 || !std::filesystem::is_directory(directories[0]))
+    {
+        printf("Usage: %s <source directory> <output directory> [-force] [-verify] [-lods] [-nooptimize] [-quantize] [-texture-type auto|rgba8|rgb8|rgb5a1|rgb5] [-nodither] [-nomips]\n", argv[0]);
+        return 1;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::filesystem::path sourcedir = directories[0], outputdir = directories[1];
+    std::string manifestpath = (outputdir / MANIFEST_FILENAME).string();
+
+    AssetManifest old = AssetManifest();
+    old.Load(manifestpath);
+
+    // ===== SCAN =====
+
+    std::vector<CookItem> items = std::vector<CookItem>();
+    for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(sourcedir))
+    {
+        if (!entry.is_regular_file()) continue;
+
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char ch) { return std::tolower(ch); });
+
+        CookItem item = CookItem();
+        std::string cookedext;
+        if (ext == ".obj") { item.type = UCSCENE_ASSET_MESH; cookedext = ".ucmesh"; }
+        else if (ext == ".png") { item.type = UCSCENE_ASSET_TEXTURE; cookedext = ".uctex"; }
+        else if (ext == ".wav") { item.type = UCSCENE_ASSET_AUDIOCLIP; cookedext = ".ucsound"; }
+        else continue;
+
+        std::filesystem::path relative = entry.path().lexically_relative(sourcedir);
+        item.source = relative.generic_string();
+        item.cooked = std::filesystem::path(relative).replace_extension(cookedext).generic_string();
+        item.size = entry.file_size();
+        item.time = entry.last_write_time().time_since_epoch().count();
+        item.settingsHash = settingshash(item.type, &settings);
+        item.previous = old.Find(item.source);
+        items.push_back(item);
+    }
+    std::sort(items.begin(), items.end(), [](const CookItem &a, const CookItem &b) { return a.source < b.source; });
+
+    // ===== CHECK =====
+
+    // untouched sources take hash from manifest, the rest are read.
+    JobSystem jobs = JobSystem();
+    jobs.ParallelFor(items.size(), 16, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            CookItem *item = &items[i];
+            const UCMANIFESTEntry *prev = item->previous >= 0 ? &old.GetEntries()[item->previous] : nullptr;
+
+            if (prev && prev->sourceSize == item->size && prev->sourceTime == item->time)
+            {
+                item->hash = prev->sourceHash;
+                item->hashed = true;
+            }
+            else
+            {
+                uint64_t size;
+                item->hashed = hashfile((sourcedir / item->source).string(), &item->hash, &size);
+            }
+
+            item->dirty = force || !prev || !item->hashed || prev->sourceHash != item->hash || prev->settingsHash != item->settingsHash ||
+                strcmp(old.GetString(prev->cookedPath), item->cooked.c_str()) || !old.Validate(item->previous, outputdir.string(), verify);
+
+            if (!item->dirty)
+            {
+                item->ok = true;
+                item->cookedHash = prev->cookedHash;
+                item->cookedSize = prev->cookedSize;
+            }
+        }
+    });
+
+    // ===== COOK =====
+
+    std::vector<CookItem *> dirty = std::vector<CookItem *>();
+    for (CookItem &item : items) if (item.dirty) dirty.push_back(&item);
+
+    jobs.ParallelFor(dirty.size(), 1, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++) cook(dirty[i], sourcedir, outputdir, &settings);
+    });
+
+    // ===== MANIFEST =====
+
+    // failed assets are left out, so runtime never takes their stale cooked files.
+    AssetManifest manifest = AssetManifest();
+    size_t failed = 0;
+    for (CookItem &item : items)
+    {
+        if (item.dirty) printf("%s %s -> %s%s%s\n", item.ok ? "cooked" : "FAILED", item.source.c_str(), item.cooked.c_str(), item.ok ? "" : ": ", item.error.c_str());
+        if (!item.ok) { failed++; continue; }
+
+        UCMANIFESTEntry e = UCMANIFESTEntry();
+        e.sourceId = Utils::hash64(item.source);
+        e.sourceHash = item.hash;
+        e.settingsHash = item.settingsHash;
+        e.sourceSize = item.size;
+        e.sourceTime = item.time;
+        e.cookedHash = item.cookedHash;
+        e.cookedSize = item.cookedSize;
+        e.type = item.type;
+        manifest.AddEntry(e, item.source, item.cooked);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(outputdir, ec);
+    if (!manifest.Save(manifestpath))
+    {
+        printf("Error: can't write \"%s\".\n", manifestpath.c_str());
+        return 1;
+    }
+
+    // saved manifest is sorted, so it can be searched.
+    size_t removed = 0;
+    for (size_t i = 0; i < old.GetEntriesCount(); i++)
+        if (manifest.Find(old.GetEntries()[i].sourceId) < 0) removed++;
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%zu assets: %zu cooked, %zu up to date, %zu failed, %zu dropped from manifest (%.2f s).\n", items.size(),
+        dirty.size() - failed, items.size() - dirty.size(), failed, removed, seconds);
+    return failed ? 1 : 0;
+}
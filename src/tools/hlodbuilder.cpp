@@ -0,0 +1,210 @@
+/*
+    Offline HLOD builder: merges cells "cell_<x>_<z>.ucscene" of world directory into regions of NxN cells and writes
+    proxy of every region next to them:
+        hlod_<N>_<rx>_<rz>.ucmesh - merged and simplified geometry (world space),
+        hlod_<N>_<rx>_<rz>.uctex - baked atlas,
+        hlod_<N>_<rx>_<rz>.ucscene - single entity that uses them, streamed by WorldPartition instead of far cells.
+
+    Usage: hlodbuilder <world directory> [region size in cells = 4] [cluster size = 0.5] [tile size = 64]
+    Asset paths in cells are resolved relative to current directory (as in game), so run it from game's directory.
+*/
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "../glm.hpp"
+#include "../formats/UCSCENEFile.hpp"
+#include "../formats/UCMESHData.hpp"
+#include "../formats/UCTEXImage.hpp"
+#include "../geometry/HLODBuilder.hpp"
+
+static std::unordered_map<uint64_t, std::unique_ptr<UCMESHData>> meshes;
+static std::unordered_map<uint64_t, std::unique_ptr<UCTEXImage>> textures;
+
+static glm::mat4 tomatrix(const UCSCENETransform *t)
+{
+    // same as Transform::GetTransformationMatrix().
+    glm::quat q = glm::quat(t->rotation[3], t->rotation[0], t->rotation[1], t->rotation[2]);
+    return glm::scale(glm::translate(glm::mat4(1), glm::vec3(t->position[0], t->position[1], t->position[2])) * glm::toMat4(q),
+        glm::vec3(t->scale[0], t->scale[1], t->scale[2]));
+}
+
+static glm::vec4 tocolor(const float c[4]) { return glm::vec4(c[0], c[1], c[2], c[3]); }
+
+// missing or broken assets are loaded once and remembered as nullptr.
+static UCMESHData *getmesh(UCSCENEFile *file, uint64_t id)
+{
+    if (meshes.count(id)) return meshes[id].get();
+
+    int64_t a = file->FindAsset(id);
+    std::unique_ptr<UCMESHData> m = std::make_unique<UCMESHData>();
+    if (a < 0 || !m->LoadFromUCMESHFile(file->GetString(file->GetAssets()[a].path)))
+    {
+        if (a >= 0) printf("Warning: can't load mesh \"%s\".\n", file->GetString(file->GetAssets()[a].path));
+        m = nullptr;
+    }
+    return (meshes[id] = std::move(m)).get();
+}
+
+static UCTEXImage *gettexture(UCSCENEFile *file, uint64_t id)
+{
+    if (id == 0) return nullptr;
+    if (textures.count(id)) return textures[id].get();
+
+    int64_t a = file->FindAsset(id);
+    std::unique_ptr<UCTEXImage> t = std::make_unique<UCTEXImage>();
+    if (a < 0 || !t->LoadFromUCTEXFile(file->GetString(file->GetAssets()[a].path)))
+    {
+        if (a >= 0) printf("Warning: can't load texture \"%s\".\n", file->GetString(file->GetAssets()[a].path));
+        t = nullptr;
+    }
+    return (textures[id] = std::move(t)).get();
+}
+
+struct
+{
+    bool first;
+    uint32_t culling;
+    bool mixedCulling;
+    float alphaCutoff;
+} typedef SurfaceFlags;
+
+static void addnode(HLODBuilder *builder, UCSCENEFile *file, const UCSCENENode *node, glm::mat4 world, SurfaceFlags *flags)
+{
+    if (node->type != UCSCENE_NODE_ENTITY || (node->flags & UCSCENE_NODE_HIDDEN)) return;
+
+    const UCSCENESurface *surfaces = file->GetSurfaces() + node->firstSurface;
+    for (uint32_t i = 0; i < node->surfacesCount; i++)
+    {
+        const UCSCENESurface *s = &surfaces[i];
+        if (s->culling == UCSCENE_CULLING_BOTH) continue; // never rendered.
+
+        UCMESHData *mesh = getmesh(file, s->mesh);
+        if (!mesh) continue;
+
+        builder->AddSurface(mesh, world * tomatrix(&s->transform), gettexture(file, s->texture), tocolor(node->color) * tocolor(s->color));
+
+        if (flags->first) flags->culling = s->culling;
+        else if (flags->culling != s->culling) flags->mixedCulling = true;
+        flags->alphaCutoff = std::max(flags->alphaCutoff, s->alphaCutoff);
+        flags->first = false;
+    }
+}
+
+static void addcell(HLODBuilder *builder, std::string filename, SurfaceFlags *flags)
+{
+    UCSCENEFile file = UCSCENEFile();
+    if (!file.Open(filename))
+    {
+        printf("Warning: can't open \"%s\", skipped.\n", filename.c_str());
+        return;
+    }
+
+    // parents always come first, so world matrices are built in one pass.
+    const UCSCENENode *nodes = file.GetNodes();
+    std::vector<glm::mat4> world = std::vector<glm::mat4>(file.GetSceneNodesCount());
+    for (uint32_t i = 0; i < world.size(); i++)
+    {
+        world[i] = (nodes[i].parent < 0 ? glm::mat4(1) : world[nodes[i].parent]) * tomatrix(&nodes[i].transform);
+        addnode(builder, &file, &nodes[i], world[i], flags);
+    }
+
+    const UCSCENEInstance *instances = file.GetInstances();
+    for (uint32_t i = 0; i < file.GetCount(UCSCENE_TABLE_INSTANCES); i++)
+    {
+        int64_t p = file.FindPrefab(instances[i].prefab);
+        if (p < 0) continue;
+
+        const UCSCENEPrefab *prefab = &file.GetPrefabs()[p];
+        glm::mat4 root = (instances[i].parent < 0 ? glm::mat4(1) : world[instances[i].parent]) * tomatrix(&instances[i].transform);
+
+        std::vector<glm::mat4> pworld = std::vector<glm::mat4>(prefab->nodesCount);
+        const UCSCENENode *n = nodes + prefab->firstNode;
+        for (uint32_t j = 0; j < prefab->nodesCount; j++)
+        {
+            pworld[j] = (n[j].parent < 0 ? root : pworld[n[j].parent - prefab->firstNode]) * tomatrix(&n[j].transform);
+            addnode(builder, &file, &n[j], pworld[j], flags);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <world directory> [region size in cells = 4] [cluster size = 0.5] [tile size = 64]\n", argv[0]);
+        return 1;
+    }
+
+    std::filesystem::path directory = argv[1];
+    int regionsize = argc > 2 ? atoi(argv[2]) : 4;
+    HLODSettings settings = HLODBuilder::GetDefaultSettings();
+    if (argc > 3) settings.clusterSize = atof(argv[3]);
+    if (argc > 4) settings.tileSize = atoi(argv[4]);
+
+    if (regionsize < 1 || !std::filesystem::is_directory(directory))
+    {
+        printf("Invalid world directory or region size.\n");
+        return 1;
+    }
+
+    // region -> its cells, ordered so output is stable.
+    std::map<std::pair<int, int>, std::vector<std::string>> regions = std::map<std::pair<int, int>, std::vector<std::string>>();
+    for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(directory))
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ".ucscene") continue;
+
+        int x, z, length = 0;
+        std::string name = entry.path().stem().string();
+        if (sscanf(name.c_str(), "cell_%d_%d%n", &x, &z, &length) != 2 || length != (int)name.size()) continue;
+
+        std::pair<int, int> region = { (int)std::floor((float)x / regionsize), (int)std::floor((float)z / regionsize) };
+        regions[region].push_back(entry.path().generic_string());
+    }
+
+    unsigned int built = 0;
+    for (std::pair<const std::pair<int, int>, std::vector<std::string>> &r : regions)
+    {
+        HLODBuilder builder = HLODBuilder();
+        SurfaceFlags flags = { true, 1, false, 0.0f };
+        for (std::string &cell : r.second) addcell(&builder, cell, &flags);
+
+        std::string base = (directory / ("hlod_" + std::to_string(regionsize) + "_" + std::to_string(r.first.first) + "_" + std::to_string(r.first.second))).generic_string();
+
+        UCMESHData mesh = UCMESHData();
+        UCTEXImage atlas = UCTEXImage();
+        if (!builder.Build(settings, &mesh, &atlas) || mesh.indices.empty())
+        {
+            printf("Region %d %d: nothing to build.\n", r.first.first, r.first.second);
+            continue;
+        }
+
+        UCSCENEWriter writer = UCSCENEWriter();
+        UCSCENESurface surface = UCSCENEWriter::MakeSurface(writer.AddAsset(UCSCENE_ASSET_MESH, base + ".ucmesh"), writer.AddAsset(UCSCENE_ASSET_TEXTURE, base + ".uctex"));
+        surface.culling = flags.mixedCulling ? (uint32_t)UCSCENE_CULLING_NONE : flags.culling;
+        surface.alphaCutoff = flags.alphaCutoff > 0.0f ? 0.5f : 0.0f;
+        writer.AddSurface(writer.AddNode(UCSCENEWriter::MakeNode(UCSCENE_NODE_ENTITY, UCSCENEWriter::IdentityTransform())), surface);
+
+        if (!mesh.SaveToUCMESHFile(base + ".ucmesh") || !atlas.SaveToUCTEXFile(base + ".uctex") || !writer.Save(base + ".ucscene"))
+        {
+            printf("Error: can't write \"%s\" proxy files.\n", base.c_str());
+            return 1;
+        }
+
+        HLODStats st = builder.GetStats();
+        printf("Region %d %d: %zu cells, %zu surfaces, %zu -> %zu triangles, %u tiles of %u px in %ux%u atlas.\n", r.first.first, r.first.second,
+            r.second.size(), builder.GetSurfacesCount(), st.sourceTrianglesCount, st.proxyTrianglesCount, st.tilesCount, st.tileSize, st.atlasWidth, st.atlasHeight);
+        built++;
+    }
+
+    printf("Built %u proxies.\n", built);
+    return 0;
+}
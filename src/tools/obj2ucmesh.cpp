@@ -0,0 +1,103 @@
+/*
+    OBJ -> UCMESH converter (replaces obj2ucmesh.py): vertices are welded by hash map, polygons of any size are triangulated.
+    Several inputs are converted in parallel, every one is written next to it with .ucmesh extension.
+
+    Usage: obj2ucmesh [-lods] [-nooptimize] [-quantize] <input .obj> [output .ucmesh]
+           obj2ucmesh [-lods] [-nooptimize] [-quantize] <input .obj>...
+    -lods - also generate LOD chain (see MeshSimplifier), file is written as UCMESH version 1.
+    -nooptimize - keep OBJ face order instead of vertex cache, overdraw and vertex fetch optimization (see MeshOptimizer).
+    -quantize - 16-bit positions and UVs within mesh bounds and delta coded indices, file is written as UCMESH version 2.
+*/
+
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <cstdio>
+#include <cstring>
+
+#include "../geometry/MeshCooker.hpp"
+#include "../objects/JobSystem.hpp"
+
+struct
+{
+    std::string input, output;
+    bool ok;
+    std::string error;
+    MeshCookStats stats;
+    uint64_t size;
+} typedef Conversion;
+
+static void convert(Conversion *c, MeshCookSettings settings)
+{
+    c->ok = MeshCooker::CookOBJFile(c->input, c->output, settings, &c->stats, &c->error);
+    if (!c->ok) return;
+
+    std::error_code ec;
+    c->size = std::filesystem::file_size(c->output, ec);
+}
+
+int main(int argc, char **argv)
+{
+    MeshCookSettings settings = MeshCooker::GetDefaultSettings();
+    std::vector<std::string> files = std::vector<std::string>();
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-lods")) settings.lods = true;
+        else if (!strcmp(argv[i], "-nooptimize")) settings.optimize = false;
+        else if (!strcmp(argv[i], "-quantize")) settings.quantize = true;
+        else files.push_back(argv[i]);
+    }
+
+    if (files.empty())
+    {
+        printf("Usage: %s [-lods] [-nooptimize] [-quantize] <input .obj> [output .ucmesh]\n", argv[0]);
+        printf("       %s [-lods] [-nooptimize] [-quantize] <input .obj>...\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Conversion> conversions = std::vector<Conversion>();
+    bool single = files.size() == 2 && std::filesystem::path(files[1]).extension() == ".ucmesh";
+    for (size_t i = 0; i < (single ? 1 : files.size()); i++)
+    {
+        Conversion c = Conversion();
+        c.input = files[i];
+        c.output = single ? files[1] : std::filesystem::path(files[i]).replace_extension(".ucmesh").generic_string();
+        conversions.push_back(c);
+    }
+
+    JobSystem jobs = JobSystem();
+    jobs.ParallelFor(conversions.size(), 1, [&conversions, settings](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++) convert(&conversions[i], settings);
+    });
+
+    int failed = 0;
+    for (Conversion &c : conversions)
+    {
+        if (!c.ok)
+        {
+            printf("%s: error: %s.\n", c.input.c_str(), c.error.c_str());
+            failed++;
+            continue;
+        }
+
+        MeshCookStats *st = &c.stats;
+        printf("%s -> %s: %zu vertices, %zu triangles (%zu polygons triangulated", c.input.c_str(), c.output.c_str(), st->verticesCount, st->trianglesCount, st->obj.polygonsCount);
+        if (st->obj.degenerateTrianglesCount) printf(", %zu degenerate triangles dropped", st->obj.degenerateTrianglesCount);
+        printf(")");
+        if (settings.lods)
+        {
+            printf(", LODs:");
+            if (st->lodsTrianglesCount.empty()) printf(" none");
+            for (size_t t : st->lodsTrianglesCount) printf(" %zu", t);
+        }
+        if (settings.optimize) printf(", ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", st->before.acmr, st->after.acmr, st->before.atvr, st->after.atvr);
+        else printf(", ACMR %.3f, ATVR %.3f", st->after.acmr, st->after.atvr);
+        printf(", %llu bytes", (unsigned long long)c.size);
+        printf(".\n");
+
+        if (st->obj.skippedLinesCount) printf("%s: warning: %zu invalid or unsupported lines skipped (first is line %zu).\n", c.input.c_str(), st->obj.skippedLinesCount, st->obj.firstSkippedLine);
+    }
+
+    return failed ? 1 : 0;
+}
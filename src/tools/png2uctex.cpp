@@ -0,0 +1,142 @@
+/*
+    PNG -> UCTEX converter (replaces png2uctex.py): any PNG (palette, grayscale, 16 bit) is decoded by libpng and written
+    as chosen UCTEX type with mip chain (UCTEX version 1). Several files are converted in parallel, directories are
+    scanned recursively, every output is written next to its input with .uctex extension.
+
+    Usage: png2uctex [options] <input .png> [output .uctex]
+           png2uctex [options] <input .png or directory>...
+    Options:
+        -type <auto|rgba8|rgb8|rgb5a1|rgb5> - auto (default) is RGBA8 for images with transparency, RGB8 for the rest;
+        -nodither - no ordered dithering for RGB5A1/RGB5;
+        -nomips - write level 0 only (UCTEX version 0).
+*/
+
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+
+#include "../formats/UCTEXImage.hpp"
+#include "../formats/PNGReader.hpp"
+#include "../objects/JobSystem.hpp"
+
+struct
+{
+    int type;
+    bool dither;
+    bool mips;
+} typedef ConversionSettings;
+
+struct
+{
+    std::string input, output;
+    bool ok;
+    std::string error;
+    uint32_t width, height;
+    UCTEXType type;
+    size_t levelsCount;
+} typedef Conversion;
+
+static void convert(Conversion *c, ConversionSettings settings)
+{
+    UCTEXImage image = UCTEXImage();
+    if (!PNGReader::ReadPNGFile(c->input, &image, &c->error)) return;
+
+    c->width = image.GetWidth();
+    c->height = image.GetHeight();
+    if (!image.SaveCookedUCTEXFile(c->output, settings.type, settings.dither, settings.mips, &c->type, &c->levelsCount))
+    {
+        c->error = "can't write \"" + c->output + "\"";
+        return;
+    }
+    c->ok = true;
+}
+
+int main(int argc, char **argv)
+{
+    ConversionSettings settings = { UCTEX_TYPE_AUTO, true, true };
+    std::vector<std::string> inputs = std::vector<std::string>();
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-nodither")) settings.dither = false;
+        else if (!strcmp(argv[i], "-nomips")) settings.mips = false;
+        else if (!strcmp(argv[i], "-type") && i + 1 < argc)
+        {
+            i++;
+            if (!UCTEXImage::ParseTypeName(argv[i], &settings.type))
+            {
+                printf("Unknown type \"%s\".\n", argv[i]);
+                return 1;
+            }
+        }
+        else inputs.push_back(argv[i]);
+    }
+
+    if (inputs.empty())
+    {
+        printf("Usage: %s [-type auto|rgba8|rgb8|rgb5a1|rgb5] [-nodither] [-nomips] <input .png> [output .uctex]\n", argv[0]);
+        printf("       %s [-type auto|rgba8|rgb8|rgb5a1|rgb5] [-nodither] [-nomips] <input .png or directory>...\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Conversion> conversions = std::vector<Conversion>();
+    auto add = [&conversions](std::string input, std::string output)
+    {
+        Conversion c = Conversion();
+        c.input = input;
+        c.output = output;
+        conversions.push_back(c);
+    };
+
+    if (inputs.size() == 2 && std::filesystem::path(inputs[1]).extension() == ".uctex") add(inputs[0], inputs[1]);
+    else
+    {
+        for (std::string &in : inputs)
+        {
+            if (!std::filesystem::is_directory(in))
+            {
+                add(in, std::filesystem::path(in).replace_extension(".uctex").generic_string());
+                continue;
+            }
+
+            std::vector<std::string> found = std::vector<std::string>();
+            for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(in))
+            {
+                if (!entry.is_regular_file()) continue;
+
+                std::string ext = entry.path().extension().string();
+                std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char ch) { return std::tolower(ch); });
+                if (ext == ".png") found.push_back(entry.path().generic_string());
+            }
+
+            // directory order isn't stable.
+            std::sort(found.begin(), found.end());
+            for (std::string &f : found) add(f, std::filesystem::path(f).replace_extension(".uctex").generic_string());
+        }
+    }
+
+    JobSystem jobs = JobSystem();
+    jobs.ParallelFor(conversions.size(), 1, [&conversions, settings](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++) convert(&conversions[i], settings);
+    });
+
+    int failed = 0;
+    for (Conversion &c : conversions)
+    {
+        if (!c.ok)
+        {
+            printf("%s: error: %s.\n", c.input.c_str(), c.error.c_str());
+            failed++;
+            continue;
+        }
+
+        printf("%s -> %s: %ux%u %s, %zu levels.\n", c.input.c_str(), c.output.c_str(), c.width, c.height, UCTEXImage::GetTypeName(c.type), c.levelsCount);
+    }
+
+    if (conversions.size() > 1) printf("Converted %zu of %zu files.\n", conversions.size() - failed, conversions.size());
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,152 @@
+/*
+    Offline PVS builder: computes cell-to-cell visibility of static geometry of scene and writes it next to it
+    ("level.ucscene" -> "level.ucpvs"), Scene loads it automatically.
+
+    Static geometry is every visible entity of scene and its prefab instances flagged UCSCENE_NODE_STATIC, except
+    alpha tested surfaces (fences, foliage) and ones that are never rendered. Props and doors must be left unflagged,
+    otherwise what's behind them stays hidden after they move. Surfaces are treated as opaque from both sides.
+
+    Usage: pvsbuilder <scene.ucscene> [cell size = 4] [samples per cell = 32] [rays per pair = 256] [threads = 0 - all]
+    Asset paths in scene are resolved relative to current directory (as in game), so run it from game's directory.
+*/
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../glm.hpp"
+#include "../formats/UCSCENEFile.hpp"
+#include "../formats/UCMESHData.hpp"
+#include "../formats/UCPVSFile.hpp"
+#include "../geometry/PVSBuilder.hpp"
+#include "../objects/JobSystem.hpp"
+
+static std::unordered_map<uint64_t, std::unique_ptr<UCMESHData>> meshes;
+
+static glm::mat4 tomatrix(const UCSCENETransform *t)
+{
+    // same as Transform::GetTransformationMatrix().
+    glm::quat q = glm::quat(t->rotation[3], t->rotation[0], t->rotation[1], t->rotation[2]);
+    return glm::scale(glm::translate(glm::mat4(1), glm::vec3(t->position[0], t->position[1], t->position[2])) * glm::toMat4(q),
+        glm::vec3(t->scale[0], t->scale[1], t->scale[2]));
+}
+
+// missing or broken meshes are loaded once and remembered as nullptr.
+static UCMESHData *getmesh(UCSCENEFile *file, uint64_t id)
+{
+    if (meshes.count(id)) return meshes[id].get();
+
+    int64_t a = file->FindAsset(id);
+    std::unique_ptr<UCMESHData> m = std::make_unique<UCMESHData>();
+    if (a < 0 || !m->LoadFromUCMESHFile(file->GetString(file->GetAssets()[a].path)))
+    {
+        if (a >= 0) printf("Warning: can't load mesh \"%s\".\n", file->GetString(file->GetAssets()[a].path));
+        m = nullptr;
+    }
+    return (meshes[id] = std::move(m)).get();
+}
+
+static void addnode(PVSBuilder *builder, UCSCENEFile *file, const UCSCENENode *node, glm::mat4 world)
+{
+    if (node->type != UCSCENE_NODE_ENTITY || !(node->flags & UCSCENE_NODE_STATIC) || (node->flags & UCSCENE_NODE_HIDDEN)) return;
+
+    const UCSCENESurface *surfaces = file->GetSurfaces() + node->firstSurface;
+    for (uint32_t i = 0; i < node->surfacesCount; i++)
+    {
+        const UCSCENESurface *s = &surfaces[i];
+        if (s->culling == UCSCENE_CULLING_BOTH || s->alphaCutoff > 0.0f) continue; // never rendered or alpha tested (has holes).
+
+        UCMESHData *mesh = getmesh(file, s->mesh);
+        if (mesh) builder->AddMesh(mesh, world * tomatrix(&s->transform));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <scene.ucscene> [cell size = 4] [samples per cell = 32] [rays per pair = 256] [threads = 0 - all]\n", argv[0]);
+        return 1;
+    }
+
+    std::string filename = argv[1];
+    PVSSettings settings = PVSBuilder::GetDefaultSettings();
+    if (argc > 2) settings.cellSize = glm::vec3(atof(argv[2]));
+    if (argc > 3) settings.samplesPerCell = atoi(argv[3]);
+    if (argc > 4) settings.raysPerPair = atoi(argv[4]);
+    unsigned int threads = argc > 5 ? atoi(argv[5]) : 0;
+
+    size_t dot = filename.find_last_of('.');
+    if (dot == std::string::npos || filename.substr(dot) != ".ucscene" || settings.cellSize.x <= 0.0f)
+    {
+        printf("Invalid scene file name or cell size.\n");
+        return 1;
+    }
+    std::string output = filename.substr(0, dot) + ".ucpvs";
+
+    UCSCENEFile file = UCSCENEFile();
+    if (!file.Open(filename))
+    {
+        printf("Error: can't open \"%s\".\n", filename.c_str());
+        return 1;
+    }
+
+    // parents always come first, so world matrices are built in one pass.
+    PVSBuilder builder = PVSBuilder();
+    const UCSCENENode *nodes = file.GetNodes();
+    std::vector<glm::mat4> world = std::vector<glm::mat4>(file.GetSceneNodesCount());
+    for (uint32_t i = 0; i < world.size(); i++)
+    {
+        world[i] = (nodes[i].parent < 0 ? glm::mat4(1) : world[nodes[i].parent]) * tomatrix(&nodes[i].transform);
+        addnode(&builder, &file, &nodes[i], world[i]);
+    }
+
+    const UCSCENEInstance *instances = file.GetInstances();
+    for (uint32_t i = 0; i < file.GetCount(UCSCENE_TABLE_INSTANCES); i++)
+    {
+        int64_t p = file.FindPrefab(instances[i].prefab);
+        if (p < 0) continue;
+
+        const UCSCENEPrefab *prefab = &file.GetPrefabs()[p];
+        glm::mat4 root = (instances[i].parent < 0 ? glm::mat4(1) : world[instances[i].parent]) * tomatrix(&instances[i].transform);
+
+        std::vector<glm::mat4> pworld = std::vector<glm::mat4>(prefab->nodesCount);
+        const UCSCENENode *n = nodes + prefab->firstNode;
+        for (uint32_t j = 0; j < prefab->nodesCount; j++)
+        {
+            pworld[j] = (n[j].parent < 0 ? root : pworld[n[j].parent - prefab->firstNode]) * tomatrix(&n[j].transform);
+            addnode(&builder, &file, &n[j], pworld[j]);
+        }
+    }
+
+    JobSystem jobs = JobSystem(threads);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (!builder.Build(settings, &jobs))
+    {
+        printf("Error: no static geometry (UCSCENE_NODE_STATIC) or too many cells (max %d), try bigger cell size.\n", PVS_MAX_CELLS);
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    UCPVSWriter writer = UCPVSWriter();
+    writer.SetGrid(builder.GetGridMin(), builder.GetCellSize(), builder.GetCellsCount());
+    glm::uvec3 c = builder.GetCellsCount();
+    for (uint32_t i = 0; i < c.x * c.y * c.z; i++) writer.AddRow(builder.GetRow(i));
+
+    if (!writer.Save(output))
+    {
+        printf("Error: can't write \"%s\".\n", output.c_str());
+        return 1;
+    }
+
+    PVSStats st = builder.GetStats();
+    size_t cells = (size_t)c.x * c.y * c.z;
+    printf("%zu triangles, %ux%ux%u cells (%zu inside of walls or outside), %.1f visible per cell on average, %llu rays in %.2f s on %u threads.\n",
+        st.trianglesCount, c.x, c.y, c.z, st.emptyCellsCount, (double)st.visiblePairsCount / cells, (unsigned long long)st.raysCount, seconds, jobs.GetThreadsCount());
+    printf("Written \"%s\": %zu -> %zu bytes of visibility data.\n", output.c_str(), builder.GetRowSize() * cells, writer.GetDataSize());
+    return 0;
+}
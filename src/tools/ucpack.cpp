@@ -0,0 +1,126 @@
+/*
+    Packs cooked assets of directory into UCPACK archive, which game mounts instead of separate files (see UCPACKFile).
+    Files are added in path order, so assets of one directory (level) lie together and are read sequentially.
+
+    Usage: ucpack [-compress] [-align <bytes>] [-all] <directory> <output .ucpack>
+           ucpack -list <archive .ucpack>
+    -compress - LZ4 compress entries that get at least 1/8 smaller, UCSCENE files are always stored (they are read in place).
+    -align - alignment of entries, power of two, at least 8 (16 by default).
+    -all - pack every file, not only cooked ones (.ucmesh, .uctex, .ucsound, .ucscene, .ucpvs).
+*/
+
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../formats/MappedFile.hpp"
+#include "../formats/UCPACKFile.hpp"
+
+static bool iscooked(std::string extension) { return extension == ".ucmesh" || extension == ".uctex" || extension == ".ucsound" || extension == ".ucscene" || extension == ".ucpvs"; }
+
+static int list(std::string filename)
+{
+    UCPACKFile pack = UCPACKFile();
+    if (!pack.Open(filename))
+    {
+        printf("Error: \"%s\" isn't valid UCPACK archive.\n", filename.c_str());
+        return 1;
+    }
+
+    // in data order.
+    std::vector<const UCPACKEntry *> entries = std::vector<const UCPACKEntry *>();
+    for (uint32_t i = 0; i < pack.GetEntriesCount(); i++) entries.push_back(&pack.GetEntries()[i]);
+    std::sort(entries.begin(), entries.end(), [](const UCPACKEntry *a, const UCPACKEntry *b) { return a->offset < b->offset; });
+
+    uint64_t original = 0, stored = 0;
+    for (const UCPACKEntry *e : entries)
+    {
+        printf("%12llu %12llu %s %s\n", (unsigned long long)e->originalSize, (unsigned long long)e->size,
+            e->flags & UCPACK_ENTRY_COMPRESSED ? "lz4   " : "stored", pack.GetString(e->path));
+        original += e->originalSize;
+        stored += e->size;
+    }
+    printf("%zu entries, %llu bytes (%llu stored).\n", entries.size(), (unsigned long long)original, (unsigned long long)stored);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bool compress = false, all = false;
+    uint32_t alignment = UCPACK_DEFAULT_ALIGNMENT;
+    std::vector<std::string> args = std::vector<std::string>();
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-list") && i + 1 < argc) return list(argv[i + 1]);
+        else if (!strcmp(argv[i], "-compress")) compress = true;
+        else if (!strcmp(argv[i], "-all")) all = true;
+        else if (!strcmp(argv[i], "-align") && i + 1 < argc) alignment = strtoul(argv[++i], nullptr, 10);
+        else args.push_back(argv[i]);
+    }
+
+    if (args.size() != 2)
+    {
+        printf("Usage: %s [-compress] [-align <bytes>] [-all] <directory> <output .ucpack>\n", argv[0]);
+        printf("       %s -list <archive .ucpack>\n", argv[0]);
+        return 1;
+    }
+
+    std::filesystem::path root = args[0], output = args[1];
+    std::error_code ec;
+    if (!std::filesystem::is_directory(root, ec))
+    {
+        printf("Error: \"%s\" isn't a directory.\n", root.string().c_str());
+        return 1;
+    }
+
+    std::vector<std::string> files = std::vector<std::string>();
+    for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(root, ec))
+    {
+        if (!entry.is_regular_file() || std::filesystem::equivalent(entry.path(), output, ec)) continue;
+        if (!all && !iscooked(entry.path().extension().string())) continue;
+        files.push_back(entry.path().lexically_relative(root).generic_string());
+    }
+    std::sort(files.begin(), files.end());
+
+    UCPACKWriter writer = UCPACKWriter();
+    if (!writer.Create(output.string(), alignment))
+    {
+        printf("Error: can't create \"%s\" (alignment must be power of two, at least 8).\n", output.string().c_str());
+        return 1;
+    }
+
+    uint64_t original = 0;
+    size_t compressed = 0;
+    for (std::string &f : files)
+    {
+        MappedFile file = MappedFile();
+        if (!file.Open((root / f).string()))
+        {
+            printf("Error: can't read \"%s\".\n", f.c_str());
+            return 1;
+        }
+
+        bool scene = std::filesystem::path(f).extension() == ".ucscene";
+        if (!writer.AddEntry(f, file.GetData(), file.GetSize(), compress && !scene))
+        {
+            printf("Error: can't add \"%s\" (write failed or path hash collides with another one).\n", f.c_str());
+            return 1;
+        }
+        original += file.GetSize();
+        if (writer.GetEntries()[writer.GetEntriesCount() - 1].flags & UCPACK_ENTRY_COMPRESSED) compressed++;
+    }
+
+    if (!writer.Finish())
+    {
+        printf("Error: can't write \"%s\".\n", output.string().c_str());
+        return 1;
+    }
+
+    printf("%s: %zu entries (%zu compressed), %llu bytes of files -> %llu bytes.\n", output.string().c_str(), files.size(), compressed,
+        (unsigned long long)original, (unsigned long long)writer.GetSize());
+    return 0;
+}
@@ -34,4 +34,26 @@ namespace Utils
     { return "{" + std::to_string(v.x) + "; " + std::to_string(v.y) + "; " + std::to_string(v.z) + "}"; }
 
     glm::vec3 wrapangles(glm::vec3 euler) { return glm::vec3(fmod(euler.x, 360.0f), fmod(euler.y, 360.0f), fmod(euler.z, 360.0f)); }
+
+    uint64_t hash64(const void *data, size_t size, uint64_t seed)
+    {
+        const uint8_t *bytes = (const uint8_t *)data;
+        uint64_t hash = seed;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ULL;
+        }
+        return hash;
+    }
+
+    uint64_t hash64(std::string str, uint64_t seed) { return hash64(str.data(), str.size(), seed); }
+
+    std::string tohex(uint64_t value)
+    {
+        const char *digits = "0123456789abcdef";
+        std::string ret = std::string(16, '0');
+        for (int i = 15; i >= 0; i--, value >>= 4) ret[i] = digits[value & 0xF];
+        return ret;
+    }
 }
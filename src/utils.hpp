@@ -2,6 +2,9 @@
 #define UTILS_HPP
 
 #include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
 
 #include "glm.hpp"
 
@@ -25,6 +28,21 @@ namespace Utils
     glm::vec3 normalize(glm::vec3 v);
     glm::vec3 wrapangles(glm::vec3 euler);
     std::string tostring(glm::vec3 v);
+
+    // 64-bit FNV-1a, seed allows to chain hashes of several blocks.
+    const uint64_t HASH64_SEED = 0xCBF29CE484222325ULL;
+    uint64_t hash64(const void *data, size_t size, uint64_t seed = HASH64_SEED);
+    uint64_t hash64(std::string str, uint64_t seed = HASH64_SEED);
+    std::string tohex(uint64_t value);
+
+    // copies next size bytes of buffer [*p; end) and moves *p past them, false if there aren't enough of them.
+    inline bool readbytes(const uint8_t **p, const uint8_t *end, void *out, size_t size)
+    {
+        if ((size_t)(end - *p) < size) return false;
+        memcpy(out, *p, size);
+        *p += size;
+        return true;
+    }
 }
 
 #endif
\ No newline at end of file